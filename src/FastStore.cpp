@@ -36,6 +36,8 @@
 #include <fstream>
 #include <vector>
 #include <cstring>
+#include <climits>
+#include <cmath>
 
 #include <Rcpp.h>
 
@@ -44,6 +46,15 @@
 #include <interface/ifsttable.h>
 #include <interface/icolumnfactory.h>
 #include <interface/fststore.h>
+#include <interface/fstfilter.h>
+#include <interface/fstsource.h>
+#include <interface/fstmemorybuffer.h>
+#include <interface/fstbatchreader.h>
+#include <interface/fstreadplanner.h>
+#include <interface/fstiocounter.h>
+#include <interface/fstasyncreader.h>
+#include <interface/openmphelper.h>
+#include <character/character_v6.h>
 
 #include <blockrunner_char.h>
 #include <fsttable.h>
@@ -76,13 +87,18 @@ inline int FindKey(StringVector colNameList, String item)
 }
 
 
-SEXP fststore(String fileName, SEXP table, SEXP compression, SEXP uniformEncoding)
+SEXP fststore(String fileName, SEXP table, SEXP compression, SEXP uniformEncoding, SEXP append)
 {
   if (!Rf_isLogical(uniformEncoding))
   {
     ::Rf_error("Parameter uniform.encoding should be a logical value");
   }
 
+  if (!Rf_isLogical(append))
+  {
+    ::Rf_error("Parameter append should be a logical value");
+  }
+
   if (!Rf_isInteger(compression))
   {
     ::Rf_error("Parameter compression should be an integer value between 0 and 100");
@@ -99,7 +115,14 @@ SEXP fststore(String fileName, SEXP table, SEXP compression, SEXP uniformEncodin
 
   try
   {
-    fstStore.fstWrite(fstTable, compress);
+    if (*LOGICAL(append))
+    {
+      fstStore.fstAppend(fstTable, compress);
+    }
+    else
+    {
+      fstStore.fstWrite(fstTable, compress);
+    }
   }
   catch (const std::runtime_error& e)
   {
@@ -110,9 +133,378 @@ SEXP fststore(String fileName, SEXP table, SEXP compression, SEXP uniformEncodin
 }
 
 
-SEXP fstmetadata(String fileName)
+SEXP fstaddcolumns(String fileName, SEXP table, SEXP compression, SEXP uniformEncoding)
 {
+  if (!Rf_isLogical(uniformEncoding))
+  {
+    ::Rf_error("Parameter uniform.encoding should be a logical value");
+  }
+
+  if (!Rf_isInteger(compression))
+  {
+    ::Rf_error("Parameter compression should be an integer value between 0 and 100");
+  }
+
+  int compress = *INTEGER(compression);
+  if ((compress < 0) | (compress > 100))
+  {
+    ::Rf_error("Parameter compression should be an integer value between 0 and 100");
+  }
+
+  FstTable fstTable(table, *LOGICAL(uniformEncoding));
+  FstStore fstStore(fileName.get_cstring());
+
+  try
+  {
+    fstStore.fstAppendColumns(fstTable, compress);
+  }
+  catch (const std::runtime_error& e)
+  {
+    ::Rf_error(e.what());
+  }
+
+  return table;
+}
+
+
+SEXP fstserialize(SEXP table, SEXP compression, SEXP uniformEncoding)
+{
+  if (!Rf_isLogical(uniformEncoding))
+  {
+    ::Rf_error("Parameter uniform.encoding should be a logical value");
+  }
+
+  if (!Rf_isInteger(compression))
+  {
+    ::Rf_error("Parameter compression should be an integer value between 0 and 100");
+  }
+
+  int compress = *INTEGER(compression);
+  if ((compress < 0) | (compress > 100))
+  {
+    ::Rf_error("Parameter compression should be an integer value between 0 and 100");
+  }
+
+  FstTable fstTable(table, *LOGICAL(uniformEncoding));
+  FstStore fstStore("");
+
+  // the serialized table is collected in memory and copied to a raw vector afterwards
+  FstMemoryBuffer* memoryBuffer = new FstMemoryBuffer(1 << 20);
+
+  try
+  {
+    fstStore.fstWrite(fstTable, compress, *memoryBuffer);
+  }
+  catch (const std::runtime_error& e)
+  {
+    delete memoryBuffer;
+    ::Rf_error(e.what());
+  }
+
+  SEXP rawVec;
+  PROTECT(rawVec = Rf_allocVector(RAWSXP, memoryBuffer->Size()));
+  std::memcpy(RAW(rawVec), memoryBuffer->Data(), memoryBuffer->Size());
+  delete memoryBuffer;
+  UNPROTECT(1);
+
+  return rawVec;
+}
+
+
+// Store for a fst file path or for a raw vector with a serialized table
+inline FstStore* SourceStore(SEXP source)
+{
+  if (TYPEOF(source) == RAWSXP)
+  {
+    return new FstStore(reinterpret_cast<const char*>(RAW(source)), XLENGTH(source));
+  }
+
+  return new FstStore(CHAR(STRING_ELT(source, 0)));
+}
+
+
+// Finalizer of a fst handle, also used to close a handle explicitly
+static void FstHandleFinalizer(SEXP handle)
+{
+  FstStore* fstStore = static_cast<FstStore*>(R_ExternalPtrAddr(handle));
+
+  if (fstStore == nullptr) return;
+
+  delete fstStore;
+  R_ClearExternalPtr(handle);
+}
+
+
+// Opened store of a fst handle, an error is raised if the handle is closed
+inline FstStore* HandleStore(SEXP handle)
+{
+  FstStore* fstStore = static_cast<FstStore*>(R_ExternalPtrAddr(handle));
+
+  if (fstStore == nullptr)
+  {
+    ::Rf_error("The fst handle is closed.");
+  }
+
+  return fstStore;
+}
+
+
+SEXP fstopen(String fileName)
+{
+  FstStore* fstStore = new FstStore(fileName.get_cstring());
+
+  try
+  {
+    fstStore->fstOpen();
+  }
+  catch (const std::runtime_error& e)
+  {
+    delete fstStore;
+    ::Rf_error(e.what());
+  }
+
+  SEXP handle;
+  PROTECT(handle = R_MakeExternalPtr(fstStore, Rf_install("fst_handle"), R_NilValue));
+  R_RegisterCFinalizerEx(handle, FstHandleFinalizer, TRUE);
+  UNPROTECT(1);
+
+  return handle;
+}
+
+
+SEXP fstclose(SEXP handle)
+{
+  FstHandleFinalizer(handle);
+
+  return R_NilValue;
+}
+
+
+SEXP fstwriteropen(String fileName, SEXP compression)
+{
+  if (!Rf_isInteger(compression))
+  {
+    ::Rf_error("Parameter compression should be an integer value between 0 and 100");
+  }
+
+  int compress = *INTEGER(compression);
+  if ((compress < 0) | (compress > 100))
+  {
+    ::Rf_error("Parameter compression should be an integer value between 0 and 100");
+  }
+
   FstStore* fstStore = new FstStore(fileName.get_cstring());
+
+  try
+  {
+    fstStore->fstStreamOpen(compress);
+  }
+  catch (const std::runtime_error& e)
+  {
+    delete fstStore;
+    ::Rf_error(e.what());
+  }
+
+  // a writer that is garbage collected before it's closed completes the file with the chunks written so far
+  SEXP writer;
+  PROTECT(writer = R_MakeExternalPtr(fstStore, Rf_install("fst_writer"), R_NilValue));
+  R_RegisterCFinalizerEx(writer, FstHandleFinalizer, TRUE);
+  UNPROTECT(1);
+
+  return writer;
+}
+
+
+SEXP fstwriterchunk(SEXP writer, SEXP table, SEXP uniformEncoding)
+{
+  if (!Rf_isLogical(uniformEncoding))
+  {
+    ::Rf_error("Parameter uniform.encoding should be a logical value");
+  }
+
+  FstStore* fstStore = static_cast<FstStore*>(R_ExternalPtrAddr(writer));
+
+  if (fstStore == nullptr)
+  {
+    ::Rf_error("The fst writer is closed.");
+  }
+
+  FstTable fstTable(table, *LOGICAL(uniformEncoding));
+
+  try
+  {
+    fstStore->fstStreamChunk(fstTable);
+  }
+  catch (const std::runtime_error& e)
+  {
+    ::Rf_error(e.what());
+  }
+
+  return table;
+}
+
+
+SEXP fstwriterclose(SEXP writer)
+{
+  FstStore* fstStore = static_cast<FstStore*>(R_ExternalPtrAddr(writer));
+
+  if (fstStore == nullptr)
+  {
+    return R_NilValue;
+  }
+
+  // the store is released before an error is raised
+  R_ClearExternalPtr(writer);
+
+  try
+  {
+    fstStore->fstStreamClose();
+  }
+  catch (const std::runtime_error& e)
+  {
+    delete fstStore;
+    ::Rf_error(e.what());
+  }
+
+  delete fstStore;
+
+  return R_NilValue;
+}
+
+
+// Finalizer of a batch reader, also used to close a reader explicitly
+static void FstBatchReaderFinalizer(SEXP reader)
+{
+  FstBatchReader* batchReader = static_cast<FstBatchReader*>(R_ExternalPtrAddr(reader));
+
+  if (batchReader == nullptr) return;
+
+  delete batchReader;  // waits for a batch that is being read
+  R_ClearExternalPtr(reader);
+}
+
+
+SEXP fstbatchopen(String fileName, SEXP columnSelection, SEXP startRow, SEXP endRow, SEXP batchSize)
+{
+  FstBatchReader* batchReader = new FstBatchReader(fileName.get_cstring(),
+    static_cast<unsigned long long>(*REAL(batchSize)));
+
+  StringArray* colSelection = nullptr;
+
+  if (!Rf_isNull(columnSelection))
+  {
+    colSelection = new StringArray();
+    colSelection->SetArray(columnSelection);
+  }
+
+  int eRow = -1;
+
+  if (!Rf_isNull(endRow))
+  {
+    eRow = *INTEGER(endRow);
+  }
+
+  try
+  {
+    batchReader->Open(colSelection, *INTEGER(startRow), eRow);
+  }
+  catch (const std::runtime_error& e)
+  {
+    delete colSelection;
+    delete batchReader;
+    ::Rf_error(e.what());
+  }
+
+  delete colSelection;
+
+  SEXP reader;
+  PROTECT(reader = R_MakeExternalPtr(batchReader, Rf_install("fst_reader"), R_NilValue));
+  R_RegisterCFinalizerEx(reader, FstBatchReaderFinalizer, TRUE);
+  UNPROTECT(1);
+
+  return reader;
+}
+
+
+SEXP fstbatchnext(SEXP reader)
+{
+  FstBatchReader* batchReader = static_cast<FstBatchReader*>(R_ExternalPtrAddr(reader));
+
+  if (batchReader == nullptr)
+  {
+    ::Rf_error("The fst reader is closed.");
+  }
+
+  FstBatch* batch = nullptr;
+
+  try
+  {
+    batch = batchReader->NextBatch();
+  }
+  catch (const std::runtime_error& e)
+  {
+    ::Rf_error(e.what());
+  }
+
+  // all rows have been read
+  if (batch == nullptr)
+  {
+    return R_NilValue;
+  }
+
+  // The columns are copied to R vectors while the next batch is read
+  FstTable tableReader;
+  ColumnFactory columnFactory;
+  batch->table.CopyTo(tableReader, &columnFactory);
+
+  unsigned int nrOfCols = batch->selectedCols.Length();
+  SEXP colNameVec;
+  PROTECT(colNameVec = Rf_allocVector(STRSXP, nrOfCols));
+
+  for (unsigned int colNr = 0; colNr < nrOfCols; ++colNr)
+  {
+    SET_STRING_ELT(colNameVec, colNr, Rf_mkChar(batch->selectedCols.GetElement(colNr)));
+  }
+
+  Rf_setAttrib(tableReader.resTable, R_NamesSymbol, colNameVec);
+
+  // Convert keyIndex to keyNames
+  vector<int> keyIndex = batch->keyIndex;
+  SEXP keyNames;
+  PROTECT(keyNames = Rf_allocVector(STRSXP, keyIndex.size()));
+
+  int count = 0;
+
+  for (vector<int>::iterator keyIt = keyIndex.begin(); keyIt != keyIndex.end(); ++keyIt)
+  {
+    SET_STRING_ELT(keyNames, count++, STRING_ELT(colNameVec, *keyIt));
+  }
+
+  delete batch;
+
+  UNPROTECT(2);
+
+  return List::create(
+    _["keyNames"]   = keyNames,
+    _["keyIndex"]   = keyIndex,
+    _["colNameVec"] = colNameVec,
+    _["resTable"]   = tableReader.resTable);
+}
+
+
+SEXP fstbatchclose(SEXP reader)
+{
+  FstBatchReaderFinalizer(reader);
+
+  return R_NilValue;
+}
+
+
+SEXP fstmetadata(SEXP fileName)
+{
+  // an opened fst handle, the path of a fst file or a serialized table
+  bool isHandle = TYPEOF(fileName) == EXTPTRSXP;
+  FstStore* fstStore = isHandle ? HandleStore(fileName) : SourceStore(fileName);
   IColumnFactory* columnFactory = new ColumnFactory();
 
   try
@@ -123,12 +515,12 @@ SEXP fstmetadata(String fileName)
   catch (const std::runtime_error& e)
   {
     delete columnFactory;
-    delete fstStore;
+    if (!isHandle) delete fstStore;
 
     // We may be looking at a fst v0.7.2 file format, this unsafe code will be removed later
-    if (std::strcmp(e.what(), FSTERROR_NON_FST_FILE) == 0)
+    if (std::strcmp(e.what(), FSTERROR_NON_FST_FILE) == 0 && TYPEOF(fileName) == STRSXP)
     {
-      List resOld = fstMeta_v1(fileName);  // scans further for safety
+      List resOld = fstMeta_v1(String(STRING_ELT(fileName, 0)));  // scans further for safety
 
       IntegerVector typeVec = resOld[4];
 
@@ -183,7 +575,7 @@ SEXP fstmetadata(String fileName)
 
     retList = List::create(
       _["nNofCols"]         = fstStore->nrOfCols,
-      _["nrOfRows"]         = *(fstStore->p_nrOfRows),
+      _["nrOfRows"]         = fstStore->nrOfRows,
       _["fstVersion"]       = fstStore->version,
       _["keyLength"]        = fstStore->keyLength,
       _["colBaseType"]      = colBaseType,
@@ -196,7 +588,7 @@ SEXP fstmetadata(String fileName)
   {
     retList = List::create(
       _["nrOfCols"]        = fstStore->nrOfCols,
-      _["nrOfRows"]        = *fstStore->p_nrOfRows,
+      _["nrOfRows"]        = fstStore->nrOfRows,
       _["fstVersion"]      = fstStore->version,
       _["keyLength"]       = fstStore->keyLength,
       _["colBaseType"]     = colBaseType,
@@ -205,26 +597,213 @@ SEXP fstmetadata(String fileName)
   }
 
   delete columnFactory;
-  delete fstStore;
+  if (!isHandle) delete fstStore;
 
   return retList;
 }
 
 
-SEXP fstretrieve(String fileName, SEXP columnSelection, SEXP startRow, SEXP endRow)
+/**
+ * \brief Convert a filter specification created by R function filter_spec() to a FstFilter
+ * \param filterSpec list with elements 'op' and 'args' (for '&' and '|') or 'op', 'column' and 'values'
+ * \param filter resulting filter
+ */
+inline void SetFilter(SEXP filterSpec, FstFilter &filter)
 {
+  List spec(filterSpec);
+  std::string op = as<std::string>(spec["op"]);
+
+  if (op == "&" || op == "|")
+  {
+    filter.filterOperator = op == "&" ? FstFilterOperator::AND : FstFilterOperator::OR;
+
+    List args = spec["args"];
+    filter.children.resize(args.size());
+
+    for (int argNr = 0; argNr < args.size(); ++argNr)
+    {
+      SetFilter(args[argNr], filter.children[argNr]);
+    }
+
+    return;
+  }
+
+  if (op == "==") filter.filterOperator = FstFilterOperator::EQUAL;
+  else if (op == "!=") filter.filterOperator = FstFilterOperator::NOT_EQUAL;
+  else if (op == "<") filter.filterOperator = FstFilterOperator::LESS;
+  else if (op == "<=") filter.filterOperator = FstFilterOperator::LESS_EQUAL;
+  else if (op == ">") filter.filterOperator = FstFilterOperator::GREATER;
+  else if (op == ">=") filter.filterOperator = FstFilterOperator::GREATER_EQUAL;
+  else if (op == "%in%") filter.filterOperator = FstFilterOperator::IN;
+  else if (op == "between") filter.filterOperator = FstFilterOperator::RANGE;
+  else throw(runtime_error("Unknown filter operator '" + op + "'"));
+
+  filter.columnName = as<std::string>(spec["column"]);
+
+  SEXP values = spec["values"];
+  int nrOfValues = LENGTH(values);
+
+  // Character values, NA values are removed by filter_spec()
+  if (Rf_isString(values))
+  {
+    for (int valueNr = 0; valueNr < nrOfValues; ++valueNr)
+    {
+      filter.stringValues.push_back(CHAR(STRING_ELT(values, valueNr)));
+    }
+
+    return;
+  }
+
+  // integer64 values are stored in double vectors
+  if (Rf_inherits(values, "integer64"))
+  {
+    long long* int64Values = reinterpret_cast<long long*>(REAL(values));
+
+    for (int valueNr = 0; valueNr < nrOfValues; ++valueNr)
+    {
+      long long value = int64Values[valueNr];
+      filter.int64Values.push_back(value);
+      filter.values.push_back(value == LLONG_MIN ? NA_REAL : static_cast<double>(value));
+    }
+
+    return;
+  }
+
+  double* doubleValues = REAL(values);
+
+  for (int valueNr = 0; valueNr < nrOfValues; ++valueNr)
+  {
+    filter.values.push_back(doubleValues[valueNr]);
+  }
+}
+
+
+// Convert a named list of key values (character, double or integer64 vectors of equal length) to a key lookup
+inline void SetKeyLookup(SEXP keys, FstKeyLookup &keyLookup)
+{
+  List keyList(keys);
+  CharacterVector keyNames = keyList.names();
+  int nrOfKeyCols = keyList.size();
+
+  keyLookup.columns.resize(nrOfKeyCols);
+
+  for (int keyNr = 0; keyNr < nrOfKeyCols; ++keyNr)
+  {
+    FstKeyColumn &column = keyLookup.columns[keyNr];
+    SEXP values = keyList[keyNr];
+    int nrOfValues = LENGTH(values);
+
+    column.columnName = as<std::string>(keyNames[keyNr]);
+
+    // Character values, lookups with NA values are removed by lookup_fst()
+    if (Rf_isString(values))
+    {
+      for (int valueNr = 0; valueNr < nrOfValues; ++valueNr)
+      {
+        column.stringValues.push_back(CHAR(STRING_ELT(values, valueNr)));
+      }
+
+      continue;
+    }
+
+    // integer64 values are stored in double vectors
+    if (Rf_inherits(values, "integer64"))
+    {
+      long long* int64Values = reinterpret_cast<long long*>(REAL(values));
+
+      for (int valueNr = 0; valueNr < nrOfValues; ++valueNr)
+      {
+        column.int64Values.push_back(int64Values[valueNr]);
+        column.values.push_back(static_cast<double>(int64Values[valueNr]));
+      }
+
+      continue;
+    }
+
+    double* doubleValues = REAL(values);
+
+    for (int valueNr = 0; valueNr < nrOfValues; ++valueNr)
+    {
+      column.values.push_back(doubleValues[valueNr]);
+    }
+  }
+}
+
+
+// Convert a numeric vector of (1-based) row numbers to a row index, rows are checked by the fst library
+inline void SetRowIndex(SEXP rows, FstRowIndex &rowIndex)
+{
+  int nrOfRows = LENGTH(rows);
+  double* rowValues = REAL(rows);
+
+  rowIndex.rows.resize(nrOfRows);
+
+  for (int rowNr = 0; rowNr < nrOfRows; ++rowNr)
+  {
+    // row numbers below 1 (and NA) are out of range, as are fractional rows and rows beyond the maximum table size
+    double row = rowValues[rowNr];
+    bool isValid = row >= 1 && row <= 1e18 && row == std::floor(row);
+    rowIndex.rows[rowNr] = isValid ? static_cast<unsigned long long>(row) : 0;
+  }
+}
+
+
+SEXP fstretrieve(SEXP fileName, SEXP columnSelection, SEXP startRow, SEXP endRow, SEXP filter, SEXP keys,
+  SEXP rows)
+{
+  // an opened fst handle, the path of a fst file or a serialized table
+  bool isHandle = TYPEOF(fileName) == EXTPTRSXP;
+  FstStore* handleStore = isHandle ? HandleStore(fileName) : nullptr;
+
+  // Row filter
+  FstFilter* rowFilter = nullptr;
+
+  if (!Rf_isNull(filter))
+  {
+    rowFilter = new FstFilter();
+
+    try
+    {
+      SetFilter(filter, *rowFilter);
+    }
+    catch (const std::exception& e)
+    {
+      delete rowFilter;
+      ::Rf_error(e.what());
+    }
+  }
+
+  // Key lookup
+  FstKeyLookup* keyLookup = nullptr;
+
+  if (!Rf_isNull(keys))
+  {
+    keyLookup = new FstKeyLookup();
+    SetKeyLookup(keys, *keyLookup);
+  }
+
+  // Row index
+  FstRowIndex* rowIndex = nullptr;
+
+  if (!Rf_isNull(rows))
+  {
+    rowIndex = new FstRowIndex();
+    SetRowIndex(rows, *rowIndex);
+  }
+
   FstTable tableReader;
   IColumnFactory* columnFactory = new ColumnFactory();
-  FstStore* fstStore = new FstStore(fileName.get_cstring());
+  FstStore* fstStore = isHandle ? handleStore : SourceStore(fileName);
 
-  int sRow = *INTEGER(startRow);
+  // integer or double row numbers, lazy columns can start beyond the integer range
+  long long sRow = static_cast<long long>(Rf_asReal(startRow));
 
   // Set to last row
-  int eRow = -1;
+  long long eRow = -1;
 
   if (!Rf_isNull(endRow))
   {
-    eRow = *INTEGER(endRow);
+    eRow = static_cast<long long>(Rf_asReal(endRow));
   }
 
   vector<int> keyIndex;
@@ -242,17 +821,21 @@ SEXP fstretrieve(String fileName, SEXP columnSelection, SEXP startRow, SEXP endR
 
   try
   {
-    fstStore->fstRead(tableReader, colSelection, sRow, eRow, columnFactory, keyIndex, colNames);
+    fstStore->fstRead(tableReader, colSelection, sRow, eRow, columnFactory, keyIndex, colNames, rowFilter, keyLookup,
+      rowIndex);
   }
   catch (const std::runtime_error& e)
   {
+    delete rowFilter;
+    delete keyLookup;
+    delete rowIndex;
     delete colSelection;
     delete columnFactory;
-    delete fstStore;
+    if (!isHandle) delete fstStore;
     delete colNames;
 
     // We may be looking at a fst v0.7.2 file format, this unsafe code will be removed later
-    if (std::strcmp(e.what(), FSTERROR_NON_FST_FILE) == 0)
+    if (std::strcmp(e.what(), FSTERROR_NON_FST_FILE) == 0 && TYPEOF(fileName) == STRSXP)
     {
       result = -1;
     }
@@ -267,14 +850,14 @@ SEXP fstretrieve(String fileName, SEXP columnSelection, SEXP startRow, SEXP endR
   // Test deprecated version format !!!
   if (result == -1)
   {
-    delete colSelection;
-    delete columnFactory;
-    delete fstStore;
-    delete colNames;
+    if (!Rf_isNull(filter) || !Rf_isNull(keys) || !Rf_isNull(rows))
+    {
+      ::Rf_error("Row filters, key lookups and row indexes are not supported for files created with a beta version of the fst package");
+    }
 
     try
     {
-      SEXP res = fstRead_v1(fileName, columnSelection, startRow, endRow);
+      SEXP res = fstRead_v1(String(STRING_ELT(fileName, 0)), columnSelection, startRow, endRow);
 
       Rf_warning("This fst file was created with a beta version of the fst package. Please re-write the data as this format will not be supported in future releases.");
 
@@ -304,9 +887,12 @@ SEXP fstretrieve(String fileName, SEXP columnSelection, SEXP startRow, SEXP endR
     SET_STRING_ELT(keyNames, count++, STRING_ELT(colNameVec, *keyIt));
   }
 
+  delete rowFilter;
+  delete keyLookup;
+  delete rowIndex;
   delete colSelection;
   delete columnFactory;
-  delete fstStore;
+  if (!isHandle) delete fstStore;
   delete colNames;
 
   UNPROTECT(1);
@@ -317,3 +903,235 @@ SEXP fstretrieve(String fileName, SEXP columnSelection, SEXP startRow, SEXP endR
     _["colNameVec"] = colNameVec,
     _["resTable"]   = tableReader.resTable);
 }
+
+
+SEXP fstzonemap(String fileName, String columnName)
+{
+  FstStore* fstStore = new FstStore(fileName.get_cstring());
+  IColumnFactory* columnFactory = new ColumnFactory();
+  ZoneMap zoneMap;
+
+  try
+  {
+    fstStore->fstMeta(columnFactory);
+
+    int colNr = -1;
+    for (int col = 0; col < fstStore->nrOfCols; ++col)
+    {
+      if (std::strcmp(fstStore->blockReader->GetElement(col), columnName.get_cstring()) == 0)
+      {
+        colNr = col;
+        break;
+      }
+    }
+
+    if (colNr == -1)
+    {
+      throw(runtime_error("Selected column not found."));
+    }
+
+    fstStore->fstReadZoneMap(colNr, zoneMap);
+  }
+  catch (const std::runtime_error& e)
+  {
+    delete columnFactory;
+    delete fstStore;
+
+    ::Rf_error(e.what());
+  }
+
+  delete columnFactory;
+  delete fstStore;
+
+  // Convert block statistics to R vectors, integer64 values are stored in a double vector
+  int nrOfBlocks = zoneMap.blocks.size();
+
+  NumericVector startRow(nrOfBlocks);
+  NumericVector nrOfRows(nrOfBlocks);
+  NumericVector naCount(nrOfBlocks);
+  LogicalVector hasStatistics(nrOfBlocks);
+  NumericVector minValue(nrOfBlocks);
+  NumericVector maxValue(nrOfBlocks);
+
+  for (int block = 0; block < nrOfBlocks; ++block)
+  {
+    ZoneMapBlock &zoneMapBlock = zoneMap.blocks[block];
+
+    startRow[block] = static_cast<double>(zoneMapBlock.startRow + 1);
+    nrOfRows[block] = static_cast<double>(zoneMapBlock.nrOfRows);
+    hasStatistics[block] = zoneMapBlock.hasStatistics;
+
+    if (!zoneMapBlock.hasStatistics)
+    {
+      naCount[block] = NA_REAL;
+      minValue[block] = NA_REAL;
+      maxValue[block] = NA_REAL;
+      continue;
+    }
+
+    naCount[block] = static_cast<double>(zoneMapBlock.naCount);
+
+    switch (zoneMap.valueType)
+    {
+      case FstColumnType::INT_64:
+        std::memcpy(&minValue[block], &zoneMapBlock.minValue, 8);
+        std::memcpy(&maxValue[block], &zoneMapBlock.maxValue, 8);
+        break;
+
+      case FstColumnType::DOUBLE_64:
+        minValue[block] = zoneMapBlock.minValue.doubleValue;
+        maxValue[block] = zoneMapBlock.maxValue.doubleValue;
+        break;
+
+      default:
+        minValue[block] = static_cast<double>(zoneMapBlock.minValue.intValue);
+        maxValue[block] = static_cast<double>(zoneMapBlock.maxValue.intValue);
+        break;
+    }
+
+    // no non-NA values in block
+    if (zoneMapBlock.naCount == zoneMapBlock.nrOfRows)
+    {
+      minValue[block] = NA_REAL;
+      maxValue[block] = NA_REAL;
+
+      // NA value of bit64 package
+      if (zoneMap.valueType == FstColumnType::INT_64)
+      {
+        long long naInt64 = LLONG_MIN;
+        std::memcpy(&minValue[block], &naInt64, 8);
+        std::memcpy(&maxValue[block], &naInt64, 8);
+      }
+    }
+  }
+
+  if (zoneMap.valueType == FstColumnType::INT_64)
+  {
+    minValue.attr("class") = "integer64";
+    maxValue.attr("class") = "integer64";
+  }
+
+  return List::create(
+    _["startRow"]      = startRow,
+    _["nrOfRows"]      = nrOfRows,
+    _["naCount"]       = naCount,
+    _["hasStatistics"] = hasStatistics,
+    _["min"]           = minValue,
+    _["max"]           = maxValue);
+}
+
+
+SEXP fstreadmethod(SEXP readMethod)
+{
+  if (Rf_isNull(readMethod))
+  {
+    return Rf_ScalarInteger(GetFstReadMethod());
+  }
+
+  if (!Rf_isNumeric(readMethod) || Rf_length(readMethod) != 1)
+  {
+    ::Rf_error("Parameter readMethod should be a single integer value");
+  }
+
+  int previousMethod = SetFstReadMethod(Rf_asInteger(readMethod));
+
+  if (previousMethod == -1)
+  {
+    ::Rf_error("Parameter readMethod should be 0 (memory mapped), 1 (positional reads) or 2 (stream)");
+  }
+
+  return Rf_ScalarInteger(previousMethod);
+}
+
+
+SEXP fstreadgap(SEXP readGap)
+{
+  if (Rf_isNull(readGap))
+  {
+    return Rf_ScalarReal(static_cast<double>(GetFstReadGap()));
+  }
+
+  if (!Rf_isNumeric(readGap) || Rf_length(readGap) != 1 || std::isnan(Rf_asReal(readGap)))
+  {
+    ::Rf_error("Parameter readGap should be a single numeric value");
+  }
+
+  long long previousGap = SetFstReadGap(static_cast<long long>(Rf_asReal(readGap)));
+
+  return Rf_ScalarReal(static_cast<double>(previousGap));
+}
+
+
+SEXP fstreadlatency(SEXP latency)
+{
+  if (Rf_isNull(latency))
+  {
+    return Rf_ScalarInteger(GetFstReadLatency());
+  }
+
+  if (!Rf_isNumeric(latency) || Rf_length(latency) != 1 || Rf_asInteger(latency) == NA_INTEGER ||
+    Rf_asInteger(latency) < 0)
+  {
+    ::Rf_error("Parameter latency should be a positive number of microseconds");
+  }
+
+  unsigned int previousLatency = SetFstReadLatency(static_cast<unsigned int>(Rf_asInteger(latency)));
+
+  return Rf_ScalarInteger(previousLatency);
+}
+
+
+SEXP fstreadqueue(SEXP queueDepth)
+{
+  if (Rf_isNull(queueDepth))
+  {
+    return Rf_ScalarInteger(GetFstReadQueueDepth());
+  }
+
+  if (!Rf_isNumeric(queueDepth) || Rf_length(queueDepth) != 1 || Rf_asInteger(queueDepth) == NA_INTEGER ||
+    Rf_asInteger(queueDepth) < 0)
+  {
+    ::Rf_error("Parameter queueDepth should be a positive number of outstanding reads");
+  }
+
+  int previousDepth = SetFstReadQueueDepth(Rf_asInteger(queueDepth));
+
+  return Rf_ScalarInteger(previousDepth);
+}
+
+
+SEXP fstchardict(SEXP enable)
+{
+  if (Rf_isNull(enable))
+  {
+    return Rf_ScalarLogical(GetFstCharZstdDictionary());
+  }
+
+  if (!Rf_isLogical(enable) || Rf_length(enable) != 1 || LOGICAL(enable)[0] == NA_LOGICAL)
+  {
+    ::Rf_error("Parameter enable should be TRUE or FALSE");
+  }
+
+  bool previousEnable = SetFstCharZstdDictionary(LOGICAL(enable)[0] != 0);
+
+  return Rf_ScalarLogical(previousEnable);
+}
+
+
+SEXP fstwritebudget(SEXP budget)
+{
+  if (Rf_isNull(budget))
+  {
+    return Rf_ScalarReal(static_cast<double>(GetFstWriteBudget()));
+  }
+
+  if (!Rf_isNumeric(budget) || Rf_length(budget) != 1 || std::isnan(Rf_asReal(budget)) || Rf_asReal(budget) < 0 ||
+    Rf_asReal(budget) > 1e18)
+  {
+    ::Rf_error("Parameter budget should be a positive number of bytes");
+  }
+
+  unsigned long long previousBudget = SetFstWriteBudget(static_cast<unsigned long long>(Rf_asReal(budget)));
+
+  return Rf_ScalarReal(static_cast<double>(previousBudget));
+}
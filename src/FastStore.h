@@ -39,17 +39,67 @@
 
 #include <Rcpp.h>
 
-#define FST_VERSION 1  // version number of the fst package (odd numbers are dev versions)
 
+// [[Rcpp::export]]
+SEXP fststore(Rcpp::String fileName, SEXP table, SEXP compression, SEXP uniformEncoding, SEXP append);
+
+// [[Rcpp::export]]
+SEXP fstaddcolumns(Rcpp::String fileName, SEXP table, SEXP compression, SEXP uniformEncoding);
+
+// [[Rcpp::export]]
+SEXP fstserialize(SEXP table, SEXP compression, SEXP uniformEncoding);
+
+// [[Rcpp::export]]
+SEXP fstopen(Rcpp::String fileName);
+
+// [[Rcpp::export]]
+SEXP fstclose(SEXP handle);
+
+// [[Rcpp::export]]
+SEXP fstwriteropen(Rcpp::String fileName, SEXP compression);
+
+// [[Rcpp::export]]
+SEXP fstwriterchunk(SEXP writer, SEXP table, SEXP uniformEncoding);
+
+// [[Rcpp::export]]
+SEXP fstwriterclose(SEXP writer);
+
+// [[Rcpp::export]]
+SEXP fstbatchopen(Rcpp::String fileName, SEXP columnSelection, SEXP startRow, SEXP endRow, SEXP batchSize);
+
+// [[Rcpp::export]]
+SEXP fstbatchnext(SEXP reader);
+
+// [[Rcpp::export]]
+SEXP fstbatchclose(SEXP reader);
+
+// [[Rcpp::export]]
+SEXP fstmetadata(SEXP fileName);
+
+// [[Rcpp::export]]
+SEXP fstretrieve(SEXP fileName, SEXP columnSelection, SEXP startRow, SEXP endRow, SEXP filter, SEXP keys,
+  SEXP rows);
+
+// [[Rcpp::export]]
+SEXP fstzonemap(Rcpp::String fileName, Rcpp::String columnName);
+
+// [[Rcpp::export]]
+SEXP fstreadmethod(SEXP readMethod);
+
+// [[Rcpp::export]]
+SEXP fstreadgap(SEXP readGap);
+
+// [[Rcpp::export]]
+SEXP fstreadlatency(SEXP latency);
 
 // [[Rcpp::export]]
-SEXP fststore(Rcpp::String fileName, SEXP table, SEXP compression, SEXP uniformEncoding);
+SEXP fstreadqueue(SEXP queueDepth);
 
 // [[Rcpp::export]]
-SEXP fstmetadata(Rcpp::String fileName);
+SEXP fstchardict(SEXP enable);
 
 // [[Rcpp::export]]
-SEXP fstretrieve(Rcpp::String fileName, SEXP columnSelection, SEXP startRow, SEXP endRow);
+SEXP fstwritebudget(SEXP budget);
 
 
 #endif  // FASTSTORE_H
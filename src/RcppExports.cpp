@@ -6,8 +6,8 @@
 using namespace Rcpp;
 
 // fststore
-SEXP fststore(Rcpp::String fileName, SEXP table, SEXP compression, SEXP uniformEncoding);
-RcppExport SEXP _fst_fststore(SEXP fileNameSEXP, SEXP tableSEXP, SEXP compressionSEXP, SEXP uniformEncodingSEXP) {
+SEXP fststore(Rcpp::String fileName, SEXP table, SEXP compression, SEXP uniformEncoding, SEXP append);
+RcppExport SEXP _fst_fststore(SEXP fileNameSEXP, SEXP tableSEXP, SEXP compressionSEXP, SEXP uniformEncodingSEXP, SEXP appendSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -15,32 +15,236 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< SEXP >::type table(tableSEXP);
     Rcpp::traits::input_parameter< SEXP >::type compression(compressionSEXP);
     Rcpp::traits::input_parameter< SEXP >::type uniformEncoding(uniformEncodingSEXP);
-    rcpp_result_gen = Rcpp::wrap(fststore(fileName, table, compression, uniformEncoding));
+    Rcpp::traits::input_parameter< SEXP >::type append(appendSEXP);
+    rcpp_result_gen = Rcpp::wrap(fststore(fileName, table, compression, uniformEncoding, append));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fstaddcolumns
+SEXP fstaddcolumns(Rcpp::String fileName, SEXP table, SEXP compression, SEXP uniformEncoding);
+RcppExport SEXP _fst_fstaddcolumns(SEXP fileNameSEXP, SEXP tableSEXP, SEXP compressionSEXP, SEXP uniformEncodingSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::String >::type fileName(fileNameSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type table(tableSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type compression(compressionSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type uniformEncoding(uniformEncodingSEXP);
+    rcpp_result_gen = Rcpp::wrap(fstaddcolumns(fileName, table, compression, uniformEncoding));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fstserialize
+SEXP fstserialize(SEXP table, SEXP compression, SEXP uniformEncoding);
+RcppExport SEXP _fst_fstserialize(SEXP tableSEXP, SEXP compressionSEXP, SEXP uniformEncodingSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type table(tableSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type compression(compressionSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type uniformEncoding(uniformEncodingSEXP);
+    rcpp_result_gen = Rcpp::wrap(fstserialize(table, compression, uniformEncoding));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fstopen
+SEXP fstopen(Rcpp::String fileName);
+RcppExport SEXP _fst_fstopen(SEXP fileNameSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::String >::type fileName(fileNameSEXP);
+    rcpp_result_gen = Rcpp::wrap(fstopen(fileName));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fstclose
+SEXP fstclose(SEXP handle);
+RcppExport SEXP _fst_fstclose(SEXP handleSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type handle(handleSEXP);
+    rcpp_result_gen = Rcpp::wrap(fstclose(handle));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fstwriteropen
+SEXP fstwriteropen(Rcpp::String fileName, SEXP compression);
+RcppExport SEXP _fst_fstwriteropen(SEXP fileNameSEXP, SEXP compressionSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::String >::type fileName(fileNameSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type compression(compressionSEXP);
+    rcpp_result_gen = Rcpp::wrap(fstwriteropen(fileName, compression));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fstwriterchunk
+SEXP fstwriterchunk(SEXP writer, SEXP table, SEXP uniformEncoding);
+RcppExport SEXP _fst_fstwriterchunk(SEXP writerSEXP, SEXP tableSEXP, SEXP uniformEncodingSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type writer(writerSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type table(tableSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type uniformEncoding(uniformEncodingSEXP);
+    rcpp_result_gen = Rcpp::wrap(fstwriterchunk(writer, table, uniformEncoding));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fstwriterclose
+SEXP fstwriterclose(SEXP writer);
+RcppExport SEXP _fst_fstwriterclose(SEXP writerSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type writer(writerSEXP);
+    rcpp_result_gen = Rcpp::wrap(fstwriterclose(writer));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fstbatchopen
+SEXP fstbatchopen(Rcpp::String fileName, SEXP columnSelection, SEXP startRow, SEXP endRow, SEXP batchSize);
+RcppExport SEXP _fst_fstbatchopen(SEXP fileNameSEXP, SEXP columnSelectionSEXP, SEXP startRowSEXP, SEXP endRowSEXP, SEXP batchSizeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::String >::type fileName(fileNameSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type columnSelection(columnSelectionSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type startRow(startRowSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type endRow(endRowSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type batchSize(batchSizeSEXP);
+    rcpp_result_gen = Rcpp::wrap(fstbatchopen(fileName, columnSelection, startRow, endRow, batchSize));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fstbatchnext
+SEXP fstbatchnext(SEXP reader);
+RcppExport SEXP _fst_fstbatchnext(SEXP readerSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type reader(readerSEXP);
+    rcpp_result_gen = Rcpp::wrap(fstbatchnext(reader));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fstbatchclose
+SEXP fstbatchclose(SEXP reader);
+RcppExport SEXP _fst_fstbatchclose(SEXP readerSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type reader(readerSEXP);
+    rcpp_result_gen = Rcpp::wrap(fstbatchclose(reader));
     return rcpp_result_gen;
 END_RCPP
 }
 // fstmetadata
-SEXP fstmetadata(Rcpp::String fileName);
+SEXP fstmetadata(SEXP fileName);
 RcppExport SEXP _fst_fstmetadata(SEXP fileNameSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< Rcpp::String >::type fileName(fileNameSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type fileName(fileNameSEXP);
     rcpp_result_gen = Rcpp::wrap(fstmetadata(fileName));
     return rcpp_result_gen;
 END_RCPP
 }
 // fstretrieve
-SEXP fstretrieve(Rcpp::String fileName, SEXP columnSelection, SEXP startRow, SEXP endRow);
-RcppExport SEXP _fst_fstretrieve(SEXP fileNameSEXP, SEXP columnSelectionSEXP, SEXP startRowSEXP, SEXP endRowSEXP) {
+SEXP fstretrieve(SEXP fileName, SEXP columnSelection, SEXP startRow, SEXP endRow, SEXP filter, SEXP keys, SEXP rows);
+RcppExport SEXP _fst_fstretrieve(SEXP fileNameSEXP, SEXP columnSelectionSEXP, SEXP startRowSEXP, SEXP endRowSEXP, SEXP filterSEXP, SEXP keysSEXP, SEXP rowsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< Rcpp::String >::type fileName(fileNameSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type fileName(fileNameSEXP);
     Rcpp::traits::input_parameter< SEXP >::type columnSelection(columnSelectionSEXP);
     Rcpp::traits::input_parameter< SEXP >::type startRow(startRowSEXP);
     Rcpp::traits::input_parameter< SEXP >::type endRow(endRowSEXP);
-    rcpp_result_gen = Rcpp::wrap(fstretrieve(fileName, columnSelection, startRow, endRow));
+    Rcpp::traits::input_parameter< SEXP >::type filter(filterSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type keys(keysSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type rows(rowsSEXP);
+    rcpp_result_gen = Rcpp::wrap(fstretrieve(fileName, columnSelection, startRow, endRow, filter, keys, rows));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fstzonemap
+SEXP fstzonemap(Rcpp::String fileName, Rcpp::String columnName);
+RcppExport SEXP _fst_fstzonemap(SEXP fileNameSEXP, SEXP columnNameSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::String >::type fileName(fileNameSEXP);
+    Rcpp::traits::input_parameter< Rcpp::String >::type columnName(columnNameSEXP);
+    rcpp_result_gen = Rcpp::wrap(fstzonemap(fileName, columnName));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fstreadmethod
+SEXP fstreadmethod(SEXP readMethod);
+RcppExport SEXP _fst_fstreadmethod(SEXP readMethodSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type readMethod(readMethodSEXP);
+    rcpp_result_gen = Rcpp::wrap(fstreadmethod(readMethod));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fstreadgap
+SEXP fstreadgap(SEXP readGap);
+RcppExport SEXP _fst_fstreadgap(SEXP readGapSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type readGap(readGapSEXP);
+    rcpp_result_gen = Rcpp::wrap(fstreadgap(readGap));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fstreadlatency
+SEXP fstreadlatency(SEXP latency);
+RcppExport SEXP _fst_fstreadlatency(SEXP latencySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type latency(latencySEXP);
+    rcpp_result_gen = Rcpp::wrap(fstreadlatency(latency));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fstreadqueue
+SEXP fstreadqueue(SEXP queueDepth);
+RcppExport SEXP _fst_fstreadqueue(SEXP queueDepthSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type queueDepth(queueDepthSEXP);
+    rcpp_result_gen = Rcpp::wrap(fstreadqueue(queueDepth));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fstchardict
+SEXP fstchardict(SEXP enable);
+RcppExport SEXP _fst_fstchardict(SEXP enableSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type enable(enableSEXP);
+    rcpp_result_gen = Rcpp::wrap(fstchardict(enable));
+    return rcpp_result_gen;
+END_RCPP
+}
+// fstwritebudget
+SEXP fstwritebudget(SEXP budget);
+RcppExport SEXP _fst_fstwritebudget(SEXP budgetSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type budget(budgetSEXP);
+    rcpp_result_gen = Rcpp::wrap(fstwritebudget(budget));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -56,6 +260,21 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// fstlazycolumn
+SEXP fstlazycolumn(Rcpp::String fileName, Rcpp::String columnName, SEXP startRow, SEXP length, SEXP templateVec);
+RcppExport SEXP _fst_fstlazycolumn(SEXP fileNameSEXP, SEXP columnNameSEXP, SEXP startRowSEXP, SEXP lengthSEXP, SEXP templateVecSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::String >::type fileName(fileNameSEXP);
+    Rcpp::traits::input_parameter< Rcpp::String >::type columnName(columnNameSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type startRow(startRowSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type length(lengthSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type templateVec(templateVecSEXP);
+    rcpp_result_gen = Rcpp::wrap(fstlazycolumn(fileName, columnName, startRow, length, templateVec));
+    return rcpp_result_gen;
+END_RCPP
+}
 // fstcomp
 SEXP fstcomp(SEXP rawVec, SEXP compressor, SEXP compression, SEXP hash);
 RcppExport SEXP _fst_fstcomp(SEXP rawVecSEXP, SEXP compressorSEXP, SEXP compressionSEXP, SEXP hashSEXP) {
@@ -81,6 +300,17 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// fstzstdreuse
+SEXP fstzstdreuse(SEXP reuse);
+RcppExport SEXP _fst_fstzstdreuse(SEXP reuseSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type reuse(reuseSEXP);
+    rcpp_result_gen = Rcpp::wrap(fstzstdreuse(reuse));
+    return rcpp_result_gen;
+END_RCPP
+}
 // getnrofthreads
 SEXP getnrofthreads();
 RcppExport SEXP _fst_getnrofthreads() {
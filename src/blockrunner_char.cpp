@@ -40,6 +40,10 @@
 
 #include <blockrunner_char.h>
 
+#include <ZSTD/common/xxhash.h>
+
+#include <cstring>
+
 #include <Rcpp.h>
 
 
@@ -135,17 +139,127 @@ void BlockWriterChar::SetBuffersFromVec(unsigned long long startCount, unsigned
 }
 
 
+IStringWriter* BlockWriterChar::CreateThreadWriter()
+{
+  // Reading the CHARSXP's of a regular character vector doesn't allocate, but the elements of an ALTREP vector might
+  // have to be created first
+#if defined(R_VERSION) && R_VERSION >= R_Version(3, 5, 0)
+  if (ALTREP(*strVec)) return nullptr;
+#endif
+
+  return new BlockWriterChar(*strVec, vecLength, stackBufSize, uniformEncoding);
+}
+
+
 void BlockReaderChar::AllocateVec(unsigned long long vecLength)
 {
   PROTECT(this->strVec = Rf_allocVector(STRSXP, vecLength));
   isProtected = true;
 }
 
+
+void BlockReaderChar::ClearCache()
+{
+  if (stringCache != nullptr)
+  {
+    memset(stringCache, 0, STRING_CACHE_SIZE * sizeof(SEXP));
+  }
+
+  cacheLookups = 0;
+  cacheHits = 0;
+  cacheBypass = 0;
+}
+
+
+SEXP BlockReaderChar::MakeString(const char* str, unsigned int length)
+{
+  // Low hit rate in the last sample window, R's global string cache is used directly
+  if (cacheBypass != 0)
+  {
+    --cacheBypass;
+    return Rf_mkCharLenCE(str, length, this->strEncoding);
+  }
+
+  if (stringCache == nullptr)
+  {
+    stringCache = new SEXP[STRING_CACHE_SIZE];
+    memset(stringCache, 0, STRING_CACHE_SIZE * sizeof(SEXP));
+  }
+
+  SEXP* slot = &stringCache[XXH64(str, length, 0) & (STRING_CACHE_SIZE - 1)];
+  SEXP curStr = *slot;
+
+  if (curStr != nullptr && static_cast<unsigned int>(LENGTH(curStr)) == length && memcmp(CHAR(curStr), str, length) == 0)
+  {
+    ++cacheHits;
+  }
+  else
+  {
+    curStr = Rf_mkCharLenCE(str, length, this->strEncoding);
+    *slot = curStr;  // replaces the previous string in this slot
+  }
+
+  // Test the hit rate at the end of each sample window
+  if (++cacheLookups == STRING_CACHE_WINDOW)
+  {
+    if (cacheHits < STRING_CACHE_WINDOW * STRING_CACHE_MIN_HIT_RATE)
+    {
+      cacheBypass = STRING_CACHE_BYPASS;
+    }
+
+    cacheLookups = 0;
+    cacheHits = 0;
+  }
+
+  return curStr;
+}
+
+bool BlockReaderChar::SetLevels(unsigned int nrOfLevels, const char* const* levelStrings,
+  const unsigned int* levelSizes)
+{
+  if (levelVec != R_NilValue) R_ReleaseObject(levelVec);
+
+  levelVec = Rf_allocVector(STRSXP, nrOfLevels);
+  R_PreserveObject(levelVec);
+
+  for (unsigned int level = 0; level < nrOfLevels; ++level)
+  {
+    if (levelStrings[level] == nullptr)
+    {
+      SET_STRING_ELT(levelVec, level, NA_STRING);
+      continue;
+    }
+
+    SET_STRING_ELT(levelVec, level, Rf_mkCharLenCE(levelStrings[level], levelSizes[level], this->strEncoding));
+  }
+
+  return true;
+}
+
+
+void BlockReaderChar::LevelCodesToVec(unsigned long long nrOfElements, unsigned long long vecOffset,
+  const int* levelCodes)
+{
+  for (unsigned long long elem = 0; elem < nrOfElements; ++elem)
+  {
+    int levelCode = levelCodes[elem];
+
+    if (levelCode == NA_INTEGER)
+    {
+      SET_STRING_ELT(strVec, vecOffset + elem, NA_STRING);
+      continue;
+    }
+
+    SET_STRING_ELT(strVec, vecOffset + elem, STRING_ELT(levelVec, levelCode - 1));
+  }
+}
+
+
 void BlockReaderChar::BufferToVec(unsigned long long nrOfElements, unsigned long long startElem,
-  unsigned long long endElem, unsigned long long vecOffset, unsigned int* sizeMeta, char* buf)
+  unsigned long long endElem, unsigned long long vecOffset, const unsigned int* sizeMeta, const char* buf)
 {
   unsigned long long nrOfNAInts = 1 + nrOfElements / 32;  // last bit is NA flag
-  unsigned int* bitsNA = &sizeMeta[nrOfElements];
+  const unsigned int* bitsNA = &sizeMeta[nrOfElements];
   unsigned long long pos = 0;
 
   if (startElem != 0)
@@ -160,7 +274,7 @@ void BlockReaderChar::BufferToVec(unsigned long long nrOfElements, unsigned long
     for (unsigned long long blockElem = startElem; blockElem <= endElem; ++blockElem)
     {
       unsigned long long newPos = sizeMeta[blockElem];
-      SEXP curStr = Rf_mkCharLenCE(buf + pos, newPos - pos, this->strEncoding);
+      SEXP curStr = MakeString(buf + pos, newPos - pos);
       SET_STRING_ELT(strVec, vecOffset + blockElem - startElem, curStr);
       pos = newPos;  // update to new string offset
     }
@@ -192,7 +306,7 @@ void BlockReaderChar::BufferToVec(unsigned long long nrOfElements, unsigned long
       // Get string from data stream
 
       unsigned long long newPos = sizeMeta[blockElem];
-      SEXP curStr = Rf_mkCharLenCE(buf + pos, newPos - pos, this->strEncoding);
+      SEXP curStr = MakeString(buf + pos, newPos - pos);
       SET_STRING_ELT(strVec, vecOffset + blockElem - startElem, curStr);
       pos = newPos;  // update to new string offset
     }
@@ -217,7 +331,7 @@ void BlockReaderChar::BufferToVec(unsigned long long nrOfElements, unsigned long
     // Get string from data stream
 
     unsigned long long newPos = sizeMeta[blockElem];
-    SEXP curStr = Rf_mkCharLenCE(buf + pos, newPos - pos, this->strEncoding);
+    SEXP curStr = MakeString(buf + pos, newPos - pos);
     SET_STRING_ELT(strVec, vecOffset + blockElem - startElem, curStr);
     pos = newPos;  // update to new string offset
   }
@@ -234,7 +348,7 @@ void BlockReaderChar::BufferToVec(unsigned long long nrOfElements, unsigned long
       for (unsigned long long blockElem = cycle * 32; blockElem != middleCycleEnd; ++blockElem)
       {
         unsigned long long newPos = sizeMeta[blockElem];
-        SEXP curStr = Rf_mkCharLenCE(buf + pos, newPos - pos, this->strEncoding);
+        SEXP curStr = MakeString(buf + pos, newPos - pos);
         SET_STRING_ELT(strVec, vecOffset + blockElem - startElem, curStr);
         pos = newPos;  // update to new string offset
       }
@@ -257,7 +371,7 @@ void BlockReaderChar::BufferToVec(unsigned long long nrOfElements, unsigned long
 
       // Get string from data stream
 
-      SEXP curStr = Rf_mkCharLenCE(buf + pos, newPos - pos, this->strEncoding);
+      SEXP curStr = MakeString(buf + pos, newPos - pos);
       SET_STRING_ELT(strVec, vecOffset + blockElem - startElem, curStr);
       pos = newPos;  // update to new string offset
     }
@@ -282,7 +396,7 @@ void BlockReaderChar::BufferToVec(unsigned long long nrOfElements, unsigned long
 
     // Get string from data stream
 
-    SEXP curStr = Rf_mkCharLenCE(buf + pos, newPos - pos, this->strEncoding);
+    SEXP curStr = MakeString(buf + pos, newPos - pos);
     SET_STRING_ELT(strVec, vecOffset + blockElem - startElem, curStr);
     pos = newPos;  // update to new string offset
   }
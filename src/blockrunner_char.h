@@ -109,6 +109,8 @@ class BlockWriterChar : public IStringWriter
     }
 
     void SetBuffersFromVec(unsigned long long startCount, unsigned long long endCount);
+
+    IStringWriter* CreateThreadWriter();
 };
 
 
@@ -119,41 +121,81 @@ class BlockReaderChar : public IStringColumn
   cetype_t strEncoding;
   FstColumnAttribute columnAttribute;
 
+  // Cache with the last created string for each hash slot. The cached strings are elements of strVec and are
+  // protected with it.
+  SEXP levelVec;  // level strings of a dictionary encoded chunk, preserved until replaced
+
+  SEXP* stringCache;
+  unsigned int cacheLookups;  // lookups in the current sample window
+  unsigned int cacheHits;  // hits in the current sample window
+  unsigned long long cacheBypass;  // number of strings that are still created without the cache
+
+  /**
+   * \brief Create a string, reusing the string of an identical earlier element when available
+   * \param str string data
+   * \param length number of bytes in the string
+   */
+  SEXP MakeString(const char* str, unsigned int length);
+
+  void ClearCache();
+
 public:
   BlockReaderChar()
   {
     isProtected = true;
     this->columnAttribute = columnAttribute;  // keep attribute for later use
+    this->strEncoding = cetype_t::CE_NATIVE;
+    this->levelVec = R_NilValue;
+    this->stringCache = nullptr;
+    this->cacheLookups = 0;
+    this->cacheHits = 0;
+    this->cacheBypass = 0;
   }
 
-  ~BlockReaderChar(){ if (isProtected) UNPROTECT(1); }
+  ~BlockReaderChar()
+  {
+    delete[] stringCache;
+    if (levelVec != R_NilValue) R_ReleaseObject(levelVec);
+    if (isProtected) UNPROTECT(1);
+  }
 
   void AllocateVec(unsigned long long vecLength);
 
   void SetEncoding(StringEncoding stringEncoding)
   {
+    cetype_t encoding;
+
     switch (stringEncoding)
     {
       case StringEncoding::LATIN1:
       {
-        strEncoding = cetype_t::CE_LATIN1;
+        encoding = cetype_t::CE_LATIN1;
         break;
       }
 
       case StringEncoding::UTF8:
       {
-        strEncoding = cetype_t::CE_UTF8;
+        encoding = cetype_t::CE_UTF8;
         break;
       }
 
       default:  // native or unknown encoding
-        strEncoding = cetype_t::CE_NATIVE;
+        encoding = cetype_t::CE_NATIVE;
         break;
     }
+
+    // cached strings have the encoding of the previous chunk
+    if (encoding != strEncoding) ClearCache();
+
+    strEncoding = encoding;
   }
 
   void BufferToVec(unsigned long long nrOfElements, unsigned long long startElem, unsigned long long endElem,
-    unsigned long long vecOffset, unsigned int* sizeMeta, char* buf);
+    unsigned long long vecOffset, const unsigned int* sizeMeta, const char* buf);
+
+  bool SetLevels(unsigned int nrOfLevels, const char* const* levelStrings, const unsigned int* levelSizes);
+
+  void LevelCodesToVec(unsigned long long nrOfElements, unsigned long long vecOffset, const int* levelCodes);
 
   const char* GetElement(unsigned long long elementNr)
   {
@@ -0,0 +1,473 @@
+/*
+  fst - An R-package for ultra fast storage and retrieval of datasets.
+  Copyright (C) 2017, Mark AJ Klik
+
+  BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following disclaimer
+    in the documentation and/or other materials provided with the
+    distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+    A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  You can contact the author at :
+  - fst source repository : https://github.com/fstPackage/fst
+*/
+
+
+
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <Rcpp.h>
+#include <Rversion.h>
+
+#include <fstaltrep.h>
+#include <FastStore.h>
+
+// The ALTREP header can only be used from C++ code as of R 3.6.0
+#if defined(R_VERSION) && R_VERSION >= R_Version(3, 6, 0)
+  #define FST_ALTREP
+  #include <R_ext/Altrep.h>
+#endif
+
+
+using namespace std;
+using namespace Rcpp;
+
+
+#ifdef FST_ALTREP
+
+static R_altrep_class_t lazy_integer_class;
+static R_altrep_class_t lazy_real_class;
+static R_altrep_class_t lazy_logical_class;
+
+
+/**
+ * \brief Location of the data of a lazy column in a fst file and the blocks of rows read so far.
+ */
+class LazyColumn
+{
+public:
+  string fileName;
+  string columnName;
+  R_xlen_t startRow;  // first row of the column in the fst file (1-based)
+  R_xlen_t length;
+  int elementSize;
+  vector<char*> blocks;  // blocks of LAZY_BLOCK_SIZE rows, nullptr if not read yet
+  SEXP handle;  // fst handle opened at the first read, so the file metadata is parsed only once
+
+  LazyColumn(const char* fileName, const char* columnName, R_xlen_t startRow, R_xlen_t length, int elementSize)
+  {
+    this->fileName = fileName;
+    this->columnName = columnName;
+    this->startRow = startRow;
+    this->length = length;
+    this->elementSize = elementSize;
+    this->handle = R_NilValue;
+
+    blocks.resize((length + LAZY_BLOCK_SIZE - 1) / LAZY_BLOCK_SIZE, nullptr);
+  }
+
+  ~LazyColumn()
+  {
+    ReleaseBlocks();
+    CloseHandle();
+  }
+
+  /**
+   * \brief Read a range of rows of the column from file.
+   *
+   * \param firstRow First row to read (0-based, relative to the start of the lazy column).
+   * \param nrOfRows Number of rows to read.
+   * \return Unprotected vector with the requested rows.
+   */
+  SEXP ReadRows(R_xlen_t firstRow, R_xlen_t nrOfRows);
+
+  /**
+   * \brief Data of a block of rows, the block is read from file if required.
+   */
+  const char* Block(R_xlen_t blockNr);
+
+  /**
+   * \brief Number of rows in a block.
+   */
+  R_xlen_t BlockRows(R_xlen_t blockNr)
+  {
+    return min((R_xlen_t) LAZY_BLOCK_SIZE, length - blockNr * LAZY_BLOCK_SIZE);
+  }
+
+  int NrOfLoadedBlocks()
+  {
+    int count = 0;
+
+    for (vector<char*>::iterator it = blocks.begin(); it != blocks.end(); ++it)
+    {
+      if (*it != nullptr) count++;
+    }
+
+    return count;
+  }
+
+  void ReleaseBlocks()
+  {
+    for (vector<char*>::iterator it = blocks.begin(); it != blocks.end(); ++it)
+    {
+      delete[] *it;
+      *it = nullptr;
+    }
+  }
+
+  /**
+   * \brief Close the fst handle, the file is opened again on the next read.
+   */
+  void CloseHandle()
+  {
+    if (handle == R_NilValue) return;
+
+    fstclose(handle);
+    R_ReleaseObject(handle);
+    handle = R_NilValue;
+  }
+};
+
+
+inline void* VectorData(SEXP vec)
+{
+  if (TYPEOF(vec) == REALSXP) return REAL(vec);
+  if (TYPEOF(vec) == LGLSXP) return LOGICAL(vec);
+
+  return INTEGER(vec);
+}
+
+
+SEXP LazyColumn::ReadRows(R_xlen_t firstRow, R_xlen_t nrOfRows)
+{
+  if (handle == R_NilValue)
+  {
+    handle = fstopen(fileName);
+    R_PreserveObject(handle);
+  }
+
+  // row numbers are doubles to allow for columns beyond the integer range
+  SEXP colName = PROTECT(Rf_mkString(columnName.c_str()));
+  SEXP sRow = PROTECT(Rf_ScalarReal((double) (startRow + firstRow)));
+  SEXP eRow = PROTECT(Rf_ScalarReal((double) (startRow + firstRow + nrOfRows - 1)));
+
+  SEXP res = PROTECT(fstretrieve(handle, colName, sRow, eRow, R_NilValue, R_NilValue, R_NilValue));
+  SEXP vec = VECTOR_ELT(VECTOR_ELT(res, 3), 0);
+
+  UNPROTECT(4);
+
+  if (XLENGTH(vec) != nrOfRows)
+  {
+    Rf_error("Lazy column '%s' could not be read, the fst file was changed after the column was created",
+      columnName.c_str());
+  }
+
+  return vec;
+}
+
+
+const char* LazyColumn::Block(R_xlen_t blockNr)
+{
+  if (blocks[blockNr] != nullptr) return blocks[blockNr];
+
+  R_xlen_t nrOfRows = BlockRows(blockNr);
+  SEXP vec = PROTECT(ReadRows(blockNr * LAZY_BLOCK_SIZE, nrOfRows));
+
+  char* block = new char[nrOfRows * elementSize];
+  memcpy(block, VectorData(vec), nrOfRows * elementSize);
+  blocks[blockNr] = block;
+
+  UNPROTECT(1);
+
+  return block;
+}
+
+
+inline LazyColumn* GetLazyColumn(SEXP x)
+{
+  LazyColumn* lazyColumn = (LazyColumn*) R_ExternalPtrAddr(R_altrep_data1(x));
+
+  if (lazyColumn == nullptr)
+  {
+    Rf_error("Lazy column is no longer valid");
+  }
+
+  return lazyColumn;
+}
+
+
+void LazyColumnFinalizer(SEXP extPtr)
+{
+  LazyColumn* lazyColumn = (LazyColumn*) R_ExternalPtrAddr(extPtr);
+  delete lazyColumn;
+  R_ClearExternalPtr(extPtr);
+}
+
+
+/**
+ * \brief Read the complete column into a regular vector that is stored as the data2 field of the ALTREP object.
+ * Blocks that were read before are reused, the other rows are read with a single read per range of missing blocks.
+ */
+SEXP MaterializeLazyColumn(SEXP x)
+{
+  SEXP data2 = R_altrep_data2(x);
+  if (data2 != R_NilValue) return data2;
+
+  LazyColumn* lazyColumn = GetLazyColumn(x);
+  SEXP vec;
+
+  if (lazyColumn->NrOfLoadedBlocks() == 0)
+  {
+    PROTECT(vec = lazyColumn->ReadRows(0, lazyColumn->length));
+  }
+  else
+  {
+    PROTECT(vec = Rf_allocVector(TYPEOF(x), lazyColumn->length));
+
+    char* data = (char*) VectorData(vec);
+    int elementSize = lazyColumn->elementSize;
+    R_xlen_t nrOfBlocks = lazyColumn->blocks.size();
+    R_xlen_t blockNr = 0;
+
+    while (blockNr < nrOfBlocks)
+    {
+      R_xlen_t firstRow = blockNr * LAZY_BLOCK_SIZE;
+
+      if (lazyColumn->blocks[blockNr] != nullptr)
+      {
+        memcpy(data + firstRow * elementSize, lazyColumn->blocks[blockNr], lazyColumn->BlockRows(blockNr) * elementSize);
+        blockNr++;
+        continue;
+      }
+
+      // range of blocks that were not read yet
+      R_xlen_t lastBlock = blockNr + 1;
+      while (lastBlock < nrOfBlocks && lazyColumn->blocks[lastBlock] == nullptr) lastBlock++;
+
+      R_xlen_t nrOfRows = min(lastBlock * LAZY_BLOCK_SIZE, lazyColumn->length) - firstRow;
+      SEXP rows = PROTECT(lazyColumn->ReadRows(firstRow, nrOfRows));
+      memcpy(data + firstRow * elementSize, VectorData(rows), nrOfRows * elementSize);
+      UNPROTECT(1);
+
+      blockNr = lastBlock;
+    }
+  }
+
+  R_set_altrep_data2(x, vec);
+  lazyColumn->ReleaseBlocks();
+  lazyColumn->CloseHandle();  // no further reads
+
+  UNPROTECT(1);
+
+  return vec;
+}
+
+
+// ALTREP methods
+
+R_xlen_t LazyLength(SEXP x)
+{
+  SEXP data2 = R_altrep_data2(x);
+  if (data2 != R_NilValue) return XLENGTH(data2);
+
+  return GetLazyColumn(x)->length;
+}
+
+
+Rboolean LazyInspect(SEXP x, int pre, int deep, int pvec, void (*inspect_subtree)(SEXP, int, int, int))
+{
+  if (R_altrep_data2(x) != R_NilValue)
+  {
+    Rprintf(" fst lazy column (materialized)\n");
+    return TRUE;
+  }
+
+  LazyColumn* lazyColumn = GetLazyColumn(x);
+  Rprintf(" fst lazy column '%s' (%d of %d blocks read)\n", lazyColumn->columnName.c_str(),
+    lazyColumn->NrOfLoadedBlocks(), (int) lazyColumn->blocks.size());
+
+  return TRUE;
+}
+
+
+SEXP LazySerializedState(SEXP x)
+{
+  return MaterializeLazyColumn(x);
+}
+
+
+SEXP LazyUnserialize(SEXP altrepClass, SEXP state)
+{
+  return state;
+}
+
+
+void* LazyDataptr(SEXP x, Rboolean writeable)
+{
+  return VectorData(MaterializeLazyColumn(x));
+}
+
+
+const void* LazyDataptrOrNull(SEXP x)
+{
+  SEXP data2 = R_altrep_data2(x);
+  if (data2 == R_NilValue) return nullptr;
+
+  return VectorData(data2);
+}
+
+
+template<typename T>
+T LazyElt(SEXP x, R_xlen_t i)
+{
+  SEXP data2 = R_altrep_data2(x);
+  if (data2 != R_NilValue) return ((const T*) VectorData(data2))[i];
+
+  const T* block = (const T*) GetLazyColumn(x)->Block(i / LAZY_BLOCK_SIZE);
+
+  return block[i % LAZY_BLOCK_SIZE];
+}
+
+
+template<typename T>
+R_xlen_t LazyGetRegion(SEXP x, R_xlen_t i, R_xlen_t n, T* buf)
+{
+  R_xlen_t count = min(n, LazyLength(x) - i);
+  if (count <= 0) return 0;
+
+  SEXP data2 = R_altrep_data2(x);
+
+  if (data2 != R_NilValue)
+  {
+    memcpy(buf, (const T*) VectorData(data2) + i, count * sizeof(T));
+    return count;
+  }
+
+  LazyColumn* lazyColumn = GetLazyColumn(x);
+  R_xlen_t pos = 0;
+
+  while (pos < count)
+  {
+    R_xlen_t row = i + pos;
+    R_xlen_t blockNr = row / LAZY_BLOCK_SIZE;
+    R_xlen_t offset = row % LAZY_BLOCK_SIZE;
+    R_xlen_t nrOfRows = min(lazyColumn->BlockRows(blockNr) - offset, count - pos);
+
+    memcpy(buf + pos, (const T*) lazyColumn->Block(blockNr) + offset, nrOfRows * sizeof(T));
+    pos += nrOfRows;
+  }
+
+  return count;
+}
+
+
+void SetLazyMethods(R_altrep_class_t lazyClass)
+{
+  R_set_altrep_Length_method(lazyClass, LazyLength);
+  R_set_altrep_Inspect_method(lazyClass, LazyInspect);
+  R_set_altrep_Serialized_state_method(lazyClass, LazySerializedState);
+  R_set_altrep_Unserialize_method(lazyClass, LazyUnserialize);
+
+  R_set_altvec_Dataptr_method(lazyClass, LazyDataptr);
+  R_set_altvec_Dataptr_or_null_method(lazyClass, LazyDataptrOrNull);
+}
+
+#endif  // FST_ALTREP
+
+
+SEXP fstlazycolumn(String fileName, String columnName, SEXP startRow, SEXP length, SEXP templateVec)
+{
+#ifdef FST_ALTREP
+  R_altrep_class_t lazyClass;
+  int elementSize;
+
+  switch (TYPEOF(templateVec))
+  {
+    case INTSXP:
+      lazyClass = lazy_integer_class;
+      elementSize = sizeof(int);
+      break;
+
+    case REALSXP:
+      lazyClass = lazy_real_class;
+      elementSize = sizeof(double);
+      break;
+
+    case LGLSXP:
+      lazyClass = lazy_logical_class;
+      elementSize = sizeof(int);
+      break;
+
+    default:
+      Rf_error("Lazy columns are only available for integer, double and logical columns");
+  }
+
+  R_xlen_t nrOfRows = (R_xlen_t) Rf_asReal(length);
+
+  if (nrOfRows < 1)
+  {
+    Rf_error("A lazy column should have at least a single row");
+  }
+
+  LazyColumn* lazyColumn = new LazyColumn(fileName.get_cstring(), columnName.get_cstring(),
+    (R_xlen_t) Rf_asReal(startRow), nrOfRows, elementSize);
+
+  SEXP extPtr = PROTECT(R_MakeExternalPtr(lazyColumn, R_NilValue, R_NilValue));
+  R_RegisterCFinalizerEx(extPtr, LazyColumnFinalizer, TRUE);
+
+  SEXP vec = PROTECT(R_new_altrep(lazyClass, extPtr, R_NilValue));
+  DUPLICATE_ATTRIB(vec, templateVec);
+
+  UNPROTECT(2);
+
+  return vec;
+#else
+  Rf_error("Lazy columns require R version 3.6.0 or later");
+  return R_NilValue;
+#endif
+}
+
+
+extern "C" void register_fst_altrep_classes(DllInfo* dll)
+{
+#ifdef FST_ALTREP
+  lazy_integer_class = R_make_altinteger_class("fst_lazy_integer", "fst", dll);
+  SetLazyMethods(lazy_integer_class);
+  R_set_altinteger_Elt_method(lazy_integer_class, LazyElt<int>);
+  R_set_altinteger_Get_region_method(lazy_integer_class, LazyGetRegion<int>);
+
+  lazy_real_class = R_make_altreal_class("fst_lazy_real", "fst", dll);
+  SetLazyMethods(lazy_real_class);
+  R_set_altreal_Elt_method(lazy_real_class, LazyElt<double>);
+  R_set_altreal_Get_region_method(lazy_real_class, LazyGetRegion<double>);
+
+  lazy_logical_class = R_make_altlogical_class("fst_lazy_logical", "fst", dll);
+  SetLazyMethods(lazy_logical_class);
+  R_set_altlogical_Elt_method(lazy_logical_class, LazyElt<int>);
+  R_set_altlogical_Get_region_method(lazy_logical_class, LazyGetRegion<int>);
+#endif
+}
@@ -0,0 +1,64 @@
+/*
+  fst - An R-package for ultra fast storage and retrieval of datasets.
+  Copyright (C) 2017, Mark AJ Klik
+
+  BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following disclaimer
+    in the documentation and/or other materials provided with the
+    distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+    A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  You can contact the author at :
+  - fst source repository : https://github.com/fstPackage/fst
+*/
+
+
+#ifndef FST_ALTREP_H
+#define FST_ALTREP_H
+
+
+#include <Rcpp.h>
+#include <R_ext/Rdynload.h>
+
+
+#define LAZY_BLOCK_SIZE 65536  // number of rows read from file when an element of a lazy column is accessed
+
+
+/**
+ * \brief Create a lazy column: an ALTREP vector that reads the data of a stored column on first access.
+ *
+ * \param fileName Name of the fst file.
+ * \param columnName Name of the stored column.
+ * \param startRow First row of the column to read (1-based).
+ * \param length Number of rows in the lazy column.
+ * \param templateVec Vector of the same type as the stored column, its attributes are copied to the result.
+ */
+// [[Rcpp::export]]
+SEXP fstlazycolumn(Rcpp::String fileName, Rcpp::String columnName, SEXP startRow, SEXP length, SEXP templateVec);
+
+
+// Called once on loading fst from init.c
+extern "C" void register_fst_altrep_classes(DllInfo* dll);
+
+
+#endif  // FST_ALTREP_H
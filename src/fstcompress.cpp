@@ -37,6 +37,7 @@
 
 #include <interface/fstcompressor.h>
 #include <interface/fsthash.h>
+#include <compression/compression.h>
 
 #include <typefactory.h>
 
@@ -156,3 +157,20 @@ SEXP fstdecomp(SEXP rawVec)
   return resVec;
 }
 
+
+SEXP fstzstdreuse(SEXP reuse)
+{
+  if (Rf_isNull(reuse))
+  {
+    return Rf_ScalarLogical(GetZstdContextReuse());
+  }
+
+  if (!Rf_isLogical(reuse) || Rf_length(reuse) != 1 || LOGICAL(reuse)[0] == NA_LOGICAL)
+  {
+    ::Rf_error("Parameter reuse should be TRUE or FALSE");
+  }
+
+  bool previousReuse = SetZstdContextReuse(LOGICAL(reuse)[0] != 0);
+
+  return Rf_ScalarLogical(previousReuse);
+}
@@ -53,4 +53,8 @@ SEXP fstcomp(SEXP rawVec, SEXP compressor, SEXP compression, SEXP hash);
 SEXP fstdecomp(SEXP rawVec);
 
 
+// [[Rcpp::export]]
+SEXP fstzstdreuse(SEXP reuse);
+
+
 #endif  // FASTSTORE_H
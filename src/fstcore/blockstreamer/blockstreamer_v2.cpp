@@ -37,12 +37,22 @@ You can contact the author at :
 #include <cstring>
 #include <iostream>
 #include <algorithm>
+#include <climits>
+#include <stdexcept>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 
 // Framework libraries
 #include <compression/compression.h>
 #include <compression/compressor.h>
 #include <interface/fstdefines.h>
 #include <interface/openmphelper.h>
+#include <interface/fstasyncreader.h>
+
+#include <ZSTD/common/xxhash.h>
 
 #include "blockstreamer_v2.h"
 
@@ -58,25 +68,217 @@ You can contact the author at :
 #define BLOCK_ALGO_MASK 0xffff000000000000
 #define BLOCK_POS_MASK 0x0000ffffffffffff
 #define MAX_COMPRESSBOUND_PLUS_META_SIZE 17044
+#define BLOCK_ZONE_MAP_FLAG 0x0001000000000000  // set in the last block position when a zone map follows the data blocks
+#define ZONE_MAP_HEADER_SIZE 8
+#define ZONE_MAP_ENTRY_SIZE 24
+#define DATA_ZONE_MAP_HEADER_SIZE 16
 
 
 using namespace std;
 
 
-// Method for writing column data of any type to a ofstream.
-void fdsStreamUncompressed_v2(ofstream &myfile, char* vec, unsigned long long vecLength, int elementSize, int blockSizeElems,
-  FixedRatioCompressor* fixedRatioCompressor, std::string annotation)
+// Zone map [follows the last data block, flagged in the last block position] [size: 8 + 24 * nrOfBlocks]
+//
+//  4                      | unsigned int       | zoneMapType        // column type of the statistics (INT_32, DOUBLE_64 or INT_64)
+//  4                      | unsigned int       | nrOfBlocks         // number of data blocks
+//
+// for each block:
+//  8                      | long long / double | minValue           // smallest non-NA value (0 if all values are NA)
+//  8                      | long long / double | maxValue           // largest non-NA value (0 if all values are NA)
+//  8                      | unsigned long long | naCount            // number of NA values
+
+
+// Zone map of uncompressed or fixed-ratio compressed data [directly follows the data] [size: 16 + zone map]
+//
+// This data has no block index to flag a zone map, the hash identifies the zone map. Readers that are not aware of
+// zone maps don't read beyond the data.
+//
+//  8                      | unsigned long long | hash value         // hash of the remaining bytes
+//  4                      | unsigned int       | blockSizeElements  // number of elements per block
+//  4                      |                    | free bytes         // possible future use
+//  8 + 24 * nrOfBlocks    |                    | zone map           // zone map with the layout above
+
+
+// Minimum, maximum and NA count of a block of integer or integer64 values
+template<typename T>
+inline void IntBlockStatistics(const T* values, unsigned int nrOfElements, T naValue, char* zoneMapEntry)
+{
+  long long* minValue = reinterpret_cast<long long*>(zoneMapEntry);
+  long long* maxValue = reinterpret_cast<long long*>(&zoneMapEntry[8]);
+  unsigned long long* naCount = reinterpret_cast<unsigned long long*>(&zoneMapEntry[16]);
+
+  T minVal = 0;
+  T maxVal = 0;
+  unsigned long long nrOfNA = 0;
+  unsigned int pos = 0;
+
+  // skip leading NA values
+  for (; pos < nrOfElements; ++pos)
+  {
+    if (values[pos] != naValue)
+    {
+      minVal = values[pos];
+      maxVal = values[pos];
+      break;
+    }
+
+    ++nrOfNA;
+  }
+
+  for (; pos < nrOfElements; ++pos)
+  {
+    T value = values[pos];
+
+    if (value == naValue)
+    {
+      ++nrOfNA;
+      continue;
+    }
+
+    if (value < minVal) minVal = value;
+    if (value > maxVal) maxVal = value;
+  }
+
+  *minValue = static_cast<long long>(minVal);
+  *maxValue = static_cast<long long>(maxVal);
+  *naCount = nrOfNA;
+}
+
+
+// Minimum, maximum and NA count of a block of double values, NaN values are counted as NA
+inline void DoubleBlockStatistics(const double* values, unsigned int nrOfElements, char* zoneMapEntry)
+{
+  double* minValue = reinterpret_cast<double*>(zoneMapEntry);
+  double* maxValue = reinterpret_cast<double*>(&zoneMapEntry[8]);
+  unsigned long long* naCount = reinterpret_cast<unsigned long long*>(&zoneMapEntry[16]);
+
+  double minVal = 0;
+  double maxVal = 0;
+  unsigned long long nrOfNA = 0;
+  unsigned int pos = 0;
+
+  // skip leading NA values
+  for (; pos < nrOfElements; ++pos)
+  {
+    if (values[pos] == values[pos])
+    {
+      minVal = values[pos];
+      maxVal = values[pos];
+      break;
+    }
+
+    ++nrOfNA;
+  }
+
+  for (; pos < nrOfElements; ++pos)
+  {
+    double value = values[pos];
+
+    if (value != value)  // NA or NaN
+    {
+      ++nrOfNA;
+      continue;
+    }
+
+    if (value < minVal) minVal = value;
+    if (value > maxVal) maxVal = value;
+  }
+
+  *minValue = minVal;
+  *maxValue = maxVal;
+  *naCount = nrOfNA;
+}
+
+
+// Calculate the zone map entry of a single block
+inline void BlockStatistics(const char* blockData, unsigned int nrOfElements, FstColumnType zoneMapType, char* zoneMapEntry)
+{
+  switch (zoneMapType)
+  {
+    case FstColumnType::INT_32:
+      IntBlockStatistics(reinterpret_cast<const int*>(blockData), nrOfElements, static_cast<int>(FST_NA_INT), zoneMapEntry);
+      break;
+
+    case FstColumnType::DOUBLE_64:
+      DoubleBlockStatistics(reinterpret_cast<const double*>(blockData), nrOfElements, zoneMapEntry);
+      break;
+
+    case FstColumnType::INT_64:
+      IntBlockStatistics(reinterpret_cast<const long long*>(blockData), nrOfElements, LLONG_MIN, zoneMapEntry);
+      break;
+
+    default:
+      break;
+  }
+}
+
+
+// Append the zone map of uncompressed or fixed-ratio compressed data, the block statistics are calculated in parallel
+inline void AppendDataZoneMap(IFstSink &myfile, const char* vec, unsigned long long vecLength, int elementSize,
+  int blockSizeElems, FstColumnType zoneMapType)
+{
+  int nrOfBlocks = 1 + (vecLength - 1) / blockSizeElems;
+  int remain = 1 + (vecLength + blockSizeElems - 1) % blockSizeElems;  // number of elements in last incomplete block
+  unsigned long long zoneMapSize = DATA_ZONE_MAP_HEADER_SIZE + ZONE_MAP_HEADER_SIZE + ZONE_MAP_ENTRY_SIZE * nrOfBlocks;
+
+  char* zoneMap = new char[zoneMapSize];
+
+  unsigned int* p_blockSizeElements = reinterpret_cast<unsigned int*>(&zoneMap[8]);
+  unsigned int* p_free = reinterpret_cast<unsigned int*>(&zoneMap[12]);
+  unsigned int* p_zoneMapType = reinterpret_cast<unsigned int*>(&zoneMap[DATA_ZONE_MAP_HEADER_SIZE]);
+  unsigned int* p_nrOfBlocks = reinterpret_cast<unsigned int*>(&zoneMap[DATA_ZONE_MAP_HEADER_SIZE + 4]);
+
+  *p_blockSizeElements = blockSizeElems;
+  *p_free = 0;
+  *p_zoneMapType = static_cast<unsigned int>(zoneMapType);
+  *p_nrOfBlocks = nrOfBlocks;
+
+  char* entries = &zoneMap[DATA_ZONE_MAP_HEADER_SIZE + ZONE_MAP_HEADER_SIZE];
+  int nrOfThreads = max(1, min(GetFstThreads(), nrOfBlocks));
+
+#pragma omp parallel for num_threads(nrOfThreads)
+  for (int block = 0; block < nrOfBlocks; block++)
+  {
+    unsigned long long vecOffset = static_cast<unsigned long long>(block) * blockSizeElems * elementSize;
+    BlockStatistics(&vec[vecOffset], block == nrOfBlocks - 1 ? remain : blockSizeElems, zoneMapType,
+      &entries[ZONE_MAP_ENTRY_SIZE * block]);
+  }
+
+  unsigned long long* p_hash = reinterpret_cast<unsigned long long*>(zoneMap);
+  *p_hash = XXH64(&zoneMap[8], zoneMapSize - 8, FST_HASH_SEED);
+
+  try
+  {
+    SinkAppend(myfile, zoneMap, zoneMapSize);
+  }
+  catch (...)
+  {
+    delete[] zoneMap;
+    throw;
+  }
+
+  delete[] zoneMap;
+}
+
+
+// Method for writing column data of any type to a stream.
+void fdsStreamUncompressed_v2(IFstSink &myfile, char* vec, unsigned long long vecLength, int elementSize, int blockSizeElems,
+  FixedRatioCompressor* fixedRatioCompressor, std::string annotation, FstColumnType zoneMapType)
 {
+  // Per-block statistics
+  bool hasZoneMap = vecLength > 0 && ((zoneMapType == FstColumnType::INT_32) ||
+    (zoneMapType == FstColumnType::DOUBLE_64) || (zoneMapType == FstColumnType::INT_64));
+
   unsigned int annotationLength = annotation.length();
   int nrOfBlocks = 1 + (vecLength - 1) / blockSizeElems;  // number of compressed / uncompressed blocks
   int remain = 1 + (vecLength + blockSizeElems - 1) % blockSizeElems;  // number of elements in last incomplete block
   int blockSize = blockSizeElems * elementSize;
 
-  myfile.write((char*) &annotationLength, 4);
+  SinkAppend(myfile, (char*) &annotationLength, 4);
 
   if (annotationLength > 0)
   {
-    myfile.write(annotation.c_str(), annotationLength);
+    SinkAppend(myfile, annotation.c_str(), annotationLength);
   }
 
   // Write uncompressed vector to disk in blocks
@@ -86,7 +288,7 @@ void fdsStreamUncompressed_v2(ofstream &myfile, char* vec, unsigned long long ve
   if (fixedRatioCompressor == nullptr )
   {
     unsigned int compress[2] = { 0, 0 };
-    myfile.write(reinterpret_cast<char*>(compress), COL_META_SIZE);
+    SinkAppend(myfile, reinterpret_cast<char*>(compress), COL_META_SIZE);
 
     uint64_t blockPos = 0;
 
@@ -95,11 +297,13 @@ void fdsStreamUncompressed_v2(ofstream &myfile, char* vec, unsigned long long ve
   	// and use (thread-) local cache for writing)
     for (int block = 0; block != nrOfBlocks; ++block)
     {
-      myfile.write(&vec[blockPos], blockSize);
+      SinkAppend(myfile, &vec[blockPos], blockSize);
       blockPos += blockSize;
     }
 
-    myfile.write(&vec[blockPos], remain * elementSize);
+    SinkAppend(myfile, &vec[blockPos], remain * elementSize);
+
+    if (hasZoneMap) AppendDataZoneMap(myfile, vec, vecLength, elementSize, blockSizeElems, zoneMapType);
 
     return;
   }
@@ -122,7 +326,9 @@ void fdsStreamUncompressed_v2(ofstream &myfile, char* vec, unsigned long long ve
     CompAlgo compAlgo;
     fixedRatioCompressor->Compress(&compBuf[COL_META_SIZE], compressBufSizeRemain, vec, remainBlock, compAlgo);
     compress[1] = static_cast<unsigned int>(compAlgo);  // set fixed-ratio compression algorithm
-    myfile.write(compBuf, compressBufSizeRemain + COL_META_SIZE);
+    SinkAppend(myfile, compBuf, compressBufSizeRemain + COL_META_SIZE);
+
+    if (hasZoneMap) AppendDataZoneMap(myfile, vec, vecLength, elementSize, blockSizeElems, zoneMapType);
 
     return;
   }
@@ -140,7 +346,7 @@ void fdsStreamUncompressed_v2(ofstream &myfile, char* vec, unsigned long long ve
   CompAlgo compAlgo;
   fixedRatioCompressor->Compress(&compBuf[COL_META_SIZE], compressBufSize, vec, blockSize, compAlgo);
   compress[1] = static_cast<unsigned int>(compAlgo);  // set fixed-ratio compression algorithm
-  myfile.write(compBuf, compressBufSize + COL_META_SIZE);
+  SinkAppend(myfile, compBuf, compressBufSize + COL_META_SIZE);
 
   // Next blocks
 
@@ -150,35 +356,101 @@ void fdsStreamUncompressed_v2(ofstream &myfile, char* vec, unsigned long long ve
   {
     fixedRatioCompressor->Compress(compBuf, compressBufSize, &vec[blockPos], blockSize, compAlgo);
     blockPos += blockSize;
-    myfile.write(compBuf, compressBufSize);
+    SinkAppend(myfile, compBuf, compressBufSize);
   }
 
   // Last block
 
   fixedRatioCompressor->Compress(compBuf, compressBufSizeRemain, &vec[blockPos], remainBlock, compAlgo);
-  myfile.write(compBuf, compressBufSizeRemain);
+  SinkAppend(myfile, compBuf, compressBufSizeRemain);
+
+  if (hasZoneMap) AppendDataZoneMap(myfile, vec, vecLength, elementSize, blockSizeElems, zoneMapType);
 }
 
 
 #define BATCH_SIZE_WRITE 25
 
+
+// Bounded reorder buffer between the compression threads and the writer of a column. Batches are compressed (out of
+// order) into a ring of slots, the writer appends them to the sink in batch order and then releases the slot for the
+// batch that is nrOfSlots batches further. A compression thread only waits when all slots are in use.
+class BatchReorderBuffer
+{
+  std::mutex slotMutex;
+  std::condition_variable slotCondition;
+  std::vector<int> slotBatch;      // batch that is allowed to use each slot
+  std::vector<bool> isCompressed;  // the slot holds its compressed batch
+  int nrOfSlots;
+
+public:
+  BatchReorderBuffer(int nrOfSlots)
+  {
+    this->nrOfSlots = nrOfSlots;
+
+    for (int slot = 0; slot < nrOfSlots; ++slot)
+    {
+      slotBatch.push_back(slot);
+      isCompressed.push_back(false);
+    }
+  }
+
+  int Slot(int batch) const { return batch % nrOfSlots; }
+
+  // Wait until the slot of a batch is released for that batch
+  void WaitFree(int batch)
+  {
+    std::unique_lock<std::mutex> lock(slotMutex);
+    slotCondition.wait(lock, [&] { return slotBatch[Slot(batch)] == batch; });
+  }
+
+  // Signal the writer that a batch is compressed
+  void Complete(int batch)
+  {
+    {
+      std::lock_guard<std::mutex> lock(slotMutex);
+      isCompressed[Slot(batch)] = true;
+    }
+
+    slotCondition.notify_all();
+  }
+
+  // Wait until a batch is compressed
+  void WaitCompressed(int batch)
+  {
+    std::unique_lock<std::mutex> lock(slotMutex);
+    slotCondition.wait(lock, [&] { return slotBatch[Slot(batch)] == batch && isCompressed[Slot(batch)]; });
+  }
+
+  // Release the slot of a written batch for the batch that is nrOfSlots batches further
+  void Release(int batch)
+  {
+    {
+      std::lock_guard<std::mutex> lock(slotMutex);
+      slotBatch[Slot(batch)] = batch + nrOfSlots;
+      isCompressed[Slot(batch)] = false;
+    }
+
+    slotCondition.notify_all();
+  }
+};
+
 // Method for writing column data of any type to a stream.
-void fdsStreamcompressed_v2(ofstream &myfile, char* colVec, unsigned long long nrOfRows, int elementSize,
-  StreamCompressor* streamCompressor, int blockSizeElems, std::string annotation)
+void fdsStreamcompressed_v2(IFstSink &myfile, char* colVec, unsigned long long nrOfRows, int elementSize,
+  StreamCompressor* streamCompressor, int blockSizeElems, std::string annotation, FstColumnType zoneMapType)
 {
   unsigned int annotationLength = annotation.length();
   int nrOfBlocks = 1 + (nrOfRows - 1) / blockSizeElems;  // number of compressed / uncompressed blocks
   int remain = 1 + (nrOfRows + blockSizeElems - 1) % blockSizeElems;  // number of elements in last incomplete block
   int blockSize = blockSizeElems * elementSize;
 
-  myfile.write((char*) &annotationLength, 4);
+  SinkAppend(myfile, (char*) &annotationLength, 4);
 
   if (annotationLength > 0)
   {
-    myfile.write(annotation.c_str(), annotationLength);
+    SinkAppend(myfile, annotation.c_str(), annotationLength);
   }
 
-  unsigned long long curPos = myfile.tellp();
+  unsigned long long curPos = myfile.Size();
 
   // Blocks meta information
   // Allocate a 8 bytes alligned buffer
@@ -191,9 +463,35 @@ void fdsStreamcompressed_v2(ofstream &myfile, char* colVec, unsigned long long n
   *maxCompSize = blockSize;  // can be used later for optimization
 
   // Write block index
-  myfile.write(static_cast<char*>(blockIndex), 8 + COL_META_SIZE + nrOfBlocks * 8);
+  try
+  {
+    SinkAppend(myfile, static_cast<char*>(blockIndex), 8 + COL_META_SIZE + nrOfBlocks * 8);
+  }
+  catch (...)
+  {
+    delete[] blockIndex;
+    throw;
+  }
+
   unsigned long long blockIndexPos = 8 + COL_META_SIZE + nrOfBlocks * 8;  // relative to the column data starting position
 
+  // Per-block statistics
+  bool hasZoneMap = (zoneMapType == FstColumnType::INT_32) || (zoneMapType == FstColumnType::DOUBLE_64) ||
+    (zoneMapType == FstColumnType::INT_64);
+  unsigned long long zoneMapSize = ZONE_MAP_HEADER_SIZE + ZONE_MAP_ENTRY_SIZE * nrOfBlocks;
+  char* zoneMap = nullptr;
+
+  if (hasZoneMap)
+  {
+    zoneMap = new char[zoneMapSize];
+
+    unsigned int* p_zoneMapType = reinterpret_cast<unsigned int*>(zoneMap);
+    unsigned int* p_nrOfBlocks = reinterpret_cast<unsigned int*>(&zoneMap[4]);
+
+    *p_zoneMapType = static_cast<unsigned int>(zoneMapType);
+    *p_nrOfBlocks = nrOfBlocks;
+  }
+
 
   // Compress in blocks
   --nrOfBlocks;  // Do last block later
@@ -211,54 +509,135 @@ void fdsStreamcompressed_v2(ofstream &myfile, char* colVec, unsigned long long n
   int nrOfThreads = max(1, min(GetFstThreads(), nrOfBlocks));
   int batchSize = min(BATCH_SIZE_WRITE, nrOfBlocks / nrOfThreads);  // keep thread buffer small
   batchSize = max(1, batchSize);
-  char* threadBuffer = new char[nrOfThreads * MAX_COMPRESSBOUND * batchSize];
   int nrOfBatches = nrOfBlocks / batchSize;  // number of complete batches with complete blocks
 
-  if (nrOfBatches > 0)
+  // A single thread compresses and writes the batches in turn. Multiple threads compress into the slots of a reorder
+  // buffer that is drained in batch order by a dedicated writer, so compression doesn't stall on the writes or on
+  // slower (less compressible) batches of other threads
+  int nrOfSlots = nrOfThreads == 1 ? 1 : nrOfThreads * WRITE_REORDER_SLOTS;
+  char* threadBuffer = new char[nrOfSlots * MAX_COMPRESSBOUND * batchSize];
+  unsigned int* slotCompSize = new unsigned int[nrOfSlots * batchSize];
+  unsigned int* slotAlgorithm = new unsigned int[nrOfSlots * batchSize];
+  vector<unsigned long long> slotTotSize(nrOfSlots);
+
+  // Release all buffers when a write fails
+  auto deleteBuffers = [&]
+  {
+    delete[] threadBuffer;
+    delete[] slotCompSize;
+    delete[] slotAlgorithm;
+    delete[] zoneMap;
+    delete[] blockIndex;
+  };
+
+  // Compress a batch into its slot of the reorder buffer
+  auto compressBatch = [&](int batch, int slot)
+  {
+    unsigned int* compSize = &slotCompSize[slot * batchSize];
+    unsigned int* blockAlgorithm = &slotAlgorithm[slot * batchSize];
+    unsigned long long totSize = 0;
+
+    for (int offset = 0; offset < batchSize; offset++)
+    {
+      int block = batch * batchSize + offset;
+      CompAlgo compAlgo;
+      char* compBuf = &threadBuffer[slot * MAX_COMPRESSBOUND * batchSize + totSize];
+      unsigned long long vecOffset = static_cast<unsigned long long>(block) * static_cast<unsigned long long>(blockSize);
+      compSize[offset] = static_cast<unsigned int>(streamCompressor->Compress(&colVec[vecOffset], blockSize, compBuf, compAlgo, block));
+
+      if (hasZoneMap)
+      {
+        BlockStatistics(&colVec[vecOffset], blockSizeElems, zoneMapType, &zoneMap[ZONE_MAP_HEADER_SIZE + ZONE_MAP_ENTRY_SIZE * block]);
+      }
+
+      totSize += static_cast<unsigned long long>(compSize[offset]);
+      blockAlgorithm[offset] = static_cast<unsigned int>(compAlgo);
+    }
+
+    slotTotSize[slot] = totSize;
+  };
+
+  // Append a compressed batch to the stream and register its blocks in the block index
+  auto writeBatch = [&](int batch, int slot)
   {
-	  // Parallel region processes batches with batchSize complete blocks per batch
+    for (int offset = 0; offset < batchSize; offset++)
+    {
+      int block = batch * batchSize + offset;
+      unsigned int compSize = slotCompSize[slot * batchSize + offset];
+      blockPosition[block] = blockIndexPos | (static_cast<unsigned long long>(slotAlgorithm[slot * batchSize + offset]) << 48); // starting position and algorithm in 2 high bytes
+      blockIndexPos += compSize;  // compressed block length
+      if (compSize > maxCompressionSize) maxCompressionSize = compSize;
+    }
+
+    SinkAppend(myfile, &threadBuffer[slot * MAX_COMPRESSBOUND * batchSize], slotTotSize[slot]);
+  };
+
+  if (nrOfBatches > 0 && nrOfThreads == 1)
+  {
+    for (int batch = 0; batch < nrOfBatches; batch++)
+    {
+      compressBatch(batch, 0);
+      writeBatch(batch, 0);
+    }
+  }
+  else if (nrOfBatches > 0)
+  {
+    BatchReorderBuffer reorderBuffer(nrOfSlots);
+    std::atomic<int> nextBatch(0);
+
+    // Exceptions can't leave the writer thread, after a failed write the remaining batches are only released so the
+    // compression threads can finish
+    bool writeFailed = false;
+    std::string errorMessage;
+
+    thread writer([&]
+    {
+      for (int batch = 0; batch < nrOfBatches; batch++)
+      {
+        reorderBuffer.WaitCompressed(batch);
+
+        if (!writeFailed)
+        {
+          try
+          {
+            writeBatch(batch, reorderBuffer.Slot(batch));
+          }
+          catch (const std::exception &e)
+          {
+            errorMessage = e.what();
+            writeFailed = true;
+          }
+          catch (...)
+          {
+            errorMessage = "Error writing compressed blocks to the stream";
+            writeFailed = true;
+          }
+        }
+
+        reorderBuffer.Release(batch);
+      }
+    });
+
+    // Parallel region processes batches with batchSize complete blocks per batch. Batches are claimed in order from
+    // a shared counter, so a thread that waits for a free slot always waits for an earlier batch
 
 #pragma omp parallel num_threads(nrOfThreads)
-	  {
-#pragma omp for ordered schedule(static, 1)
-		  for (int batch = 0; batch < nrOfBatches; batch++)
-		  {
-			  unsigned int compSize[BATCH_SIZE_WRITE];
-			  unsigned int blockAlgorithm[BATCH_SIZE_WRITE];
-
-			  int threadNr = OMP_GET_THREAD_NUM;  // use memory buffer specific for this thread
-
-			  unsigned long long totSize = 0;
-			  unsigned int localMax = 0;
-
-			  for (int offset = 0; offset < batchSize; offset++)
-			  {
-				  int block = batch * batchSize + offset;
-				  CompAlgo compAlgo;
-				  char* compBuf = &threadBuffer[threadNr * MAX_COMPRESSBOUND * batchSize + totSize];
-          unsigned long long vecOffset = static_cast<unsigned long long>(block) * static_cast<unsigned long long>(blockSize);
-				  compSize[offset] = static_cast<unsigned int>(streamCompressor->Compress(&colVec[vecOffset], blockSize, compBuf, compAlgo, block));
-				  totSize += static_cast<unsigned long long>(compSize[offset]);
-				  blockAlgorithm[offset] = static_cast<unsigned int>(compAlgo);
-				  if (compSize[offset] > localMax) localMax = compSize[offset];
-			  }
-
-
-#pragma omp ordered
-			  {
-				  for (int offset = 0; offset < batchSize; offset++)
-				  {
-					  int block = batch * batchSize + offset;
-					  blockPosition[block] = blockIndexPos | (static_cast<unsigned long long>(blockAlgorithm[offset]) << 48); // starting position and algorithm in 2 high bytes
-					  blockIndexPos += compSize[offset];  // compressed block length
-				  }
-
-				  char* compBuf = &threadBuffer[threadNr * MAX_COMPRESSBOUND * batchSize];
-				  if (localMax > maxCompressionSize) maxCompressionSize = localMax;
-				  myfile.write(compBuf, totSize);
-			  }
-		  }
-	  }
+    {
+      for (int batch = nextBatch++; batch < nrOfBatches; batch = nextBatch++)
+      {
+        reorderBuffer.WaitFree(batch);
+        compressBatch(batch, reorderBuffer.Slot(batch));
+        reorderBuffer.Complete(batch);
+      }
+    }
+
+    writer.join();
+
+    if (writeFailed)
+    {
+      deleteBuffers();
+      throw(runtime_error(errorMessage));
+    }
   }
 
   //////////////////////////////////////////////////////////
@@ -282,6 +661,11 @@ void fdsStreamcompressed_v2(ofstream &myfile, char* colVec, unsigned long long n
       unsigned long long vecOffset = static_cast<unsigned long long>(block) * static_cast<unsigned long long>(blockSize);
 		  compSize = static_cast<unsigned int>(streamCompressor->Compress(&colVec[vecOffset], blockSize, &compBuf[totSize], compAlgo, block));
 		  totSize += compSize;
+
+		  if (hasZoneMap)
+		  {
+		    BlockStatistics(&colVec[vecOffset], blockSizeElems, zoneMapType, &zoneMap[ZONE_MAP_HEADER_SIZE + ZONE_MAP_ENTRY_SIZE * block]);
+		  }
 		  blockAlgorithm = static_cast<unsigned int>(compAlgo);
 		  if (compSize > maxCompressionSize) maxCompressionSize = compSize;
 
@@ -294,15 +678,30 @@ void fdsStreamcompressed_v2(ofstream &myfile, char* colVec, unsigned long long n
     compSize = static_cast<unsigned int>(streamCompressor->Compress(&colVec[vecOffset], remain * elementSize, &compBuf[totSize], compAlgo, nrOfBlocks));
 	  totSize += compSize;
 
+	  if (hasZoneMap)
+	  {
+	    BlockStatistics(&colVec[vecOffset], remain, zoneMapType, &zoneMap[ZONE_MAP_HEADER_SIZE + ZONE_MAP_ENTRY_SIZE * nrOfBlocks]);
+	  }
+
 	  if (compSize > maxCompressionSize) maxCompressionSize = compSize;
 	  blockAlgorithm = static_cast<unsigned int>(compAlgo);
 	  blockPosition[nrOfBlocks] = blockIndexPos | (static_cast<unsigned long long>(blockAlgorithm) << 48); // starting position and algorithm in 2 high bytes
 	  blockIndexPos += compSize;  // compressed block length
 
-	  myfile.write(compBuf, totSize);
+    try
+    {
+      SinkAppend(myfile, compBuf, totSize);
+    }
+    catch (...)
+    {
+      deleteBuffers();
+      throw;
+    }
   }
 
   delete[] threadBuffer;
+  delete[] slotCompSize;
+  delete[] slotAlgorithm;
 
   // Might be usefull in future implementation
   *maxCompSize = maxCompressionSize;
@@ -311,18 +710,33 @@ void fdsStreamcompressed_v2(ofstream &myfile, char* colVec, unsigned long long n
   blockPosition = reinterpret_cast<unsigned long long*>(&blockIndex[COL_META_SIZE + 8 + nrOfBlocks * 8]);
   *blockPosition = blockIndexPos;
 
-  // Rewrite blockIndex
-  myfile.seekp(curPos);
-  myfile.write(static_cast<char*>(blockIndex), COL_META_SIZE + 16 + nrOfBlocks * 8);
-  myfile.seekp(0, ios_base::end);
+  try
+  {
+    // Zone map directly follows the last block, readers that are not aware of zone maps ignore the flag
+    if (hasZoneMap)
+    {
+      SinkAppend(myfile, zoneMap, zoneMapSize);
+      *blockPosition |= BLOCK_ZONE_MAP_FLAG;
+    }
+
+    // Rewrite blockIndex
+    myfile.Write(static_cast<char*>(blockIndex), curPos, COL_META_SIZE + 16 + nrOfBlocks * 8);
+  }
+  catch (...)
+  {
+    delete[] zoneMap;
+    delete[] blockIndex;
+    throw;
+  }
 
+  delete[] zoneMap;
   delete[] blockIndex;
 }
 
 
-// Read data compressed with a fixed ratio compressor from a stream
+// Read data compressed with a fixed ratio compressor from a source
 // Note that repSize is assumed to be a multiple of elementSize
-inline void fdsReadFixedCompStream_v2(istream &myfile, char* outVec, unsigned long long blockPos,
+inline void fdsReadFixedCompStream_v2(IFstSource &myfile, char* outVec, unsigned long long blockPos,
   unsigned int* meta, unsigned long long startRow, int elementSize, unsigned long long vecLength)
 {
   unsigned int compAlgo = meta[1];  // identifier of the fixed ratio compressor
@@ -342,10 +756,7 @@ inline void fdsReadFixedCompStream_v2(istream &myfile, char* outVec, unsigned lo
 
   Decompressor decompressor;  // decompressor
 
-  if (startRep > 0)
-  {
-    myfile.seekg(blockPos + COL_META_SIZE + startRep * targetRepSize);  // move to startRep
-  }
+  unsigned long long readPos = blockPos + COL_META_SIZE + startRep * targetRepSize;  // position of startRep
 
   unsigned int startRowRep = startRep * repSizeElement;
   unsigned int startOffset = startRow - startRowRep;  // rep-block offset in number of elements
@@ -358,8 +769,9 @@ inline void fdsReadFixedCompStream_v2(istream &myfile, char* outVec, unsigned lo
     char repBuf[MAX_TARGET_REP_SIZE];  // rep unit buffer for target
     char buf[MAX_SOURCE_REP_SIZE];  // rep unit buffer for source
 
-    myfile.read(repBuf, targetRepSize);  // read single repetition block
-    decompressor.Decompress(compAlgo, buf, repSize, repBuf, targetRepSize);  // decompress repetition block
+    const char* repData = SourceData(myfile, repBuf, readPos, targetRepSize);  // single repetition block
+    decompressor.Decompress(compAlgo, buf, repSize, repData, targetRepSize);  // decompress repetition block
+    readPos += targetRepSize;
 
     if (startRep == endRep)  // finished
     {
@@ -393,9 +805,10 @@ inline void fdsReadFixedCompStream_v2(istream &myfile, char* outVec, unsigned lo
     // Decompress full blocks
     for (unsigned int block = 0; block < nrOfFullBlocks; ++block)
     {
-      myfile.read(repBuf, targetBlockSize);
-      decompressor.Decompress(compAlgo, &outP[activeBlockPos], blockSize, repBuf, targetBlockSize);
+      const char* repData = SourceData(myfile, repBuf, readPos, targetBlockSize);
+      decompressor.Decompress(compAlgo, &outP[activeBlockPos], blockSize, repData, targetBlockSize);
       activeBlockPos += blockSize;
+      readPos += targetBlockSize;
     }
   }
   else
@@ -405,10 +818,11 @@ inline void fdsReadFixedCompStream_v2(istream &myfile, char* outVec, unsigned lo
     // Decompress full blocks
     for (unsigned int block = 0; block < nrOfFullBlocks; ++block)
     {
-      myfile.read(repBuf, targetBlockSize);
-      decompressor.Decompress(compAlgo, alignBuf, blockSize, repBuf, targetBlockSize);
+      const char* repData = SourceData(myfile, repBuf, readPos, targetBlockSize);
+      decompressor.Decompress(compAlgo, alignBuf, blockSize, repData, targetBlockSize);
       memcpy(&outP[activeBlockPos], alignBuf, blockSize);  // move to unaligned output vector
       activeBlockPos += blockSize;
+      readPos += targetBlockSize;
     }
   }
 
@@ -417,19 +831,20 @@ inline void fdsReadFixedCompStream_v2(istream &myfile, char* outVec, unsigned lo
   // Read last block
   unsigned int lastBlockSize = remainReps * repSize;  // block size in bytes
   unsigned int lastTargetBlockSize = remainReps * targetRepSize;  // block size in bytes
-  myfile.read(repBuf, lastTargetBlockSize);
+  const char* lastData = SourceData(myfile, repBuf, readPos, lastTargetBlockSize);
 
   // Decompress all but last repetition block fully
   if (lastBlockSize != repSize)
   {
     if ((reinterpret_cast<uintptr_t>(outP) % 8) == 0)  // aligned pointer
     {
-      decompressor.Decompress(compAlgo, &outP[activeBlockPos], lastBlockSize - repSize, repBuf, lastTargetBlockSize - targetRepSize);
+      decompressor.Decompress(compAlgo, &outP[activeBlockPos], lastBlockSize - repSize, lastData,
+        lastTargetBlockSize - targetRepSize);
     }
     else
     {
       char alignBuf[PREF_BLOCK_SIZE];  // alignment buffer
-      decompressor.Decompress(compAlgo, alignBuf, lastBlockSize - repSize, repBuf, lastTargetBlockSize - targetRepSize);
+      decompressor.Decompress(compAlgo, alignBuf, lastBlockSize - repSize, lastData, lastTargetBlockSize - targetRepSize);
       memcpy(&outP[activeBlockPos], alignBuf, lastBlockSize - repSize);
     }
   }
@@ -438,36 +853,37 @@ inline void fdsReadFixedCompStream_v2(istream &myfile, char* outVec, unsigned lo
   char buf[MAX_SOURCE_REP_SIZE];  // single rep unit buffer
   unsigned int nrOfElemsLastRep = startRow + vecLength - endRep * repSizeElement;
 
-  decompressor.Decompress(compAlgo, buf, repSize, &repBuf[lastTargetBlockSize - targetRepSize], targetRepSize);  // decompress repetition block
+  decompressor.Decompress(compAlgo, buf, repSize, &lastData[lastTargetBlockSize - targetRepSize], targetRepSize);  // decompress repetition block
   memcpy(&outP[activeBlockPos + lastBlockSize - repSize], buf, elementSize * nrOfElemsLastRep);  // skip last elements if required
 }
 
 #define UNCOMPRESSED_BLOCKSIZE 262144  // reading in small block is more efficient (probably more efficient L3 caching)
 
+// Decompress (or copy) a batch of consecutive blocks into the output vector, batchData points to the stored blocks
 void ProcessBatch(char* outVec, char* blockIndex, unsigned long long blockSize, Decompressor decompressor, unsigned long long outOffset, bool isAlligned,
-  unsigned long long blockStart, unsigned long long blockEnd, unsigned long long*& bStart, unsigned long long*& bEnd, char* threadBuf)
+  unsigned long long blockStart, unsigned long long blockEnd, const char* batchData)
 {
 	unsigned long long totSize = 0;
 	for (unsigned long long blockCount = blockStart; blockCount < blockEnd; blockCount++)
 	{
 		// File offsets and algorithm
-		bStart = reinterpret_cast<unsigned long long*>(&blockIndex[8 * blockCount]);
-		bEnd = reinterpret_cast<unsigned long long*>(&blockIndex[8 + 8 * blockCount]);
+		unsigned long long* bStart = reinterpret_cast<unsigned long long*>(&blockIndex[8 * blockCount]);
+		unsigned long long* bEnd = reinterpret_cast<unsigned long long*>(&blockIndex[8 + 8 * blockCount]);
 		unsigned short threadAlgo = static_cast<unsigned short>(((*bStart) >> 48) & 0xffff);
 		unsigned long long curCompBlockSize = (*bEnd & BLOCK_POS_MASK) - (*bStart & BLOCK_POS_MASK);
 
 		if (threadAlgo == 0)  // uncompressed block
 		{
-			memcpy(&outVec[outOffset + (blockCount - 1) * blockSize], &threadBuf[totSize], blockSize);  // copy to misaligned pointer
+			memcpy(&outVec[outOffset + (blockCount - 1) * blockSize], &batchData[totSize], blockSize);  // copy to misaligned pointer
 		}
 		else if (isAlligned)  // compressed and output vector alligned
 		{
-			decompressor.Decompress(threadAlgo, &outVec[outOffset + (blockCount - 1) * blockSize], blockSize, &threadBuf[totSize], curCompBlockSize);
+			decompressor.Decompress(threadAlgo, &outVec[outOffset + (blockCount - 1) * blockSize], blockSize, &batchData[totSize], curCompBlockSize);
 		}
 		else  // misaligned output vector, memcpy to avoid inefficient decompression
 		{
 			char allignBuf[MAX_SIZE_COMPRESS_BLOCK];
-			decompressor.Decompress(threadAlgo, allignBuf, blockSize, &threadBuf[totSize], curCompBlockSize);
+			decompressor.Decompress(threadAlgo, allignBuf, blockSize, &batchData[totSize], curCompBlockSize);
 			memcpy(&outVec[outOffset + (blockCount - 1) * blockSize], allignBuf, blockSize);  // copy to misaligned pointer
 		}
 
@@ -475,18 +891,97 @@ void ProcessBatch(char* outVec, char* blockIndex, unsigned long long blockSize,
 	}
 }
 
-void fdsReadColumn_v2(istream &myfile, char* outVec, unsigned long long blockPos, unsigned long long startRow,
-  unsigned long long length, unsigned long long size, int elementSize, std::string &annotation, int maxbatchSize)
+// Decompress the batches of a source that is not memory based while the next batches are read by an asynchronous
+// reader. Batch reads are submitted in order, with up to queueDepth reads outstanding ahead of the batches that are
+// being decompressed. A slot buffer is reused for the next batch once its current batch is decompressed.
+void ProcessBatchesAsync(IFstSource &myfile, char* outVec, char* blockIndex, unsigned long long blockSize, Decompressor &decompressor,
+  unsigned long long outOffset, bool isAlligned, unsigned long long blockPos, unsigned long long maxBlock, int batchSize,
+  long long nrOfBatches, int nrOfThreads, int queueDepth)
 {
-  myfile.seekg(blockPos);
+  // slot size is determined by the largest batch (instead of worst case block sizes)
+  unsigned long long slotSize = 0;
+  for (long long blockJob = 0; blockJob < nrOfBatches; blockJob++)
+  {
+    unsigned long long blockStart = 1 + blockJob * batchSize;
+    unsigned long long blockEnd = min(blockStart + batchSize, maxBlock + 1);
+    unsigned long long* bStart = reinterpret_cast<unsigned long long*>(&blockIndex[8 * blockStart]);
+    unsigned long long* bEnd = reinterpret_cast<unsigned long long*>(&blockIndex[8 * blockEnd]);
+    slotSize = max(slotSize, (*bEnd & BLOCK_POS_MASK) - (*bStart & BLOCK_POS_MASK));
+  }
+
+  slotSize = (slotSize + 15) & ~15ULL;  // 16-byte allignment of each slot
+
+  // a slot for each decompression thread and each outstanding read
+  int nrOfSlots = static_cast<int>(min((long long) (queueDepth + nrOfThreads), nrOfBatches));
+  char* slotBuffer = new char[nrOfSlots * slotSize];
+
+  FstAsyncReader asyncReader(myfile, nrOfSlots, min(queueDepth, nrOfSlots));
+
+  // batch reads are submitted in order, the read of a batch is awaited by the thread that decompresses it
+  auto submitBatch = [&](long long blockJob)
+  {
+    unsigned long long blockStart = 1 + blockJob * batchSize;
+    unsigned long long blockEnd = min(blockStart + batchSize, maxBlock + 1);
+    unsigned long long* bStart = reinterpret_cast<unsigned long long*>(&blockIndex[8 * blockStart]);
+    unsigned long long* bEnd = reinterpret_cast<unsigned long long*>(&blockIndex[8 * blockEnd]);
+    unsigned long long batchPos = *bStart & BLOCK_POS_MASK;
+    int slot = static_cast<int>(blockJob % nrOfSlots);
+
+    asyncReader.Submit(slot, blockJob, &slotBuffer[slot * slotSize], blockPos + batchPos, (*bEnd & BLOCK_POS_MASK) - batchPos);
+  };
+
+  for (long long blockJob = 0; blockJob < nrOfSlots; blockJob++)
+  {
+    submitBatch(blockJob);
+  }
+
+  bool readFailed = false;
+
+  // A batch only waits for reads that were submitted after the decompression of an earlier batch, so the dynamic
+  // schedule (which hands out the batches in order) can't deadlock
+#pragma omp parallel for num_threads(nrOfThreads) schedule(dynamic, 1)
+  for (long long blockJob = 0; blockJob < nrOfBatches; blockJob++)
+  {
+    unsigned long long blockStart = 1 + blockJob * batchSize;
+    unsigned long long blockEnd = min(blockStart + batchSize, maxBlock + 1);
+    int slot = static_cast<int>(blockJob % nrOfSlots);
+
+    // a failed read leaves the slot with (part of) the data of an earlier batch, so the batch is not decompressed
+    if (asyncReader.Wait(slot, blockJob))
+    {
+      ProcessBatch(outVec, blockIndex, blockSize, decompressor, outOffset, isAlligned, blockStart, blockEnd, &slotBuffer[slot * slotSize]);
+    }
+    else
+    {
+#pragma omp critical(fst_async_batches)
+      readFailed = true;
+    }
+
+    // later batches are still submitted, their reads are awaited by the other threads
+    if (blockJob + nrOfSlots < nrOfBatches)
+    {
+      submitBatch(blockJob + nrOfSlots);
+    }
+  }
+
+  delete[] slotBuffer;
+
+  if (readFailed)
+  {
+    throw(runtime_error(FSTERROR_DAMAGED_DATA));
+  }
+}
 
+void fdsReadColumn_v2(IFstSource &myfile, char* outVec, unsigned long long blockPos, unsigned long long startRow,
+  unsigned long long length, unsigned long long size, int elementSize, std::string &annotation, int maxbatchSize)
+{
   unsigned int annotationLength;
-  myfile.read((char*) &annotationLength, 4);
+  myfile.Read((char*) &annotationLength, blockPos, 4);
 
   if (annotationLength > 0)
   {
     char* annotationBuf = new char[annotationLength];
-    myfile.read(annotationBuf, annotationLength);
+    myfile.Read(annotationBuf, blockPos + 4, annotationLength);
 
     annotation += std::string(annotationBuf, annotationLength);
 
@@ -498,15 +993,15 @@ void fdsReadColumn_v2(istream &myfile, char* outVec, unsigned long long blockPos
 
 	// Read header
 	unsigned int compress[2];
-	myfile.read(reinterpret_cast<char*>(compress), COL_META_SIZE);
+	myfile.Read(reinterpret_cast<char*>(compress), blockPos, COL_META_SIZE);
 
 	// Data is uncompressed or uses a fixed-ratio compressor (logical)
 	if (compress[0] == 0)
 	{
 		if (compress[1] == 0)  // uncompressed data
 		{
-			// Jump to startRow position
-			if (startRow > 0) myfile.seekg(blockPos + elementSize * startRow + COL_META_SIZE);
+			// startRow position
+			unsigned long long readPos = blockPos + elementSize * startRow + COL_META_SIZE;
 
 			uint64_t totBytes = static_cast<uint64_t>(length) * elementSize;
 
@@ -517,13 +1012,35 @@ void fdsReadColumn_v2(istream &myfile, char* outVec, unsigned long long blockPos
 			uint64_t remainingBytes = totBytes - nrOfBlocks * UNCOMPRESSED_BLOCKSIZE;  // last block
 			uint64_t curBlockPos = 0;
 
+			// A source that is not memory based is read with multiple outstanding requests
+			int queueDepth = GetFstReadQueueDepth();
+
+			if (queueDepth > 0 && nrOfBlocks > 0 && myfile.Map(readPos, totBytes) == nullptr)
+			{
+				int nrOfReads = static_cast<int>(nrOfBlocks + 1);
+				FstAsyncReader asyncReader(myfile, nrOfReads, min(queueDepth, nrOfReads));
+
+				for (int readNr = 0; readNr < nrOfReads; ++readNr)
+				{
+					uint64_t readLength = readNr == nrOfReads - 1 ? remainingBytes : UNCOMPRESSED_BLOCKSIZE;
+					asyncReader.Submit(readNr, readNr, &outVec[readNr * UNCOMPRESSED_BLOCKSIZE], readPos + readNr * UNCOMPRESSED_BLOCKSIZE, readLength);
+				}
+
+				for (int readNr = 0; readNr < nrOfReads; ++readNr)
+				{
+					asyncReader.Wait(readNr, readNr);
+				}
+
+				return;
+			}
+
 			for (uint64_t block = 0; block != nrOfBlocks; ++block)
 			{
-				// Read data
-				myfile.read(&outVec[curBlockPos], UNCOMPRESSED_BLOCKSIZE);
+				// Read data, a memory based source copies directly into the output vector
+				myfile.Read(&outVec[curBlockPos], readPos + curBlockPos, UNCOMPRESSED_BLOCKSIZE);
 				curBlockPos += UNCOMPRESSED_BLOCKSIZE;
 			}
-			myfile.read(&outVec[curBlockPos], remainingBytes);
+			myfile.Read(&outVec[curBlockPos], readPos + curBlockPos, remainingBytes);
 
 			return;
 		}
@@ -548,14 +1065,9 @@ void fdsReadColumn_v2(istream &myfile, char* outVec, unsigned long long blockPos
   unsigned long long endBlock = (startRow + length - 1) / blockSizeElements;
 	int startOffset = startRow % blockSizeElements;
 
-	if (startBlock > 0)
-	{
-		myfile.seekg(blockPos + COL_META_SIZE + 8 * startBlock);  // move to startBlock meta info
-	}
-
-	// Read block index (position pointer and algorithm for each block)
+	// Read block index (position pointer and algorithm for each block) starting at the startBlock meta info
 	char* blockIndex = new char[(2 + endBlock - startBlock) * 8];  // 1 long file pointer using 2 highest bytes for algorithm
-	myfile.read(blockIndex, (2 + endBlock - startBlock) * 8);
+	myfile.Read(blockIndex, blockPos + COL_META_SIZE + 8 * startBlock, (2 + endBlock - startBlock) * 8);
 
 	int blockSize = elementSize * blockSizeElements;
 
@@ -581,8 +1093,8 @@ void fdsReadColumn_v2(istream &myfile, char* outVec, unsigned long long blockPos
 	{
 		if (algo == 0)  // no compression on this block
 		{
-			myfile.seekg(blockPos + blockPosStart + elementSize * startOffset);  // move to block data position
-			myfile.read(static_cast<char*>(outVec), static_cast<uint64_t>(length)* elementSize);
+			myfile.Read(static_cast<char*>(outVec), blockPos + blockPosStart + elementSize * startOffset,
+			  static_cast<uint64_t>(length)* elementSize);
 
 			delete[] blockIndex;
 
@@ -596,16 +1108,16 @@ void fdsReadColumn_v2(istream &myfile, char* outVec, unsigned long long blockPos
 			curSize = 1 + (size + blockSizeElements - 1) % blockSizeElements;  // smaller last block size
 		}
 
-		myfile.seekg(blockPos + blockPosStart);  // move to block data position, not always necessary!
-		myfile.read(compBuf, compSize);
+		// compressed data is only copied to compBuf when the source is not memory based
+		const char* compData = SourceData(myfile, compBuf, blockPos + blockPosStart, compSize);
 
 		if (length == curSize)
 		{
-			decompressor.Decompress(algo, outVec, elementSize * length, compBuf, compSize);  // direct decompress
+			decompressor.Decompress(algo, outVec, elementSize * length, compData, compSize);  // direct decompress
 		}
 		else
 		{
-			decompressor.Decompress(algo, tmpBuf, elementSize * curSize, compBuf, compSize);  // decompress in tmp buffer
+			decompressor.Decompress(algo, tmpBuf, elementSize * curSize, compData, compSize);  // decompress in tmp buffer
 			memcpy(outVec, &tmpBuf[elementSize * startOffset], elementSize * length);  // data range
 		}
 
@@ -621,21 +1133,19 @@ void fdsReadColumn_v2(istream &myfile, char* outVec, unsigned long long blockPos
 
 	if (algo == 0)  // no compression
 	{
-		myfile.seekg(blockPos + blockPosStart + elementSize * startOffset);  // move to block data position
-		myfile.read(outVec, elementSize * subBlockSize);  // read first block data
+		myfile.Read(outVec, blockPos + blockPosStart + elementSize * startOffset, elementSize * subBlockSize);  // first block data
 	}
 	else
 	{
-		myfile.seekg(blockPos + blockPosStart);  // move to block data position
-		myfile.read(compBuf, compSize);
+		const char* compData = SourceData(myfile, compBuf, blockPos + blockPosStart, compSize);
 
 		if (startOffset == 0)  // full block
 		{
-			decompressor.Decompress(algo, outVec, blockSize, compBuf, compSize);
+			decompressor.Decompress(algo, outVec, blockSize, compData, compSize);
 		}
 		else
 		{
-			decompressor.Decompress(algo, tmpBuf, blockSize, compBuf, compSize);
+			decompressor.Decompress(algo, tmpBuf, blockSize, compData, compSize);
 			memcpy(outVec, &tmpBuf[elementSize * startOffset], elementSize * subBlockSize);
 		}
 	}
@@ -656,57 +1166,67 @@ void fdsReadColumn_v2(istream &myfile, char* outVec, unsigned long long blockPos
 	int nrOfThreads = max(1ULL, min((unsigned long long) GetFstThreads(), maxBlock));
 	int batchSize = min((unsigned long long) maxbatchSize, maxBlock / nrOfThreads);  // keep thread buffer small
 	batchSize = max(1, batchSize);
-	char* threadBuffer = new char[nrOfThreads * MAX_COMPRESSBOUND * batchSize];
   long long nrOfBatches = (maxBlock + batchSize - 1) / batchSize;  // number of batches (last one may be smaller)
-  long long blockCount = 0;
 
   //////////////////////////////////////////////////////////
   // Parallel logic starts here
   //////////////////////////////////////////////////////////
 
-#pragma omp parallel num_threads(nrOfThreads) shared(isAlligned,nrOfBatches,batchSize,blockCount)
+  // A source that is not memory based is read ahead of the decompression, so that I/O and decompression overlap. The
+  // asynchronous reads use smaller batches, so that the (short) row range of a single read task is pipelined as well
+  int queueDepth = GetFstReadQueueDepth();
+  int asyncBatchSize = min(batchSize, READ_QUEUE_BATCH_SIZE);
+  long long nrOfAsyncBatches = (maxBlock + asyncBatchSize - 1) / asyncBatchSize;
+  unsigned long long middlePos = *reinterpret_cast<unsigned long long*>(&blockIndex[8]) & BLOCK_POS_MASK;
+  unsigned long long middleEnd = *reinterpret_cast<unsigned long long*>(&blockIndex[8 * (maxBlock + 1)]) & BLOCK_POS_MASK;
+
+  if (queueDepth > 0 && nrOfAsyncBatches > 1 && myfile.Map(blockPos + middlePos, middleEnd - middlePos) == nullptr)
   {
-#pragma omp for schedule(static, 1)
-    for (long long blockJob = 0; blockJob < nrOfBatches; blockJob++)  // a blockJob is a single unit of work
+    try
     {
-      int threadNr = OMP_GET_THREAD_NUM;  // use memory buffer specific for this thread
-
-      unsigned long long blockStart;
-      unsigned long long blockEnd;
-      unsigned long long  *bStart, *bEnd;
-      char* threadBuf;
-      int curBatchSize = batchSize;
+      ProcessBatchesAsync(myfile, outVec, blockIndex, blockSize, decompressor, outOffset, isAlligned, blockPos, maxBlock,
+        asyncBatchSize, nrOfAsyncBatches, nrOfThreads, queueDepth);
+    }
+    catch (const std::exception &)
+    {
+      delete[] blockIndex;
+      throw;
+    }
+  }
+  else
+  {
+    char* threadBuffer = new char[nrOfThreads * MAX_COMPRESSBOUND * batchSize];
 
-#pragma omp critical
+#pragma omp parallel num_threads(nrOfThreads) shared(isAlligned,nrOfBatches,batchSize)
+    {
+#pragma omp for schedule(static, 1)
+      for (long long blockJob = 0; blockJob < nrOfBatches; blockJob++)  // a blockJob is a single unit of work
       {
-        blockStart = 1 + blockCount * batchSize;
-        bStart = reinterpret_cast<unsigned long long*>(&blockIndex[8 * blockStart]);
+        int threadNr = OMP_GET_THREAD_NUM;  // use memory buffer specific for this thread
 
         // last batch might have a smaller size
-        if (blockCount == (nrOfBatches - 1))
-        {
-          curBatchSize = batchSize - (nrOfBatches * batchSize % maxBlock);
-        }
+        unsigned long long blockStart = 1 + blockJob * batchSize;
+        unsigned long long blockEnd = min(blockStart + batchSize, maxBlock + 1);
 
-        blockEnd = blockStart + curBatchSize;
+        // determine position and total length of compressed blocks in batch
+        unsigned long long* bStart = reinterpret_cast<unsigned long long*>(&blockIndex[8 * blockStart]);
+        unsigned long long* bEnd = reinterpret_cast<unsigned long long*>(&blockIndex[8 * blockEnd]);
+        unsigned long long batchPos = *bStart & BLOCK_POS_MASK;
+        unsigned long long curCompSize = (*bEnd & BLOCK_POS_MASK) - batchPos;
 
-        // determine total length of compressed blocks in batch
-        blockCount++;
-        bEnd = reinterpret_cast<unsigned long long*>(&blockIndex[8 * blockEnd]);
-        unsigned long long curCompSize = (*bEnd & BLOCK_POS_MASK) - (*bStart & BLOCK_POS_MASK);
+        // Positional reads don't depend on the order of the batches. A memory based source is decompressed directly,
+        // other sources are cached in threadBuf first (non zero copy for uncompressed blocks)
+        char* threadBuf = &threadBuffer[threadNr * MAX_COMPRESSBOUND * batchSize];  // MAX_COMPRESSBOUND is adjusted to 16-byte allignment
+        const char* batchData = SourceData(myfile, threadBuf, blockPos + batchPos, curCompSize);
 
-        threadBuf = &threadBuffer[threadNr * MAX_COMPRESSBOUND * batchSize];  // MAX_COMPRESSBOUND is adjusted to 16-byte allignment
+        // Decompress all blocks into output vector
 
-        myfile.read(threadBuf, curCompSize);  // always cache in threadBuf first (non zero copy for uncompressed blocks)
+        ProcessBatch(outVec, blockIndex, blockSize, decompressor, outOffset, isAlligned, blockStart, blockEnd, batchData);
       }
-
-      // Decompress all blocks into output vector
-
-      ProcessBatch(outVec, blockIndex, blockSize, decompressor, outOffset, isAlligned, blockStart, blockEnd, bStart, bEnd, threadBuf);
     }
-  }
 
-  delete[] threadBuffer;
+    delete[] threadBuffer;
+  }
 
   //////////////////////////////////////////////////////////
   // Parallel logic ends here
@@ -739,10 +1259,10 @@ void fdsReadColumn_v2(istream &myfile, char* outVec, unsigned long long blockPos
 
   if (algo == 0)  // no compression
   {
-    myfile.read(&outVec[outOffset], elementSize * remain);  // read remaining elements from block
+    myfile.Read(&outVec[outOffset], blockPos + blockPosStart, elementSize * remain);  // read remaining elements from block
   } else
   {
-    myfile.read(compBuf, compSize);
+    const char* compData = SourceData(myfile, compBuf, blockPos + blockPosStart, compSize);
 
     if (endBlock == (nrOfBlocks - 1))  // test for last block
     {
@@ -753,17 +1273,17 @@ void fdsReadColumn_v2(istream &myfile, char* outVec, unsigned long long blockPos
     {
       if ((outOffset % 8) == 0)  // outVec pointer is 8-byte aligned
       {
-        decompressor.Decompress(algo, &outVec[outOffset], curSize * elementSize, compBuf, compSize);
+        decompressor.Decompress(algo, &outVec[outOffset], curSize * elementSize, compData, compSize);
       }
       else
       {
-        decompressor.Decompress(algo, tmpBuf, curSize * elementSize, compBuf, compSize);
+        decompressor.Decompress(algo, tmpBuf, curSize * elementSize, compData, compSize);
         memcpy(&outVec[outOffset], tmpBuf, curSize * elementSize);
       }
     }
     else
     {
-      decompressor.Decompress(algo, tmpBuf, curSize * elementSize, compBuf, compSize);  // define tmpBuf locally for speed ?
+      decompressor.Decompress(algo, tmpBuf, curSize * elementSize, compData, compSize);  // define tmpBuf locally for speed ?
       memcpy(static_cast<char*>(&outVec[outOffset]), tmpBuf, elementSize * remain);
     }
   }
@@ -771,3 +1291,212 @@ void fdsReadColumn_v2(istream &myfile, char* outVec, unsigned long long blockPos
   delete[] blockIndex;
 }
 
+
+
+bool fdsPlanColumn_v2(FstReadPlanner &planner, unsigned long long blockPos, unsigned long long startRow,
+  unsigned long long length, unsigned long long size, int elementSize)
+{
+  if (!planner.Require(blockPos, 4)) return false;
+
+  unsigned int annotationLength;
+  planner.Read((char*) &annotationLength, blockPos, 4);
+
+  // Annotation and header
+  if (!planner.Require(blockPos + 4, annotationLength + COL_META_SIZE)) return false;
+
+  blockPos += 4 + annotationLength;
+
+  unsigned int compress[2];
+  planner.Read(reinterpret_cast<char*>(compress), blockPos, COL_META_SIZE);
+
+  // Data is uncompressed or uses a fixed-ratio compressor (logical)
+  if (compress[0] == 0)
+  {
+    if (compress[1] == 0)  // uncompressed data
+    {
+      return planner.Require(blockPos + COL_META_SIZE + elementSize * startRow, elementSize * length);
+    }
+
+    // a damaged header is reported by the reader
+    if (compress[1] >= NR_OF_ALGORITHMS) return true;
+
+    unsigned int repSize = fixedRatioSourceRepSize[compress[1]];
+    unsigned int targetRepSize = fixedRatioTargetRepSize[compress[1]];
+    unsigned int repSizeElement = repSize / elementSize;
+
+    if (repSizeElement == 0) return true;
+
+    unsigned long long startRep = startRow / repSizeElement;
+    unsigned long long endRep = (startRow + length - 1) / repSizeElement;
+
+    return planner.Require(blockPos + COL_META_SIZE + startRep * targetRepSize, (1 + endRep - startRep) * targetRepSize);
+  }
+
+  // Data is compressed
+
+  unsigned int blockSizeElements = compress[1];  // number of elements per block
+
+  if (blockSizeElements == 0) return true;
+
+  unsigned long long startBlock = startRow / blockSizeElements;
+  unsigned long long endBlock = (startRow + length - 1) / blockSizeElements;
+
+  // Block index slice with the start of the first and the end of the last block
+  unsigned long long indexPos = blockPos + COL_META_SIZE + 8 * startBlock;
+
+  if (!planner.Require(indexPos, (2 + endBlock - startBlock) * 8)) return false;
+
+  unsigned long long blockPStart;
+  unsigned long long blockPEnd;
+  planner.Read(reinterpret_cast<char*>(&blockPStart), indexPos, 8);
+  planner.Read(reinterpret_cast<char*>(&blockPEnd), indexPos + 8 * (1 + endBlock - startBlock), 8);
+
+  unsigned long long blockPosStart = blockPStart & BLOCK_POS_MASK;
+  unsigned long long blockPosEnd = blockPEnd & BLOCK_POS_MASK;
+
+  if (blockPosEnd < blockPosStart) return true;
+
+  return planner.Require(blockPos + blockPosStart, blockPosEnd - blockPosStart);
+}
+
+
+// Position of the zone map that follows uncompressed or fixed-ratio compressed data, 0 if the data has no zone map
+inline unsigned long long DataZoneMapPos(IFstSource &myfile, unsigned long long dataPos, unsigned long long size,
+  int elementSize, unsigned int compAlgo, unsigned int &blockSizeElements)
+{
+  if (size == 0) return 0;
+
+  unsigned long long dataSize = size * elementSize;
+
+  // fixed-ratio compressed blocks are stored as consecutive reps
+  if (compAlgo != 0)
+  {
+    if (compAlgo >= NR_OF_ALGORITHMS || fixedRatioSourceRepSize[compAlgo] == 0) return 0;
+
+    unsigned long long repSize = fixedRatioSourceRepSize[compAlgo];
+    dataSize = ((dataSize + repSize - 1) / repSize) * fixedRatioTargetRepSize[compAlgo];
+  }
+
+  unsigned long long headerPos = dataPos + dataSize;
+  unsigned long long fileSize = myfile.Size();
+
+  // the data is followed by other data or by the end of the file
+  if (headerPos > fileSize || DATA_ZONE_MAP_HEADER_SIZE + ZONE_MAP_HEADER_SIZE > fileSize - headerPos) return 0;
+
+  char header[DATA_ZONE_MAP_HEADER_SIZE];
+  if (!myfile.Read(header, headerPos, DATA_ZONE_MAP_HEADER_SIZE)) return 0;
+
+  blockSizeElements = *reinterpret_cast<unsigned int*>(&header[8]);
+  if (blockSizeElements == 0) return 0;
+
+  unsigned long long nrOfBlocks = 1 + (size - 1) / blockSizeElements;
+  unsigned long long zoneMapSize = DATA_ZONE_MAP_HEADER_SIZE + ZONE_MAP_HEADER_SIZE + ZONE_MAP_ENTRY_SIZE * nrOfBlocks;
+
+  if (zoneMapSize > fileSize - headerPos) return 0;
+
+  // the hash tells a zone map apart from the bytes that follow data without a zone map
+  char* zoneMap = new char[zoneMapSize];
+  bool isValid = myfile.Read(zoneMap, headerPos, zoneMapSize);
+
+  isValid = isValid &&
+    *reinterpret_cast<unsigned long long*>(zoneMap) == XXH64(&zoneMap[8], zoneMapSize - 8, FST_HASH_SEED);
+
+  delete[] zoneMap;
+
+  return isValid ? headerPos + DATA_ZONE_MAP_HEADER_SIZE : 0;
+}
+
+
+bool fdsReadZoneMap_v2(IFstSource &myfile, unsigned long long blockPos, unsigned long long size, unsigned long long rowOffset,
+  int elementSize, vector<ZoneMapBlock> &blocks)
+{
+  unsigned int annotationLength;
+  bool isValid = myfile.Read((char*) &annotationLength, blockPos, 4);
+
+  blockPos += 4 + annotationLength;
+
+  // Read header
+  unsigned int compress[2];
+  isValid = isValid && myfile.Read(reinterpret_cast<char*>(compress), blockPos, COL_META_SIZE);
+
+  // Uncompressed and fixed-ratio compressed data has no block index, a zone map directly follows the data
+  unsigned long long zoneMapPos = 0;
+  unsigned int blockSizeElements = compress[1];  // number of elements per block
+  unsigned long long nrOfBlocks = 0;
+
+  if (isValid && compress[0] == 0)
+  {
+    zoneMapPos = DataZoneMapPos(myfile, blockPos + COL_META_SIZE, size, elementSize, compress[1], blockSizeElements);
+    nrOfBlocks = zoneMapPos == 0 ? 0 : 1 + (size - 1) / blockSizeElements;
+  }
+  else if (isValid)
+  {
+    // a damaged header can't be used to locate the zone map
+    if (blockSizeElements == 0) throw(runtime_error(FSTERROR_DAMAGED_ZONEMAP));
+
+    nrOfBlocks = 1 + (size - 1) / blockSizeElements;
+
+    // Last block position holds the zone map flag
+    unsigned long long lastBlockPos;
+    isValid = myfile.Read(reinterpret_cast<char*>(&lastBlockPos), blockPos + COL_META_SIZE + 8 * nrOfBlocks, 8);
+
+    if (isValid && (lastBlockPos & BLOCK_ZONE_MAP_FLAG) != 0)
+    {
+      zoneMapPos = blockPos + (lastBlockPos & BLOCK_POS_MASK);
+    }
+  }
+
+  if (zoneMapPos == 0)
+  {
+    ZoneMapBlock block;
+    block.startRow = rowOffset;
+    block.nrOfRows = size;
+    block.naCount = 0;
+    block.hasStatistics = false;
+    block.minValue.intValue = 0;
+    block.maxValue.intValue = 0;
+
+    blocks.push_back(block);
+
+    return false;
+  }
+
+  unsigned long long zoneMapSize = ZONE_MAP_HEADER_SIZE + ZONE_MAP_ENTRY_SIZE * nrOfBlocks;
+
+  if (zoneMapPos > myfile.Size() || zoneMapSize > myfile.Size() - zoneMapPos)
+  {
+    throw(runtime_error(FSTERROR_DAMAGED_ZONEMAP));
+  }
+
+  char* zoneMap = new char[zoneMapSize];
+
+  isValid = myfile.Read(zoneMap, zoneMapPos, zoneMapSize);
+
+  unsigned int* p_nrOfBlocks = reinterpret_cast<unsigned int*>(&zoneMap[4]);
+
+  if (!isValid || *p_nrOfBlocks != nrOfBlocks)
+  {
+    delete[] zoneMap;
+    throw(runtime_error(FSTERROR_DAMAGED_ZONEMAP));
+  }
+
+  for (unsigned long long blockNr = 0; blockNr < nrOfBlocks; ++blockNr)
+  {
+    char* zoneMapEntry = &zoneMap[ZONE_MAP_HEADER_SIZE + ZONE_MAP_ENTRY_SIZE * blockNr];
+
+    ZoneMapBlock block;
+    block.startRow = rowOffset + blockNr * blockSizeElements;
+    block.nrOfRows = min(static_cast<unsigned long long>(blockSizeElements), size - blockNr * blockSizeElements);
+    block.hasStatistics = true;
+
+    memcpy(&block.minValue, zoneMapEntry, 8);
+    memcpy(&block.maxValue, &zoneMapEntry[8], 8);
+    memcpy(&block.naCount, &zoneMapEntry[16], 8);
+
+    blocks.push_back(block);
+  }
+
+  delete[] zoneMap;
+
+  return true;
+}
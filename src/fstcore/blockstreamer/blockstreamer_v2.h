@@ -37,21 +37,45 @@
 #define BLOCKSTORE_H
 
 #include <fstream>
+#include <vector>
 
 #include <compression/compressor.h>
+#include <interface/ifstcolumn.h>
+#include <interface/fstzonemap.h>
+#include <interface/ifstsource.h>
+#include <interface/ifstsink.h>
+#include <interface/fstreadplanner.h>
 
-// Method for writing column data of any type to a ofstream.
-void fdsStreamUncompressed_v2(std::ofstream &myfile, char* vec, unsigned long long vecLength, int elementSize, int blockSizeElems,
-  FixedRatioCompressor* fixedRatioCompressor, std::string annotation);
+// Method for writing column data of any type to a stream.
+// For zoneMapType INT_32, DOUBLE_64 or INT_64, per-block statistics are stored in a zone map after the data.
+void fdsStreamUncompressed_v2(IFstSink &myfile, char* vec, unsigned long long vecLength, int elementSize, int blockSizeElems,
+  FixedRatioCompressor* fixedRatioCompressor, std::string annotation, FstColumnType zoneMapType);
 
 
 // Method for writing column data of any type to a stream.
-void fdsStreamcompressed_v2(std::ofstream &myfile, char* colVec, unsigned long long nrOfRows, int elementSize,
-  StreamCompressor* streamCompressor, int blockSizeElems, std::string annotation);
+// For zoneMapType INT_32, DOUBLE_64 or INT_64, per-block statistics are stored in a zone map after the last block.
+void fdsStreamcompressed_v2(IFstSink &myfile, char* colVec, unsigned long long nrOfRows, int elementSize,
+  StreamCompressor* streamCompressor, int blockSizeElems, std::string annotation, FstColumnType zoneMapType);
 
 
-void fdsReadColumn_v2(std::istream &myfile, char* outVec, unsigned long long blockPos, unsigned long long startRow, unsigned long long length,
+// Method for reading (a range of rows of) a column from a source. The data blocks are read with positional reads, so
+// batches of blocks can be fetched and decompressed in parallel. Memory based sources are decompressed without a copy.
+void fdsReadColumn_v2(IFstSource &myfile, char* outVec, unsigned long long blockPos, unsigned long long startRow, unsigned long long length,
   unsigned long long size, int elementSize, std::string &annotation, int maxbatchSize);
 
 
+// Plan the byte ranges that fdsReadColumn_v2 reads for a range of rows: the header, the required slice of the block
+// index and the data blocks. Returns false if ranges were requested that have to be fetched before the column can be
+// planned further (see FstReadPlanner).
+bool fdsPlanColumn_v2(FstReadPlanner &planner, unsigned long long blockPos, unsigned long long startRow,
+  unsigned long long length, unsigned long long size, int elementSize);
+
+
+// Read the zone map of a column without reading the data blocks. The block statistics are appended to 'blocks' using
+// 'rowOffset' as the row number of the first element. Returns false if the column was stored without a zone map, in
+// which case a single block without statistics is appended.
+bool fdsReadZoneMap_v2(IFstSource &myfile, unsigned long long blockPos, unsigned long long size, unsigned long long rowOffset,
+  int elementSize, std::vector<ZoneMapBlock> &blocks);
+
+
 #endif // BLOCKSTORE_H
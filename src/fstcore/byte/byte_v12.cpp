@@ -41,13 +41,13 @@
 using namespace std;
 
 
-void fdsWriteByteVec_v12(ofstream &myfile, char* byteVector, unsigned long long nrOfRows, unsigned int compression, std::string annotation)
+void fdsWriteByteVec_v12(IFstSink &myfile, char* byteVector, unsigned long long nrOfRows, unsigned int compression, std::string annotation)
 {
   int blockSize = BLOCKSIZE_BYTE;  // block size in bytes
 
   if (compression == 0)
   {
-    return fdsStreamUncompressed_v2(myfile, byteVector, nrOfRows, 1, BLOCKSIZE_BYTE, nullptr, annotation);
+    return fdsStreamUncompressed_v2(myfile, byteVector, nrOfRows, 1, BLOCKSIZE_BYTE, nullptr, annotation, FstColumnType::UNKNOWN);
   }
 
   if (compression <= 50)  // low compression: linear mix of uncompressed and LZ4_SHUF
@@ -57,7 +57,16 @@ void fdsWriteByteVec_v12(ofstream &myfile, char* byteVector, unsigned long long
     StreamCompressor* streamCompressor = new StreamLinearCompressor(compress1, 2 * compression);
 
     streamCompressor->CompressBufferSize(blockSize);
-    fdsStreamcompressed_v2(myfile, byteVector, nrOfRows, 1, streamCompressor, BLOCKSIZE_BYTE, annotation);
+    try
+    {
+      fdsStreamcompressed_v2(myfile, byteVector, nrOfRows, 1, streamCompressor, BLOCKSIZE_BYTE, annotation, FstColumnType::UNKNOWN);
+    }
+    catch (...)
+    {
+      delete compress1;
+      delete streamCompressor;
+      throw;
+    }
 
     delete compress1;
     delete streamCompressor;
@@ -68,7 +77,17 @@ void fdsWriteByteVec_v12(ofstream &myfile, char* byteVector, unsigned long long
   Compressor* compress2 = new SingleCompressor(CompAlgo::ZSTD, 0);
   StreamCompressor* streamCompressor = new StreamCompositeCompressor(compress1, compress2, 2 * (compression - 50));
   streamCompressor->CompressBufferSize(blockSize);
-  fdsStreamcompressed_v2(myfile, byteVector, nrOfRows, 1, streamCompressor, BLOCKSIZE_BYTE, annotation);
+  try
+  {
+    fdsStreamcompressed_v2(myfile, byteVector, nrOfRows, 1, streamCompressor, BLOCKSIZE_BYTE, annotation, FstColumnType::UNKNOWN);
+  }
+  catch (...)
+  {
+    delete compress1;
+    delete compress2;
+    delete streamCompressor;
+    throw;
+  }
 
   delete compress1;
   delete compress2;
@@ -78,7 +97,7 @@ void fdsWriteByteVec_v12(ofstream &myfile, char* byteVector, unsigned long long
 }
 
 
-void fdsReadByteVec_v12(istream &myfile, char* byteVec, unsigned long long blockPos, unsigned long long startRow, unsigned long long length,
+void fdsReadByteVec_v12(IFstSource &myfile, char* byteVec, unsigned long long blockPos, unsigned long long startRow, unsigned long long length,
   unsigned long long size)
 {
   std::string annotation;
@@ -39,9 +39,12 @@
 
 #include <fstream>
 
-void fdsWriteByteVec_v12(std::ofstream &myfile, char* byteVector, unsigned long long nrOfRows, unsigned int compression, std::string annotation);
+#include <interface/ifstsource.h>
+#include <interface/ifstsink.h>
 
-void fdsReadByteVec_v12(std::istream &myfile, char* byteVector, unsigned long long blockPos, unsigned long long startRow,
+void fdsWriteByteVec_v12(IFstSink &myfile, char* byteVector, unsigned long long nrOfRows, unsigned int compression, std::string annotation);
+
+void fdsReadByteVec_v12(IFstSource &myfile, char* byteVector, unsigned long long blockPos, unsigned long long startRow,
   unsigned long long length, unsigned long long size);
 
 #endif // BYTE_V12_H
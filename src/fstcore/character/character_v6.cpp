@@ -35,9 +35,28 @@ You can contact the author at :
 #include "character/character_v6.h"
 #include "interface/istringwriter.h"
 #include "interface/fstdefines.h"
+#include "interface/openmphelper.h"
+#include "interface/fstmemorybuffer.h"
+#include "interface/fstfilter.h"
+#include "character/stringdictionary.h"
+#include "factor/factor_v7.h"
 #include <compression/compressor.h>
 
 #include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+// Use compile time thread counter for speed
+#ifdef _OPENMP
+  #include <omp.h>
+  #define OMP_GET_THREAD_NUM omp_get_thread_num()
+#else
+  #define OMP_GET_THREAD_NUM 0
+#endif
 
 
 // #include <boost/unordered_map.hpp>
@@ -45,26 +64,45 @@ You can contact the author at :
 using namespace std;
 
 
-inline unsigned int StoreCharBlock_v6(ofstream &myfile, IStringWriter* blockRunner, unsigned long long startCount, unsigned long long endCount)
+// Trained ZSTD dictionaries are disabled by default, files that use them can't be read by earlier versions
+static bool CharZstdDictionary = false;
+
+
+bool GetFstCharZstdDictionary()
+{
+  return CharZstdDictionary;
+}
+
+
+bool SetFstCharZstdDictionary(bool enable)
+{
+  bool previousEnable = CharZstdDictionary;
+  CharZstdDictionary = enable;
+
+  return previousEnable;
+}
+
+
+inline unsigned int StoreCharBlock_v6(IFstSink &myfile, IStringWriter* blockRunner, unsigned long long startCount, unsigned long long endCount)
 {
   blockRunner->SetBuffersFromVec(startCount, endCount);
 
   unsigned int nrOfElements = endCount - startCount;  // the string at position endCount is not included
   unsigned int nrOfNAInts = 1 + nrOfElements / 32;  // add 1 bit for NA present flag
 
-  myfile.write((char*)(blockRunner->strSizes), nrOfElements * 4);  // write string lengths
-  myfile.write((char*)(blockRunner->naInts), nrOfNAInts * 4);  // write string lengths
+  SinkAppend(myfile, (char*)(blockRunner->strSizes), nrOfElements * 4);  // write string lengths
+  SinkAppend(myfile, (char*)(blockRunner->naInts), nrOfNAInts * 4);  // write string lengths
 
   unsigned int totSize = blockRunner->bufSize;
 
-  myfile.write(blockRunner->activeBuf, totSize);
+  SinkAppend(myfile, blockRunner->activeBuf, totSize);
 
   return totSize + (nrOfElements + nrOfNAInts) * 4;
 
 }
 
 
-inline unsigned int storeCharBlockCompressed_v6(ofstream &myfile, IStringWriter* blockRunner, unsigned int startCount,
+inline unsigned int storeCharBlockCompressed_v6(IFstSink &myfile, IStringWriter* blockRunner, unsigned int startCount,
   unsigned int endCount, StreamCompressor* intCompressor, StreamCompressor* charCompressor, unsigned short int &algoInt,
   unsigned short int &algoChar, int &intBufSize, int blockNr)
 {
@@ -83,13 +121,13 @@ inline unsigned int storeCharBlockCompressed_v6(ofstream &myfile, IStringWriter*
 
   CompAlgo compAlgorithm;
   intBufSize = intCompressor->Compress((char*)(blockRunner->strSizes), strSizesBufLength, intBuf, compAlgorithm, blockNr);
-  myfile.write(intBuf, intBufSize);
+  SinkAppend(myfile, intBuf, intBufSize);
 
   //intCompressor->WriteBlock(myfile, (char*)(stringWriter->strSizes), intBuf);
   algoInt = (unsigned short int) (compAlgorithm);  // store selected algorithm
 
   // Write NA bits uncompressed (add compression later ?)
-  myfile.write((char*)(blockRunner->naInts), nrOfNAInts * 4);  // write string lengths
+  SinkAppend(myfile, (char*)(blockRunner->naInts), nrOfNAInts * 4);  // write string lengths
 
   unsigned int totSize = blockRunner->bufSize;
 
@@ -99,7 +137,7 @@ inline unsigned int storeCharBlockCompressed_v6(ofstream &myfile, IStringWriter*
 
   // Compress buffer
   int resSize = charCompressor->Compress(blockRunner->activeBuf, totSize, compBuf, compAlgorithm, blockNr);
-  myfile.write(compBuf, resSize);
+  SinkAppend(myfile, compBuf, resSize);
   //charCompressor->WriteBlock(myfile, stringWriter->activeBuf, compBuf);
 
   algoChar = (unsigned short int) (compAlgorithm);  // store selected algorithm
@@ -111,74 +149,35 @@ inline unsigned int storeCharBlockCompressed_v6(ofstream &myfile, IStringWriter*
 }
 
 
-void fdsWriteCharVec_v6(ofstream &myfile, IStringWriter* stringWriter, int compression, StringEncoding stringEncoding)
+// Compressors for the string lengths and the character data of the blocks of a character vector. A trained ZSTD
+// dictionary replaces the ZSTD compressor of the character data, so it's used for the same blocks.
+class CharBlockCompressors
 {
-  unsigned long long vecLength = stringWriter->vecLength;  // expected to be larger than zero
-
-  unsigned long long curPos = myfile.tellp();
-  unsigned long long nrOfBlocks = (vecLength - 1) / BLOCKSIZE_CHAR;  // number of blocks minus 1
-
-  if (compression == 0)
-  {
-    unsigned int metaSize = CHAR_HEADER_SIZE + (nrOfBlocks + 1) * 8;
-    char *meta = new char[metaSize];  // first CHAR_HEADER_SIZE bytes store compression setting and block size
-
-    // Set column header
-    unsigned int* isCompressed  = reinterpret_cast<unsigned int*>(meta);
-    unsigned int* blockSizeChar = reinterpret_cast<unsigned int*>(&meta[4]);
-    *blockSizeChar = BLOCKSIZE_CHAR;  // check why 2047 and not 2048
-  	*isCompressed = stringEncoding << 1;
-
-    myfile.write(meta, metaSize);  // write block offset index
-
-    unsigned long long* blockPos = reinterpret_cast<unsigned long long*>(&meta[CHAR_HEADER_SIZE]);
-    unsigned long long fullSize = metaSize;
-
-    for (unsigned long long block = 0; block < nrOfBlocks; ++block)
-    {
-      unsigned int totSize = StoreCharBlock_v6(myfile, stringWriter, block * BLOCKSIZE_CHAR, (block + 1) * BLOCKSIZE_CHAR);
-      fullSize += totSize;
-      blockPos[block] = fullSize;
-    }
-
-    unsigned int totSize = StoreCharBlock_v6(myfile, stringWriter, nrOfBlocks * BLOCKSIZE_CHAR, vecLength);
-    fullSize += totSize;
-    blockPos[nrOfBlocks] = fullSize;
-
-    myfile.seekp(curPos + CHAR_HEADER_SIZE);
-    myfile.write(reinterpret_cast<char*>(blockPos), (nrOfBlocks + 1) * 8);  // additional zero for index convenience
-    myfile.seekp(curPos + fullSize);  // back to end of file
-
-    delete[] meta;
-
-    return;
-  }
-
-
-  // Use compression
+  Compressor* compressInt;
+  Compressor* compressInt2;
+  Compressor* compressChar;
+  Compressor* compressChar2;
 
-  unsigned int metaSize = CHAR_HEADER_SIZE + (nrOfBlocks + 1) * CHAR_INDEX_SIZE;  // 1 long and 2 unsigned int per block
-  char *meta = new char[metaSize];
+public:
+  StreamCompressor* streamCompressInt;
+  StreamCompressor* streamCompressChar;
 
-  // Set column header
-  unsigned int* isCompressed  = (unsigned int*) meta;
-  unsigned int* blockSizeChar = (unsigned int*) &meta[4];
-  *blockSizeChar = BLOCKSIZE_CHAR;
-  *isCompressed = (stringEncoding << 1) | 1;  // set compression flag
+  CharBlockCompressors(int compression, ZstdDictionary* zstdDictionary);
 
-  myfile.write(meta, metaSize);  // write block offset and algorithm index
+  ~CharBlockCompressors();
+};
 
-  char* blockP = &meta[CHAR_HEADER_SIZE];
 
-  unsigned long long fullSize = metaSize;
+CharBlockCompressors::CharBlockCompressors(int compression, ZstdDictionary* zstdDictionary)
+{
+  this->compressInt        = nullptr;
+  this->compressInt2       = nullptr;
+  this->compressChar       = nullptr;
+  this->compressChar2      = nullptr;
+  this->streamCompressInt  = nullptr;
+  this->streamCompressChar = nullptr;
 
-  // Compressors
-  Compressor* compressInt;
-  Compressor* compressInt2 = nullptr;
-  StreamCompressor* streamCompressInt = nullptr;
-  Compressor* compressChar = nullptr;
-  Compressor* compressChar2 = nullptr;
-  StreamCompressor* streamCompressChar;
+  if (compression == 0) return;  // no compressors required
 
   // Compression settings
   if (compression <= 50)
@@ -199,323 +198,907 @@ void fdsWriteCharVec_v6(ofstream &myfile, IStringWriter* stringWriter, int compr
 
     // Character vector compressor
     compressChar = new SingleCompressor(CompAlgo::LZ4, 20);
-    compressChar2 = new SingleCompressor(CompAlgo::ZSTD, 20);
+    if (zstdDictionary != nullptr)
+    {
+      compressChar2 = new ZstdDictCompressor(zstdDictionary);
+    }
+    else
+    {
+      compressChar2 = new SingleCompressor(CompAlgo::ZSTD, 20);
+    }
+
     streamCompressChar = new StreamCompositeCompressor(compressChar, compressChar2, 2 * (compression - 50));
   }
+}
+
+
+CharBlockCompressors::~CharBlockCompressors()
+{
+  delete streamCompressInt;
+  delete streamCompressChar;
+  delete compressInt;
+  delete compressInt2;
+  delete compressChar;
+  delete compressChar2;
+}
 
-  for (unsigned long long block = 0; block < nrOfBlocks; ++block)
+
+/**
+ * \brief Determine the level code of each string in a vector
+ * \param stringWriter vector to encode
+ * \param dictionary dictionary with the distinct strings (output)
+ * \param levelCodes level code for each string, NA strings have code FST_NA_INT (output)
+ * \return false if the vector has too many distinct values for a dictionary encoding
+ */
+bool BuildDictionary_v6(IStringWriter* stringWriter, StringDictionary &dictionary, vector<int> &levelCodes)
+{
+  unsigned long long vecLength = stringWriter->vecLength;
+
+  levelCodes.reserve(min(vecLength, static_cast<unsigned long long>(DICTIONARY_SAMPLE_ROWS)));
+
+  for (unsigned long long startCount = 0; startCount < vecLength; startCount += BLOCKSIZE_CHAR)
   {
-    unsigned long long* blockPos = (unsigned long long*) blockP;
-    unsigned short int* algoInt  = (unsigned short int*) (blockP + 8);
-    unsigned short int* algoChar = (unsigned short int*) (blockP + 10);
-    int* intBufSize = (int*) (blockP + 12);
+    unsigned long long endCount = min(startCount + BLOCKSIZE_CHAR, vecLength);
+    stringWriter->SetBuffersFromVec(startCount, endCount);
+
+    const unsigned int* strSizes = stringWriter->strSizes;
+    const unsigned int* naInts = stringWriter->naInts;
+    const char* buf = stringWriter->activeBuf;
+    unsigned int pos = 0;
 
-    stringWriter->SetBuffersFromVec(block * BLOCKSIZE_CHAR, (block + 1) * BLOCKSIZE_CHAR);
-    unsigned long long totSize = storeCharBlockCompressed_v6(myfile, stringWriter, block * BLOCKSIZE_CHAR,
-      (block + 1) * BLOCKSIZE_CHAR, streamCompressInt, streamCompressChar, *algoInt, *algoChar, *intBufSize, block);
+    for (unsigned int blockElem = 0; blockElem < endCount - startCount; ++blockElem)
+    {
+      unsigned int newPos = strSizes[blockElem];
+
+      if (((naInts[blockElem / 32] >> (blockElem % 32)) & 1) != 0)
+      {
+        levelCodes.push_back(FST_NA_INT);
+      }
+      else
+      {
+        levelCodes.push_back(dictionary.Add(buf + pos, newPos - pos));
+      }
 
-    fullSize += totSize;
-    *blockPos = fullSize;
-    blockP += CHAR_INDEX_SIZE;  // advance one block index entry
+      pos = newPos;
+    }
+
+    // Test the number of distinct values after the sample and keep testing while the vector is encoded
+    if (endCount < DICTIONARY_SAMPLE_ROWS) continue;
+
+    if (dictionary.NrOfLevels() > DICTIONARY_MAX_LEVELS) return false;
+
+    if (static_cast<unsigned long long>(dictionary.NrOfLevels()) * DICTIONARY_MIN_RATIO > endCount) return false;
+
+    if (levelCodes.capacity() < vecLength) levelCodes.reserve(vecLength);
   }
 
-  unsigned long long* blockPos = (unsigned long long*) blockP;
-  unsigned short int* algoInt  = (unsigned short int*) (blockP + 8);
-  unsigned short int* algoChar = (unsigned short int*) (blockP + 10);
-  int* intBufSize = (int*) (blockP + 12);
+  return true;
+}
 
-  stringWriter->SetBuffersFromVec(nrOfBlocks * BLOCKSIZE_CHAR, vecLength);
-  unsigned long long totSize = storeCharBlockCompressed_v6(myfile, stringWriter, nrOfBlocks * BLOCKSIZE_CHAR,
-    vecLength, streamCompressInt, streamCompressChar, *algoInt, *algoChar, *intBufSize, nrOfBlocks);
 
-  fullSize += totSize;
-  *blockPos = fullSize;
+/**
+ * \brief Train a ZSTD dictionary from samples of the strings of blocks that are spread evenly over a vector
+ * \param stringWriter vector to sample
+ * \param dict buffer of at least ZSTD_DICT_SIZE bytes for the dictionary (output)
+ * \return size of the dictionary, 0 if the sample is too small or no dictionary could be trained
+ */
+unsigned int TrainZstdDictionary_v6(IStringWriter* stringWriter, char* dict)
+{
+  unsigned long long vecLength = stringWriter->vecLength;
+  unsigned long long nrOfBlocks = 1 + (vecLength - 1) / BLOCKSIZE_CHAR;
+  unsigned long long nrOfSampleBlocks = min(nrOfBlocks, static_cast<unsigned long long>(ZSTD_DICT_SAMPLE_BLOCKS));
+  unsigned int sampleLimit = static_cast<unsigned int>(ZSTD_DICT_MAX_SAMPLES_SIZE / nrOfSampleBlocks);  // per block
 
-  delete streamCompressInt;
-  delete streamCompressChar;
-  delete compressInt;
-  delete compressInt2;
-  delete compressChar;
-  delete compressChar2;
+  vector<char> samples;
+  vector<size_t> sampleSizes;
+
+  for (unsigned long long sampleBlock = 0; sampleBlock < nrOfSampleBlocks; ++sampleBlock)
+  {
+    unsigned long long startCount = ((sampleBlock * nrOfBlocks) / nrOfSampleBlocks) * BLOCKSIZE_CHAR;
+    unsigned long long endCount = min(startCount + BLOCKSIZE_CHAR, vecLength);
+    stringWriter->SetBuffersFromVec(startCount, endCount);
+
+    const unsigned int* strSizes = stringWriter->strSizes;
+    unsigned int nrOfElements = static_cast<unsigned int>(endCount - startCount);
+    unsigned int samplePos = 0;
 
-  myfile.seekp(curPos + CHAR_HEADER_SIZE);
-  myfile.write((char*)(&meta[CHAR_HEADER_SIZE]), (nrOfBlocks + 1) * CHAR_INDEX_SIZE);  // additional zero for index convenience
-  myfile.seekp(0, ios_base::end);
+    // each sample holds consecutive strings, so that short strings are not trained on their own
+    for (unsigned int blockElem = 0; blockElem < nrOfElements; ++blockElem)
+    {
+      unsigned int pos = strSizes[blockElem];
+
+      if (pos > sampleLimit) break;
+
+      if (pos - samplePos < ZSTD_DICT_SAMPLE_SIZE && blockElem + 1 < nrOfElements) continue;
+
+      if (pos > samplePos)
+      {
+        sampleSizes.push_back(pos - samplePos);
+        samplePos = pos;
+      }
+    }
+
+    samples.insert(samples.end(), stringWriter->activeBuf, stringWriter->activeBuf + samplePos);
+  }
+
+  if (samples.size() < ZSTD_DICT_MIN_SAMPLES_SIZE) return 0;
+
+  return ZstdDictionary::Train(dict, ZSTD_DICT_SIZE, samples.data(), sampleSizes.data(),
+    static_cast<unsigned int>(sampleSizes.size()));
+}
+
+
+/**
+ * \brief Test if a trained dictionary reduces the size of a vector compared to ZSTD without a dictionary
+ *
+ * Blocks that are spread evenly over the vector are compressed with and without the dictionary at the same level. The
+ * expected gain on the blocks that are compressed with ZSTD should exceed the stored size of the dictionary. The test
+ * blocks follow sampled blocks, so that the gain is not overestimated on data the dictionary was trained on.
+ * \param stringWriter vector to test
+ * \param zstdDictionary trained dictionary
+ * \param dictSize stored size of the dictionary
+ * \param compression compression setting in the range 51 - 100
+ * \return true if the dictionary reduces the size of the vector
+ */
+bool ZstdDictionaryPays_v6(IStringWriter* stringWriter, ZstdDictionary* zstdDictionary, unsigned int dictSize,
+  int compression)
+{
+  unsigned long long vecLength = stringWriter->vecLength;
+  unsigned long long nrOfBlocks = 1 + (vecLength - 1) / BLOCKSIZE_CHAR;
+  unsigned long long nrOfTestBlocks = min(nrOfBlocks, static_cast<unsigned long long>(ZSTD_DICT_TEST_BLOCKS));
+
+  SingleCompressor zstdCompressor(CompAlgo::ZSTD, ZSTD_DICT_LEVEL);
+  ZstdDictCompressor dictCompressor(zstdDictionary);
+  vector<char> compBuf;
+  long long gain = 0;
+
+  unsigned long long nrOfSampleBlocks = min(nrOfBlocks, static_cast<unsigned long long>(ZSTD_DICT_SAMPLE_BLOCKS));
+
+  for (unsigned long long testBlock = 0; testBlock < nrOfTestBlocks; ++testBlock)
+  {
+    // block following a sample block, see TrainZstdDictionary_v6
+    unsigned long long sampleBlock = ((2 * testBlock + 1) * nrOfSampleBlocks) / (2 * nrOfTestBlocks);
+    unsigned long long block = min((sampleBlock * nrOfBlocks) / nrOfSampleBlocks + 1, nrOfBlocks - 1);
+
+    unsigned long long startCount = block * BLOCKSIZE_CHAR;
+    unsigned long long endCount = min(startCount + BLOCKSIZE_CHAR, vecLength);
+    stringWriter->SetBuffersFromVec(startCount, endCount);
+
+    unsigned int totSize = stringWriter->bufSize;
+    compBuf.resize(max(zstdCompressor.CompressBufferSize(totSize), dictCompressor.CompressBufferSize(totSize)));
+
+    CompAlgo compAlgorithm;
+    gain += zstdCompressor.Compress(compBuf.data(), compBuf.size(), stringWriter->activeBuf, totSize, compAlgorithm);
+    gain -= dictCompressor.Compress(compBuf.data(), compBuf.size(), stringWriter->activeBuf, totSize, compAlgorithm);
+  }
+
+  // fraction of the blocks that is compressed with ZSTD, see CharBlockCompressors
+  double nrOfZstdBlocks = nrOfBlocks * (2 * (compression - 50)) / 100.0;
+
+  return gain * nrOfZstdBlocks / nrOfTestBlocks > dictSize;
+}
+
+
+unsigned int fdsWriteCharVec_v6(IFstSink &myfile, IStringWriter* stringWriter, int compression,
+  StringEncoding stringEncoding, bool allowDictionary)
+{
+  unsigned long long vecLength = stringWriter->vecLength;  // expected to be larger than zero
+
+  // Low-cardinality vectors are stored as a dictionary with level codes
+  if (allowDictionary && vecLength >= DICTIONARY_MIN_ROWS)
+  {
+    StringDictionary dictionary(stringEncoding);
+    vector<int> levelCodes;
+
+    if (BuildDictionary_v6(stringWriter, dictionary, levelCodes))
+    {
+      unsigned long long curPos = myfile.Size();
+
+      char meta[CHAR_DICTIONARY_HEADER_SIZE];
+      unsigned int* isCompressed  = reinterpret_cast<unsigned int*>(meta);
+      unsigned int* blockSizeChar = reinterpret_cast<unsigned int*>(&meta[4]);
+      unsigned long long* vecSize = reinterpret_cast<unsigned long long*>(&meta[8]);
+
+      *isCompressed = (stringEncoding << 1) | CHAR_DICTIONARY;
+      *blockSizeChar = BLOCKSIZE_CHAR;
+      *vecSize = 0;
+
+      if (compression > 0) *isCompressed |= 1;  // set compression flag
+
+      SinkAppend(myfile, meta, CHAR_DICTIONARY_HEADER_SIZE);
+
+      fdsWriteFactorVec_v7(myfile, levelCodes.data(), &dictionary, vecLength, compression, stringEncoding, "");
+
+      // Rewrite header with the size of the vector
+      *vecSize = myfile.Size() - curPos;
+
+      myfile.Write(meta, curPos, CHAR_DICTIONARY_HEADER_SIZE);
+
+      return FST_VERSION_CHAR_DICT;
+    }
+  }
+
+  unsigned long long curPos = myfile.Size();
+  unsigned long long nrOfBlocks = (vecLength - 1) / BLOCKSIZE_CHAR;  // number of blocks minus 1
+
+  // The character data of the blocks is compressed with a dictionary trained on a sample of the vector
+  char* zstdDict = nullptr;
+  unsigned int zstdDictSize = 0;
+  ZstdDictionary* zstdDictionary = nullptr;
+  unsigned long long indexStart = CHAR_HEADER_SIZE;  // position of the block index
+
+  // ZSTD is only used with a compression setting above 50, lower settings use LZ4 for all blocks
+  if (allowDictionary && compression > 50 && GetFstCharZstdDictionary() && vecLength >= ZSTD_DICT_MIN_ROWS)
+  {
+    zstdDict = new char[ZSTD_DICT_SIZE];
+    zstdDictSize = TrainZstdDictionary_v6(stringWriter, zstdDict);
+
+    if (zstdDictSize > 0)
+    {
+      zstdDictionary = new ZstdDictionary(zstdDict, zstdDictSize, ZSTD_DICT_LEVEL);
+
+      if (!zstdDictionary->IsValid() || !ZstdDictionaryPays_v6(stringWriter, zstdDictionary, zstdDictSize, compression))
+      {
+        delete zstdDictionary;
+        zstdDictionary = nullptr;
+        zstdDictSize = 0;
+      }
+    }
+
+    // dictionary is stored directly after the header, padded to 8 bytes
+    if (zstdDictSize > 0) indexStart += CHAR_ZSTD_DICT_HEADER_SIZE + 8 * ((zstdDictSize + 7) / 8);
+  }
+
+  // block index with the end position of each block, for compressed vectors also the algorithms and int buffer size
+  unsigned int indexEntrySize = compression == 0 ? 8 : CHAR_INDEX_SIZE;
+  unsigned long long metaSize = indexStart + (nrOfBlocks + 1) * indexEntrySize;
+  char *meta = new char[metaSize];  // first CHAR_HEADER_SIZE bytes store compression setting and block size
+
+  // Set column header
+  unsigned int* isCompressed  = reinterpret_cast<unsigned int*>(meta);
+  unsigned int* blockSizeChar = reinterpret_cast<unsigned int*>(&meta[4]);
+  *blockSizeChar = BLOCKSIZE_CHAR;  // check why 2047 and not 2048
+  *isCompressed = stringEncoding << 1;
+
+  if (compression > 0) *isCompressed |= 1;  // set compression flag
+
+  if (zstdDictSize > 0)
+  {
+    // Dictionary header with the size of the dictionary
+    unsigned int* dictHeader = reinterpret_cast<unsigned int*>(&meta[CHAR_HEADER_SIZE]);
+    dictHeader[0] = zstdDictSize;
+    dictHeader[1] = 0;
+
+    char* dictP = &meta[CHAR_HEADER_SIZE + CHAR_ZSTD_DICT_HEADER_SIZE];
+    memcpy(dictP, zstdDict, zstdDictSize);
+    memset(dictP + zstdDictSize, 0, indexStart - CHAR_HEADER_SIZE - CHAR_ZSTD_DICT_HEADER_SIZE - zstdDictSize);
+
+    *isCompressed |= CHAR_ZSTD_DICT;
+  }
+
+  delete[] zstdDict;
+
+  SinkAppend(myfile, meta, metaSize);  // write block offset (and algorithm) index
+
+  // Each thread gathers the strings of a block with its own writer, the first thread uses the main writer
+  int nrOfThreads = static_cast<int>(min(static_cast<unsigned long long>(GetFstThreads()), nrOfBlocks + 1));
+  vector<IStringWriter*> threadWriters(nrOfThreads, nullptr);
+  threadWriters[0] = stringWriter;
+
+  for (int threadNr = 1; threadNr < nrOfThreads; ++threadNr)
+  {
+    threadWriters[threadNr] = stringWriter->CreateThreadWriter();
+
+    // vector can't be accessed concurrently
+    if (threadWriters[threadNr] == nullptr)
+    {
+      nrOfThreads = threadNr;
+      break;
+    }
+  }
+
+  long long nrOfJobs = nrOfBlocks + 1;
+  unsigned long long fullSize = metaSize;
+
+  //////////////////////////////////////////////////////////
+  // Parallel logic starts here
+  //////////////////////////////////////////////////////////
+
+  // Blocks are gathered and compressed concurrently into a buffer per thread and written in order
+
+#pragma omp parallel num_threads(nrOfThreads)
+  {
+    IStringWriter* blockWriter = threadWriters[OMP_GET_THREAD_NUM];
+    FstMemoryBuffer blockBuffer(MAX_CHAR_STACK_SIZE);
+
+    // the stream compressors keep the buffer size of the current block, so each thread uses its own
+    CharBlockCompressors compressors(compression, zstdDictionary);
+
+#pragma omp for ordered schedule(static, 1)
+    for (long long block = 0; block < nrOfJobs; ++block)
+    {
+      unsigned long long startCount = block * BLOCKSIZE_CHAR;
+      unsigned long long endCount = min(startCount + BLOCKSIZE_CHAR, vecLength);
+      char* blockP = &meta[indexStart + block * indexEntrySize];
+
+      blockBuffer.Clear();
+
+      if (compression == 0)
+      {
+        StoreCharBlock_v6(blockBuffer, blockWriter, startCount, endCount);
+      }
+      else
+      {
+        unsigned short int* algoInt  = reinterpret_cast<unsigned short int*>(blockP + 8);
+        unsigned short int* algoChar = reinterpret_cast<unsigned short int*>(blockP + 10);
+        int* intBufSize = reinterpret_cast<int*>(blockP + 12);
+
+        blockWriter->SetBuffersFromVec(startCount, endCount);
+        storeCharBlockCompressed_v6(blockBuffer, blockWriter, startCount, endCount, compressors.streamCompressInt,
+          compressors.streamCompressChar, *algoInt, *algoChar, *intBufSize, block);
+      }
+
+#pragma omp ordered
+      {
+        SinkAppend(myfile, blockBuffer.Data(), blockBuffer.Size());
+
+        fullSize += blockBuffer.Size();
+        *reinterpret_cast<unsigned long long*>(blockP) = fullSize;
+      }
+    }
+  }
+
+  //////////////////////////////////////////////////////////
+  // Parallel logic ends here
+  //////////////////////////////////////////////////////////
+
+  for (int threadNr = 1; threadNr < nrOfThreads; ++threadNr)
+  {
+    delete threadWriters[threadNr];
+  }
+
+  delete zstdDictionary;
+
+  // additional zero for index convenience
+  myfile.Write(&meta[indexStart], curPos + indexStart, (nrOfBlocks + 1) * indexEntrySize);
 
   delete[] meta;
 
-  return;
+  return zstdDictSize > 0 ? FST_VERSION_CHAR_DICT : FST_VERSION_BASE;
 }
 
 
-inline void ReadDataBlock_v6(istream &myfile, IStringColumn* blockReader, unsigned long long blockSize, unsigned long long nrOfElements,
-  unsigned long long startElem, unsigned long long endElem, unsigned long long vecOffset)
+// Data of a single block of a character vector, ready to be converted to strings
+struct CharBlockStage
+{
+  const unsigned int* strSizes;  // cumulative string lengths followed by the NA bits
+  const char* charData;  // string data
+  unsigned int* sizeBuffer;  // owned buffer with the string lengths, nullptr if used directly from the source
+  char* charBuffer;  // owned buffer with the string data, nullptr if used directly from the source
+};
+
+
+inline void ReleaseStage_v6(CharBlockStage &stage)
+{
+  delete[] stage.sizeBuffer;
+  delete[] stage.charBuffer;
+
+  stage.sizeBuffer = nullptr;
+  stage.charBuffer = nullptr;
+}
+
+
+inline void StageDataBlock_v6(IFstSource &myfile, CharBlockStage &stage, unsigned long long dataPos,
+  unsigned long long blockSize, unsigned long long nrOfElements)
 {
   unsigned long long nrOfNAInts = 1 + nrOfElements / 32;  // last bit is NA flag
   unsigned long long totElements = nrOfElements + nrOfNAInts;
-  unsigned int *sizeMeta = new unsigned int[totElements];
-  myfile.read((char*) sizeMeta, totElements * 4);  // read cumulative string lengths and NA bits
-
   unsigned int charDataSize = blockSize - totElements * 4;
 
-  char* buf = new char[charDataSize];
-  myfile.read(buf, charDataSize);  // read string lengths
+  // A memory based source is used directly, the string lengths are only copied when they are not aligned
+  const char* blockData = myfile.Map(dataPos, blockSize);
+
+  if (blockData != nullptr)
+  {
+    stage.charData = &blockData[totElements * 4];
 
-  // Create IBlockReader
-  // IBlockReader* blockReader = new BlockReaderChar(strVec);
-  blockReader->BufferToVec(nrOfElements, startElem, endElem, vecOffset, sizeMeta, buf);
-  // delete blockReader;
+    if ((reinterpret_cast<uintptr_t>(blockData) % 4) == 0)
+    {
+      stage.strSizes = reinterpret_cast<const unsigned int*>(blockData);
+      return;
+    }
 
-  // ReadDataBlockInfo_v6(strVec, nrOfElements, startElem, endElem, vecOffset, sizeMeta, buf);
+    stage.sizeBuffer = new unsigned int[totElements];
+    memcpy(stage.sizeBuffer, blockData, totElements * 4);
+    stage.strSizes = stage.sizeBuffer;
 
-  delete[] sizeMeta;
-  delete[] buf;
+    return;
+  }
+
+  stage.sizeBuffer = new unsigned int[totElements];
+  stage.strSizes = stage.sizeBuffer;
+  myfile.Read((char*) stage.sizeBuffer, dataPos, totElements * 4);  // read cumulative string lengths and NA bits
+
+  stage.charBuffer = new char[charDataSize];
+  stage.charData = stage.charBuffer;
+  myfile.Read(stage.charBuffer, dataPos + totElements * 4, charDataSize);  // read string data
 }
 
 
-inline void ReadDataBlockCompressed_v6(istream &myfile, IStringColumn* blockReader, unsigned long long blockSize, unsigned long long nrOfElements,
-  unsigned long long startElem, unsigned long long endElem, unsigned long long vecOffset,
-  unsigned int intBlockSize, Decompressor &decompressor, unsigned short int &algoInt, unsigned short int &algoChar)
+// Blocks with algorithm ZSTD_DICT are decompressed with zstdDictionary, the trained dictionary of the vector
+inline void StageDataBlockCompressed_v6(IFstSource &myfile, CharBlockStage &stage, unsigned long long dataPos,
+  unsigned long long blockSize, unsigned long long nrOfElements, unsigned int intBlockSize, unsigned short int algoInt,
+  unsigned short int algoChar, ZstdDictionary* zstdDictionary)
 {
+  // Uncompressed blocks have the same layout as the blocks of an uncompressed vector
+  if (algoInt == 0 && algoChar == 0)
+  {
+    StageDataBlock_v6(myfile, stage, dataPos, blockSize, nrOfElements);
+    return;
+  }
+
   unsigned long long nrOfNAInts = 1 + nrOfElements / 32;  // NA metadata including overall NA bit
   unsigned long long totElements = nrOfElements + nrOfNAInts;
   unsigned int *sizeMeta = new unsigned int[totElements];
 
+  stage.sizeBuffer = sizeMeta;
+  stage.strSizes = sizeMeta;
+
   // Read and uncompress str sizes data
   if (algoInt == 0)  // uncompressed
   {
-    myfile.read((char*) sizeMeta, totElements * 4);  // read cumulative string lengths
+    myfile.Read((char*) sizeMeta, dataPos, totElements * 4);  // read cumulative string lengths
   }
   else
   {
-    unsigned int intBufSize = intBlockSize;
-    char *strSizeBuf = new char[intBufSize];
-    myfile.read(strSizeBuf, intBufSize);
-    myfile.read((char*) &sizeMeta[nrOfElements], nrOfNAInts * 4);  // read cumulative string lengths
+    myfile.Read((char*) &sizeMeta[nrOfElements], dataPos + intBlockSize, nrOfNAInts * 4);  // read cumulative string lengths
 
     // Decompress size but not NA metadata (which is currently uncompressed)
+    const char* strSizeData = myfile.Map(dataPos, intBlockSize);
 
-    decompressor.Decompress(algoInt, (char*) sizeMeta, nrOfElements * 4, strSizeBuf, intBlockSize);
-
-    delete[] strSizeBuf;
+    if (strSizeData != nullptr)  // decompress from memory based source
+    {
+      Decompressor::Decompress(algoInt, (char*) sizeMeta, nrOfElements * 4, strSizeData, intBlockSize);
+    }
+    else
+    {
+      char *strSizeBuf = new char[intBlockSize];
+      myfile.Read(strSizeBuf, dataPos, intBlockSize);
+      Decompressor::Decompress(algoInt, (char*) sizeMeta, nrOfElements * 4, strSizeBuf, intBlockSize);
+      delete[] strSizeBuf;
+    }
   }
 
   unsigned int charDataSizeUncompressed = sizeMeta[nrOfElements - 1];
 
-  // Read and uncompress string vector data, use stack if possible here !!!!!
+  // Read and uncompress string vector data
   unsigned int charDataSize = blockSize - intBlockSize - nrOfNAInts * 4;
+  unsigned long long charDataPos = dataPos + intBlockSize + nrOfNAInts * 4;
+  const char* charData = myfile.Map(charDataPos, charDataSize);
+
+  // Uncompressed string data is used directly from a memory based source
+  if (algoChar == 0 && charData != nullptr)
+  {
+    stage.charData = charData;
+    return;
+  }
+
   char* buf = new char[charDataSizeUncompressed];
+  stage.charBuffer = buf;
+  stage.charData = buf;
 
   if (algoChar == 0)
   {
-    myfile.read(buf, charDataSize);  // read string lengths
+    myfile.Read(buf, charDataPos, charDataSize);  // read string data
+  }
+  else if (algoChar == CompAlgo::ZSTD_DICT)
+  {
+    if (zstdDictionary == nullptr) throw(runtime_error(FSTERROR_DAMAGED_DATA));
+
+    char* bufCompressed = nullptr;
+
+    if (charData == nullptr)
+    {
+      bufCompressed = new char[charDataSize];
+      myfile.Read(bufCompressed, charDataPos, charDataSize);  // read compressed string data
+      charData = bufCompressed;
+    }
+
+    bool isValid = zstdDictionary->Decompress(buf, charDataSizeUncompressed, charData, charDataSize);
+    delete[] bufCompressed;
+
+    if (!isValid) throw(runtime_error(FSTERROR_DAMAGED_DATA));
+  }
+  else if (charData != nullptr)
+  {
+    Decompressor::Decompress(algoChar, buf, charDataSizeUncompressed, charData, charDataSize);
   }
   else
   {
     char* bufCompressed = new char[charDataSize];
-    myfile.read(bufCompressed, charDataSize);  // read string lengths
-    decompressor.Decompress(algoChar, buf, charDataSizeUncompressed, bufCompressed, charDataSize);
+    myfile.Read(bufCompressed, charDataPos, charDataSize);  // read compressed string data
+    Decompressor::Decompress(algoChar, buf, charDataSizeUncompressed, bufCompressed, charDataSize);
     delete[] bufCompressed;
   }
+}
+
+
+/**
+ * \brief Read the trained ZSTD dictionary that is stored directly after the header of a character vector
+ * \param myfile source with the vector
+ * \param blockPos position of the vector
+ * \param indexStart offset of the block index from blockPos, directly after the dictionary (output)
+ * \return dictionary for decompression, owned by the caller
+ */
+ZstdDictionary* ReadZstdDictionary_v6(IFstSource &myfile, unsigned long long blockPos, unsigned long long &indexStart)
+{
+  unsigned int dictHeader[2];
+  bool isValid = myfile.Read(reinterpret_cast<char*>(dictHeader), blockPos + CHAR_HEADER_SIZE,
+    CHAR_ZSTD_DICT_HEADER_SIZE);
+
+  unsigned int dictSize = dictHeader[0];
+  unsigned long long dictPos = blockPos + CHAR_HEADER_SIZE + CHAR_ZSTD_DICT_HEADER_SIZE;
+
+  if (!isValid || dictSize == 0 || dictPos + dictSize > myfile.Size())
+  {
+    throw(runtime_error(FSTERROR_DAMAGED_DATA));
+  }
 
-  blockReader->BufferToVec(nrOfElements, startElem, endElem, vecOffset, sizeMeta, buf);
+  // block index follows the dictionary, padded to 8 bytes
+  indexStart = CHAR_HEADER_SIZE + CHAR_ZSTD_DICT_HEADER_SIZE + 8 * ((dictSize + 7ULL) / 8);
 
-  delete[] buf;  // character vector buffer
-  delete[] sizeMeta;
+  ZstdDictionary* zstdDictionary;
+  const char* dict = myfile.Map(dictPos, dictSize);
+
+  if (dict != nullptr)  // memory based source
+  {
+    zstdDictionary = new ZstdDictionary(dict, dictSize, -1);
+  }
+  else
+  {
+    char* dictBuf = new char[dictSize];
+    myfile.Read(dictBuf, dictPos, dictSize);
+    zstdDictionary = new ZstdDictionary(dictBuf, dictSize, -1);
+    delete[] dictBuf;
+  }
+
+  if (!zstdDictionary->IsValid())
+  {
+    delete zstdDictionary;
+    throw(runtime_error(FSTERROR_DAMAGED_DATA));
+  }
+
+  return zstdDictionary;
 }
 
 
-void fdsReadCharVec_v6(istream &myfile, IStringColumn* blockReader, unsigned long long blockPos, unsigned long long startRow,
-  unsigned long long vecLength, unsigned long long size)
+unsigned long long ReadCharVecDictionary_v6(IFstSource &myfile, IStringColumn* blockReader, unsigned long long blockPos,
+  unsigned long long startRow, unsigned long long vecLength, unsigned long long size, unsigned long long vecOffset)
 {
-  // Jump to startRow size
-  myfile.seekg(blockPos);
+  unsigned long long vecSize;
+  myfile.Read(reinterpret_cast<char*>(&vecSize), blockPos + CHAR_HEADER_SIZE, 8);
 
-  // Read algorithm type and block size
-  unsigned int meta[2];
-  myfile.read((char*) meta, CHAR_HEADER_SIZE);
+  unsigned long long factorPos = blockPos + CHAR_DICTIONARY_HEADER_SIZE;
 
-  unsigned int compression = meta[0] & 1;  // maximum 8 encodings
-  StringEncoding stringEncoding = static_cast<StringEncoding>(meta[0] >> 1 & 7);  // at maximum 8 encodings
+  FilterStringColumn levels;
+  unsigned int nrOfLevels = fdsReadFactorLevels_v7(myfile, &levels, factorPos);
 
-  unsigned long long blockSizeChar = static_cast<unsigned long long>(meta[1]);
-  unsigned long long totNrOfBlocks = (size - 1) / blockSizeChar;  // total number of blocks minus 1
-  unsigned long long startBlock = startRow / blockSizeChar;
-  unsigned long long startOffset = startRow - (startBlock * blockSizeChar);
-  unsigned long long endBlock = (startRow + vecLength - 1)  / blockSizeChar;
-  unsigned long long endOffset = (startRow + vecLength - 1)  -  endBlock *blockSizeChar;
-  unsigned long long nrOfBlocks = 1 + endBlock - startBlock;  // total number of blocks to read
+  // Columns that support level codes create each level string only once
+  vector<const char*> levelStrings(nrOfLevels);
+  vector<unsigned int> levelSizes(nrOfLevels);
 
-  // Create result vector
-  blockReader->AllocateVec(vecLength);
-  blockReader->SetEncoding(stringEncoding);
+  for (unsigned int level = 0; level < nrOfLevels; ++level)
+  {
+    levelStrings[level] = levels.IsNA(level) ? nullptr : levels.Element(level).data();
+    levelSizes[level] = static_cast<unsigned int>(levels.Element(level).size());
+  }
 
-  // Vector data is uncompressed
-  if (compression == 0)
+  bool useLevelCodes = blockReader->SetLevels(nrOfLevels, levelStrings.data(), levelSizes.data());
+
+  // Otherwise the strings of each block are assembled from the level strings
+  unsigned long long batchSize = min(vecLength, static_cast<unsigned long long>(DICTIONARY_READ_BATCH));
+  int* levelCodes = new int[batchSize];
+  unsigned int* blockMeta = new unsigned int[BLOCKSIZE_CHAR + 1 + BLOCKSIZE_CHAR / 32];
+  vector<char> blockData;
+  blockData.reserve(MAX_CHAR_STACK_SIZE);
+
+  for (unsigned long long batchStart = 0; batchStart < vecLength; batchStart += batchSize)
   {
-    unsigned long long *blockOffset = new unsigned long long[1 + nrOfBlocks];  // block positions
+    unsigned long long batchLength = min(batchSize, vecLength - batchStart);
 
-    if (startBlock > 0)  // include previous block offset
+    try
     {
-      myfile.seekg(blockPos + CHAR_HEADER_SIZE + (startBlock - 1) * 8);  // jump to correct block index
-      myfile.read((char*) blockOffset, (1 + nrOfBlocks) * 8);
+      fdsReadFactorVec_v7(myfile, nullptr, levelCodes, factorPos, startRow + batchStart, batchLength, size);
     }
-    else
+    catch (const std::exception &)
     {
-      blockOffset[0] = CHAR_HEADER_SIZE + (totNrOfBlocks + 1) * 8;
-      myfile.read((char*) &blockOffset[1], nrOfBlocks * 8);
+      delete[] levelCodes;
+      delete[] blockMeta;
+      throw;
     }
 
-
-    // Navigate to first selected data block
-    unsigned long long offset = blockOffset[0];
-    myfile.seekg(blockPos + offset);
-
-    unsigned long long endElem = blockSizeChar - 1;
-    unsigned long long nrOfElements = blockSizeChar;
-
-    if (startBlock == endBlock)  // subset start and end of block
+    if (useLevelCodes)
     {
-      endElem = endOffset;
-      if (endBlock == totNrOfBlocks)
+      for (unsigned long long elem = 0; elem < batchLength; ++elem)
       {
-        nrOfElements = size - totNrOfBlocks * blockSizeChar;  // last block can have less elements
+        unsigned int levelCode = static_cast<unsigned int>(levelCodes[elem]);
+
+        if (levelCode != FST_NA_INT && (levelCode == 0 || levelCode > nrOfLevels))
+        {
+          delete[] levelCodes;
+          delete[] blockMeta;
+          throw(runtime_error("Incompatible fst file."));
+        }
       }
-    }
-
-    // Read first block with offset
-    unsigned long long blockSize = blockOffset[1] - offset;  // size of data block
 
-    ReadDataBlock_v6(myfile, blockReader, blockSize, nrOfElements, startOffset, endElem, 0);
+      blockReader->LevelCodesToVec(batchLength, vecOffset + batchStart, levelCodes);
+      continue;
+    }
 
-    if (startBlock == endBlock)  // subset start and end of block
+    for (unsigned long long blockStart = 0; blockStart < batchLength; blockStart += BLOCKSIZE_CHAR)
     {
-      delete[] blockOffset;
+      unsigned int nrOfElements = static_cast<unsigned int>(min(static_cast<unsigned long long>(BLOCKSIZE_CHAR),
+        batchLength - blockStart));
+      unsigned int* bitsNA = &blockMeta[nrOfElements];
+      const int* blockCodes = &levelCodes[blockStart];
+      bool hasNA = false;
 
-      return;
-    }
+      memset(bitsNA, 0, (1 + nrOfElements / 32) * 4);
+      blockData.clear();
 
-    offset = blockOffset[1];
-    unsigned long long vecPos = blockSizeChar - startOffset;
+      for (unsigned int blockElem = 0; blockElem < nrOfElements; ++blockElem)
+      {
+        unsigned int levelCode = static_cast<unsigned int>(blockCodes[blockElem]);
+
+        if (levelCode == FST_NA_INT)
+        {
+          bitsNA[blockElem / 32] |= 1U << (blockElem % 32);
+          hasNA = true;
+        }
+        else if (levelCode == 0 || levelCode > nrOfLevels)
+        {
+          delete[] levelCodes;
+          delete[] blockMeta;
+          throw(runtime_error("Incompatible fst file."));
+        }
+        else
+        {
+          const string &level = levels.Element(levelCode - 1);
+          blockData.insert(blockData.end(), level.begin(), level.end());
+        }
+
+        blockMeta[blockElem] = static_cast<unsigned int>(blockData.size());
+      }
 
-    if (endBlock == totNrOfBlocks)
-    {
-      nrOfElements = size - totNrOfBlocks * blockSizeChar;  // last block can have less elements
+      if (hasNA) bitsNA[nrOfElements / 32] |= 1U << (nrOfElements % 32);  // NA flag
+
+      blockReader->BufferToVec(nrOfElements, 0, nrOfElements - 1, vecOffset + batchStart + blockStart, blockMeta,
+        blockData.data());
     }
+  }
 
-    --nrOfBlocks;  // iterate full blocks
-    for (unsigned long long block = 1; block < nrOfBlocks; ++block)
-    {
-      unsigned long long newPos = blockOffset[block + 1];
+  delete[] levelCodes;
+  delete[] blockMeta;
 
-      ReadDataBlock_v6(myfile, blockReader, newPos - offset, blockSizeChar, 0, blockSizeChar - 1, vecPos);
+  return blockPos + vecSize;
+}
 
-      vecPos += blockSizeChar;
-      offset = newPos;
-    }
 
-    unsigned long long newPos = blockOffset[nrOfBlocks + 1];
-    ReadDataBlock_v6(myfile, blockReader, newPos - offset, nrOfElements, 0, endOffset, vecPos);
+unsigned long long fdsReadCharVec_v6(IFstSource &myfile, IStringColumn* blockReader, unsigned long long blockPos,
+  unsigned long long startRow, unsigned long long vecLength, unsigned long long size, unsigned long long vecOffset)
+{
+  // Read algorithm type and block size
+  unsigned int meta[2];
+  bool isValid = myfile.Read((char*) meta, blockPos, CHAR_HEADER_SIZE);
 
-    delete[] blockOffset;
+  unsigned int compression = meta[0] & 1;  // maximum 8 encodings
+  StringEncoding stringEncoding = static_cast<StringEncoding>(meta[0] >> 1 & 7);  // at maximum 8 encodings
 
-    return;
+  unsigned long long blockSizeChar = static_cast<unsigned long long>(meta[1]);
+
+  if (!isValid || blockSizeChar == 0)
+  {
+    throw(runtime_error(FSTERROR_DAMAGED_DATA));
   }
+  unsigned long long totNrOfBlocks = (size - 1) / blockSizeChar;  // total number of blocks minus 1
+  unsigned long long startBlock = startRow / blockSizeChar;
+  unsigned long long startOffset = startRow - (startBlock * blockSizeChar);
+  unsigned long long endBlock = (startRow + vecLength - 1)  / blockSizeChar;
+  unsigned long long endOffset = (startRow + vecLength - 1)  -  endBlock *blockSizeChar;
+  long long nrOfBlocks = 1 + endBlock - startBlock;  // total number of blocks to read
 
+  // Result vector is allocated by the caller, possibly spanning multiple chunks
+  blockReader->SetEncoding(stringEncoding);
 
-  // Vector data is compressed
+  if ((meta[0] & CHAR_DICTIONARY) != 0)
+  {
+    return ReadCharVecDictionary_v6(myfile, blockReader, blockPos, startRow, vecLength, size, vecOffset);
+  }
 
-  unsigned int bufLength = (nrOfBlocks + 1) * CHAR_INDEX_SIZE;  // 1 long and 2 unsigned int per block
-  char *blockInfo = new char[bufLength + CHAR_INDEX_SIZE];  // add extra first element for convenience
+  // The block index follows the trained ZSTD dictionary, if present
+  unsigned long long indexStart = CHAR_HEADER_SIZE;
+  ZstdDictionary* zstdDictionary = nullptr;
 
+  if ((meta[0] & CHAR_ZSTD_DICT) != 0)
+  {
+    zstdDictionary = ReadZstdDictionary_v6(myfile, blockPos, indexStart);
+  }
+
+  // Block index with the end position of each block, for compressed vectors also the algorithms and int buffer size
+  unsigned int indexEntrySize = compression == 0 ? 8 : CHAR_INDEX_SIZE;
+  char *blockInfo = new char[(nrOfBlocks + 1) * indexEntrySize];  // add extra first element for convenience
 
   if (startBlock > 0)  // include previous block offset
   {
-    myfile.seekg(blockPos + CHAR_HEADER_SIZE + (startBlock - 1) * CHAR_INDEX_SIZE);  // jump to correct block index
-    myfile.read(blockInfo, (nrOfBlocks + 1) * CHAR_INDEX_SIZE);
+    isValid = myfile.Read(blockInfo, blockPos + indexStart + (startBlock - 1) * indexEntrySize,
+      (nrOfBlocks + 1) * indexEntrySize);
   }
   else
   {
     unsigned long long* firstBlock = (unsigned long long*) blockInfo;
-    *firstBlock = CHAR_HEADER_SIZE + (totNrOfBlocks + 1) * CHAR_INDEX_SIZE;  // offset of first data block
-    myfile.read(&blockInfo[CHAR_INDEX_SIZE], nrOfBlocks * CHAR_INDEX_SIZE);
+    *firstBlock = indexStart + (totNrOfBlocks + 1) * indexEntrySize;  // offset of first data block
+    isValid = myfile.Read(&blockInfo[indexEntrySize], blockPos + indexStart, nrOfBlocks * indexEntrySize);
   }
 
-  // Get block meta data
-  unsigned long long* offset = (unsigned long long*) blockInfo;
-  char* blockP = &blockInfo[CHAR_INDEX_SIZE];
-  unsigned long long* curBlockPos = (unsigned long long*) blockP;
-  unsigned short int* algoInt  = (unsigned short int*) (blockP + 8);
-  unsigned short int* algoChar = (unsigned short int*) (blockP + 10);
-  int* intBufSize = (int*) (blockP + 12);
+  // Position directly after the last selected data block
+  unsigned long long endPos = blockPos + *reinterpret_cast<unsigned long long*>(&blockInfo[nrOfBlocks * indexEntrySize]);
 
-  // move to first data block
+  // the selected blocks should be available in the source (e.g. a truncated file or buffer)
+  if (!isValid || endPos > myfile.Size())
+  {
+    delete[] blockInfo;
+    delete zstdDictionary;
+    throw(runtime_error(FSTERROR_DAMAGED_DATA));
+  }
 
-  myfile.seekg(blockPos + *offset);
+  // Blocks are read and decompressed in batches by all threads, the strings of a batch are created by the main thread
+  int nrOfThreads = static_cast<int>(min(static_cast<long long>(GetFstThreads()), nrOfBlocks));
+  long long batchSize = nrOfThreads == 1 ? 1 : nrOfThreads * CHAR_READ_BATCH;
+  vector<CharBlockStage> stages(min(batchSize, nrOfBlocks));
 
-  unsigned long long endElem = blockSizeChar - 1;
-  unsigned long long nrOfElements = blockSizeChar;
+  bool hasError = false;
+  std::string errorMessage;
 
-  if (startBlock == endBlock)  // subset start and end of block
+  for (long long batchStart = 0; batchStart < nrOfBlocks; batchStart += batchSize)
   {
-    endElem = endOffset;
-    if (endBlock == totNrOfBlocks)
+    long long batchEnd = min(batchStart + batchSize, nrOfBlocks);
+
+    //////////////////////////////////////////////////////////
+    // Parallel logic starts here
+    //////////////////////////////////////////////////////////
+
+#pragma omp parallel for num_threads(nrOfThreads) schedule(dynamic, 1)
+    for (long long block = batchStart; block < batchEnd; ++block)
     {
-      nrOfElements = size - totNrOfBlocks * blockSizeChar;  // last block can have less elements
+      CharBlockStage &stage = stages[block - batchStart];
+      stage.sizeBuffer = nullptr;
+      stage.charBuffer = nullptr;
+
+      unsigned long long offset = *reinterpret_cast<unsigned long long*>(&blockInfo[block * indexEntrySize]);
+      char* blockP = &blockInfo[(block + 1) * indexEntrySize];
+      unsigned long long blockEnd = *reinterpret_cast<unsigned long long*>(blockP);
+
+      // last block can have less elements
+      unsigned long long nrOfElements = startBlock + block == totNrOfBlocks ?
+        size - totNrOfBlocks * blockSizeChar : blockSizeChar;
+
+      try
+      {
+        if (compression == 0)
+        {
+          StageDataBlock_v6(myfile, stage, blockPos + offset, blockEnd - offset, nrOfElements);
+        }
+        else
+        {
+          unsigned short int* algoInt  = reinterpret_cast<unsigned short int*>(blockP + 8);
+          unsigned short int* algoChar = reinterpret_cast<unsigned short int*>(blockP + 10);
+          int* intBufSize = reinterpret_cast<int*>(blockP + 12);
+
+          StageDataBlockCompressed_v6(myfile, stage, blockPos + offset, blockEnd - offset, nrOfElements, *intBufSize,
+            *algoInt, *algoChar, zstdDictionary);
+        }
+      }
+      catch (const std::exception &e)
+      {
+#pragma omp critical(fst_char_read_error)
+        {
+          if (!hasError) errorMessage = e.what();
+          hasError = true;
+        }
+      }
     }
-  }
 
-  // Read first block with offset
-  unsigned long long blockSize = *curBlockPos - *offset;  // size of data block
+    //////////////////////////////////////////////////////////
+    // Parallel logic ends here
+    //////////////////////////////////////////////////////////
 
-  Decompressor decompressor;  // uncompress all availble algorithms
+    if (hasError)
+    {
+      for (long long block = batchStart; block < batchEnd; ++block) ReleaseStage_v6(stages[block - batchStart]);
 
-  ReadDataBlockCompressed_v6(myfile, blockReader, blockSize, nrOfElements, startOffset, endElem, 0, *intBufSize,
-                             decompressor, *algoInt, *algoChar);
+      delete[] blockInfo;
+      delete zstdDictionary;
+      throw(runtime_error(errorMessage));
+    }
 
+    // Convert the staged blocks to strings in order
+    for (long long block = batchStart; block < batchEnd; ++block)
+    {
+      CharBlockStage &stage = stages[block - batchStart];
 
-  if (startBlock == endBlock)  // subset start and end of block
-  {
-    delete[] blockInfo;
+      unsigned long long nrOfElements = startBlock + block == totNrOfBlocks ?
+        size - totNrOfBlocks * blockSizeChar : blockSizeChar;
+      unsigned long long startElem = block == 0 ? startOffset : 0;
+      unsigned long long endElem = block == nrOfBlocks - 1 ? endOffset : blockSizeChar - 1;
+      unsigned long long vecPos = block == 0 ? vecOffset : vecOffset + block * blockSizeChar - startOffset;
 
-    return;
+      blockReader->BufferToVec(nrOfElements, startElem, endElem, vecPos, stage.strSizes, stage.charData);
+
+      ReleaseStage_v6(stage);
+    }
   }
 
-  offset = curBlockPos;
+  delete[] blockInfo;
+  delete zstdDictionary;
+
+  return endPos;
+}
 
-  unsigned long long vecPos = blockSizeChar - startOffset;
 
-  if (endBlock == totNrOfBlocks)
+bool fdsPlanCharVec_v6(FstReadPlanner &planner, unsigned long long blockPos, unsigned long long startRow,
+  unsigned long long vecLength, unsigned long long size)
+{
+  if (!planner.Require(blockPos, CHAR_HEADER_SIZE)) return false;
+
+  unsigned int meta[2];
+  planner.Read((char*) meta, blockPos, CHAR_HEADER_SIZE);
+
+  if ((meta[0] & CHAR_DICTIONARY) != 0)
   {
-    nrOfElements = size - totNrOfBlocks * blockSizeChar;  // last block can have less elements
+    bool isPlanned = planner.Require(blockPos + CHAR_HEADER_SIZE, 8);  // vector size
+
+    return fdsPlanFactorVec_v7(planner, blockPos + CHAR_DICTIONARY_HEADER_SIZE, startRow, vecLength, size, true) &&
+      isPlanned;
   }
 
-  --nrOfBlocks;  // iterate all but last block
-  blockP += CHAR_INDEX_SIZE;  // move to next index element
-  for (unsigned int block = 1; block < nrOfBlocks; ++block)
+  unsigned long long blockSizeChar = static_cast<unsigned long long>(meta[1]);
+
+  // a damaged header is reported by the reader
+  if (blockSizeChar == 0) return true;
+
+  // The block index follows the trained ZSTD dictionary, if present
+  unsigned long long indexStart = CHAR_HEADER_SIZE;
+  bool isDictPlanned = true;
+
+  if ((meta[0] & CHAR_ZSTD_DICT) != 0)
   {
-    unsigned long long* curBlockPos = (unsigned long long*) blockP;
-    unsigned short int* algoInt  = (unsigned short int*) (blockP + 8);
-    unsigned short int* algoChar = (unsigned short int*) (blockP + 10);
-    int* intBufSize = (int*) (blockP + 12);
+    if (!planner.Require(blockPos + CHAR_HEADER_SIZE, CHAR_ZSTD_DICT_HEADER_SIZE)) return false;
 
-    ReadDataBlockCompressed_v6(myfile, blockReader, *curBlockPos - *offset, blockSizeChar, 0, blockSizeChar - 1, vecPos, *intBufSize,
-      decompressor, *algoInt, *algoChar);
+    unsigned int dictSize;
+    planner.Read(reinterpret_cast<char*>(&dictSize), blockPos + CHAR_HEADER_SIZE, 4);
 
-    vecPos += blockSizeChar;
-    offset = curBlockPos;
-    blockP += CHAR_INDEX_SIZE;  // move to next index element
+    isDictPlanned = planner.Require(blockPos + CHAR_HEADER_SIZE + CHAR_ZSTD_DICT_HEADER_SIZE, dictSize);
+    indexStart += CHAR_ZSTD_DICT_HEADER_SIZE + 8 * ((dictSize + 7ULL) / 8);
   }
 
-  curBlockPos = (unsigned long long*) blockP;
-  algoInt  = (unsigned short int*) (blockP + 8);
-  algoChar = (unsigned short int*) (blockP + 10);
-  intBufSize = (int*) (blockP + 12);
+  unsigned int indexEntrySize = (meta[0] & 1) == 0 ? 8 : CHAR_INDEX_SIZE;
+  unsigned long long totNrOfBlocks = (size - 1) / blockSizeChar;  // total number of blocks minus 1
+  unsigned long long startBlock = startRow / blockSizeChar;
+  unsigned long long endBlock = (startRow + vecLength - 1) / blockSizeChar;
+
+  // Index entries of the selected blocks, including the entry of the previous block with the start position
+  unsigned long long indexPos = blockPos + indexStart + (startBlock > 0 ? startBlock - 1 : 0) * indexEntrySize;
+  unsigned long long indexEnd = blockPos + indexStart + (endBlock + 1) * indexEntrySize;
 
-  ReadDataBlockCompressed_v6(myfile, blockReader, *curBlockPos - *offset, nrOfElements, 0, endOffset, vecPos, *intBufSize,
-    decompressor, *algoInt, *algoChar);
+  if (!planner.Require(indexPos, indexEnd - indexPos)) return false;
 
-  delete[] blockInfo;
+  unsigned long long dataStart = indexStart + (totNrOfBlocks + 1) * indexEntrySize;  // offset of first block
+  unsigned long long dataEnd;
+
+  if (startBlock > 0) planner.Read(reinterpret_cast<char*>(&dataStart), indexPos, 8);
+  planner.Read(reinterpret_cast<char*>(&dataEnd), indexEnd - indexEntrySize, 8);
+
+  if (dataEnd < dataStart) return isDictPlanned;
 
-  return;
+  return planner.Require(blockPos + dataStart, dataEnd - dataStart) && isDictPlanned;
 }
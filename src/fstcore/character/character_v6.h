@@ -42,12 +42,39 @@
 
 #include "interface/istringwriter.h"
 #include "interface/ifstcolumn.h"
+#include "interface/ifstsource.h"
+#include "interface/ifstsink.h"
+#include "interface/fstreadplanner.h"
 
 
-void fdsWriteCharVec_v6(std::ofstream &myfile, IStringWriter* blockRunner, int compression, StringEncoding stringEncoding);
+// Character columns that are compressed with ZSTD (compression above 50) are stored with a ZSTD dictionary that is
+// trained from a sample of the column when enabled. The dictionary is stored once in the column header and used for the
+// character data of the blocks that are compressed with ZSTD, it's only kept if it reduces the size of these blocks.
+// Disabled by default, files with trained dictionaries can't be read by earlier versions of fst.
+bool GetFstCharZstdDictionary();
 
 
-void fdsReadCharVec_v6(std::istream &myfile, IStringColumn* blockReader, unsigned long long blockPos, unsigned long long startRow,
+// Enable or disable the trained ZSTD dictionaries of character columns, returns the previous setting
+bool SetFstCharZstdDictionary(bool enable);
+
+
+// Vectors with a low number of distinct values are stored as a dictionary with level codes when allowDictionary is
+// set, the level strings and codes are stored with the factor format. Other vectors use a trained ZSTD dictionary when
+// allowDictionary is set and trained dictionaries are enabled (see GetFstCharZstdDictionary). Returns the fstcore
+// version required to read the stored vector, vectors with either dictionary can't be read by earlier versions.
+unsigned int fdsWriteCharVec_v6(IFstSink &myfile, IStringWriter* blockRunner, int compression, StringEncoding stringEncoding,
+  bool allowDictionary = false);
+
+
+// The result vector in blockReader is expected to be allocated by the caller. Elements are stored
+// starting at position vecOffset, so a single vector can be filled from multiple (row) chunks.
+// Returns the file position directly after the last data block that was read.
+unsigned long long fdsReadCharVec_v6(IFstSource &myfile, IStringColumn* blockReader, unsigned long long blockPos,
+  unsigned long long startRow, unsigned long long vecLength, unsigned long long size, unsigned long long vecOffset);
+
+
+// Plan the byte ranges that fdsReadCharVec_v6 reads for a range of rows (see fdsPlanColumn_v2).
+bool fdsPlanCharVec_v6(FstReadPlanner &planner, unsigned long long blockPos, unsigned long long startRow,
   unsigned long long vecLength, unsigned long long size);
 
 
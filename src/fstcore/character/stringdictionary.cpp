@@ -0,0 +1,132 @@
+/*
+  fst - An R-package for ultra fast storage and retrieval of datasets.
+  Copyright (C) 2017, Mark AJ Klik
+
+  BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following disclaimer
+    in the documentation and/or other materials provided with the
+    distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+    A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  You can contact the author at :
+  - fst source repository : https://github.com/fstPackage/fst
+*/
+
+
+#include <cstring>
+
+#include <character/stringdictionary.h>
+#include <interface/fstdefines.h>
+#include <ZSTD/common/xxhash.h>
+
+using namespace std;
+
+
+#define DICTIONARY_HASH_SEED  0
+#define DICTIONARY_MIN_SLOTS  1024
+
+
+StringDictionary::StringDictionary(StringEncoding encoding)
+{
+  this->encoding   = encoding;
+  this->vecLength  = 0;
+  this->bufSize    = 0;
+  this->activeBuf  = nullptr;
+  this->slots.assign(DICTIONARY_MIN_SLOTS, 0);
+  this->sizeBuffer.resize(BLOCKSIZE_CHAR);
+  this->naBuffer.resize(1 + BLOCKSIZE_CHAR / 32);
+  this->strSizes   = sizeBuffer.data();
+  this->naInts     = naBuffer.data();
+}
+
+
+void StringDictionary::Grow()
+{
+  unsigned long long newSize = 2 * slots.size();
+  unsigned long long mask = newSize - 1;
+
+  slots.assign(newSize, 0);
+
+  for (unsigned int level = 0; level < levelHashes.size(); ++level)
+  {
+    unsigned long long slotNr = levelHashes[level] & mask;
+    while (slots[slotNr] != 0) slotNr = (slotNr + 1) & mask;
+
+    slots[slotNr] = level + 1;
+  }
+}
+
+
+unsigned int StringDictionary::Add(const char* str, unsigned int length)
+{
+  unsigned long long hash = XXH64(str, length, DICTIONARY_HASH_SEED);
+  unsigned long long mask = slots.size() - 1;
+  unsigned long long slotNr = hash & mask;
+
+  // Linear probing
+  while (slots[slotNr] != 0)
+  {
+    unsigned int level = slots[slotNr] - 1;
+
+    if (levelHashes[level] == hash)
+    {
+      unsigned int levelStart = level == 0 ? 0 : levelEnds[level - 1];
+
+      if (levelEnds[level] - levelStart == length && memcmp(&levelData[levelStart], str, length) == 0)
+      {
+        return level + 1;
+      }
+    }
+
+    slotNr = (slotNr + 1) & mask;
+  }
+
+  // New level
+  levelData.insert(levelData.end(), str, str + length);
+  levelEnds.push_back(static_cast<unsigned int>(levelData.size()));
+  levelHashes.push_back(hash);
+  slots[slotNr] = static_cast<unsigned int>(levelEnds.size());
+  vecLength = levelEnds.size();
+
+  // Keep the load factor below 0.5
+  if (2 * levelEnds.size() > slots.size()) Grow();
+
+  return static_cast<unsigned int>(levelEnds.size());
+}
+
+
+void StringDictionary::SetBuffersFromVec(unsigned long long startCount, unsigned long long endCount)
+{
+  unsigned long long nrOfElements = endCount - startCount;
+  unsigned int startPos = startCount == 0 ? 0 : levelEnds[startCount - 1];
+
+  for (unsigned long long level = startCount; level < endCount; ++level)
+  {
+    sizeBuffer[level - startCount] = levelEnds[level] - startPos;
+  }
+
+  memset(naInts, 0, (1 + nrOfElements / 32) * 4);
+
+  bufSize = levelEnds[endCount - 1] - startPos;
+  activeBuf = levelData.data() + startPos;
+}
@@ -0,0 +1,80 @@
+/*
+  fst - An R-package for ultra fast storage and retrieval of datasets.
+  Copyright (C) 2017, Mark AJ Klik
+
+  BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following disclaimer
+    in the documentation and/or other materials provided with the
+    distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+    A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  You can contact the author at :
+  - fst source repository : https://github.com/fstPackage/fst
+*/
+
+#ifndef STRING_DICTIONARY_H
+#define STRING_DICTIONARY_H
+
+#include <vector>
+
+#include <interface/istringwriter.h>
+
+
+/**
+ * \brief Dictionary with the distinct strings of a character vector.
+ *
+ * Strings are added in order of appearance and are identified by their (1-based) level number. The dictionary is
+ * also a string writer for its level strings, so the levels can be stored with the character vector writer.
+ */
+class StringDictionary : public IStringWriter
+{
+  StringEncoding encoding;
+  std::vector<char> levelData;                    // concatenated level strings
+  std::vector<unsigned int> levelEnds;            // end position of each level in levelData
+  std::vector<unsigned long long> levelHashes;    // hash of each level
+  std::vector<unsigned int> slots;                // hash table with level number, zero for an empty slot
+  std::vector<unsigned int> sizeBuffer;           // cumulative string lengths of the current block
+  std::vector<unsigned int> naBuffer;             // NA bits of the current block (levels are never NA)
+
+  void Grow();
+
+public:
+  StringDictionary(StringEncoding encoding);
+
+  /**
+   * \brief Get the level number of a string, the string is added if it's not in the dictionary yet
+   * \param str string data
+   * \param length number of bytes in the string
+   * \return level number of the string, starting at 1
+   */
+  unsigned int Add(const char* str, unsigned int length);
+
+  unsigned int NrOfLevels() const { return static_cast<unsigned int>(levelEnds.size()); }
+
+  StringEncoding Encoding() { return encoding; }
+
+  void SetBuffersFromVec(unsigned long long startCount, unsigned long long endCount);
+};
+
+
+#endif  // STRING_DICTIONARY_H
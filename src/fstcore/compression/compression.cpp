@@ -58,6 +58,86 @@ size_t MAX_compressBound(size_t srcSize)
 	return max(ZSTD_compressBound(srcSize), LZ4_COMPRESSBOUND(srcSize));
 }
 
+
+// Contexts are reused unless disabled (for benchmarks)
+static bool ZstdContextReuse = true;
+
+
+bool GetZstdContextReuse()
+{
+  return ZstdContextReuse;
+}
+
+
+bool SetZstdContextReuse(bool reuse)
+{
+  bool previousReuse = ZstdContextReuse;
+  ZstdContextReuse = reuse;
+
+  return previousReuse;
+}
+
+
+// ZSTD compression and decompression contexts of a single thread. The contexts are created on first use and freed
+// when the thread ends, so the threads of the OpenMP pool keep their contexts across blocks, columns and calls.
+class ZstdThreadContext
+{
+  ZSTD_CCtx* cctx;
+  ZSTD_DCtx* dctx;
+
+public:
+  ZstdThreadContext()
+  {
+    this->cctx = nullptr;
+    this->dctx = nullptr;
+  }
+
+  ~ZstdThreadContext()
+  {
+    ZSTD_freeCCtx(cctx);  // no-op for a nullptr
+    ZSTD_freeDCtx(dctx);
+  }
+
+  ZSTD_CCtx* CompressionContext()
+  {
+    if (cctx == nullptr) cctx = ZSTD_createCCtx();
+    return cctx;
+  }
+
+  ZSTD_DCtx* DecompressionContext()
+  {
+    if (dctx == nullptr) dctx = ZSTD_createDCtx();
+    return dctx;
+  }
+};
+
+
+static thread_local ZstdThreadContext zstdThreadContext;
+
+
+// Compress a block with the context of the calling thread. The compression level of each call resets the context
+// parameters, the context memory is only reallocated when a level needs larger tables than earlier calls.
+inline size_t ZstdCompress(char* dst, unsigned int dstCapacity, const char* src, unsigned int srcSize, int compressionLevel)
+{
+  int zstdLevel = (compressionLevel * ZSTD_maxCLevel()) / 100;
+  ZSTD_CCtx* cctx = ZstdContextReuse ? zstdThreadContext.CompressionContext() : nullptr;
+
+  if (cctx == nullptr) return ZSTD_compress(dst, dstCapacity, src, srcSize, zstdLevel);
+
+  return ZSTD_compressCCtx(cctx, dst, dstCapacity, src, srcSize, zstdLevel);
+}
+
+
+// Decompress a block with the context of the calling thread
+inline size_t ZstdDecompress(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
+{
+  ZSTD_DCtx* dctx = ZstdContextReuse ? zstdThreadContext.DecompressionContext() : nullptr;
+
+  if (dctx == nullptr) return ZSTD_decompress(dst, dstCapacity, src, compressedSize);
+
+  return ZSTD_decompressDCtx(dctx, dst, dstCapacity, src, compressedSize);
+}
+
 // The size of outVec is expected to be 2 times nrOfDoubles
 void ShuffleReal(double* inVec, double* outVec, int nrOfDoubles)
 {
@@ -988,7 +1068,7 @@ unsigned int ZSTD_INT_TO_BYTE_C(char* dst, unsigned int dstCapacity, const char*
 
   CompactIntToByte(buf, src, srcSize / 4);
 
-  return ZSTD_compress(dst, dstCapacity, (char*) buf,  nrOfLongs * 8,  (compressionLevel * ZSTD_maxCLevel()) / 100);
+  return ZstdCompress(dst, dstCapacity, (char*) buf, nrOfLongs * 8, compressionLevel);
 }
 
 unsigned int ZSTD_INT_TO_BYTE_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
@@ -1001,7 +1081,7 @@ unsigned int ZSTD_INT_TO_BYTE_D(char* dst, unsigned int dstCapacity, const char*
   char buf[MAX_SIZE_COMPRESS_BLOCK_QUARTER];
 
   // Decompress
-  unsigned int errorCode = static_cast<unsigned int>(ZSTD_decompress((char*) buf, 8 * nrOfLongs, src, compressedSize) != 8 * nrOfLongs);
+  unsigned int errorCode = static_cast<unsigned int>(ZstdDecompress((char*) buf, 8 * nrOfLongs, src, compressedSize) != 8 * nrOfLongs);
   DecompactByteToInt(buf, dst, nrOfDstInts);  // one integer per byte
 
   return errorCode;
@@ -1141,7 +1221,7 @@ unsigned int ZSTD_LOGIC64_C(char* dst, unsigned int dstCapacity, const char* src
 
   LogicCompr64(src, buf, nrOfLogicals);
 
-  return ZSTD_compress(dst, dstCapacity, (char*) buf,  nrOfLongs * 8,  (compressionLevel * ZSTD_maxCLevel()) / 100);
+  return ZstdCompress(dst, dstCapacity, (char*) buf, nrOfLongs * 8, compressionLevel);
 }
 
 unsigned int ZSTD_LOGIC64_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
@@ -1154,7 +1234,7 @@ unsigned int ZSTD_LOGIC64_D(char* dst, unsigned int dstCapacity, const char* src
   unsigned long long buf[MAX_SIZE_COMPRESS_BLOCK_128];
 
   // Decompress
-  unsigned int errorCode = static_cast<unsigned int>(ZSTD_decompress((char*) buf, 8 * nrOfLongs, src, compressedSize) != 8 * nrOfLongs);
+  unsigned int errorCode = static_cast<unsigned int>(ZstdDecompress((char*) buf, 8 * nrOfLongs, src, compressedSize) != 8 * nrOfLongs);
   LogicDecompr64(dst, (unsigned long long*) buf, nrOfLogicals, 0);
 
   return errorCode;
@@ -1227,7 +1307,7 @@ unsigned int ZSTD_C_SHUF8(char* dst, unsigned int dstCapacity, const char* src,
   double shuffleBuf[MAX_SIZE_COMPRESS_BLOCK_8];
 
   ShuffleReal((double*) src, shuffleBuf, doubleSize);
-  return ZSTD_compress(dst, dstCapacity, (char*) shuffleBuf, srcSize, (compressionLevel * ZSTD_maxCLevel()) / 100);
+  return ZstdCompress(dst, dstCapacity, (char*) shuffleBuf, srcSize, compressionLevel);
 }
 
 unsigned int ZSTD_D_SHUF8(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
@@ -1237,7 +1317,7 @@ unsigned int ZSTD_D_SHUF8(char* dst, unsigned int dstCapacity, const char* src,
   // double shuffleBuf[doubleSize];
   double shuffleBuf[MAX_SIZE_COMPRESS_BLOCK_8];
 
-  unsigned int errorCode = ZSTD_decompress((char*) shuffleBuf, dstCapacity, src, compressedSize) != dstCapacity;
+  unsigned int errorCode = ZstdDecompress((char*) shuffleBuf, dstCapacity, src, compressedSize) != dstCapacity;
   DeshuffleReal(shuffleBuf, (double*) dst, doubleSize);
 
   return errorCode;
@@ -1248,12 +1328,12 @@ unsigned int ZSTD_D_SHUF8(char* dst, unsigned int dstCapacity, const char* src,
 
 unsigned int ZSTD_C(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, int compressionLevel)
 {
-  return ZSTD_compress(dst, dstCapacity, src,  srcSize,  (compressionLevel * ZSTD_maxCLevel()) / 100);
+  return ZstdCompress(dst, dstCapacity, src, srcSize, compressionLevel);
 }
 
 unsigned int ZSTD_D(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
 {
-  return ZSTD_decompress(dst, dstCapacity, src, compressedSize) != dstCapacity;
+  return ZstdDecompress(dst, dstCapacity, src, compressedSize) != dstCapacity;
 }
 
 
@@ -1267,7 +1347,7 @@ unsigned int ZSTD_C_SHUF4(char* dst, unsigned int dstCapacity, const char* src,
   // int shuffleBuf[MAX_SIZE_COMPRESS_BLOCK_QUARTER];
 
   ShuffleInt2((int*) src, (int*) shuffleBuf, intSize);
-  return ZSTD_compress(dst, dstCapacity, (char*) shuffleBuf, srcSize, (compressionLevel * ZSTD_maxCLevel()) / 100);
+  return ZstdCompress(dst, dstCapacity, (char*) shuffleBuf, srcSize, compressionLevel);
 }
 
 unsigned int ZSTD_D_SHUF4(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
@@ -1276,13 +1356,40 @@ unsigned int ZSTD_D_SHUF4(char* dst, unsigned int dstCapacity, const char* src,
 
   unsigned long long shuffleBuf[MAX_SIZE_COMPRESS_BLOCK_8];
 
-  unsigned int errorCode = ZSTD_decompress((char*) shuffleBuf, dstCapacity, src, compressedSize) != dstCapacity;
+  unsigned int errorCode = ZstdDecompress((char*) shuffleBuf, dstCapacity, src, compressedSize) != dstCapacity;
   DeshuffleInt2((int*) shuffleBuf, (int*) dst, intSize);
 
   return errorCode;
 }
 
 
+// ZSTD_DICT,
+
+unsigned int ZSTD_C_DICT(char* dst, unsigned int dstCapacity, const char* src, unsigned int srcSize,
+  const ZSTD_CDict_s* cdict)
+{
+  ZSTD_CCtx* cctx = ZstdContextReuse ? zstdThreadContext.CompressionContext() : ZSTD_createCCtx();
+
+  size_t resSize = ZSTD_compress_usingCDict(cctx, dst, dstCapacity, src, srcSize, cdict);
+
+  if (!ZstdContextReuse) ZSTD_freeCCtx(cctx);
+
+  return ZSTD_isError(resSize) ? 0 : static_cast<unsigned int>(resSize);
+}
+
+unsigned int ZSTD_D_DICT(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize,
+  const ZSTD_DDict_s* ddict)
+{
+  ZSTD_DCtx* dctx = ZstdContextReuse ? zstdThreadContext.DecompressionContext() : ZSTD_createDCtx();
+
+  size_t resSize = ZSTD_decompress_usingDDict(dctx, dst, dstCapacity, src, compressedSize, ddict);
+
+  if (!ZstdContextReuse) ZSTD_freeDCtx(dctx);
+
+  return resSize != dstCapacity;
+}
+
+
 inline void smallmemcpy(char* dst, const char* src, int size)
 {
   unsigned short longs = size / 2;
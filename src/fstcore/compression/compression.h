@@ -39,6 +39,15 @@
 
 size_t MAX_compressBound(size_t srcSize);
 
+
+// ZSTD blocks are (de)compressed with contexts that are cached per thread and reused for all blocks. Returns false if
+// a new context is created for each block (as in earlier versions).
+bool GetZstdContextReuse();
+
+
+// Enable or disable the reuse of cached ZSTD contexts (only meant for benchmarks), returns the previous setting
+bool SetZstdContextReuse(bool reuse);
+
 // of LZ4 and ZSTD
 // #define LZ4_COMPRESSBOUND(isize)  ((unsigned)(isize) > (unsigned)LZ4_MAX_INPUT_SIZE ? 0 : (isize) + ((isize)/255) + 16)
 
@@ -208,4 +217,20 @@ unsigned int ZSTD_C_SHUF4(char* dst, unsigned int dstCapacity, const char* src,
 unsigned int ZSTD_D_SHUF4(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
 
 
+// ZSTD_DICT,
+
+// Digested ZSTD dictionaries (see zstd.h)
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
+// Compress with a digested dictionary, returns 0 if src could not be compressed into dstCapacity bytes
+unsigned int ZSTD_C_DICT(char* dst, unsigned int dstCapacity, const char* src, unsigned int srcSize,
+  const ZSTD_CDict_s* cdict);
+
+
+// Decompress with a digested dictionary, returns a non-zero value if the result is not exactly dstCapacity bytes
+unsigned int ZSTD_D_DICT(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize,
+  const ZSTD_DDict_s* ddict);
+
+
 #endif  // COMPRESSION_H
@@ -41,6 +41,8 @@
 
 #include <lz4.h>
 #include <zstd.h>
+#define ZDICT_STATIC_LINKING_ONLY  // for the COVER training parameters
+#include <dictBuilder/zdict.h>
 
 
 using namespace std;
@@ -469,3 +471,83 @@ int StreamCompositeCompressor::Compress(char* src,  unsigned int srcSize, char*
 
   return compSize;
 }
+
+
+ZstdDictionary::ZstdDictionary(const char* dict, unsigned int dictSize, int compressionLevel)
+{
+  this->cdict = nullptr;
+  this->ddict = nullptr;
+
+  if (compressionLevel < 0)
+  {
+    ddict = ZSTD_createDDict(dict, dictSize);
+    return;
+  }
+
+  int zstdLevel = max(1, (compressionLevel * ZSTD_maxCLevel()) / 100);
+  cdict = ZSTD_createCDict(dict, dictSize, zstdLevel);
+}
+
+ZstdDictionary::~ZstdDictionary()
+{
+  ZSTD_freeCDict(cdict);  // no-op for a nullptr
+  ZSTD_freeDDict(ddict);
+}
+
+unsigned int ZstdDictionary::Train(char* dict, unsigned int dictCapacity, const char* samples,
+  const size_t* sampleSizes, unsigned int nrOfSamples)
+{
+  // A single COVER pass with fixed segment and dmer sizes, ZDICT_trainFromBuffer optimizes these parameters with
+  // multiple passes, which takes several times longer for a small gain
+  ZDICT_cover_params_t params;
+  memset(&params, 0, sizeof(params));
+  params.k = 256;
+  params.d = 8;
+
+  size_t dictSize = ZDICT_trainFromBuffer_cover(dict, dictCapacity, samples, sampleSizes, nrOfSamples, params);
+
+  return ZDICT_isError(dictSize) ? 0 : static_cast<unsigned int>(dictSize);
+}
+
+int ZstdDictionary::CompressBufferSize(int maxBlockSize)
+{
+  return MaxCompressSize(maxBlockSize, CompAlgoType::ZSTD_TYPE);
+}
+
+int ZstdDictionary::Compress(char* dst, unsigned int dstCapacity, const char* src, unsigned int srcSize)
+{
+  return ZSTD_C_DICT(dst, dstCapacity, src, srcSize, cdict);
+}
+
+bool ZstdDictionary::Decompress(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize)
+{
+  return ZSTD_D_DICT(dst, dstCapacity, src, compressedSize, ddict) == 0;
+}
+
+
+ZstdDictCompressor::ZstdDictCompressor(ZstdDictionary* zstdDictionary)
+{
+  this->zstdDictionary = zstdDictionary;
+}
+
+int ZstdDictCompressor::CompressBufferSize(int maxBlockSize)
+{
+  return zstdDictionary->CompressBufferSize(maxBlockSize);
+}
+
+int ZstdDictCompressor::Compress(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize,
+  CompAlgo &compAlgorithm)
+{
+  int compSize = zstdDictionary->Compress(dst, dstCapacity, src, srcSize);
+
+  // store uncompressed if the block can't be compressed
+  if (compSize == 0 || compSize >= static_cast<int>(srcSize))
+  {
+    memcpy(dst, src, srcSize);
+    compAlgorithm = CompAlgo::UNCOMPRESS;
+    return srcSize;
+  }
+
+  compAlgorithm = CompAlgo::ZSTD_DICT;
+  return compSize;
+}
@@ -77,7 +77,8 @@ enum CompAlgo
   LZ4_INT_TO_SHORT_SHUF2,
   INT_TO_BYTE,
   INT_TO_SHORT,
-  ZSTD_INT_TO_BYTE
+  ZSTD_INT_TO_BYTE,
+  ZSTD_DICT  // compressed with the ZSTD dictionary of a character vector, not part of the algorithm tables
 };
 
 
@@ -347,4 +348,89 @@ public:
 };
 
 
+/**
+ A ZSTD dictionary that is trained from samples of a vector and shared by all blocks of that vector.
+ Small blocks that compress badly on their own can use the patterns of the dictionary. The digested
+ dictionaries are read-only, so blocks can be (de)compressed concurrently by multiple threads.
+*/
+class ZstdDictionary
+{
+private:
+  ZSTD_CDict_s* cdict;
+  ZSTD_DDict_s* ddict;
+
+public:
+
+  /**
+   Constructor for a dictionary, the dictionary data is copied.
+
+   @param dict Dictionary data (see Train).
+   @param dictSize Size of the dictionary data.
+   @param compressionLevel Level of compression (0 - 100), or -1 if the dictionary is only used for decompression.
+   */
+  ZstdDictionary(const char* dict, unsigned int dictSize, int compressionLevel);
+
+  ~ZstdDictionary();
+
+  /**
+   Train a dictionary from samples that are stored consecutively in a single buffer.
+
+   @param dict Buffer for the dictionary data.
+   @param dictCapacity Maximum size of the dictionary.
+   @param samples Sample data.
+   @param sampleSizes Size of each sample.
+   @param nrOfSamples Number of samples.
+   @return Size of the dictionary, 0 if no dictionary could be trained (e.g. with too few samples).
+   */
+  static unsigned int Train(char* dict, unsigned int dictCapacity, const char* samples, const size_t* sampleSizes,
+    unsigned int nrOfSamples);
+
+  bool IsValid() { return cdict != nullptr || ddict != nullptr; }
+
+  int CompressBufferSize(int maxBlockSize);
+
+  /**
+  Compress src into dst using the dictionary
+
+  @param dst Destination buffer
+  @param dstCapacity Size of destination buffer
+  @param src Source buffer
+  @param srcSize Size of source buffer
+  @return Resulting number of bytes in the compressed data, 0 if src could not be compressed
+  */
+  int Compress(char* dst, unsigned int dstCapacity, const char* src, unsigned int srcSize);
+
+  /**
+  Decompress src into dst using the dictionary
+
+  @return False if the decompressed data does not have a size of exactly dstCapacity bytes
+  */
+  bool Decompress(char* dst, unsigned int dstCapacity, const char* src, unsigned int compressedSize);
+};
+
+
+/**
+ A compressor that compresses blocks with a trained ZstdDictionary, which can be combined with other compressors
+ in a StreamCompressor. Blocks that can't be compressed with the dictionary are stored uncompressed.
+*/
+class ZstdDictCompressor : public Compressor
+{
+private:
+  ZstdDictionary* zstdDictionary;
+
+public:
+
+  /**
+   Constructor for a dictionary compressor.
+
+   @param zstdDictionary Dictionary used for compression, not owned by the compressor.
+   */
+  ZstdDictCompressor(ZstdDictionary* zstdDictionary);
+
+  int CompressBufferSize(int maxBlockSize);
+
+  int Compress(char* dst, unsigned int dstCapacity, const char* src,  unsigned int srcSize, CompAlgo &compAlgorithm);
+};
+
+
 #endif  // COMPRESSOR_H
@@ -40,13 +40,13 @@
 
 using namespace std;
 
-void fdsWriteRealVec_v9(ofstream &myfile, double* doubleVector, unsigned long long nrOfRows, unsigned int compression, std::string annotation)
+void fdsWriteRealVec_v9(IFstSink &myfile, double* doubleVector, unsigned long long nrOfRows, unsigned int compression, std::string annotation)
 {
   int blockSize = 8 * BLOCKSIZE_REAL;  // block size in bytes
 
   if (compression == 0)
   {
-    return fdsStreamUncompressed_v2(myfile, reinterpret_cast<char*>(doubleVector), nrOfRows, 8, BLOCKSIZE_REAL, nullptr, annotation);
+    return fdsStreamUncompressed_v2(myfile, reinterpret_cast<char*>(doubleVector), nrOfRows, 8, BLOCKSIZE_REAL, nullptr, annotation, FstColumnType::DOUBLE_64);
   }
 
   if (compression <= 50)  // low compression: linear mix of uncompressed LZ4
@@ -54,7 +54,16 @@ void fdsWriteRealVec_v9(ofstream &myfile, double* doubleVector, unsigned long lo
     Compressor* compress1 = new SingleCompressor(CompAlgo::LZ4, 2 * compression);
     StreamCompressor* streamCompressor = new StreamLinearCompressor(compress1, 2 * compression);
     streamCompressor->CompressBufferSize(blockSize);
-    fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(doubleVector), nrOfRows, 8, streamCompressor, BLOCKSIZE_REAL, annotation);
+    try
+    {
+      fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(doubleVector), nrOfRows, 8, streamCompressor, BLOCKSIZE_REAL, annotation, FstColumnType::DOUBLE_64);
+    }
+    catch (...)
+    {
+      delete compress1;
+      delete streamCompressor;
+      throw;
+    }
 
     delete compress1;
     delete streamCompressor;
@@ -65,7 +74,17 @@ void fdsWriteRealVec_v9(ofstream &myfile, double* doubleVector, unsigned long lo
   Compressor* compress2 = new SingleCompressor(CompAlgo::ZSTD, 20);
   StreamCompressor* streamCompressor = new StreamCompositeCompressor(compress1, compress2, 2 * (compression - 50));
   streamCompressor->CompressBufferSize(blockSize);
-  fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(doubleVector), nrOfRows, 8, streamCompressor, BLOCKSIZE_REAL, annotation);
+  try
+  {
+    fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(doubleVector), nrOfRows, 8, streamCompressor, BLOCKSIZE_REAL, annotation, FstColumnType::DOUBLE_64);
+  }
+  catch (...)
+  {
+    delete compress1;
+    delete compress2;
+    delete streamCompressor;
+    throw;
+  }
 
   delete compress1;
   delete compress2;
@@ -75,8 +94,15 @@ void fdsWriteRealVec_v9(ofstream &myfile, double* doubleVector, unsigned long lo
 }
 
 
-void fdsReadRealVec_v9(istream &myfile, double* doubleVector, unsigned long long blockPos, unsigned long long startRow,
+void fdsReadRealVec_v9(IFstSource &myfile, double* doubleVector, unsigned long long blockPos, unsigned long long startRow,
   unsigned long long length, unsigned long long size, std::string &annotation)
 {
   return fdsReadColumn_v2(myfile, reinterpret_cast<char*>(doubleVector), blockPos, startRow, length, size, 8, annotation, BATCH_SIZE_READ_DOUBLE);
 }
+
+
+bool fdsReadRealZoneMap_v9(IFstSource &myfile, unsigned long long blockPos, unsigned long long size, unsigned long long rowOffset,
+  vector<ZoneMapBlock> &blocks)
+{
+  return fdsReadZoneMap_v2(myfile, blockPos, size, rowOffset, 8, blocks);
+}
@@ -39,11 +39,21 @@
 // System libraries
 #include <ostream>
 #include <istream>
+#include <vector>
 
+#include <interface/fstzonemap.h>
+#include <interface/ifstsource.h>
+#include <interface/ifstsink.h>
 
-void fdsWriteRealVec_v9(std::ofstream &myfile, double* doubleVector, unsigned long long nrOfRows, unsigned int compression, std::string annotation);
 
-void fdsReadRealVec_v9(std::istream &myfile, double* doubleVector, unsigned long long blockPos, unsigned long long startRow,
+void fdsWriteRealVec_v9(IFstSink &myfile, double* doubleVector, unsigned long long nrOfRows, unsigned int compression, std::string annotation);
+
+void fdsReadRealVec_v9(IFstSource &myfile, double* doubleVector, unsigned long long blockPos, unsigned long long startRow,
   unsigned long long length, unsigned long long size, std::string &annotation);
 
+// Read the per-block statistics of a stored vector without reading the vector data.
+// Returns false if the vector was stored without a zone map.
+bool fdsReadRealZoneMap_v9(IFstSource &myfile, unsigned long long blockPos, unsigned long long size, unsigned long long rowOffset,
+  std::vector<ZoneMapBlock> &blocks);
+
 #endif // DOUBLE_v9_H
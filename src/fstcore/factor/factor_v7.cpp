@@ -54,10 +54,10 @@ using namespace std;
 #define HEADER_SIZE_FACTOR 16
 #define VERSION_NUMBER_FACTOR 1
 
-void fdsWriteFactorVec_v7(ofstream &myfile, int* intP, IStringWriter* blockRunner, unsigned long long size, unsigned int compression,
+void fdsWriteFactorVec_v7(IFstSink &myfile, int* intP, IStringWriter* blockRunner, unsigned long long size, unsigned int compression,
 	StringEncoding stringEncoding, std::string annotation)
 {
-  unsigned long long blockPos = myfile.tellp();  // offset for factor
+  unsigned long long blockPos = myfile.Size();  // offset for factor
   unsigned int nrOfFactorLevels = blockRunner->vecLength;
 
   // Vector meta data
@@ -69,16 +69,14 @@ void fdsWriteFactorVec_v7(ofstream &myfile, int* intP, IStringWriter* blockRunne
   // Use blockrunner to store factor levels if length > 0
   if (nrOfFactorLevels > 0)
   {
-	  myfile.write(meta, HEADER_SIZE_FACTOR);  // number of levels
+	  SinkAppend(myfile, meta, HEADER_SIZE_FACTOR);  // number of levels
 	  *nrOfLevels = nrOfFactorLevels;
 	  fdsWriteCharVec_v6(myfile, blockRunner, compression, stringEncoding);   // factor levels
 															  // Rewrite meta-data
 	  *versionNr = VERSION_NUMBER_FACTOR;
-	  *levelVecPos = myfile.tellp();  // offset for level vector
+	  *levelVecPos = myfile.Size();  // offset for level vector
 
-	  myfile.seekp(blockPos);
-	  myfile.write(meta, HEADER_SIZE_FACTOR);  // number of levels
-	  myfile.seekp(*levelVecPos);  // return to end of file
+	  myfile.Write(meta, blockPos, HEADER_SIZE_FACTOR);  // number of levels
   }
   else
   {
@@ -88,7 +86,7 @@ void fdsWriteFactorVec_v7(ofstream &myfile, int* intP, IStringWriter* blockRunne
 	  *nrOfLevels = 0;
 	  *versionNr = VERSION_NUMBER_FACTOR;
 	  *levelVecPos = blockPos + HEADER_SIZE_FACTOR;  // offset for level vector
-	  myfile.write(meta, HEADER_SIZE_FACTOR);  // write meta data
+	  SinkAppend(myfile, meta, HEADER_SIZE_FACTOR);  // write meta data
 
 	  return;
   }
@@ -104,7 +102,7 @@ void fdsWriteFactorVec_v7(ofstream &myfile, int* intP, IStringWriter* blockRunne
     if (*nrOfLevels < 128)
     {
       FixedRatioCompressor* compressor = new FixedRatioCompressor(CompAlgo::INT_TO_BYTE);  // compression level not relevant here
-      fdsStreamUncompressed_v2(myfile, (char*) intP, nrOfRows, 4, BLOCKSIZE_INT, compressor, annotation);
+      fdsStreamUncompressed_v2(myfile, (char*) intP, nrOfRows, 4, BLOCKSIZE_INT, compressor, annotation, FstColumnType::INT_32);
 
       delete compressor;
 
@@ -114,13 +112,13 @@ void fdsWriteFactorVec_v7(ofstream &myfile, int* intP, IStringWriter* blockRunne
     if (*nrOfLevels < 32768)
     {
       FixedRatioCompressor* compressor = new FixedRatioCompressor(CompAlgo::INT_TO_SHORT);  // compression level not relevant here
-      fdsStreamUncompressed_v2(myfile, (char*) intP, nrOfRows, 4, BLOCKSIZE_INT, compressor, annotation);
+      fdsStreamUncompressed_v2(myfile, (char*) intP, nrOfRows, 4, BLOCKSIZE_INT, compressor, annotation, FstColumnType::INT_32);
       delete compressor;
 
       return;
     }
 
-    fdsStreamUncompressed_v2(myfile, (char*) intP, nrOfRows, 4, BLOCKSIZE_INT, nullptr, annotation);
+    fdsStreamUncompressed_v2(myfile, (char*) intP, nrOfRows, 4, BLOCKSIZE_INT, nullptr, annotation, FstColumnType::INT_32);
 
     return;
   }
@@ -148,7 +146,18 @@ void fdsWriteFactorVec_v7(ofstream &myfile, int* intP, IStringWriter* blockRunne
 
     streamCompressor->CompressBufferSize(blockSize);
 
-    fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(intP), nrOfRows, 4, streamCompressor, BLOCKSIZE_INT, annotation);
+    try
+    {
+      fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(intP), nrOfRows, 4, streamCompressor, BLOCKSIZE_INT, annotation, FstColumnType::INT_32);
+    }
+    catch (...)
+    {
+      delete defaultCompress;
+      delete compress2;
+      delete streamCompressor;
+      throw;
+    }
+
     delete defaultCompress;
     delete compress2;
     delete streamCompressor;
@@ -163,7 +172,18 @@ void fdsWriteFactorVec_v7(ofstream &myfile, int* intP, IStringWriter* blockRunne
     StreamCompressor* streamCompressor = new StreamCompositeCompressor(defaultCompress, compress2, compression);
     streamCompressor->CompressBufferSize(blockSize);
 
-    fdsStreamcompressed_v2(myfile, (char*) intP, nrOfRows, 4, streamCompressor, BLOCKSIZE_INT, annotation);
+    try
+    {
+      fdsStreamcompressed_v2(myfile, (char*) intP, nrOfRows, 4, streamCompressor, BLOCKSIZE_INT, annotation, FstColumnType::INT_32);
+    }
+    catch (...)
+    {
+      delete defaultCompress;
+      delete compress2;
+      delete streamCompressor;
+      throw;
+    }
+
     delete defaultCompress;
     delete compress2;
     delete streamCompressor;
@@ -176,7 +196,17 @@ void fdsWriteFactorVec_v7(ofstream &myfile, int* intP, IStringWriter* blockRunne
   Compressor* compress1 = new SingleCompressor(CompAlgo::LZ4_SHUF4, 0);
   StreamCompressor* streamCompressor = new StreamLinearCompressor(compress1, compression);
   streamCompressor->CompressBufferSize(blockSize);
-  fdsStreamcompressed_v2(myfile, (char*) intP, nrOfRows, 4, streamCompressor, BLOCKSIZE_INT, annotation);
+  try
+  {
+    fdsStreamcompressed_v2(myfile, (char*) intP, nrOfRows, 4, streamCompressor, BLOCKSIZE_INT, annotation, FstColumnType::INT_32);
+  }
+  catch (...)
+  {
+    delete compress1;
+    delete streamCompressor;
+    throw;
+  }
+
   delete compress1;
   delete streamCompressor;
 
@@ -184,17 +214,41 @@ void fdsWriteFactorVec_v7(ofstream &myfile, int* intP, IStringWriter* blockRunne
 }
 
 
+// Read the level strings of a stored factor vector, the level vector is allocated here
+unsigned int fdsReadFactorLevels_v7(IFstSource &myfile, IStringColumn* blockReader, unsigned long long blockPos)
+{
+  // Get vector meta data
+  char meta[HEADER_SIZE_FACTOR];
+  myfile.Read(meta, blockPos, HEADER_SIZE_FACTOR);
+  unsigned int* versionNr = (unsigned int*) &meta;
+
+  if (*versionNr > VERSION_NUMBER_FACTOR)
+  {
+	  throw runtime_error("Incompatible fst file.");
+  }
+
+  unsigned int* nrOfLevels = (unsigned int*) &meta[4];
+
+  blockReader->AllocateVec(*nrOfLevels);
+
+  if (*nrOfLevels > 0)
+  {
+    fdsReadCharVec_v6(myfile, blockReader, blockPos + HEADER_SIZE_FACTOR, 0, *nrOfLevels, *nrOfLevels, 0);  // get level strings
+  }
+
+  return *nrOfLevels;
+}
+
+
 // Parameter 'startRow' is zero based
 // Data vector intP is expected to point to a memory block 4 * size bytes long
-void fdsReadFactorVec_v7(istream &myfile, IStringColumn* blockReader, int* intP, unsigned long long blockPos, unsigned long long startRow,
+// The level strings are skipped when blockReader is a nullptr (e.g. for all but the first chunk of a multi-chunk table)
+void fdsReadFactorVec_v7(IFstSource &myfile, IStringColumn* blockReader, int* intP, unsigned long long blockPos, unsigned long long startRow,
   unsigned long long length, unsigned long long size)
 {
-  // Jump to factor level
-  myfile.seekg(blockPos);
-
   // Get vector meta data
   char meta[HEADER_SIZE_FACTOR];
-  myfile.read(meta, HEADER_SIZE_FACTOR);
+  myfile.Read(meta, blockPos, HEADER_SIZE_FACTOR);
   unsigned int* versionNr = (unsigned int*) &meta;
 
   if (*versionNr > VERSION_NUMBER_FACTOR)
@@ -209,12 +263,16 @@ void fdsReadFactorVec_v7(istream &myfile, IStringColumn* blockReader, int* intP,
 
   if (*nrOfLevels > 0)
   {
-    fdsReadCharVec_v6(myfile, blockReader, blockPos + HEADER_SIZE_FACTOR, 0, *nrOfLevels, *nrOfLevels);  // get level strings
+    if (blockReader != nullptr)
+    {
+      blockReader->AllocateVec(*nrOfLevels);
+      fdsReadCharVec_v6(myfile, blockReader, blockPos + HEADER_SIZE_FACTOR, 0, *nrOfLevels, *nrOfLevels, 0);  // get level strings
+    }
   }
   else
   {
 	  // Create empty level vector
-	  blockReader->AllocateVec(0);
+	  if (blockReader != nullptr) blockReader->AllocateVec(0);
 
 	  // All level values must be NA, so we need only the number of levels
 	  for (unsigned int pos = 0; pos < length; pos++)
@@ -232,3 +290,67 @@ void fdsReadFactorVec_v7(istream &myfile, IStringColumn* blockReader, int* intP,
 
   return;
 }
+
+
+bool fdsReadFactorZoneMap_v7(IFstSource &myfile, unsigned long long blockPos, unsigned long long size, unsigned long long rowOffset,
+  vector<ZoneMapBlock> &blocks)
+{
+  // Get vector meta data
+  char meta[HEADER_SIZE_FACTOR];
+  myfile.Read(meta, blockPos, HEADER_SIZE_FACTOR);
+  unsigned int* versionNr = (unsigned int*) &meta;
+
+  if (*versionNr > VERSION_NUMBER_FACTOR)
+  {
+	  throw runtime_error("Incompatible fst file.");
+  }
+
+  unsigned int* nrOfLevels = (unsigned int*) &meta[4];
+  unsigned long long* levelVecPos = (unsigned long long*) &meta[8];
+
+  // Without levels all values are NA and no level values are stored
+  if (*nrOfLevels == 0)
+  {
+    ZoneMapBlock block;
+    block.startRow = rowOffset;
+    block.nrOfRows = size;
+    block.naCount = size;
+    block.hasStatistics = true;
+    block.minValue.intValue = 0;
+    block.maxValue.intValue = 0;
+
+    blocks.push_back(block);
+
+    return true;
+  }
+
+  return fdsReadZoneMap_v2(myfile, *levelVecPos, size, rowOffset, 4, blocks);
+}
+
+
+bool fdsPlanFactorVec_v7(FstReadPlanner &planner, unsigned long long blockPos, unsigned long long startRow,
+  unsigned long long length, unsigned long long size, bool withLevels)
+{
+  if (!planner.Require(blockPos, HEADER_SIZE_FACTOR)) return false;
+
+  char meta[HEADER_SIZE_FACTOR];
+  planner.Read(meta, blockPos, HEADER_SIZE_FACTOR);
+
+  unsigned int* versionNr = (unsigned int*) &meta;
+  unsigned int* nrOfLevels = (unsigned int*) &meta[4];
+  unsigned long long* levelVecPos = (unsigned long long*) &meta[8];
+
+  // an incompatible vector is reported by the reader, without levels no level codes are stored
+  if (*versionNr > VERSION_NUMBER_FACTOR || *nrOfLevels == 0) return true;
+
+  bool isPlanned = true;
+
+  if (withLevels)
+  {
+    isPlanned = fdsPlanCharVec_v6(planner, blockPos + HEADER_SIZE_FACTOR, 0, *nrOfLevels, *nrOfLevels);
+  }
+
+  if (length == 0) return isPlanned;
+
+  return fdsPlanColumn_v2(planner, *levelVecPos, startRow, length, size, 4) && isPlanned;
+}
@@ -39,18 +39,39 @@
 
 #include <iostream>
 #include <fstream>
+#include <vector>
 
 #include <interface/istringwriter.h>
 #include <interface/ifstcolumn.h>
+#include <interface/fstzonemap.h>
+#include <interface/ifstsource.h>
+#include <interface/ifstsink.h>
+#include <interface/fstreadplanner.h>
 
 
-void fdsWriteFactorVec_v7(std::ofstream &myfile, int* intP, IStringWriter* blockRunner, unsigned long long size, unsigned int compression,
+void fdsWriteFactorVec_v7(IFstSink &myfile, int* intP, IStringWriter* blockRunner, unsigned long long size, unsigned int compression,
 	StringEncoding stringEncoding, std::string annotation);
 
 
-// Parameter 'startRow' is zero based.
-void fdsReadFactorVec_v7(std::istream &myfile, IStringColumn* blockReader, int* intP, unsigned long long blockPos, unsigned long long startRow,
+// Read only the level strings of a factor vector, returns the number of levels.
+unsigned int fdsReadFactorLevels_v7(IFstSource &myfile, IStringColumn* blockReader, unsigned long long blockPos);
+
+
+// Parameter 'startRow' is zero based. Levels are skipped when blockReader is a nullptr.
+void fdsReadFactorVec_v7(IFstSource &myfile, IStringColumn* blockReader, int* intP, unsigned long long blockPos, unsigned long long startRow,
   unsigned long long length, unsigned long long size);
 
 
+// Read the per-block statistics of the level codes without reading the codes. Returns false if the codes were
+// stored without a zone map.
+bool fdsReadFactorZoneMap_v7(IFstSource &myfile, unsigned long long blockPos, unsigned long long size, unsigned long long rowOffset,
+  std::vector<ZoneMapBlock> &blocks);
+
+
+// Plan the byte ranges that fdsReadFactorVec_v7 reads for a range of rows (see fdsPlanColumn_v2), the level strings
+// are included when withLevels is set. With a length of zero only the levels are planned.
+bool fdsPlanFactorVec_v7(FstReadPlanner &planner, unsigned long long blockPos, unsigned long long startRow,
+  unsigned long long length, unsigned long long size, bool withLevels);
+
+
 #endif  // FACTOR_v7_H
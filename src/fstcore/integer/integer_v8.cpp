@@ -41,13 +41,13 @@
 using namespace std;
 
 
-void fdsWriteIntVec_v8(ofstream &myfile, int* integerVector, unsigned long long nrOfRows, unsigned int compression, std::string annotation)
+void fdsWriteIntVec_v8(IFstSink &myfile, int* integerVector, unsigned long long nrOfRows, unsigned int compression, std::string annotation)
 {
   int blockSize = 4 * BLOCKSIZE_INT;  // block size in bytes
 
   if (compression == 0)
   {
-    return fdsStreamUncompressed_v2(myfile, reinterpret_cast<char*>(integerVector), nrOfRows, 4, BLOCKSIZE_INT, nullptr, annotation);
+    return fdsStreamUncompressed_v2(myfile, reinterpret_cast<char*>(integerVector), nrOfRows, 4, BLOCKSIZE_INT, nullptr, annotation, FstColumnType::INT_32);
   }
 
   if (compression <= 50)  // low compression: linear mix of uncompressed and LZ4_SHUF
@@ -57,7 +57,16 @@ void fdsWriteIntVec_v8(ofstream &myfile, int* integerVector, unsigned long long
     StreamCompressor* streamCompressor = new StreamLinearCompressor(compress1, 2 * compression);
 
     streamCompressor->CompressBufferSize(blockSize);
-    fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(integerVector), nrOfRows, 4, streamCompressor, BLOCKSIZE_INT, annotation);
+    try
+    {
+      fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(integerVector), nrOfRows, 4, streamCompressor, BLOCKSIZE_INT, annotation, FstColumnType::INT_32);
+    }
+    catch (...)
+    {
+      delete compress1;
+      delete streamCompressor;
+      throw;
+    }
 
     delete compress1;
     delete streamCompressor;
@@ -68,7 +77,17 @@ void fdsWriteIntVec_v8(ofstream &myfile, int* integerVector, unsigned long long
   Compressor* compress2 = new SingleCompressor(CompAlgo::ZSTD_SHUF4, 0);
   StreamCompressor* streamCompressor = new StreamCompositeCompressor(compress1, compress2, 2 * (compression - 50));
   streamCompressor->CompressBufferSize(blockSize);
-  fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(integerVector), nrOfRows, 4, streamCompressor, BLOCKSIZE_INT, annotation);
+  try
+  {
+    fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(integerVector), nrOfRows, 4, streamCompressor, BLOCKSIZE_INT, annotation, FstColumnType::INT_32);
+  }
+  catch (...)
+  {
+    delete compress1;
+    delete compress2;
+    delete streamCompressor;
+    throw;
+  }
 
   delete compress1;
   delete compress2;
@@ -78,8 +97,15 @@ void fdsWriteIntVec_v8(ofstream &myfile, int* integerVector, unsigned long long
 }
 
 
-void fdsReadIntVec_v8(istream &myfile, int* integerVec, unsigned long long blockPos, unsigned long long startRow,
+void fdsReadIntVec_v8(IFstSource &myfile, int* integerVec, unsigned long long blockPos, unsigned long long startRow,
   unsigned long long length, unsigned long long size, std::string &annotation)
 {
   return fdsReadColumn_v2(myfile, reinterpret_cast<char*>(integerVec), blockPos, startRow, length, size, 4, annotation, BATCH_SIZE_READ_INT);
 }
+
+
+bool fdsReadIntZoneMap_v8(IFstSource &myfile, unsigned long long blockPos, unsigned long long size, unsigned long long rowOffset,
+  vector<ZoneMapBlock> &blocks)
+{
+  return fdsReadZoneMap_v2(myfile, blockPos, size, rowOffset, 4, blocks);
+}
@@ -39,11 +39,21 @@
 
 #include <ostream>
 #include <istream>
+#include <vector>
 
+#include <interface/fstzonemap.h>
+#include <interface/ifstsource.h>
+#include <interface/ifstsink.h>
 
-void fdsWriteIntVec_v8(std::ofstream &myfile, int* integerVector, unsigned long long nrOfRows, unsigned int compression, std::string annotation);
 
-void fdsReadIntVec_v8(std::istream &myfile, int* integerVector, unsigned long long blockPos, unsigned long long startRow,
+void fdsWriteIntVec_v8(IFstSink &myfile, int* integerVector, unsigned long long nrOfRows, unsigned int compression, std::string annotation);
+
+void fdsReadIntVec_v8(IFstSource &myfile, int* integerVector, unsigned long long blockPos, unsigned long long startRow,
   unsigned long long length, unsigned long long size, std::string &annotation);
 
+// Read the per-block statistics of a stored vector without reading the vector data.
+// Returns false if the vector was stored without a zone map.
+bool fdsReadIntZoneMap_v8(IFstSource &myfile, unsigned long long blockPos, unsigned long long size, unsigned long long rowOffset,
+  std::vector<ZoneMapBlock> &blocks);
+
 #endif // INTEGER_V8_H
@@ -41,13 +41,13 @@
 using namespace std;
 
 
-void fdsWriteInt64Vec_v11(ofstream &myfile, long long* int64Vector, unsigned long long nrOfRows, unsigned int compression, std::string annotation)
+void fdsWriteInt64Vec_v11(IFstSink &myfile, long long* int64Vector, unsigned long long nrOfRows, unsigned int compression, std::string annotation)
 {
   int blockSize = 8 * BLOCKSIZE_INT64;  // block size in bytes
 
   if (compression == 0)
   {
-    return fdsStreamUncompressed_v2(myfile, reinterpret_cast<char*>(int64Vector), nrOfRows, 8, BLOCKSIZE_INT64, nullptr, annotation);
+    return fdsStreamUncompressed_v2(myfile, reinterpret_cast<char*>(int64Vector), nrOfRows, 8, BLOCKSIZE_INT64, nullptr, annotation, FstColumnType::INT_64);
   }
 
   if (compression <= 50)  // low compression: linear mix of uncompressed and LZ4_SHUF8
@@ -55,7 +55,16 @@ void fdsWriteInt64Vec_v11(ofstream &myfile, long long* int64Vector, unsigned lon
     Compressor* compress1 = new SingleCompressor(CompAlgo::LZ4_SHUF8, 2 * compression);
     StreamCompressor* streamCompressor = new StreamLinearCompressor(compress1, 2 * compression);
     streamCompressor->CompressBufferSize(blockSize);
-    fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(int64Vector), nrOfRows, 8, streamCompressor, BLOCKSIZE_INT64, annotation);
+    try
+    {
+      fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(int64Vector), nrOfRows, 8, streamCompressor, BLOCKSIZE_INT64, annotation, FstColumnType::INT_64);
+    }
+    catch (...)
+    {
+      delete compress1;
+      delete streamCompressor;
+      throw;
+    }
 
     delete compress1;
     delete streamCompressor;
@@ -68,7 +77,17 @@ void fdsWriteInt64Vec_v11(ofstream &myfile, long long* int64Vector, unsigned lon
   Compressor* compress2 = new SingleCompressor(CompAlgo::ZSTD_SHUF8, compression - 50);
   StreamCompressor* streamCompressor = new StreamCompositeCompressor(compress1, compress2, 2 * (compression - 50));
   streamCompressor->CompressBufferSize(blockSize);
-  fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(int64Vector), nrOfRows, 8, streamCompressor, BLOCKSIZE_INT64, annotation);
+  try
+  {
+    fdsStreamcompressed_v2(myfile, reinterpret_cast<char*>(int64Vector), nrOfRows, 8, streamCompressor, BLOCKSIZE_INT64, annotation, FstColumnType::INT_64);
+  }
+  catch (...)
+  {
+    delete compress1;
+    delete compress2;
+    delete streamCompressor;
+    throw;
+  }
 
   delete compress1;
   delete compress2;
@@ -78,10 +97,17 @@ void fdsWriteInt64Vec_v11(ofstream &myfile, long long* int64Vector, unsigned lon
 }
 
 
-void fdsReadInt64Vec_v11(istream &myfile, long long* int64Vector, unsigned long long blockPos, unsigned long long startRow,
+void fdsReadInt64Vec_v11(IFstSource &myfile, long long* int64Vector, unsigned long long blockPos, unsigned long long startRow,
   unsigned long long length, unsigned long long size)
 {
   std::string annotation;
 
   return fdsReadColumn_v2(myfile, reinterpret_cast<char*>(int64Vector), blockPos, startRow, length, size, 8, annotation, BATCH_SIZE_READ_INT64);
 }
+
+
+bool fdsReadInt64ZoneMap_v11(IFstSource &myfile, unsigned long long blockPos, unsigned long long size, unsigned long long rowOffset,
+  vector<ZoneMapBlock> &blocks)
+{
+  return fdsReadZoneMap_v2(myfile, blockPos, size, rowOffset, 8, blocks);
+}
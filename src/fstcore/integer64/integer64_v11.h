@@ -38,11 +38,22 @@
 
 // System libraries
 #include <ostream>
+#include <istream>
+#include <vector>
 
+#include <interface/fstzonemap.h>
+#include <interface/ifstsource.h>
+#include <interface/ifstsink.h>
 
-void fdsWriteInt64Vec_v11(std::ofstream &myfile, long long* int64Vector, unsigned long long nrOfRows, unsigned int compression, std::string annotation);
 
-void fdsReadInt64Vec_v11(std::istream &myfile, long long* int64Vector, unsigned long long blockPos, unsigned long long startRow,
+void fdsWriteInt64Vec_v11(IFstSink &myfile, long long* int64Vector, unsigned long long nrOfRows, unsigned int compression, std::string annotation);
+
+void fdsReadInt64Vec_v11(IFstSource &myfile, long long* int64Vector, unsigned long long blockPos, unsigned long long startRow,
   unsigned long long length, unsigned long long size);
 
+// Read the per-block statistics of a stored vector without reading the vector data.
+// Returns false if the vector was stored without a zone map.
+bool fdsReadInt64ZoneMap_v11(IFstSource &myfile, unsigned long long blockPos, unsigned long long size, unsigned long long rowOffset,
+  std::vector<ZoneMapBlock> &blocks);
+
 #endif // INT64_V11_H
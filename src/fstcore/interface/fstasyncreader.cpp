@@ -0,0 +1,156 @@
+/*
+  fst - An R-package for ultra fast storage and retrieval of datasets.
+  Copyright (C) 2017, Mark AJ Klik
+
+  BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following disclaimer
+    in the documentation and/or other materials provided with the
+    distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+    A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  You can contact the author at :
+  - fst source repository : https://github.com/fstPackage/fst
+*/
+
+
+#include <interface/fstasyncreader.h>
+#include <interface/fstdefines.h>
+
+using namespace std;
+
+
+// States of the read of a slot
+#define SLOT_READ_PENDING  0
+#define SLOT_READ_DONE     1
+#define SLOT_READ_FAILED   2
+
+
+// Queue depth used by all column reads, 0 disables the asynchronous reads
+static int FstReadQueueDepth = READ_QUEUE_DEPTH;
+
+
+int GetFstReadQueueDepth()
+{
+  return FstReadQueueDepth;
+}
+
+
+int SetFstReadQueueDepth(int queueDepth)
+{
+  int previousDepth = FstReadQueueDepth;
+  FstReadQueueDepth = queueDepth < 0 ? 0 : queueDepth;
+
+  return previousDepth;
+}
+
+
+FstAsyncReader::FstAsyncReader(IFstSource &source, int nrOfSlots, int nrOfThreads)
+{
+  this->source    = &source;
+  this->isStopped = false;
+
+  slotTags.assign(nrOfSlots, -1);
+  slotStates.assign(nrOfSlots, SLOT_READ_DONE);
+
+  for (int threadNr = 0; threadNr < nrOfThreads; ++threadNr)
+  {
+    ioThreads.push_back(thread(&FstAsyncReader::Run, this));
+  }
+}
+
+
+FstAsyncReader::~FstAsyncReader()
+{
+  {
+    lock_guard<mutex> lock(readMutex);
+    isStopped = true;
+  }
+
+  requestCondition.notify_all();
+
+  for (unsigned int threadNr = 0; threadNr < ioThreads.size(); ++threadNr)
+  {
+    ioThreads[threadNr].join();
+  }
+}
+
+
+void FstAsyncReader::Submit(int slot, long long tag, char* buffer, unsigned long long pos, unsigned long long length)
+{
+  {
+    lock_guard<mutex> lock(readMutex);
+
+    slotTags[slot]   = tag;
+    slotStates[slot] = SLOT_READ_PENDING;
+
+    ReadRequest request;
+    request.buffer = buffer;
+    request.pos    = pos;
+    request.length = length;
+    request.slot   = slot;
+    request.tag    = tag;
+
+    requests.push_back(request);
+  }
+
+  requestCondition.notify_one();
+}
+
+
+bool FstAsyncReader::Wait(int slot, long long tag)
+{
+  unique_lock<mutex> lock(readMutex);
+
+  doneCondition.wait(lock, [&] { return slotTags[slot] == tag && slotStates[slot] != SLOT_READ_PENDING; });
+
+  return slotStates[slot] == SLOT_READ_DONE;
+}
+
+
+// Main loop of an I/O thread: take the oldest request, read it and signal its completion
+void FstAsyncReader::Run()
+{
+  unique_lock<mutex> lock(readMutex);
+
+  while (true)
+  {
+    requestCondition.wait(lock, [&] { return isStopped || !requests.empty(); });
+
+    // remaining requests are completed before stopping, their buffers can't be released earlier
+    if (requests.empty()) return;
+
+    ReadRequest request = requests.front();
+    requests.pop_front();
+
+    lock.unlock();
+    bool isRead = source->Read(request.buffer, request.pos, request.length);
+    lock.lock();
+
+    if (slotTags[request.slot] == request.tag)
+    {
+      slotStates[request.slot] = isRead ? SLOT_READ_DONE : SLOT_READ_FAILED;
+    }
+
+    doneCondition.notify_all();
+  }
+}
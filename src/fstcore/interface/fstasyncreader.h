@@ -0,0 +1,132 @@
+/*
+  fst - An R-package for ultra fast storage and retrieval of datasets.
+  Copyright (C) 2017, Mark AJ Klik
+
+  BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following disclaimer
+    in the documentation and/or other materials provided with the
+    distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+    A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  You can contact the author at :
+  - fst source repository : https://github.com/fstPackage/fst
+*/
+
+
+#ifndef FST_ASYNC_READER_H
+#define FST_ASYNC_READER_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include <interface/ifstsource.h>
+
+
+/**
+ * \brief Get the number of concurrent read requests that are issued ahead of the decompression of the column blocks
+ * \return queue depth, 0 if the blocks are read by the decompression threads themselves
+ */
+int GetFstReadQueueDepth();
+
+/**
+ * \brief Set the number of concurrent read requests that are issued ahead of the decompression of the column blocks
+ *
+ * Block batches of a column, uncompressed column data and the ranges fetched by the read planner are read by that
+ * many I/O threads. Only used for sources that are not memory based (see IFstSource::Map), a memory mapped file or a
+ * buffer is decompressed directly.
+ * \param queueDepth number of outstanding reads, 0 to disable the asynchronous reads
+ * \return the previous queue depth
+ */
+int SetFstReadQueueDepth(int queueDepth);
+
+
+/**
+ * \brief Reads byte ranges of a source on a pool of I/O threads, so that reads can be issued before their data is used.
+ *
+ * Each read targets a slot, a buffer owned by the caller. A read is submitted with Submit() and its completion is
+ * awaited with Wait(). With reads submitted well ahead of their use, the latency of a request is hidden behind the
+ * processing of earlier data and a slow source is read with multiple concurrent requests.
+ *
+ * The I/O threads use blocking positional reads (IFstSource::Read), so the source must allow concurrent reads. The
+ * threads are stopped when the reader is destroyed, after all submitted reads have completed.
+ */
+class FstAsyncReader
+{
+  // A submitted read
+  struct ReadRequest
+  {
+    char* buffer;
+    unsigned long long pos;
+    unsigned long long length;
+    int slot;
+    long long tag;
+  };
+
+  IFstSource* source;
+
+  std::mutex readMutex;
+  std::condition_variable requestCondition;  // signals new requests and shutdown to the I/O threads
+  std::condition_variable doneCondition;     // signals completed reads to the waiting threads
+  std::deque<ReadRequest> requests;          // submitted reads that are not started yet
+  std::vector<long long> slotTags;           // tag of the last read submitted to each slot
+  std::vector<int> slotStates;               // state of the last read of each slot
+  std::vector<std::thread> ioThreads;
+  bool isStopped;
+
+  void Run();
+
+public:
+  /**
+   * \brief Create a reader and start its I/O threads
+   * \param source source that is read, owned by the caller
+   * \param nrOfSlots number of slots that reads can be submitted to
+   * \param nrOfThreads number of I/O threads, the maximum number of concurrent requests on the source
+   */
+  FstAsyncReader(IFstSource &source, int nrOfSlots, int nrOfThreads);
+
+  ~FstAsyncReader();
+
+  /**
+   * \brief Submit a read to a slot, the slot should not have a read in progress
+   * \param slot slot that is read into
+   * \param tag identifies the read for a later Wait()
+   * \param buffer target of the read, should stay valid until the read is completed
+   * \param pos position of the range in the source
+   * \param length length of the range in bytes
+   */
+  void Submit(int slot, long long tag, char* buffer, unsigned long long pos, unsigned long long length);
+
+  /**
+   * \brief Wait until the read with a specific tag is submitted to a slot and completed
+   * \param slot slot of the read
+   * \param tag tag of the read, can be submitted by another thread after the call to Wait()
+   * \return false if the read of the source failed
+   */
+  bool Wait(int slot, long long tag);
+};
+
+
+#endif // FST_ASYNC_READER_H
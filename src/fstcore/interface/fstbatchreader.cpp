@@ -0,0 +1,566 @@
+/*
+  fst - An R-package for ultra fast storage and retrieval of datasets.
+  Copyright (C) 2017, Mark AJ Klik
+
+  BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following disclaimer
+    in the documentation and/or other materials provided with the
+    distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+    A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  You can contact the author at :
+  - fst source repository : https://github.com/fstPackage/fst
+*/
+
+
+
+#include <cstring>
+#include <stdexcept>
+
+#include <interface/fstbatchreader.h>
+#include <interface/fstdefines.h>
+
+
+using namespace std;
+
+
+void FstBatchStringColumn::AllocateVec(unsigned long long vecLength)
+{
+  starts.assign(vecLength, 0);
+  lengths.assign(vecLength, FST_BATCH_NA_LENGTH);
+
+  // NA elements point to the empty string at the start of the buffer
+  chars.clear();
+  chars.push_back(0);
+}
+
+
+void FstBatchStringColumn::BufferToVec(unsigned long long nrOfElements, unsigned long long startElem,
+  unsigned long long endElem, unsigned long long vecOffset, const unsigned int* sizeMeta, const char* buf)
+{
+  unsigned long long nrOfNAInts = 1 + nrOfElements / 32;  // last bit is NA flag
+  const unsigned int* bitsNA = &sizeMeta[nrOfElements];
+  bool hasNA = (bitsNA[nrOfNAInts - 1] & (1 << (nrOfElements % 32))) != 0;
+  unsigned long long pos = 0;
+
+  if (startElem != 0)
+  {
+    pos = sizeMeta[startElem - 1];  // offset previous element
+  }
+
+  for (unsigned long long blockElem = startElem; blockElem <= endElem; ++blockElem)
+  {
+    unsigned long long newPos = sizeMeta[blockElem];
+    unsigned long long elementNr = vecOffset + blockElem - startElem;
+
+    if (hasNA && ((bitsNA[blockElem / 32] >> (blockElem % 32)) & 1) != 0)
+    {
+      starts[elementNr] = 0;
+      lengths[elementNr] = FST_BATCH_NA_LENGTH;
+      pos = newPos;
+      continue;
+    }
+
+    starts[elementNr] = chars.size();
+    lengths[elementNr] = static_cast<unsigned int>(newPos - pos);
+    chars.insert(chars.end(), buf + pos, buf + newPos);
+    chars.push_back(0);
+    pos = newPos;
+  }
+}
+
+
+void FstBatchStringColumn::CopyTo(IStringColumn* target) const
+{
+  unsigned long long vecLength = lengths.size();
+
+  target->AllocateVec(vecLength);
+  target->SetEncoding(encoding);
+
+  // string sizes and NA bits of a single block
+  unsigned int sizeMeta[BLOCKSIZE_CHAR + 1 + BLOCKSIZE_CHAR / 32];
+  vector<char> buf;
+
+  for (unsigned long long blockStart = 0; blockStart < vecLength; blockStart += BLOCKSIZE_CHAR)
+  {
+    unsigned long long nrOfElements = vecLength - blockStart;
+    if (nrOfElements > BLOCKSIZE_CHAR) nrOfElements = BLOCKSIZE_CHAR;
+
+    unsigned long long nrOfNAInts = 1 + nrOfElements / 32;
+    unsigned int* bitsNA = &sizeMeta[nrOfElements];
+    memset(bitsNA, 0, nrOfNAInts * 4);
+
+    buf.clear();
+    bool hasNA = false;
+
+    for (unsigned long long blockElem = 0; blockElem < nrOfElements; ++blockElem)
+    {
+      unsigned long long elementNr = blockStart + blockElem;
+
+      if (lengths[elementNr] == FST_BATCH_NA_LENGTH)
+      {
+        bitsNA[blockElem / 32] |= 1u << (blockElem % 32);
+        hasNA = true;
+      }
+      else
+      {
+        const char* str = &chars[starts[elementNr]];
+        buf.insert(buf.end(), str, str + lengths[elementNr]);
+      }
+
+      sizeMeta[blockElem] = static_cast<unsigned int>(buf.size());
+    }
+
+    if (hasNA) bitsNA[nrOfNAInts - 1] |= 1u << (nrOfElements % 32);
+
+    buf.push_back(0);  // the buffer is never empty
+    target->BufferToVec(nrOfElements, 0, nrOfElements - 1, blockStart, sizeMeta, buf.data());
+  }
+}
+
+
+// Native columns of a batch. The column data is handed over to the table when the column is set, columns that are
+// not set release their data when they are deleted.
+
+class BatchColumnData
+{
+public:
+  FstBatchColumn* column;
+
+  BatchColumnData(int colType, int nrOfRows, int elementSize, FstColumnAttribute attribute, short int scale)
+  {
+    this->column = new FstBatchColumn();
+    column->colType = colType;
+    column->attribute = attribute;
+    column->scale = scale;
+
+    if (elementSize > 0)
+    {
+      column->data = new char[static_cast<unsigned long long>(nrOfRows) * elementSize];
+    }
+  }
+
+  ~BatchColumnData() { delete column; }
+
+  FstBatchColumn* Release()
+  {
+    FstBatchColumn* released = column;
+    column = nullptr;
+    return released;
+  }
+};
+
+
+class BatchFactorColumn : public IFactorColumn, public BatchColumnData
+{
+public:
+  BatchFactorColumn(int nrOfRows, FstColumnAttribute attribute) : BatchColumnData(7, nrOfRows, 4, attribute, 0) {}
+
+  int* LevelData() { return reinterpret_cast<int*>(column->data); }
+
+  IStringColumn* Levels() { return &column->strings; }
+};
+
+
+class BatchIntegerColumn : public IIntegerColumn, public BatchColumnData
+{
+public:
+  BatchIntegerColumn(int nrOfRows, FstColumnAttribute attribute, short int scale) :
+    BatchColumnData(8, nrOfRows, 4, attribute, scale) {}
+
+  int* Data() { return reinterpret_cast<int*>(column->data); }
+};
+
+
+class BatchDoubleColumn : public IDoubleColumn, public BatchColumnData
+{
+public:
+  BatchDoubleColumn(int nrOfRows, FstColumnAttribute attribute, short int scale) :
+    BatchColumnData(9, nrOfRows, 8, attribute, scale) {}
+
+  double* Data() { return reinterpret_cast<double*>(column->data); }
+
+  void Annotate(std::string annotation) { column->annotation = annotation; }
+};
+
+
+class BatchLogicalColumn : public ILogicalColumn, public BatchColumnData
+{
+public:
+  BatchLogicalColumn(int nrOfRows, FstColumnAttribute attribute) : BatchColumnData(10, nrOfRows, 4, attribute, 0) {}
+
+  int* Data() { return reinterpret_cast<int*>(column->data); }
+};
+
+
+class BatchInt64Column : public IInt64Column, public BatchColumnData
+{
+public:
+  BatchInt64Column(int nrOfRows, FstColumnAttribute attribute, short int scale) :
+    BatchColumnData(11, nrOfRows, 8, attribute, scale) {}
+
+  long long* Data() { return reinterpret_cast<long long*>(column->data); }
+};
+
+
+class BatchByteColumn : public IByteColumn, public BatchColumnData
+{
+public:
+  BatchByteColumn(int nrOfRows, FstColumnAttribute attribute) : BatchColumnData(12, nrOfRows, 1, attribute, 0) {}
+
+  char* Data() { return column->data; }
+};
+
+
+IFactorColumn* FstBatchColumnFactory::CreateFactorColumn(int nrOfRows, FstColumnAttribute columnAttribute)
+{
+  return new BatchFactorColumn(nrOfRows, columnAttribute);
+}
+
+
+ILogicalColumn* FstBatchColumnFactory::CreateLogicalColumn(int nrOfRows, FstColumnAttribute columnAttribute)
+{
+  return new BatchLogicalColumn(nrOfRows, columnAttribute);
+}
+
+
+IDoubleColumn* FstBatchColumnFactory::CreateDoubleColumn(int nrOfRows, FstColumnAttribute columnAttribute,
+  short int scale)
+{
+  return new BatchDoubleColumn(nrOfRows, columnAttribute, scale);
+}
+
+
+IIntegerColumn* FstBatchColumnFactory::CreateIntegerColumn(int nrOfRows, FstColumnAttribute columnAttribute,
+  short int scale)
+{
+  return new BatchIntegerColumn(nrOfRows, columnAttribute, scale);
+}
+
+
+IByteColumn* FstBatchColumnFactory::CreateByteColumn(int nrOfRows, FstColumnAttribute columnAttribute)
+{
+  return new BatchByteColumn(nrOfRows, columnAttribute);
+}
+
+
+IInt64Column* FstBatchColumnFactory::CreateInt64Column(int nrOfRows, FstColumnAttribute columnAttribute,
+  short int scale)
+{
+  return new BatchInt64Column(nrOfRows, columnAttribute, scale);
+}
+
+
+IStringColumn* FstBatchColumnFactory::CreateStringColumn(int nrOfRows, FstColumnAttribute columnAttribute)
+{
+  return new FstBatchStringColumn();
+}
+
+
+IStringArray* FstBatchColumnFactory::CreateStringArray()
+{
+  return new FstBatchStringArray();
+}
+
+
+FstBatchTable::~FstBatchTable()
+{
+  for (vector<FstBatchColumn*>::iterator colIt = columns.begin(); colIt != columns.end(); ++colIt)
+  {
+    delete *colIt;
+  }
+}
+
+
+void FstBatchTable::InitTable(unsigned int nrOfCols, unsigned long long nrOfRows)
+{
+  this->nrOfRows = nrOfRows;
+  columns.assign(nrOfCols, nullptr);
+}
+
+
+void FstBatchTable::SetStringColumn(IStringColumn* stringColumn, int colNr)
+{
+  FstBatchColumn* column = new FstBatchColumn();
+  column->colType = 6;
+  column->attribute = FstColumnAttribute::CHARACTER_BASE;
+  column->scale = 0;
+  column->strings = std::move(*static_cast<FstBatchStringColumn*>(stringColumn));
+  columns[colNr] = column;
+}
+
+
+void FstBatchTable::SetLogicalColumn(ILogicalColumn* logicalColumn, int colNr)
+{
+  columns[colNr] = static_cast<BatchLogicalColumn*>(logicalColumn)->Release();
+}
+
+
+void FstBatchTable::SetIntegerColumn(IIntegerColumn* integerColumn, int colNr, std::string &annotation)
+{
+  columns[colNr] = static_cast<BatchIntegerColumn*>(integerColumn)->Release();
+  columns[colNr]->annotation = annotation;
+}
+
+
+void FstBatchTable::SetDoubleColumn(IDoubleColumn* doubleColumn, int colNr, std::string &annotation)
+{
+  columns[colNr] = static_cast<BatchDoubleColumn*>(doubleColumn)->Release();
+  columns[colNr]->annotation = annotation;
+}
+
+
+void FstBatchTable::SetFactorColumn(IFactorColumn* factorColumn, int colNr)
+{
+  columns[colNr] = static_cast<BatchFactorColumn*>(factorColumn)->Release();
+}
+
+
+void FstBatchTable::SetInt64Column(IInt64Column* int64Column, int colNr)
+{
+  columns[colNr] = static_cast<BatchInt64Column*>(int64Column)->Release();
+}
+
+
+void FstBatchTable::SetByteColumn(IByteColumn* byteColumn, int colNr)
+{
+  columns[colNr] = static_cast<BatchByteColumn*>(byteColumn)->Release();
+}
+
+
+void FstBatchTable::CopyTo(IFstTable &tableReader, IColumnFactory* columnFactory) const
+{
+  int nrOfCols = static_cast<int>(columns.size());
+  int length = static_cast<int>(nrOfRows);
+
+  tableReader.InitTable(nrOfCols, nrOfRows);
+
+  // Each column is created, filled and handed to the table before the next column is created
+  for (int colNr = 0; colNr < nrOfCols; ++colNr)
+  {
+    const FstBatchColumn* column = columns[colNr];
+    string annotation = column->annotation;
+
+    switch (column->colType)
+    {
+      case 6:
+      {
+        IStringColumn* stringColumn = columnFactory->CreateStringColumn(length, column->attribute);
+        column->strings.CopyTo(stringColumn);
+        tableReader.SetStringColumn(stringColumn, colNr);
+        delete stringColumn;
+        break;
+      }
+
+      case 7:
+      {
+        IFactorColumn* factorColumn = columnFactory->CreateFactorColumn(length, column->attribute);
+        memcpy(factorColumn->LevelData(), column->data, nrOfRows * 4);
+        column->strings.CopyTo(factorColumn->Levels());
+        tableReader.SetFactorColumn(factorColumn, colNr);
+        delete factorColumn;
+        break;
+      }
+
+      case 8:
+      {
+        IIntegerColumn* integerColumn = columnFactory->CreateIntegerColumn(length, column->attribute, column->scale);
+        memcpy(integerColumn->Data(), column->data, nrOfRows * 4);
+        tableReader.SetIntegerColumn(integerColumn, colNr, annotation);
+        delete integerColumn;
+        break;
+      }
+
+      case 9:
+      {
+        IDoubleColumn* doubleColumn = columnFactory->CreateDoubleColumn(length, column->attribute, column->scale);
+        memcpy(doubleColumn->Data(), column->data, nrOfRows * 8);
+        tableReader.SetDoubleColumn(doubleColumn, colNr, annotation);
+        delete doubleColumn;
+        break;
+      }
+
+      case 10:
+      {
+        ILogicalColumn* logicalColumn = columnFactory->CreateLogicalColumn(length, column->attribute);
+        memcpy(logicalColumn->Data(), column->data, nrOfRows * 4);
+        tableReader.SetLogicalColumn(logicalColumn, colNr);
+        delete logicalColumn;
+        break;
+      }
+
+      case 11:
+      {
+        IInt64Column* int64Column = columnFactory->CreateInt64Column(length, column->attribute, column->scale);
+        memcpy(int64Column->Data(), column->data, nrOfRows * 8);
+        tableReader.SetInt64Column(int64Column, colNr);
+        delete int64Column;
+        break;
+      }
+
+      default:  // 12
+      {
+        IByteColumn* byteColumn = columnFactory->CreateByteColumn(length, column->attribute);
+        memcpy(byteColumn->Data(), column->data, nrOfRows);
+        tableReader.SetByteColumn(byteColumn, colNr);
+        delete byteColumn;
+        break;
+      }
+    }
+  }
+}
+
+
+FstBatchReader::FstBatchReader(std::string fstFile, unsigned long long batchSize) : fstStore(fstFile)
+{
+  this->columnSelection = nullptr;
+  this->batchSize = batchSize;
+  this->nextRow = 1;
+  this->lastRow = 0;
+  this->isPrefetching = false;
+  this->prefetchedBatch = nullptr;
+}
+
+
+FstBatchReader::~FstBatchReader()
+{
+  StopPrefetch();
+
+  delete prefetchedBatch;
+  delete columnSelection;
+}
+
+
+void FstBatchReader::Open(IStringArray* columnSelection, long long startRow, long long endRow)
+{
+  if (batchSize == 0)
+  {
+    throw(runtime_error("The batch size should be larger than zero."));
+  }
+
+  fstStore.fstOpen();
+
+  FstBatchColumnFactory columnFactory;
+  fstStore.fstMeta(&columnFactory);
+
+  // the selected names are copied, the batches are read by a background thread
+  if (columnSelection != nullptr)
+  {
+    unsigned int nrOfSelect = columnSelection->Length();
+
+    this->columnSelection = new FstBatchStringArray();
+    this->columnSelection->AllocateArray(nrOfSelect);
+
+    for (unsigned int colSel = 0; colSel < nrOfSelect; ++colSel)
+    {
+      this->columnSelection->SetElement(colSel, columnSelection->GetElement(colSel));
+    }
+  }
+
+  lastRow = fstStore.nrOfRows;
+
+  if (endRow >= 0 && static_cast<unsigned long long>(endRow) < lastRow)
+  {
+    lastRow = endRow;
+  }
+
+  // The first batch is read directly, so errors in the column or row selection are reported by Open()
+  prefetchedBatch = ReadBatch(startRow);
+}
+
+
+FstBatch* FstBatchReader::NextBatch()
+{
+  StopPrefetch();
+
+  if (!prefetchError.empty())
+  {
+    string errorMessage = prefetchError;
+    prefetchError.clear();
+
+    throw(runtime_error(errorMessage));
+  }
+
+  FstBatch* batch = prefetchedBatch;
+  prefetchedBatch = nullptr;
+
+  StartPrefetch();
+
+  return batch;
+}
+
+
+FstBatch* FstBatchReader::ReadBatch(unsigned long long startRow)
+{
+  unsigned long long endRow = startRow + batchSize - 1;
+  if (endRow > lastRow) endRow = lastRow;
+
+  FstBatch* batch = new FstBatch();
+  batch->startRow = startRow;
+
+  FstBatchColumnFactory columnFactory;
+
+  try
+  {
+    fstStore.fstRead(batch->table, columnSelection, startRow, endRow, &columnFactory, batch->keyIndex,
+      &batch->selectedCols, nullptr, nullptr, nullptr);
+  }
+  catch (const std::runtime_error &e)
+  {
+    delete batch;
+    throw;
+  }
+
+  nextRow = endRow + 1;
+
+  return batch;
+}
+
+
+void FstBatchReader::StartPrefetch()
+{
+  if (nextRow > lastRow) return;
+
+  isPrefetching = true;
+
+  prefetchThread = std::thread([this]()
+  {
+    try
+    {
+      prefetchedBatch = ReadBatch(nextRow);
+    }
+    catch (const std::exception &e)
+    {
+      prefetchError = e.what();
+    }
+  });
+}
+
+
+void FstBatchReader::StopPrefetch()
+{
+  if (!isPrefetching) return;
+
+  prefetchThread.join();
+  isPrefetching = false;
+}
@@ -0,0 +1,292 @@
+/*
+  fst - An R-package for ultra fast storage and retrieval of datasets.
+  Copyright (C) 2017, Mark AJ Klik
+
+  BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following disclaimer
+    in the documentation and/or other materials provided with the
+    distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+    A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  You can contact the author at :
+  - fst source repository : https://github.com/fstPackage/fst
+*/
+
+
+#ifndef FST_BATCH_READER_H
+#define FST_BATCH_READER_H
+
+
+#include <string>
+#include <vector>
+#include <thread>
+
+#include <interface/ifstcolumn.h>
+#include <interface/ifsttable.h>
+#include <interface/icolumnfactory.h>
+#include <interface/fststore.h>
+
+
+#define FST_BATCH_NA_LENGTH 0xffffffff  // length of NA elements of a FstBatchStringColumn
+
+
+/**
+ * \brief Character column of a batch, the strings are stored in a single (native) buffer
+ *
+ * Elements can be set in any order. Each string is stored with a terminating zero, NA elements have no data.
+ */
+class FstBatchStringColumn : public IStringColumn
+{
+  std::vector<unsigned long long> starts;  // position of each element in 'chars'
+  std::vector<unsigned int> lengths;  // length of each element, FST_BATCH_NA_LENGTH for NA elements
+  std::vector<char> chars;
+  StringEncoding encoding;
+
+public:
+  FstBatchStringColumn() { this->encoding = StringEncoding::NATIVE; }
+
+  void AllocateVec(unsigned long long vecLength);
+
+  void SetEncoding(StringEncoding stringEncoding) { this->encoding = stringEncoding; }
+
+  void BufferToVec(unsigned long long nrOfElements, unsigned long long startElem, unsigned long long endElem,
+    unsigned long long vecOffset, const unsigned int* sizeMeta, const char* buf);
+
+  const char* GetElement(unsigned long long elementNr) { return &chars[starts[elementNr]]; }
+
+  /**
+   * \brief Copy the strings to a column of another implementation, in blocks in the stored format
+   * \param target column that receives the strings, it's allocated with the length of this column
+   */
+  void CopyTo(IStringColumn* target) const;
+};
+
+
+/**
+ * \brief Column of a batch with its data in a native buffer
+ */
+struct FstBatchColumn
+{
+  int colType;  // stored column type (6 = character, 7 = factor, 8 = integer, ...)
+  FstColumnAttribute attribute;
+  short int scale;
+  std::string annotation;
+  char* data;  // fixed width data or factor codes, nullptr for character columns
+  FstBatchStringColumn strings;  // character data or factor levels
+
+  FstBatchColumn() { this->data = nullptr; }
+
+  ~FstBatchColumn() { delete[] data; }
+};
+
+
+/**
+ * \brief Table that receives a batch of rows in native buffers
+ *
+ * The table and its column factory don't depend on the (R) host, so a batch can be read by any thread. The columns
+ * are copied to the host table afterwards with CopyTo().
+ */
+class FstBatchTable : public IFstTable
+{
+  unsigned long long nrOfRows;
+  std::vector<FstBatchColumn*> columns;
+
+public:
+  FstBatchTable() { this->nrOfRows = 0; }
+
+  ~FstBatchTable();
+
+  unsigned long long NrOfRows() { return nrOfRows; }
+
+  unsigned int NrOfColumns() { return static_cast<unsigned int>(columns.size()); }
+
+  /**
+   * \brief Create the columns of the batch in another table
+   * \param tableReader table that receives the columns
+   * \param columnFactory factory of the columns of 'tableReader'
+   */
+  void CopyTo(IFstTable &tableReader, IColumnFactory* columnFactory) const;
+
+  // Reader interface
+  void InitTable(unsigned int nrOfCols, unsigned long long nrOfRows);
+
+  void SetStringColumn(IStringColumn* stringColumn, int colNr);
+
+  void SetLogicalColumn(ILogicalColumn* logicalColumn, int colNr);
+
+  void SetIntegerColumn(IIntegerColumn* integerColumn, int colNr, std::string &annotation);
+
+  void SetDoubleColumn(IDoubleColumn* doubleColumn, int colNr, std::string &annotation);
+
+  void SetFactorColumn(IFactorColumn* factorColumn, int colNr);
+
+  void SetInt64Column(IInt64Column* int64Column, int colNr);
+
+  void SetByteColumn(IByteColumn* byteColumn, int colNr);
+
+  void SetKeyColumns(int* keyColPos, unsigned int nrOfKeys) {}
+
+  // A batch is only read
+  FstColumnType ColumnType(unsigned int colNr, FstColumnAttribute &columnAttribute, short int &scale,
+    std::string &annotation) { return FstColumnType::UNKNOWN; }
+
+  IStringWriter* GetStringWriter(unsigned int colNr) { return nullptr; }
+
+  int* GetLogicalWriter(unsigned int colNr) { return nullptr; }
+
+  int* GetIntWriter(unsigned int colNr) { return nullptr; }
+
+  long long* GetInt64Writer(unsigned int colNr) { return nullptr; }
+
+  char* GetByteWriter(unsigned int colNr) { return nullptr; }
+
+  double* GetDoubleWriter(unsigned int colNr) { return nullptr; }
+
+  IStringWriter* GetLevelWriter(unsigned int colNr) { return nullptr; }
+
+  IStringWriter* GetColNameWriter() { return nullptr; }
+
+  void GetKeyColumns(int* keyColPos) {}
+
+  unsigned int NrOfKeys() { return 0; }
+};
+
+
+/**
+ * \brief Factory of the native columns of a FstBatchTable
+ */
+class FstBatchColumnFactory : public IColumnFactory
+{
+public:
+  IFactorColumn* CreateFactorColumn(int nrOfRows, FstColumnAttribute columnAttribute);
+
+  ILogicalColumn* CreateLogicalColumn(int nrOfRows, FstColumnAttribute columnAttribute);
+
+  IDoubleColumn* CreateDoubleColumn(int nrOfRows, FstColumnAttribute columnAttribute, short int scale);
+
+  IIntegerColumn* CreateIntegerColumn(int nrOfRows, FstColumnAttribute columnAttribute, short int scale);
+
+  IByteColumn* CreateByteColumn(int nrOfRows, FstColumnAttribute columnAttribute);
+
+  IInt64Column* CreateInt64Column(int nrOfRows, FstColumnAttribute columnAttribute, short int scale);
+
+  IStringColumn* CreateStringColumn(int nrOfRows, FstColumnAttribute columnAttribute);
+
+  IStringArray* CreateStringArray();
+};
+
+
+/**
+ * \brief Native array of strings, used for column names
+ */
+class FstBatchStringArray : public IStringArray
+{
+public:
+  std::vector<std::string> values;
+
+  void AllocateArray(unsigned int vecLength) { values.resize(vecLength); }
+
+  void SetElement(unsigned int elementNr, const char* str) { values[elementNr] = str; }
+
+  void SetElement(unsigned int elementNr, const char* str, unsigned int strLen)
+  {
+    values[elementNr] = std::string(str, strLen);
+  }
+
+  const char* GetElement(unsigned int elementNr) { return values[elementNr].c_str(); }
+
+  unsigned int Length() { return static_cast<unsigned int>(values.size()); }
+};
+
+
+/**
+ * \brief Consecutive rows of a fst file, read by a FstBatchReader
+ */
+struct FstBatch
+{
+  unsigned long long startRow;  // first row of the batch in the file (1-based)
+  FstBatchTable table;
+  std::vector<int> keyIndex;
+  FstBatchStringArray selectedCols;
+};
+
+
+/**
+ * \brief Reads (a selection of the columns of) a fst file in batches of consecutive rows
+ *
+ * The file is opened once, so the file header, chunkset headers and chunk indexes are read only once for all
+ * batches. Each batch reads the part of the column block indexes that covers its rows. While a batch is processed by
+ * the caller, the next batch is read and decompressed by a background thread (that uses the fst threads for the
+ * decompression). At most two batches are kept by the reader.
+ */
+class FstBatchReader
+{
+  FstStore fstStore;
+  FstBatchStringArray* columnSelection;  // nullptr to read all columns
+  unsigned long long batchSize;
+  unsigned long long nextRow;  // first row of the next batch to read (1-based)
+  unsigned long long lastRow;
+
+  std::thread prefetchThread;
+  bool isPrefetching;
+  FstBatch* prefetchedBatch;
+  std::string prefetchError;
+
+public:
+  /**
+   * \param fstFile path of the fst file
+   * \param batchSize number of rows in each batch (the last batch can be smaller)
+   */
+  FstBatchReader(std::string fstFile, unsigned long long batchSize);
+
+  ~FstBatchReader();
+
+  /**
+   * \brief Open the file and read the first batch
+   * \param columnSelection names of the columns to read, all columns are read when nullptr
+   * \param startRow first row to read (1-based)
+   * \param endRow last row to read, -1 to read up to the last row of the table
+   */
+  void Open(IStringArray* columnSelection, long long startRow, long long endRow);
+
+  /**
+   * \brief Get the next batch and start reading the batch after that
+   * \return the batch, to be deleted by the caller, or nullptr if all rows have been read
+   */
+  FstBatch* NextBatch();
+
+  /**
+   * \brief Number of rows of the file
+   */
+  unsigned long long NrOfRows() const { return fstStore.nrOfRows; }
+
+private:
+  FstBatch* ReadBatch(unsigned long long startRow);
+
+  void StartPrefetch();
+
+  void StopPrefetch();
+};
+
+
+#endif  // FST_BATCH_READER_H
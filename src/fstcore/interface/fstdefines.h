@@ -38,15 +38,24 @@
 
 
 // Format related defines
-#define FST_VERSION          1                  // version of fst codebase
+#define FST_VERSION          2                  // version of fst codebase
+#define FST_VERSION_BASE     1                  // fstcore version required to read files without newer column formats
+#define FST_VERSION_CHAR_DICT 2                 // fstcore version required to read character vectors with dictionaries
+#define FST_VERSION_CHUNKS   2                  // fstcore version required to read tables with appended data chunks
+#define FST_VERSION_CHUNKSETS 2                 // fstcore version required to read tables with added column chunksets
 #define TABLE_META_SIZE      44                 // size of table meta-data block
 #define FST_FILE_ID          0xa91c12f8b245a71d // identifies a fst file or memory block
 #define FST_HASH_SEED        912824571          // default seed used for xxhash algorithm
 #define CHUNKSET_HEADER_SIZE 76                 // size of chunkset header
 #define CHUNK_INDEX_SIZE     96                 // size of chunk index header
 #define DATA_INDEX_SIZE      24                 // size of data index header
+#define CHUNK_INDEX_SLOTS    4                  // number of data chunk slots in a chunk index
 #define CHAR_HEADER_SIZE     8                  // meta data header size
 #define CHAR_INDEX_SIZE      16                 // size of 1 index entry
+#define CHAR_DICTIONARY      16                 // header flag of a dictionary encoded character vector
+#define CHAR_DICTIONARY_HEADER_SIZE 16          // header size of a dictionary encoded character vector
+#define CHAR_ZSTD_DICT       32                 // header flag of a character vector with a trained ZSTD dictionary
+#define CHAR_ZSTD_DICT_HEADER_SIZE 8            // size of the header in front of a trained ZSTD dictionary
 #define BASIC_HEAP_SIZE      1048576            // starting size of heap buffer
 
 // Format flags
@@ -60,6 +69,55 @@
 #define BATCH_SIZE_READ_DOUBLE          100
 #define BATCH_SIZE_READ_BYTE            100
 
+// Row filter
+#define FILTER_SEGMENT_SIZE             4096    // number of rows in a segment that is tested with the column zone maps
+#define FILTER_BATCH_SIZE               131072  // maximum number of rows that are decoded at once for filtering
+
+// Column-parallel reads
+#define READ_TASK_SIZE                  131072  // maximum number of rows of a column that are read in a single task
+#define CHAR_READ_BATCH                 8       // number of character blocks per thread decompressed before conversion
+
+// Read planner
+#define READ_PLAN_GAP                   65536   // default maximum gap between byte ranges that are read as one request
+#define READ_PLAN_HEAD_SIZE             4096    // bytes read at the start of each column before its header is parsed
+#define READ_PLAN_BUDGET                268435456ULL  // maximum number of bytes fetched by the read planner
+#define READ_PLAN_PASSES                6       // maximum number of planning passes (rounds of merged reads)
+
+// Asynchronous reads
+#define READ_QUEUE_DEPTH                4       // default number of batch reads outstanding ahead of the decompression
+#define READ_QUEUE_BATCH_SIZE           16      // maximum number of blocks in a single asynchronous batch read
+#define READ_QUEUE_FETCH_SIZE           1048576 // maximum size of a single asynchronous read of the read planner
+
+// Column-parallel writes
+#define WRITE_PIPELINE_BUDGET           268435456ULL  // default memory budget for columns that are compressed concurrently
+#define WRITE_REORDER_SLOTS             2       // batches per compression thread in the reorder buffer of a column writer
+
+// Dictionary encoding of character columns
+#define DICTIONARY_MIN_ROWS             8188    // minimum length of a dictionary encoded vector (4 blocks)
+#define DICTIONARY_SAMPLE_ROWS          16376   // number of rows sampled before the number of distinct values is tested
+#define DICTIONARY_MIN_RATIO            16      // minimum ratio between the number of rows and distinct values
+#define DICTIONARY_MAX_LEVELS           1048576 // maximum number of distinct values of a dictionary encoded vector
+#define DICTIONARY_READ_BATCH           262016  // number of level codes that are decoded at once (128 blocks)
+
+// Trained ZSTD dictionaries of character columns
+#define ZSTD_DICT_MIN_ROWS              8188    // minimum length of a vector with a trained dictionary (4 blocks)
+#define ZSTD_DICT_SIZE                  16384   // maximum size of a trained dictionary
+#define ZSTD_DICT_SAMPLE_BLOCKS         32      // maximum number of blocks sampled for training, spread over the vector
+#define ZSTD_DICT_SAMPLE_SIZE           256     // minimum size of a single sample (consecutive strings of a block)
+#define ZSTD_DICT_MIN_SAMPLES_SIZE      32768   // minimum total size of the samples required for training
+#define ZSTD_DICT_MAX_SAMPLES_SIZE      262144 // maximum total size of the samples, divided evenly over the blocks
+#define ZSTD_DICT_LEVEL                 20      // compression level (0 - 100), equal to the ZSTD level of other blocks
+#define ZSTD_DICT_TEST_BLOCKS           4       // number of blocks compressed to test if a trained dictionary pays off
+
+// String cache used when creating the strings of a character column
+#define STRING_CACHE_SIZE               4096    // number of cached strings, a power of 2
+#define STRING_CACHE_WINDOW             4096    // number of strings in a window used to sample the cache hit rate
+#define STRING_CACHE_MIN_HIT_RATE       0.25    // cache is bypassed if the hit rate in a window is lower
+#define STRING_CACHE_BYPASS             262144  // number of strings created without the cache after a low hit rate
+
+// Key lookup
+#define KEY_LOOKUP_CACHE_BLOCKS         4       // number of decoded blocks per key column kept in memory
+
 // Cache-size related defines
 #define CACHEFACTOR						1
 #define PREV_NR_OF_BLOCKS               48                          // default number of blocks for in-memory compression
@@ -93,6 +151,13 @@
 #define FSTERROR_ERROR_OPEN_WRITE    "There was an error creating the file, please check path"
 #define FSTERROR_ERROR_OPEN_READ     "There was an error opening the file, it seems to be incomplete or damaged."
 #define FSTERROR_UPDATE_FST          "Incompatible fst file: file was created by a newer version of fst"
+#define FSTERROR_APPEND_KEYS         "Appending data to a file with key columns is not supported"
+#define FSTERROR_APPEND_COLUMNS      "Column names or types of the data do not match the columns in the fst file"
+#define FSTERROR_APPEND_LEVELS       "Factor levels of the data do not match the factor levels in the fst file"
+#define FSTERROR_APPEND_ROWS         "The number of rows of the new columns does not match the number of rows in the fst file"
+#define FSTERROR_DAMAGED_ZONEMAP     "The zone map of the column is damaged or incomplete"
+#define FSTERROR_DAMAGED_DATA        "The column data is damaged or incomplete"
+#define FSTERROR_ZONEMAP_TYPE        "Zone maps are only available for integer, double, integer64 and factor columns"
 
 #define FST_NA_INT					         0x80000000
 
@@ -0,0 +1,630 @@
+/*
+  fst - An R-package for ultra fast storage and retrieval of datasets.
+  Copyright (C) 2017, Mark AJ Klik
+
+  BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following disclaimer
+    in the documentation and/or other materials provided with the
+    distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+    A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  You can contact the author at :
+  - fst source repository : https://github.com/fstPackage/fst
+*/
+
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#include <interface/fstfilter.h>
+#include <interface/openmphelper.h>
+
+using namespace std;
+
+
+void FilterStringColumn::AllocateVec(unsigned long long vecLength)
+{
+  strings.assign(vecLength, "");
+  isNA.assign(vecLength, 0);
+}
+
+
+void FilterStringColumn::BufferToVec(unsigned long long nrOfElements, unsigned long long startElem,
+  unsigned long long endElem, unsigned long long vecOffset, const unsigned int* sizeMeta, const char* buf)
+{
+  unsigned long long nrOfNAInts = 1 + nrOfElements / 32;  // last bit is NA flag
+  const unsigned int* bitsNA = &sizeMeta[nrOfElements];
+  unsigned int flagNA = bitsNA[nrOfNAInts - 1] & (1 << (nrOfElements % 32));
+
+  unsigned long long pos = 0;
+
+  if (startElem != 0)
+  {
+    pos = sizeMeta[startElem - 1];  // offset previous element
+  }
+
+  for (unsigned long long blockElem = startElem; blockElem <= endElem; ++blockElem)
+  {
+    unsigned long long newPos = sizeMeta[blockElem];
+    unsigned long long elementNr = vecOffset + blockElem - startElem;
+
+    if (flagNA != 0 && (bitsNA[blockElem / 32] & (1 << (blockElem % 32))) != 0)
+    {
+      strings[elementNr].clear();
+      isNA[elementNr] = 1;
+    }
+    else
+    {
+      strings[elementNr].assign(buf + pos, newPos - pos);
+      isNA[elementNr] = 0;
+    }
+
+    pos = newPos;  // update to new string offset
+  }
+}
+
+
+void SelectionStringColumn::BufferToVec(unsigned long long nrOfElements, unsigned long long startElem,
+  unsigned long long endElem, unsigned long long vecOffset, const unsigned int* sizeMeta, const char* buf)
+{
+  unsigned long long nrOfNAInts = 1 + nrOfElements / 32;  // last bit is NA flag
+  const unsigned int* bitsNA = &sizeMeta[nrOfElements];
+  unsigned int flagNA = bitsNA[nrOfNAInts - 1] & (1 << (nrOfElements % 32));
+
+  // Count selected elements
+  unsigned long long nrOfSelected = 0;
+  unsigned long long selectionPos = selectionOffset + vecOffset;
+
+  for (unsigned long long blockElem = startElem; blockElem <= endElem; ++blockElem)
+  {
+    unsigned long long bitNr = selectionPos + blockElem - startElem;
+    nrOfSelected += (selection[bitNr / 64] >> (bitNr % 64)) & 1;
+  }
+
+  if (nrOfSelected == 0) return;
+
+  unsigned long long startPos = 0;
+
+  if (startElem != 0)
+  {
+    startPos = sizeMeta[startElem - 1];  // offset previous element
+  }
+
+  // Block with the selected elements only, in the same format as the source block
+  unsigned long long nrOfSelectedNAInts = 1 + nrOfSelected / 32;
+  unsigned int* selectedMeta = new unsigned int[nrOfSelected + nrOfSelectedNAInts];
+  unsigned int* selectedBitsNA = &selectedMeta[nrOfSelected];
+  char* selectedBuf = new char[sizeMeta[endElem] - startPos + 1];
+
+  memset(selectedBitsNA, 0, nrOfSelectedNAInts * 4);
+
+  unsigned long long pos = startPos;
+  unsigned int selectedPos = 0;
+  unsigned long long selectedElem = 0;
+  bool hasNA = false;
+
+  for (unsigned long long blockElem = startElem; blockElem <= endElem; ++blockElem)
+  {
+    unsigned long long newPos = sizeMeta[blockElem];
+    unsigned long long bitNr = selectionPos + blockElem - startElem;
+
+    if (((selection[bitNr / 64] >> (bitNr % 64)) & 1) != 0)
+    {
+      memcpy(selectedBuf + selectedPos, buf + pos, newPos - pos);
+      selectedPos += newPos - pos;
+      selectedMeta[selectedElem] = selectedPos;
+
+      if (flagNA != 0 && (bitsNA[blockElem / 32] & (1 << (blockElem % 32))) != 0)
+      {
+        selectedBitsNA[selectedElem / 32] |= 1 << (selectedElem % 32);
+        hasNA = true;
+      }
+
+      ++selectedElem;
+    }
+
+    pos = newPos;
+  }
+
+  if (hasNA)
+  {
+    selectedBitsNA[nrOfSelectedNAInts - 1] |= 1 << (nrOfSelected % 32);  // set NA flag
+  }
+
+  target->BufferToVec(nrOfSelected, 0, nrOfSelected - 1, resultOffset, selectedMeta, selectedBuf);
+  resultOffset += nrOfSelected;
+
+  delete[] selectedMeta;
+  delete[] selectedBuf;
+}
+
+
+inline bool BindFilterNode(const FstFilter &filter, IStringColumn* colNames, int nrOfCols, unsigned short int* colTypes,
+  vector<FilterNode> &nodes, vector<int> &filterCols, string &errorMessage)
+{
+  int nodeNr = nodes.size();
+  nodes.push_back(FilterNode());
+  nodes[nodeNr].filterOperator = filter.filterOperator;
+  nodes[nodeNr].filterCol = -1;
+
+  // AND and OR nodes
+  if (filter.filterOperator == FstFilterOperator::AND || filter.filterOperator == FstFilterOperator::OR)
+  {
+    if (filter.children.empty())
+    {
+      errorMessage = "AND and OR filters should have at least one operand";
+      return false;
+    }
+
+    for (vector<FstFilter>::const_iterator child = filter.children.begin(); child != filter.children.end(); ++child)
+    {
+      nodes[nodeNr].children.push_back(nodes.size());  // child node is added at the end
+
+      if (!BindFilterNode(*child, colNames, nrOfCols, colTypes, nodes, filterCols, errorMessage)) return false;
+    }
+
+    return true;
+  }
+
+  // Comparison nodes
+  int colNr = 0;
+  for (; colNr < nrOfCols; ++colNr)
+  {
+    if (strcmp(filter.columnName.c_str(), colNames->GetElement(colNr)) == 0) break;
+  }
+
+  if (colNr == nrOfCols)
+  {
+    errorMessage = "Filter column '" + filter.columnName + "' not found";
+    return false;
+  }
+
+  unsigned short int colType = colTypes[colNr];
+  bool isString = colType == 6 || colType == 7;  // character or factor column
+
+  if (colType < 6 || colType > 12)
+  {
+    errorMessage = "Filter column '" + filter.columnName + "' has an unknown type";
+    return false;
+  }
+
+  unsigned long long nrOfValues = isString ? filter.stringValues.size() : filter.values.size();
+
+  if ((isString && !filter.values.empty()) || (!isString && !filter.stringValues.empty()))
+  {
+    errorMessage = "Filter on column '" + filter.columnName + "' uses values of an incorrect type";
+    return false;
+  }
+
+  if (!filter.int64Values.empty() && filter.int64Values.size() != filter.values.size())
+  {
+    errorMessage = "Filter on column '" + filter.columnName + "' has an incorrect number of integer64 values";
+    return false;
+  }
+
+  if (filter.filterOperator == FstFilterOperator::RANGE && nrOfValues != 2)
+  {
+    errorMessage = "Range filter on column '" + filter.columnName + "' should have a lower and upper bound";
+    return false;
+  }
+
+  if (filter.filterOperator != FstFilterOperator::RANGE && filter.filterOperator != FstFilterOperator::IN && nrOfValues != 1)
+  {
+    errorMessage = "Filter on column '" + filter.columnName + "' should compare with a single value";
+    return false;
+  }
+
+  // Register filter column
+  int filterCol = find(filterCols.begin(), filterCols.end(), colNr) - filterCols.begin();
+  if (filterCol == static_cast<int>(filterCols.size())) filterCols.push_back(colNr);
+
+  FilterNode &node = nodes[nodeNr];
+  node.filterCol = filterCol;
+  node.stringValues = filter.stringValues;
+
+  if (filter.filterOperator != FstFilterOperator::IN)
+  {
+    node.values = filter.values;
+    node.int64Values = filter.int64Values;
+
+    return true;
+  }
+
+  // Sorted set of non-NA values for IN filters
+  for (unsigned long long valueNr = 0; valueNr < filter.values.size(); ++valueNr)
+  {
+    double value = filter.values[valueNr];
+    if (value != value) continue;  // NA never matches
+
+    node.values.push_back(value);
+    if (!filter.int64Values.empty()) node.int64Values.push_back(filter.int64Values[valueNr]);
+  }
+
+  sort(node.values.begin(), node.values.end());
+  sort(node.int64Values.begin(), node.int64Values.end());
+  sort(node.stringValues.begin(), node.stringValues.end());
+
+  return true;
+}
+
+
+bool BindFilter(const FstFilter &filter, IStringColumn* colNames, int nrOfCols, unsigned short int* colTypes,
+  vector<FilterNode> &nodes, vector<int> &filterCols, string &errorMessage)
+{
+  nodes.clear();
+  filterCols.clear();
+
+  return BindFilterNode(filter, colNames, nrOfCols, colTypes, nodes, filterCols, errorMessage);
+}
+
+
+// Test a single value
+template<class T>
+inline bool MatchValue(FstFilterOperator filterOperator, const T &value, const vector<T> &values)
+{
+  switch (filterOperator)
+  {
+    case FstFilterOperator::EQUAL:
+      return value == values[0];
+
+    case FstFilterOperator::NOT_EQUAL:
+      return value != values[0];
+
+    case FstFilterOperator::LESS:
+      return value < values[0];
+
+    case FstFilterOperator::LESS_EQUAL:
+      return value <= values[0];
+
+    case FstFilterOperator::GREATER:
+      return value > values[0];
+
+    case FstFilterOperator::GREATER_EQUAL:
+      return value >= values[0];
+
+    case FstFilterOperator::IN:
+      return binary_search(values.begin(), values.end(), value);
+
+    case FstFilterOperator::RANGE:
+      return values[0] <= value && value <= values[1];
+
+    default:
+      return false;
+  }
+}
+
+
+void SetFilterLevels(vector<FilterNode> &nodes, int filterCol, FilterStringColumn &levels)
+{
+  unsigned long long nrOfLevels = levels.Length();
+
+  for (vector<FilterNode>::iterator node = nodes.begin(); node != nodes.end(); ++node)
+  {
+    if (node->filterCol != filterCol) continue;
+
+    node->levelMatch.resize(nrOfLevels);
+
+    for (unsigned long long levelNr = 0; levelNr < nrOfLevels; ++levelNr)
+    {
+      node->levelMatch[levelNr] = !levels.IsNA(levelNr) &&
+        MatchValue(node->filterOperator, levels.Element(levelNr), node->stringValues) ? 1 : 0;
+    }
+  }
+}
+
+
+// Test a comparison on a range of values with known minimum and maximum
+template<class T>
+inline FilterResult MatchRange(FstFilterOperator filterOperator, T minValue, T maxValue, bool hasNA,
+  const vector<T> &values)
+{
+  switch (filterOperator)
+  {
+    case FstFilterOperator::EQUAL:
+    {
+      if (values[0] < minValue || values[0] > maxValue) return FilterResult::NONE;
+      if (!hasNA && minValue == values[0] && maxValue == values[0]) return FilterResult::ALL;
+      return FilterResult::SOME;
+    }
+
+    case FstFilterOperator::NOT_EQUAL:
+    {
+      if (minValue == values[0] && maxValue == values[0]) return FilterResult::NONE;
+      if (!hasNA && (values[0] < minValue || values[0] > maxValue)) return FilterResult::ALL;
+      return FilterResult::SOME;
+    }
+
+    case FstFilterOperator::LESS:
+    {
+      if (minValue >= values[0]) return FilterResult::NONE;
+      if (!hasNA && maxValue < values[0]) return FilterResult::ALL;
+      return FilterResult::SOME;
+    }
+
+    case FstFilterOperator::LESS_EQUAL:
+    {
+      if (minValue > values[0]) return FilterResult::NONE;
+      if (!hasNA && maxValue <= values[0]) return FilterResult::ALL;
+      return FilterResult::SOME;
+    }
+
+    case FstFilterOperator::GREATER:
+    {
+      if (maxValue <= values[0]) return FilterResult::NONE;
+      if (!hasNA && minValue > values[0]) return FilterResult::ALL;
+      return FilterResult::SOME;
+    }
+
+    case FstFilterOperator::GREATER_EQUAL:
+    {
+      if (maxValue < values[0]) return FilterResult::NONE;
+      if (!hasNA && minValue >= values[0]) return FilterResult::ALL;
+      return FilterResult::SOME;
+    }
+
+    case FstFilterOperator::IN:
+    {
+      typename vector<T>::const_iterator value = lower_bound(values.begin(), values.end(), minValue);
+      if (value == values.end() || *value > maxValue) return FilterResult::NONE;
+      if (!hasNA && minValue == maxValue) return FilterResult::ALL;
+      return FilterResult::SOME;
+    }
+
+    case FstFilterOperator::RANGE:
+    {
+      if (maxValue < values[0] || minValue > values[1] || values[0] > values[1]) return FilterResult::NONE;
+      if (!hasNA && minValue >= values[0] && maxValue <= values[1]) return FilterResult::ALL;
+      return FilterResult::SOME;
+    }
+
+    default:
+      return FilterResult::SOME;
+  }
+}
+
+
+FilterResult EvaluateFilterStatistics(const vector<FilterNode> &nodes, int nodeNr, const vector<unsigned short int> &colTypes,
+  const vector<FilterStatistics> &statistics)
+{
+  const FilterNode &node = nodes[nodeNr];
+
+  if (node.filterOperator == FstFilterOperator::AND)
+  {
+    FilterResult result = FilterResult::ALL;
+
+    for (vector<int>::const_iterator child = node.children.begin(); child != node.children.end(); ++child)
+    {
+      FilterResult childResult = EvaluateFilterStatistics(nodes, *child, colTypes, statistics);
+
+      if (childResult == FilterResult::NONE) return FilterResult::NONE;
+      if (childResult == FilterResult::SOME) result = FilterResult::SOME;
+    }
+
+    return result;
+  }
+
+  if (node.filterOperator == FstFilterOperator::OR)
+  {
+    FilterResult result = FilterResult::NONE;
+
+    for (vector<int>::const_iterator child = node.children.begin(); child != node.children.end(); ++child)
+    {
+      FilterResult childResult = EvaluateFilterStatistics(nodes, *child, colTypes, statistics);
+
+      if (childResult == FilterResult::ALL) return FilterResult::ALL;
+      if (childResult == FilterResult::SOME) result = FilterResult::SOME;
+    }
+
+    return result;
+  }
+
+  const FilterStatistics &stats = statistics[node.filterCol];
+
+  if (!stats.hasStatistics) return FilterResult::SOME;
+  if (stats.allNA) return FilterResult::NONE;  // NA never matches
+
+  switch (colTypes[node.filterCol])
+  {
+    // Factor codes, test the levels in the range of codes
+    case 7:
+    {
+      long long nrOfLevels = node.levelMatch.size();
+      long long minCode = max(1LL, stats.minValue.intValue);
+      long long maxCode = min(nrOfLevels, stats.maxValue.intValue);
+
+      bool anyMatch = false;
+      bool allMatch = true;
+
+      for (long long code = minCode; code <= maxCode; ++code)
+      {
+        if (node.levelMatch[code - 1] != 0)
+        {
+          anyMatch = true;
+        }
+        else
+        {
+          allMatch = false;
+        }
+      }
+
+      if (!anyMatch) return FilterResult::NONE;
+      if (allMatch && !stats.hasNA) return FilterResult::ALL;
+      return FilterResult::SOME;
+    }
+
+    case 8:
+      return MatchRange<double>(node.filterOperator, static_cast<double>(stats.minValue.intValue),
+        static_cast<double>(stats.maxValue.intValue), stats.hasNA, node.values);
+
+    case 9:
+      return MatchRange<double>(node.filterOperator, stats.minValue.doubleValue, stats.maxValue.doubleValue, stats.hasNA,
+        node.values);
+
+    case 11:
+    {
+      if (!node.int64Values.empty())
+      {
+        return MatchRange<long long>(node.filterOperator, stats.minValue.intValue, stats.maxValue.intValue, stats.hasNA,
+          node.int64Values);
+      }
+
+      return MatchRange<double>(node.filterOperator, static_cast<double>(stats.minValue.intValue),
+        static_cast<double>(stats.maxValue.intValue), stats.hasNA, node.values);
+    }
+
+    default:
+      return FilterResult::SOME;
+  }
+}
+
+
+// Test a comparison on each element of a vector, elements for which 'isNA' is true never match
+template<class T, class V, class NATest>
+inline void MatchRows(FstFilterOperator filterOperator, const T* data, unsigned long long nrOfRows, const vector<V> &values,
+  NATest isNA, char* mask)
+{
+  int nrOfThreads = GetFstThreads();
+  long long nrOfElements = static_cast<long long>(nrOfRows);
+
+#pragma omp parallel for num_threads(nrOfThreads) schedule(static)
+  for (long long row = 0; row < nrOfElements; ++row)
+  {
+    V value = static_cast<V>(data[row]);
+    mask[row] = !isNA(data[row]) && MatchValue(filterOperator, value, values) ? 1 : 0;
+  }
+}
+
+
+void EvaluateFilterRows(const vector<FilterNode> &nodes, int nodeNr, vector<FilterColumnData> &columnData,
+  unsigned long long nrOfRows, char* mask)
+{
+  const FilterNode &node = nodes[nodeNr];
+  int nrOfThreads = GetFstThreads();
+  long long nrOfElements = static_cast<long long>(nrOfRows);
+
+  // AND and OR nodes
+  if (node.filterOperator == FstFilterOperator::AND || node.filterOperator == FstFilterOperator::OR)
+  {
+    bool isAnd = node.filterOperator == FstFilterOperator::AND;
+
+    EvaluateFilterRows(nodes, node.children[0], columnData, nrOfRows, mask);
+
+    if (node.children.size() == 1) return;
+
+    char* childMask = new char[nrOfRows];
+
+    for (unsigned int childNr = 1; childNr < node.children.size(); ++childNr)
+    {
+      EvaluateFilterRows(nodes, node.children[childNr], columnData, nrOfRows, childMask);
+
+#pragma omp parallel for num_threads(nrOfThreads) schedule(static)
+      for (long long row = 0; row < nrOfElements; ++row)
+      {
+        mask[row] = isAnd ? (mask[row] & childMask[row]) : (mask[row] | childMask[row]);
+      }
+    }
+
+    delete[] childMask;
+
+    return;
+  }
+
+  FilterColumnData &data = columnData[node.filterCol];
+
+  switch (data.colType)
+  {
+    // Character vector
+    case 6:
+    {
+      FilterStringColumn &strings = data.strings;
+
+#pragma omp parallel for num_threads(nrOfThreads) schedule(static)
+      for (long long row = 0; row < nrOfElements; ++row)
+      {
+        mask[row] = !strings.IsNA(row) && MatchValue(node.filterOperator, strings.Element(row), node.stringValues) ? 1 : 0;
+      }
+
+      break;
+    }
+
+    // Factor vector, test the level codes
+    case 7:
+    {
+      const int* codes = reinterpret_cast<const int*>(data.values.data());
+      const char* levelMatch = node.levelMatch.data();
+      int nrOfLevels = node.levelMatch.size();
+
+#pragma omp parallel for num_threads(nrOfThreads) schedule(static)
+      for (long long row = 0; row < nrOfElements; ++row)
+      {
+        int code = codes[row];
+        mask[row] = code >= 1 && code <= nrOfLevels && levelMatch[code - 1] != 0 ? 1 : 0;
+      }
+
+      break;
+    }
+
+    // Integer and logical vectors
+    case 8:
+    case 10:
+    {
+      MatchRows(node.filterOperator, reinterpret_cast<const int*>(data.values.data()), nrOfRows, node.values,
+        [](int value) { return value == INT_MIN; }, mask);
+      break;
+    }
+
+    // Double vector
+    case 9:
+    {
+      MatchRows(node.filterOperator, reinterpret_cast<const double*>(data.values.data()), nrOfRows, node.values,
+        [](double value) { return value != value; }, mask);
+      break;
+    }
+
+    // Integer64 vector
+    case 11:
+    {
+      const long long* values = reinterpret_cast<const long long*>(data.values.data());
+
+      if (!node.int64Values.empty())
+      {
+        MatchRows(node.filterOperator, values, nrOfRows, node.int64Values,
+          [](long long value) { return value == LLONG_MIN; }, mask);
+        break;
+      }
+
+      MatchRows(node.filterOperator, values, nrOfRows, node.values,
+        [](long long value) { return value == LLONG_MIN; }, mask);
+      break;
+    }
+
+    // Byte vector
+    default:
+    {
+      MatchRows(node.filterOperator, reinterpret_cast<const unsigned char*>(data.values.data()), nrOfRows, node.values,
+        [](unsigned char value) { return false; }, mask);
+      break;
+    }
+  }
+}
@@ -0,0 +1,229 @@
+/*
+  fst - An R-package for ultra fast storage and retrieval of datasets.
+  Copyright (C) 2017, Mark AJ Klik
+
+  BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following disclaimer
+    in the documentation and/or other materials provided with the
+    distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+    A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  You can contact the author at :
+  - fst source repository : https://github.com/fstPackage/fst
+*/
+
+
+#ifndef FST_FILTER_H
+#define FST_FILTER_H
+
+
+#include <string>
+#include <vector>
+
+#include <interface/ifstcolumn.h>
+#include <interface/fstzonemap.h>
+
+
+// Operators that can be used in a row filter
+enum class FstFilterOperator
+{
+  AND = 0,        // all child filters should match
+  OR,             // at least one of the child filters should match
+  EQUAL,          // column == value
+  NOT_EQUAL,      // column != value
+  LESS,           // column < value
+  LESS_EQUAL,     // column <= value
+  GREATER,        // column > value
+  GREATER_EQUAL,  // column >= value
+  IN,             // column equals one of the values
+  RANGE           // first value <= column <= second value
+};
+
+
+/**
+ * \brief Row filter specification, a tree of comparisons combined with AND and OR nodes.
+ *
+ * Comparisons on numeric columns (integer, double, integer64, logical and byte) use 'values', comparisons on character
+ * and factor columns use 'stringValues' (strings are compared byte by byte). NA elements never match a comparison.
+ */
+class FstFilter
+{
+public:
+  FstFilterOperator filterOperator;
+  std::string columnName;                 // column to test (comparisons only)
+  std::vector<double> values;             // values to compare with for numeric columns
+  std::vector<long long> int64Values;     // exact values for integer64 columns (optional, used instead of 'values')
+  std::vector<std::string> stringValues;  // values to compare with for character and factor columns
+  std::vector<FstFilter> children;        // operands of AND and OR nodes
+};
+
+
+// Result of a filter test on a range of rows
+enum class FilterResult
+{
+  NONE = 0,  // no rows match
+  ALL,       // all rows match
+  SOME       // some rows might match
+};
+
+
+// Filter node bound to the columns of a fst table
+struct FilterNode
+{
+  FstFilterOperator filterOperator;
+  int filterCol;                          // index in the list of filter columns (comparisons only)
+  std::vector<double> values;             // sorted for IN
+  std::vector<long long> int64Values;     // sorted for IN
+  std::vector<std::string> stringValues;  // sorted for IN
+  std::vector<char> levelMatch;           // factor columns only: 1 for each level that matches the comparison
+  std::vector<int> children;              // node numbers of the operands of AND and OR nodes
+};
+
+
+// Column statistics of a range of rows, derived from the zone map of the column
+struct FilterStatistics
+{
+  bool hasStatistics;     // false if the statistics are unknown
+  bool hasNA;             // true if the range might contain NA values
+  bool allNA;             // true if all values in the range are NA
+  ZoneMapValue minValue;  // smallest non-NA value
+  ZoneMapValue maxValue;  // largest non-NA value
+};
+
+
+/**
+ * \brief String column that keeps the strings in memory, used for filter columns and factor levels
+ */
+class FilterStringColumn : public IStringColumn
+{
+  std::vector<std::string> strings;
+  std::vector<char> isNA;
+
+public:
+  void AllocateVec(unsigned long long vecLength);
+
+  void SetEncoding(StringEncoding stringEncoding) {}
+
+  void BufferToVec(unsigned long long nrOfElements, unsigned long long startElem, unsigned long long endElem,
+    unsigned long long vecOffset, const unsigned int* sizeMeta, const char* buf);
+
+  const char* GetElement(unsigned long long elementNr) { return strings[elementNr].c_str(); }
+
+  const std::string &Element(unsigned long long elementNr) const { return strings[elementNr]; }
+
+  bool IsNA(unsigned long long elementNr) const { return isNA[elementNr] != 0; }
+
+  unsigned long long Length() const { return strings.size(); }
+};
+
+
+// Decoded values of a filter column for a range of rows
+struct FilterColumnData
+{
+  unsigned short int colType;   // fst column type
+  std::vector<char> values;     // decoded values for non-character columns
+  FilterStringColumn strings;   // decoded values for character columns
+};
+
+
+/**
+ * \brief String column that copies only the selected elements of each block to a target column
+ *
+ * Element i of a decoded block is copied when bit 'selectionOffset + vecOffset + i' of the selection is set. The
+ * selected elements are stored consecutively in the target column, starting at element 'resultOffset'.
+ */
+class SelectionStringColumn : public IStringColumn
+{
+  IStringColumn* target;
+  const unsigned long long* selection;
+  unsigned long long selectionOffset;
+  unsigned long long resultOffset;
+
+public:
+  SelectionStringColumn(IStringColumn* target, const unsigned long long* selection, unsigned long long selectionOffset,
+    unsigned long long resultOffset)
+  {
+    this->target = target;
+    this->selection = selection;
+    this->selectionOffset = selectionOffset;
+    this->resultOffset = resultOffset;
+  }
+
+  // the target column is allocated by its owner
+  void AllocateVec(unsigned long long vecLength) {}
+
+  void SetEncoding(StringEncoding stringEncoding) { target->SetEncoding(stringEncoding); }
+
+  void BufferToVec(unsigned long long nrOfElements, unsigned long long startElem, unsigned long long endElem,
+    unsigned long long vecOffset, const unsigned int* sizeMeta, const char* buf);
+
+  const char* GetElement(unsigned long long elementNr) { return target->GetElement(elementNr); }
+};
+
+
+/**
+ * \brief Bind a filter specification to the columns of a table
+ * \param filter filter specification
+ * \param colNames names of all columns of the table
+ * \param nrOfCols number of columns in the table
+ * \param colTypes types of all columns of the table
+ * \param nodes bound filter nodes, the root node is the first element (output)
+ * \param filterCols table column numbers of the columns used in the filter (output)
+ * \param errorMessage description of the problem if the filter can't be bound (output)
+ * \return false if the filter refers to unknown columns or has incorrect values
+ */
+bool BindFilter(const FstFilter &filter, IStringColumn* colNames, int nrOfCols, unsigned short int* colTypes,
+  std::vector<FilterNode> &nodes, std::vector<int> &filterCols, std::string &errorMessage);
+
+/**
+ * \brief Determine the matching levels for all comparisons on a factor column
+ * \param nodes bound filter nodes
+ * \param filterCol index of the factor column in the list of filter columns
+ * \param levels level strings of the factor column
+ */
+void SetFilterLevels(std::vector<FilterNode> &nodes, int filterCol, FilterStringColumn &levels);
+
+/**
+ * \brief Test a filter on a range of rows using only the statistics of the filter columns
+ * \param nodes bound filter nodes
+ * \param nodeNr node to test
+ * \param colTypes types of the filter columns
+ * \param statistics statistics of the filter columns for the range of rows
+ * \return NONE or ALL if the statistics show that no or all rows match, SOME otherwise
+ */
+FilterResult EvaluateFilterStatistics(const std::vector<FilterNode> &nodes, int nodeNr,
+  const std::vector<unsigned short int> &colTypes, const std::vector<FilterStatistics> &statistics);
+
+/**
+ * \brief Test a filter on each row of a range of decoded rows
+ * \param nodes bound filter nodes
+ * \param nodeNr node to test
+ * \param columnData decoded values of the filter columns
+ * \param nrOfRows number of rows to test
+ * \param mask result of the test, 1 for each matching row (output)
+ */
+void EvaluateFilterRows(const std::vector<FilterNode> &nodes, int nodeNr, std::vector<FilterColumnData> &columnData,
+  unsigned long long nrOfRows, char* mask);
+
+
+#endif  // FST_FILTER_H
@@ -0,0 +1,134 @@
+/*
+  fst - An R-package for ultra fast storage and retrieval of datasets.
+  Copyright (C) 2017, Mark AJ Klik
+
+  BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following disclaimer
+    in the documentation and/or other materials provided with the
+    distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+    A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  You can contact the author at :
+  - fst source repository : https://github.com/fstPackage/fst
+*/
+
+
+#include <thread>
+#include <chrono>
+
+#include <interface/fstiocounter.h>
+
+
+FstCountingSource::FstCountingSource(IFstSource &source)
+{
+  this->source = &source;
+
+  Reset();
+}
+
+
+bool FstCountingSource::Read(char* buffer, unsigned long long pos, unsigned long long length)
+{
+  ++readCalls;
+  readBytes += length;
+
+  return source->Read(buffer, pos, length);
+}
+
+
+const char* FstCountingSource::Map(unsigned long long pos, unsigned long long length)
+{
+  const char* data = source->Map(pos, length);
+
+  ++mapCalls;
+  if (data != nullptr) mapBytes += length;
+
+  return data;
+}
+
+
+void FstCountingSource::Reset()
+{
+  readCalls = 0;
+  readBytes = 0;
+  mapCalls  = 0;
+  mapBytes  = 0;
+}
+
+
+FstCountingSink::FstCountingSink(IFstSink &sink)
+{
+  this->sink = &sink;
+
+  Reset();
+}
+
+
+bool FstCountingSink::Write(const char* buffer, unsigned long long pos, unsigned long long length)
+{
+  ++writeCalls;
+  writeBytes += length;
+
+  return sink->Write(buffer, pos, length);
+}
+
+
+void FstCountingSink::Reset()
+{
+  writeCalls = 0;
+  writeBytes = 0;
+}
+
+
+// Latency added to the requests on all fst files opened by a store
+static unsigned int FstReadLatency = 0;
+
+
+unsigned int GetFstReadLatency()
+{
+  return FstReadLatency;
+}
+
+
+unsigned int SetFstReadLatency(unsigned int latency)
+{
+  unsigned int previousLatency = FstReadLatency;
+  FstReadLatency = latency;
+
+  return previousLatency;
+}
+
+
+FstLatencySource::FstLatencySource(IFstSource &source, unsigned int latency)
+{
+  this->source  = &source;
+  this->latency = latency;
+}
+
+
+bool FstLatencySource::Read(char* buffer, unsigned long long pos, unsigned long long length)
+{
+  std::this_thread::sleep_for(std::chrono::microseconds(latency));
+
+  return source->Read(buffer, pos, length);
+}
@@ -0,0 +1,169 @@
+/*
+  fst - An R-package for ultra fast storage and retrieval of datasets.
+  Copyright (C) 2017, Mark AJ Klik
+
+  BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following disclaimer
+    in the documentation and/or other materials provided with the
+    distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+    A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  You can contact the author at :
+  - fst source repository : https://github.com/fstPackage/fst
+*/
+
+
+#ifndef FST_IO_COUNTER_H
+#define FST_IO_COUNTER_H
+
+#include <atomic>
+
+#include <interface/ifstsource.h>
+#include <interface/ifstsink.h>
+
+
+/**
+ * \brief Source that forwards all calls to another source and counts the calls and the number of bytes.
+ *
+ * Used to measure the I/O pattern of the readers, e.g. the number and size of the reads of a column selection. Reads
+ * are counted from all threads. A Map() call that returns a nullptr is counted as a call without bytes, the data is
+ * then read with a (counted) Read() call.
+ */
+class FstCountingSource : public IFstSource
+{
+  IFstSource* source;
+  std::atomic<unsigned long long> readCalls;
+  std::atomic<unsigned long long> readBytes;
+  std::atomic<unsigned long long> mapCalls;
+  std::atomic<unsigned long long> mapBytes;
+
+public:
+  /**
+   * \brief Create a counting source
+   * \param source source that is read, owned by the caller
+   */
+  FstCountingSource(IFstSource &source);
+
+  ~FstCountingSource() {};
+
+  unsigned long long Size() { return source->Size(); }
+
+  bool Read(char* buffer, unsigned long long pos, unsigned long long length);
+
+  const char* Map(unsigned long long pos, unsigned long long length);
+
+  unsigned long long ReadCalls() const { return readCalls; }
+
+  unsigned long long ReadBytes() const { return readBytes; }
+
+  unsigned long long MapCalls() const { return mapCalls; }
+
+  /**
+   * \brief Number of bytes accessed through successful Map() calls
+   */
+  unsigned long long MapBytes() const { return mapBytes; }
+
+  void Reset();
+};
+
+
+/**
+ * \brief Sink that forwards all calls to another sink and counts the write calls and the number of bytes written.
+ */
+class FstCountingSink : public IFstSink
+{
+  IFstSink* sink;
+  unsigned long long writeCalls;
+  unsigned long long writeBytes;
+
+public:
+  /**
+   * \brief Create a counting sink
+   * \param sink sink that is written to, owned by the caller
+   */
+  FstCountingSink(IFstSink &sink);
+
+  ~FstCountingSink() {};
+
+  unsigned long long Size() { return sink->Size(); }
+
+  bool Write(const char* buffer, unsigned long long pos, unsigned long long length);
+
+  bool Fail() { return sink->Fail(); }
+
+  unsigned long long WriteCalls() const { return writeCalls; }
+
+  unsigned long long WriteBytes() const { return writeBytes; }
+
+  void Reset();
+};
+
+
+/**
+ * \brief Get the latency that is added to each request on a fst file opened by a store
+ * \return latency in microseconds, 0 if no latency is added
+ */
+unsigned int GetFstReadLatency();
+
+/**
+ * \brief Emulate slow storage (e.g. a network file system) by adding a latency to each request on a fst file
+ *
+ * Only meant for benchmarks of the number of requests of a read, files opened by a store are then read through a
+ * FstLatencySource.
+ * \param latency latency in microseconds, 0 to read the files directly
+ * \return the previous latency
+ */
+unsigned int SetFstReadLatency(unsigned int latency);
+
+
+/**
+ * \brief Source that forwards all reads to another source after a fixed delay per request.
+ *
+ * A local stand-in for slow storage such as a network file system or a cold disk, where the cost of a read is
+ * dominated by the number of requests. The source is never memory based, so Map() always returns a nullptr and all
+ * data is read with (delayed) Read() calls.
+ */
+class FstLatencySource : public IFstSource
+{
+  IFstSource* source;
+  unsigned int latency;
+
+public:
+  /**
+   * \brief Create a source with a latency
+   * \param source source that is read, owned by the caller
+   * \param latency delay of each request in microseconds
+   */
+  FstLatencySource(IFstSource &source, unsigned int latency);
+
+  ~FstLatencySource() {};
+
+  unsigned long long Size() { return source->Size(); }
+
+  bool Read(char* buffer, unsigned long long pos, unsigned long long length);
+
+  const char* Map(unsigned long long pos, unsigned long long length) { return nullptr; }
+};
+
+
+#endif // FST_IO_COUNTER_H
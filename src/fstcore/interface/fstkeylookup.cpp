@@ -0,0 +1,445 @@
+/*
+  fst - An R-package for ultra fast storage and retrieval of datasets.
+  Copyright (C) 2017, Mark AJ Klik
+
+  BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following disclaimer
+    in the documentation and/or other materials provided with the
+    distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+    A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  You can contact the author at :
+  - fst source repository : https://github.com/fstPackage/fst
+*/
+
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <map>
+
+#include <interface/fstdefines.h>
+#include <interface/fstkeylookup.h>
+
+using namespace std;
+
+
+template<class T>
+inline int CompareValues(T value, T key)
+{
+  if (value < key) return -1;
+  if (value > key) return 1;
+  return 0;
+}
+
+
+/**
+ * \brief Compare an element of a decoded key column with a lookup value, NA elements are smaller than all lookup values
+ * \return -1, 0 or 1 when the element is smaller than, equal to or larger than the lookup value
+ */
+inline int CompareElement(const KeyLookupColumn &keyCol, const FilterColumnData &data, unsigned long long elementNr,
+  unsigned long long keyNr)
+{
+  switch (keyCol.colType)
+  {
+    case 6:
+    {
+      if (data.strings.IsNA(elementNr)) return -1;
+
+      int res = data.strings.Element(elementNr).compare(keyCol.stringValues[keyNr]);
+      return CompareValues(res, 0);
+    }
+
+    case 7:
+    {
+      int value = reinterpret_cast<const int*>(data.values.data())[elementNr];
+      if (value == INT_MIN) return -1;
+
+      return CompareValues(value, keyCol.levelCodes[keyNr]);
+    }
+
+    case 9:
+    {
+      double value = reinterpret_cast<const double*>(data.values.data())[elementNr];
+      if (std::isnan(value)) return -1;
+
+      return CompareValues(value, keyCol.values[keyNr]);
+    }
+
+    case 11:
+    {
+      long long value = reinterpret_cast<const long long*>(data.values.data())[elementNr];
+      if (value == LLONG_MIN) return -1;
+
+      if (!keyCol.int64Values.empty()) return CompareValues(value, keyCol.int64Values[keyNr]);
+
+      return CompareValues(static_cast<double>(value), keyCol.values[keyNr]);
+    }
+
+    default:  // integer and logical columns
+    {
+      int value = reinterpret_cast<const int*>(data.values.data())[elementNr];
+      if (value == INT_MIN) return -1;
+
+      return CompareValues(static_cast<double>(value), keyCol.values[keyNr]);
+    }
+  }
+}
+
+
+/**
+ * \brief Compare two lookups on a single key column
+ */
+inline int CompareLookups(const KeyLookupColumn &keyCol, unsigned long long keyNr1, unsigned long long keyNr2)
+{
+  switch (keyCol.colType)
+  {
+    case 6:
+      return CompareValues(keyCol.stringValues[keyNr1].compare(keyCol.stringValues[keyNr2]), 0);
+
+    case 7:
+      return CompareValues(keyCol.levelCodes[keyNr1], keyCol.levelCodes[keyNr2]);
+
+    case 11:
+      if (!keyCol.int64Values.empty()) return CompareValues(keyCol.int64Values[keyNr1], keyCol.int64Values[keyNr2]);
+      return CompareValues(keyCol.values[keyNr1], keyCol.values[keyNr2]);
+
+    default:
+      return CompareValues(keyCol.values[keyNr1], keyCol.values[keyNr2]);
+  }
+}
+
+
+KeyColumnSearch::KeyColumnSearch(const KeyLookupColumn* keyCol, vector<ZoneMapBlock> &blocks,
+  IKeyBlockReader* blockReader)
+{
+  this->keyCol      = keyCol;
+  this->blockReader = blockReader;
+  this->blocks      = blocks;
+
+  cacheBlockNrs.assign(KEY_LOOKUP_CACHE_BLOCKS, -1);
+  cacheData.resize(KEY_LOOKUP_CACHE_BLOCKS);
+
+  for (unsigned int slot = 0; slot < cacheData.size(); ++slot)
+  {
+    cacheData[slot].colType = keyCol->colType;
+  }
+
+  nextCacheSlot = 0;
+}
+
+
+unsigned long long KeyColumnSearch::BlockNr(unsigned long long row) const
+{
+  // last block with a start row not larger than row
+  unsigned long long lower = 0;
+  unsigned long long upper = blocks.size() - 1;
+
+  while (lower < upper)
+  {
+    unsigned long long pos = (lower + upper + 1) / 2;
+
+    if (blocks[pos].startRow > row)
+    {
+      upper = pos - 1;
+    }
+    else
+    {
+      lower = pos;
+    }
+  }
+
+  return lower;
+}
+
+
+int KeyColumnSearch::CompareValue(const ZoneMapValue &value, unsigned long long keyNr) const
+{
+  switch (keyCol->colType)
+  {
+    case 7:
+      return CompareValues(value.intValue, static_cast<long long>(keyCol->levelCodes[keyNr]));
+
+    case 9:
+      return CompareValues(value.doubleValue, keyCol->values[keyNr]);
+
+    case 11:
+      if (!keyCol->int64Values.empty()) return CompareValues(value.intValue, keyCol->int64Values[keyNr]);
+      return CompareValues(static_cast<double>(value.intValue), keyCol->values[keyNr]);
+
+    default:  // integer columns
+      return CompareValues(static_cast<double>(value.intValue), keyCol->values[keyNr]);
+  }
+}
+
+
+int KeyColumnSearch::CompareRow(unsigned long long row, unsigned long long keyNr)
+{
+  long long blockNr = BlockNr(row);
+  unsigned int slot = 0;
+
+  for (; slot < cacheBlockNrs.size(); ++slot)
+  {
+    if (cacheBlockNrs[slot] == blockNr) break;
+  }
+
+  // Decode block into the oldest cache slot
+  if (slot == cacheBlockNrs.size())
+  {
+    slot = nextCacheSlot;
+    nextCacheSlot = (nextCacheSlot + 1) % cacheBlockNrs.size();
+
+    cacheBlockNrs[slot] = -1;
+    blockReader->ReadRows(blocks[blockNr].startRow, blocks[blockNr].nrOfRows, cacheData[slot]);
+    cacheBlockNrs[slot] = blockNr;
+  }
+
+  return CompareElement(*keyCol, cacheData[slot], row - blocks[blockNr].startRow, keyNr);
+}
+
+
+unsigned long long KeyColumnSearch::Bound(unsigned long long lowerRow, unsigned long long upperRow,
+  unsigned long long keyNr, bool upper)
+{
+  if (lowerRow >= upperRow) return upperRow;
+
+  // A row matches when its value is equal to or larger than (larger than for upper bounds) the lookup value. Because
+  // the values are sorted, the rows that match are at the end of the range.
+
+  unsigned long long firstBlock = BlockNr(lowerRow);
+  unsigned long long lastBlock = BlockNr(upperRow - 1);
+
+  // Binary search for the first block with a matching last row
+  unsigned long long lower = firstBlock;
+  unsigned long long upperBlock = lastBlock + 1;
+
+  while (lower < upperBlock)
+  {
+    unsigned long long pos = (lower + upperBlock) / 2;
+    ZoneMapBlock &block = blocks[pos];
+    unsigned long long blockEnd = block.startRow + block.nrOfRows;
+    int res;
+
+    if (block.hasStatistics && block.startRow >= lowerRow && blockEnd <= upperRow)
+    {
+      // NA values are smaller than all lookup values
+      res = block.naCount == block.nrOfRows ? -1 : CompareValue(block.maxValue, keyNr);
+    }
+    else
+    {
+      res = CompareRow(min(blockEnd, upperRow) - 1, keyNr);
+    }
+
+    if (res > 0 || (res == 0 && !upper))
+    {
+      upperBlock = pos;
+    }
+    else
+    {
+      lower = pos + 1;
+    }
+  }
+
+  if (lower > lastBlock) return upperRow;  // no matching rows
+
+  ZoneMapBlock &block = blocks[lower];
+  unsigned long long startRow = max(lowerRow, block.startRow);
+  unsigned long long endRow = min(upperRow, block.startRow + block.nrOfRows);
+
+  // The first non-NA value of a block is its minimum value
+  if (block.hasStatistics && startRow == block.startRow && endRow == block.startRow + block.nrOfRows)
+  {
+    int res = CompareValue(block.minValue, keyNr);
+
+    if (res > 0 || (res == 0 && !upper)) return block.startRow + block.naCount;
+  }
+
+  // Binary search on the rows of the block, the last row of the block matches
+  unsigned long long lowerPos = startRow;
+  unsigned long long upperPos = endRow - 1;
+
+  while (lowerPos < upperPos)
+  {
+    unsigned long long pos = (lowerPos + upperPos) / 2;
+    int res = CompareRow(pos, keyNr);
+
+    if (res > 0 || (res == 0 && !upper))
+    {
+      upperPos = pos;
+    }
+    else
+    {
+      lowerPos = pos + 1;
+    }
+  }
+
+  return lowerPos;
+}
+
+
+bool BindKeyLookup(const FstKeyLookup &keyLookup, int keyLength, const int* keyColPos, IStringColumn* colNames,
+  unsigned short int* colTypes, vector<KeyLookupColumn> &keyCols, std::string &errorMessage)
+{
+  if (keyLength == 0)
+  {
+    errorMessage = "Key lookups require a fst file with key columns";
+    return false;
+  }
+
+  int nrOfLookupCols = keyLookup.columns.size();
+
+  if (nrOfLookupCols == 0 || nrOfLookupCols > keyLength)
+  {
+    errorMessage = "A key lookup should use between 1 and " + to_string(keyLength) + " key columns";
+    return false;
+  }
+
+  keyCols.resize(nrOfLookupCols);
+  unsigned long long nrOfKeys = 0;
+
+  for (int keyNr = 0; keyNr < nrOfLookupCols; ++keyNr)
+  {
+    const FstKeyColumn &column = keyLookup.columns[keyNr];
+    KeyLookupColumn &keyCol = keyCols[keyNr];
+    int colNr = keyColPos[keyNr];
+
+    if (strcmp(column.columnName.c_str(), colNames->GetElement(colNr)) != 0)
+    {
+      errorMessage = "Lookup column '" + column.columnName + "' should be key column " + to_string(keyNr + 1) +
+        " ('" + colNames->GetElement(colNr) + "')";
+      return false;
+    }
+
+    unsigned short int colType = colTypes[colNr];
+    bool isString = colType == 6 || colType == 7;  // character or factor column
+
+    if (colType < 6 || colType > 11)
+    {
+      errorMessage = "Key column '" + column.columnName + "' has a type that can't be used for key lookups";
+      return false;
+    }
+
+    unsigned long long nrOfValues = isString ? column.stringValues.size() : column.values.size();
+
+    if ((isString && !column.values.empty()) || (!isString && !column.stringValues.empty()) ||
+      (!column.int64Values.empty() && column.int64Values.size() != column.values.size()))
+    {
+      errorMessage = "Lookup column '" + column.columnName + "' uses values of an incorrect type";
+      return false;
+    }
+
+    if (keyNr != 0 && nrOfValues != nrOfKeys)
+    {
+      errorMessage = "All lookup columns should have the same number of values";
+      return false;
+    }
+
+    nrOfKeys = nrOfValues;
+
+    keyCol.colNr = colNr;
+    keyCol.colType = colType;
+    keyCol.values = column.values;
+    keyCol.int64Values = colType == 11 ? column.int64Values : vector<long long>();
+    keyCol.stringValues = column.stringValues;
+  }
+
+  return true;
+}
+
+
+void SetKeyLevels(KeyLookupColumn &keyCol, FilterStringColumn &levels)
+{
+  map<std::string, int> levelCodes;
+
+  for (unsigned long long levelNr = 0; levelNr < levels.Length(); ++levelNr)
+  {
+    if (!levels.IsNA(levelNr)) levelCodes[levels.Element(levelNr)] = levelNr + 1;
+  }
+
+  keyCol.levelCodes.resize(keyCol.stringValues.size());
+
+  for (unsigned long long keyNr = 0; keyNr < keyCol.stringValues.size(); ++keyNr)
+  {
+    map<std::string, int>::iterator level = levelCodes.find(keyCol.stringValues[keyNr]);
+    keyCol.levelCodes[keyNr] = level == levelCodes.end() ? 0 : level->second;
+  }
+}
+
+
+void SortKeyLookups(const vector<KeyLookupColumn> &keyCols, vector<unsigned long long> &keyOrder)
+{
+  const KeyLookupColumn &firstCol = keyCols[0];
+  unsigned long long nrOfKeys = firstCol.colType == 6 || firstCol.colType == 7 ?
+    firstCol.stringValues.size() : firstCol.values.size();
+
+  keyOrder.clear();
+
+  // Lookups with unknown factor levels or NaN values can't match
+  for (unsigned long long keyNr = 0; keyNr < nrOfKeys; ++keyNr)
+  {
+    bool canMatch = true;
+
+    for (unsigned int colNr = 0; colNr < keyCols.size() && canMatch; ++colNr)
+    {
+      const KeyLookupColumn &keyCol = keyCols[colNr];
+
+      if (keyCol.colType == 7)
+      {
+        canMatch = keyCol.levelCodes[keyNr] != 0;
+      }
+      else if (keyCol.colType != 6 && keyCol.int64Values.empty())
+      {
+        canMatch = !std::isnan(keyCol.values[keyNr]);
+      }
+    }
+
+    if (canMatch) keyOrder.push_back(keyNr);
+  }
+
+  // Sort on all key columns
+  sort(keyOrder.begin(), keyOrder.end(), [&keyCols](unsigned long long keyNr1, unsigned long long keyNr2)
+  {
+    for (unsigned int colNr = 0; colNr < keyCols.size(); ++colNr)
+    {
+      int res = CompareLookups(keyCols[colNr], keyNr1, keyNr2);
+      if (res != 0) return res < 0;
+    }
+
+    return keyNr1 < keyNr2;
+  });
+
+  // Remove duplicate lookups
+  vector<unsigned long long>::iterator last = unique(keyOrder.begin(), keyOrder.end(),
+    [&keyCols](unsigned long long keyNr1, unsigned long long keyNr2)
+  {
+    for (unsigned int colNr = 0; colNr < keyCols.size(); ++colNr)
+    {
+      if (CompareLookups(keyCols[colNr], keyNr1, keyNr2) != 0) return false;
+    }
+
+    return true;
+  });
+
+  keyOrder.erase(last, keyOrder.end());
+}
@@ -0,0 +1,183 @@
+/*
+  fst - An R-package for ultra fast storage and retrieval of datasets.
+  Copyright (C) 2017, Mark AJ Klik
+
+  BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following disclaimer
+    in the documentation and/or other materials provided with the
+    distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+    A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  You can contact the author at :
+  - fst source repository : https://github.com/fstPackage/fst
+*/
+
+
+#ifndef FST_KEY_LOOKUP_H
+#define FST_KEY_LOOKUP_H
+
+
+#include <string>
+#include <vector>
+
+#include <interface/fstzonemap.h>
+#include <interface/fstfilter.h>
+
+
+/**
+ * \brief Values of a single key column for a batch of key lookups
+ *
+ * Numeric key columns (integer, double, integer64 and logical) use 'values', character and factor key columns use
+ * 'stringValues'. All value vectors of a lookup have the same length, element i of each vector is part of lookup i.
+ */
+class FstKeyColumn
+{
+public:
+  std::string columnName;                 // name of the key column
+  std::vector<double> values;             // lookup values for numeric key columns
+  std::vector<long long> int64Values;     // exact values for integer64 key columns (optional, used instead of 'values')
+  std::vector<std::string> stringValues;  // lookup values for character and factor key columns
+};
+
+
+/**
+ * \brief Batch of key lookups on a fst file that was stored with key columns (a sorted table)
+ *
+ * The lookup columns should be the first (or all) key columns of the table, in the order of the key. A row of the
+ * table is selected when its key columns are equal to all lookup columns of at least one of the lookups.
+ */
+class FstKeyLookup
+{
+public:
+  std::vector<FstKeyColumn> columns;
+};
+
+
+// Key lookup column bound to a column of a fst table
+struct KeyLookupColumn
+{
+  int colNr;                              // column number in the table
+  unsigned short int colType;             // fst column type
+  std::vector<double> values;             // numeric lookup values
+  std::vector<long long> int64Values;     // exact integer64 lookup values (optional)
+  std::vector<std::string> stringValues;  // character lookup values
+  std::vector<int> levelCodes;            // factor columns only: level code of each lookup value, 0 if not a level
+};
+
+
+/**
+ * \brief Reads a range of rows of a key column
+ */
+class IKeyBlockReader
+{
+public:
+  virtual ~IKeyBlockReader() {};
+
+  /**
+   * \brief Decode a range of rows of the key column
+   * \param startRow first row to decode
+   * \param length number of rows to decode
+   * \param data decoded values (output), the column type is set by the caller
+   */
+  virtual void ReadRows(unsigned long long startRow, unsigned long long length, FilterColumnData &data) = 0;
+};
+
+
+/**
+ * \brief Binary search on a key column of a fst file
+ *
+ * The column is divided in the blocks that were used to store the column data. A search first selects the block that
+ * contains the requested bound using the zone map statistics of the blocks (when available) and then decodes only that
+ * block (and possibly a block at the edge of the search range). The most recently decoded blocks are kept in a cache,
+ * so lookups with nearby keys can reuse them.
+ */
+class KeyColumnSearch
+{
+  const KeyLookupColumn* keyCol;
+  IKeyBlockReader* blockReader;
+  std::vector<ZoneMapBlock> blocks;
+
+  std::vector<long long> cacheBlockNrs;
+  std::vector<FilterColumnData> cacheData;
+  unsigned int nextCacheSlot;
+
+public:
+  /**
+   * \brief Create a key column search
+   * \param keyCol bound key lookup column
+   * \param blocks consecutive storage blocks of the key column, covering all rows that can be searched. The statistics
+   * of a block should only be marked as available when all rows of the block are part of the searchable range.
+   * \param blockReader reader used to decode blocks of the key column
+   */
+  KeyColumnSearch(const KeyLookupColumn* keyCol, std::vector<ZoneMapBlock> &blocks, IKeyBlockReader* blockReader);
+
+  /**
+   * \brief Find the first row in a sorted range of rows with a value equal to or larger than a lookup value
+   * \param lowerRow first row of the range
+   * \param upperRow row after the last row of the range, the values in the range should be sorted (NA values first)
+   * \param keyNr lookup number
+   * \param upper if true, find the first row with a value larger than the lookup value
+   * \return the requested row, upperRow when all values in the range are smaller than (or equal to) the lookup value
+   */
+  unsigned long long Bound(unsigned long long lowerRow, unsigned long long upperRow, unsigned long long keyNr,
+    bool upper);
+
+private:
+  unsigned long long BlockNr(unsigned long long row) const;
+
+  int CompareValue(const ZoneMapValue &value, unsigned long long keyNr) const;
+
+  int CompareRow(unsigned long long row, unsigned long long keyNr);
+};
+
+
+/**
+ * \brief Bind a key lookup to the key columns of a table
+ * \param keyLookup key lookup specification
+ * \param keyLength number of key columns of the table
+ * \param keyColPos column numbers of the key columns
+ * \param colNames names of all columns of the table
+ * \param colTypes types of all columns of the table
+ * \param keyCols bound lookup columns (output)
+ * \param errorMessage description of the problem if the lookup can't be bound (output)
+ * \return false if the lookup columns are not the leading key columns of the table or have incorrect values
+ */
+bool BindKeyLookup(const FstKeyLookup &keyLookup, int keyLength, const int* keyColPos, IStringColumn* colNames,
+  unsigned short int* colTypes, std::vector<KeyLookupColumn> &keyCols, std::string &errorMessage);
+
+/**
+ * \brief Determine the level codes of the lookup values of a factor key column
+ * \param keyCol bound factor lookup column
+ * \param levels level strings of the factor column
+ */
+void SetKeyLevels(KeyLookupColumn &keyCol, FilterStringColumn &levels);
+
+/**
+ * \brief Sort the lookups in key order, duplicate lookups and lookups that can't match are removed
+ * \param keyCols bound lookup columns
+ * \param keyOrder lookup numbers in key order (output)
+ */
+void SortKeyLookups(const std::vector<KeyLookupColumn> &keyCols, std::vector<unsigned long long> &keyOrder);
+
+
+#endif  // FST_KEY_LOOKUP_H
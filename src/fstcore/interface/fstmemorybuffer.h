@@ -0,0 +1,84 @@
+/*
+  fst - An R-package for ultra fast storage and retrieval of datasets.
+  Copyright (C) 2017, Mark AJ Klik
+
+  BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following disclaimer
+    in the documentation and/or other materials provided with the
+    distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+    A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  You can contact the author at :
+  - fst source repository : https://github.com/fstPackage/fst
+*/
+
+#ifndef FST_MEMORY_BUFFER_H
+#define FST_MEMORY_BUFFER_H
+
+#include <interface/ifstsink.h>
+
+
+/**
+ * \brief Sink that stores the written data in a growable memory region.
+ *
+ * Used to collect a column (or a block of strings) in memory, so that multiple columns can be compressed concurrently
+ * before they are appended to the file. Also used to serialize a complete table to memory. The region is allocated
+ * with the expected size and grows if more data is written.
+ */
+class FstMemoryBuffer : public IFstSink
+{
+  char* buffer;
+  unsigned long long capacity;
+  unsigned long long size;  // number of bytes written (high-water mark)
+
+public:
+  /**
+   * \brief Create a buffer
+   * \param capacity initial size of the memory region in bytes
+   */
+  FstMemoryBuffer(unsigned long long capacity);
+
+  ~FstMemoryBuffer() { delete[] buffer; }
+
+  /**
+   * \brief Data written to the buffer
+   */
+  const char* Data() const { return buffer; }
+
+  /**
+   * \brief Discard the written data, the memory region is kept for reuse
+   */
+  void Clear() { size = 0; }
+
+  unsigned long long Size() { return size; }
+
+  bool Write(const char* data, unsigned long long pos, unsigned long long length);
+
+  bool Fail() { return false; }
+
+private:
+  void Reserve(unsigned long long minCapacity);
+};
+
+
+#endif // FST_MEMORY_BUFFER_H
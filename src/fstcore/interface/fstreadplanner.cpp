@@ -0,0 +1,272 @@
+/*
+  fst - An R-package for ultra fast storage and retrieval of datasets.
+  Copyright (C) 2017, Mark AJ Klik
+
+  BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following disclaimer
+    in the documentation and/or other materials provided with the
+    distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+    A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  You can contact the author at :
+  - fst source repository : https://github.com/fstPackage/fst
+*/
+
+
+#include <algorithm>
+#include <cstring>
+
+#include <interface/fstreadplanner.h>
+#include <interface/fstdefines.h>
+#include <interface/fstasyncreader.h>
+
+using namespace std;
+
+
+// Gap used by all reads, a negative value disables the read planner
+static long long FstReadGap = READ_PLAN_GAP;
+
+
+long long GetFstReadGap()
+{
+  return FstReadGap;
+}
+
+
+long long SetFstReadGap(long long readGap)
+{
+  long long previousGap = FstReadGap;
+  FstReadGap = readGap;
+
+  return previousGap;
+}
+
+
+FstReadPlanner::FstReadPlanner(IFstSource &source, unsigned long long maxGap, unsigned long long budget)
+{
+  this->source       = &source;
+  this->maxGap       = maxGap;
+  this->budget       = budget;
+  this->plannedBytes = 0;
+  this->fetchCalls   = 0;
+}
+
+
+FstReadPlanner::~FstReadPlanner()
+{
+  for (unsigned int rangeNr = 0; rangeNr < fetched.size(); ++rangeNr)
+  {
+    delete[] fetched[rangeNr].data;
+  }
+}
+
+
+const FstReadPlanner::PlanRange* FstReadPlanner::Find(unsigned long long pos, unsigned long long length) const
+{
+  unsigned long long end = pos + length;
+
+  // first fetched range that starts after pos
+  unsigned int high = fetched.size();
+  unsigned int low = 0;
+
+  while (low < high)
+  {
+    unsigned int mid = low + (high - low) / 2;
+
+    if (fetched[mid].pos <= pos)
+    {
+      low = mid + 1;
+    }
+    else
+    {
+      high = mid;
+    }
+  }
+
+  // fetched ranges can overlap, so earlier ranges are tested as long as they could contain the requested range
+  for (unsigned int rangeNr = low; rangeNr > 0 && fetched[rangeNr - 1].maxEnd >= end; --rangeNr)
+  {
+    const PlanRange &range = fetched[rangeNr - 1];
+
+    if (range.pos + range.length >= end) return &range;
+  }
+
+  return nullptr;
+}
+
+
+bool FstReadPlanner::Require(unsigned long long pos, unsigned long long length)
+{
+  if (length == 0 || Find(pos, length) != nullptr) return true;
+
+  // ranges outside the source are left to the readers, which report the damaged data
+  unsigned long long size = source->Size();
+
+  if (pos > size || length > size - pos) return false;
+
+  if (plannedBytes + length > budget) return false;
+
+  PlanRange range;
+  range.pos    = pos;
+  range.length = length;
+  range.data   = nullptr;
+  range.maxEnd = 0;
+
+  requested.push_back(range);
+  plannedBytes += length;
+
+  return false;
+}
+
+
+bool FstReadPlanner::Fetch()
+{
+  if (requested.empty()) return false;
+
+  sort(requested.begin(), requested.end(), [](const PlanRange &range1, const PlanRange &range2)
+  {
+    return range1.pos < range2.pos;
+  });
+
+  // Merge overlapping ranges and ranges that are less than maxGap bytes apart
+  vector<PlanRange> merged;
+  merged.push_back(requested[0]);
+
+  for (unsigned int rangeNr = 1; rangeNr < requested.size(); ++rangeNr)
+  {
+    PlanRange &last = merged.back();
+    PlanRange &range = requested[rangeNr];
+    unsigned long long lastEnd = last.pos + last.length;
+
+    if (range.pos <= lastEnd + maxGap)
+    {
+      last.length = max(lastEnd, range.pos + range.length) - last.pos;
+      continue;
+    }
+
+    merged.push_back(range);
+  }
+
+  requested.clear();
+
+  // Merged ranges are split into pieces that are read concurrently by an asynchronous reader, so that a large range is
+  // read with multiple outstanding requests
+  vector<unsigned int> pieceRanges;
+  vector<unsigned long long> pieceOffsets;
+
+  for (unsigned int rangeNr = 0; rangeNr < merged.size(); ++rangeNr)
+  {
+    PlanRange &range = merged[rangeNr];
+    range.data = new char[range.length];
+
+    ++fetchCalls;
+
+    for (unsigned long long offset = 0; offset < range.length; offset += READ_QUEUE_FETCH_SIZE)
+    {
+      pieceRanges.push_back(rangeNr);
+      pieceOffsets.push_back(offset);
+    }
+  }
+
+  vector<bool> isRead(merged.size(), true);
+  int queueDepth = GetFstReadQueueDepth();
+  int nrOfPieces = static_cast<int>(pieceRanges.size());
+
+  if (queueDepth > 0 && nrOfPieces > 1)
+  {
+    FstAsyncReader asyncReader(*source, nrOfPieces, min(queueDepth, nrOfPieces));
+
+    for (int pieceNr = 0; pieceNr < nrOfPieces; ++pieceNr)
+    {
+      PlanRange &range = merged[pieceRanges[pieceNr]];
+      unsigned long long offset = pieceOffsets[pieceNr];
+
+      asyncReader.Submit(pieceNr, pieceNr, range.data + offset, range.pos + offset,
+        min(static_cast<unsigned long long>(READ_QUEUE_FETCH_SIZE), range.length - offset));
+    }
+
+    for (int pieceNr = 0; pieceNr < nrOfPieces; ++pieceNr)
+    {
+      if (!asyncReader.Wait(pieceNr, pieceNr)) isRead[pieceRanges[pieceNr]] = false;
+    }
+  }
+  else
+  {
+    for (unsigned int rangeNr = 0; rangeNr < merged.size(); ++rangeNr)
+    {
+      isRead[rangeNr] = source->Read(merged[rangeNr].data, merged[rangeNr].pos, merged[rangeNr].length);
+    }
+  }
+
+  bool isFetched = false;
+
+  for (unsigned int rangeNr = 0; rangeNr < merged.size(); ++rangeNr)
+  {
+    // a range that can't be read is read (and reported) by the readers themselves
+    if (!isRead[rangeNr])
+    {
+      delete[] merged[rangeNr].data;
+      continue;
+    }
+
+    fetched.push_back(merged[rangeNr]);
+    isFetched = true;
+  }
+
+  sort(fetched.begin(), fetched.end(), [](const PlanRange &range1, const PlanRange &range2)
+  {
+    return range1.pos < range2.pos;
+  });
+
+  unsigned long long maxEnd = 0;
+
+  for (unsigned int rangeNr = 0; rangeNr < fetched.size(); ++rangeNr)
+  {
+    maxEnd = max(maxEnd, fetched[rangeNr].pos + fetched[rangeNr].length);
+    fetched[rangeNr].maxEnd = maxEnd;
+  }
+
+  return isFetched;
+}
+
+
+bool FstReadPlanner::Read(char* buffer, unsigned long long pos, unsigned long long length)
+{
+  const PlanRange* range = Find(pos, length);
+
+  if (range == nullptr) return source->Read(buffer, pos, length);
+
+  memcpy(buffer, range->data + (pos - range->pos), length);
+
+  return true;
+}
+
+
+const char* FstReadPlanner::Map(unsigned long long pos, unsigned long long length)
+{
+  const PlanRange* range = Find(pos, length);
+
+  if (range == nullptr) return source->Map(pos, length);
+
+  return range->data + (pos - range->pos);
+}
@@ -0,0 +1,137 @@
+/*
+  fst - An R-package for ultra fast storage and retrieval of datasets.
+  Copyright (C) 2017, Mark AJ Klik
+
+  BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following disclaimer
+    in the documentation and/or other materials provided with the
+    distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+    A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  You can contact the author at :
+  - fst source repository : https://github.com/fstPackage/fst
+*/
+
+
+#ifndef FST_READ_PLANNER_H
+#define FST_READ_PLANNER_H
+
+#include <vector>
+
+#include <interface/ifstsource.h>
+
+
+/**
+ * \brief Get the maximum gap between two byte ranges that are merged into a single read by the read planner
+ * \return gap in bytes, a negative value if the read planner is disabled
+ */
+long long GetFstReadGap();
+
+/**
+ * \brief Set the maximum gap between two byte ranges that are merged into a single read by the read planner
+ *
+ * The bytes in the gap are read but not used, so a larger gap trades bandwidth for fewer requests. A negative value
+ * disables the read planner, the columns are then read with separate requests for each header, index and block batch.
+ * \param readGap gap in bytes
+ * \return the previous gap
+ */
+long long SetFstReadGap(long long readGap);
+
+
+/**
+ * \brief Source that serves the reads of a column selection from a few large reads on another source.
+ *
+ * The byte ranges needed by the column readers are planned first: for each column the header is parsed and the
+ * required part of the block index and the data blocks is determined. Ranges that are planned in the same pass are
+ * sorted, merged when they are less than a gap apart and read with a single request each. Because the headers have to
+ * be read before the index and the index before the data, planning takes a few passes with a round of merged reads
+ * each.
+ *
+ * Afterwards the readers use the planner as their source. Reads and mappings that fall inside a fetched range are
+ * served from memory (so blocks are decompressed directly from the fetched buffers), all other requests are passed to
+ * the underlying source. A plan only affects the number and size of the requests, not the result of a read.
+ *
+ * Planning (Require and Fetch) is done by a single thread, reads from the planned source can be done by all threads.
+ */
+class FstReadPlanner : public IFstSource
+{
+  // A range of bytes of the underlying source
+  struct PlanRange
+  {
+    unsigned long long pos;
+    unsigned long long length;
+    char* data;                 // fetched bytes, nullptr for a requested range
+    unsigned long long maxEnd;  // largest end position of this and all preceding fetched ranges
+  };
+
+  IFstSource* source;
+  unsigned long long maxGap;
+  unsigned long long budget;          // maximum number of bytes held by the planner
+  unsigned long long plannedBytes;    // bytes requested or fetched so far
+  unsigned long long fetchCalls;      // number of merged ranges read from the underlying source
+  std::vector<PlanRange> requested;   // ranges requested since the last fetch
+  std::vector<PlanRange> fetched;     // fetched ranges sorted on position
+
+  const PlanRange* Find(unsigned long long pos, unsigned long long length) const;
+
+public:
+  /**
+   * \brief Create a planner on a source
+   * \param source source that is read, owned by the caller
+   * \param maxGap maximum gap in bytes between ranges that are merged into a single read
+   * \param budget maximum number of bytes that are fetched, the remaining ranges are read directly by the readers
+   */
+  FstReadPlanner(IFstSource &source, unsigned long long maxGap, unsigned long long budget);
+
+  ~FstReadPlanner();
+
+  /**
+   * \brief Request a range of bytes for the next fetch
+   * \return true if the range was already fetched and can be read, false if the range is requested (or can't be
+   * planned within the budget)
+   */
+  bool Require(unsigned long long pos, unsigned long long length);
+
+  /**
+   * \brief Read all requested ranges, merged into as few ranges as possible
+   *
+   * Large ranges are read in pieces with concurrent requests when asynchronous reads are enabled (see
+   * SetFstReadQueueDepth).
+   * \return true if any range was read
+   */
+  bool Fetch();
+
+  /**
+   * \brief Number of merged ranges read from the underlying source by Fetch()
+   */
+  unsigned long long FetchCalls() const { return fetchCalls; }
+
+  unsigned long long Size() { return source->Size(); }
+
+  bool Read(char* buffer, unsigned long long pos, unsigned long long length);
+
+  const char* Map(unsigned long long pos, unsigned long long length);
+};
+
+
+#endif // FST_READ_PLANNER_H
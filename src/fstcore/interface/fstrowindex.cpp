@@ -0,0 +1,129 @@
+/*
+  fst - An R-package for ultra fast storage and retrieval of datasets.
+  Copyright (C) 2017, Mark AJ Klik
+
+  BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following disclaimer
+    in the documentation and/or other materials provided with the
+    distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+    A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  You can contact the author at :
+  - fst source repository : https://github.com/fstPackage/fst
+*/
+
+
+#include <algorithm>
+
+#include <interface/fstrowindex.h>
+
+
+using namespace std;
+
+
+void ScatterStringColumn::BufferToVec(unsigned long long nrOfElements, unsigned long long startElem,
+  unsigned long long endElem, unsigned long long vecOffset, const unsigned int* sizeMeta, const char* buf)
+{
+  unsigned long long selectionPos = selectionOffset + vecOffset;
+
+  for (unsigned long long blockElem = startElem; blockElem <= endElem; ++blockElem)
+  {
+    unsigned long long bitNr = selectionPos + blockElem - startElem;
+
+    if (((selection[bitNr / 64] >> (bitNr % 64)) & 1) == 0) continue;
+
+    // the element is copied from the source block to each result position of the selected row
+    for (unsigned long long posNr = scatter->offsets[selectedNr]; posNr < scatter->offsets[selectedNr + 1]; ++posNr)
+    {
+      target->BufferToVec(nrOfElements, blockElem, blockElem, scatter->positions[posNr], sizeMeta, buf);
+    }
+
+    ++selectedNr;
+  }
+}
+
+
+bool SortRowIndex(const FstRowIndex &rowIndex, unsigned long long nrOfRows, vector<unsigned long long> &selectedRows,
+  RowScatter &scatter, string &errorMessage)
+{
+  const vector<unsigned long long> &rows = rowIndex.rows;
+  unsigned long long nrOfRequested = rows.size();
+  bool inOrder = true;
+
+  for (unsigned long long pos = 0; pos < nrOfRequested; ++pos)
+  {
+    if (rows[pos] < 1 || rows[pos] > nrOfRows)
+    {
+      errorMessage = "Row index is out of range.";
+      return false;
+    }
+
+    if (pos > 0 && rows[pos] <= rows[pos - 1]) inOrder = false;
+  }
+
+  selectedRows.clear();
+  scatter.offsets.clear();
+  scatter.positions.clear();
+
+  // Rows requested in table order without duplicates are read directly into the result
+  if (inOrder)
+  {
+    selectedRows.resize(nrOfRequested);
+
+    for (unsigned long long pos = 0; pos < nrOfRequested; ++pos)
+    {
+      selectedRows[pos] = rows[pos] - 1;
+    }
+
+    return true;
+  }
+
+  // Result positions ordered by row, positions of duplicate rows keep their order
+  vector<unsigned long long> order(nrOfRequested);
+
+  for (unsigned long long pos = 0; pos < nrOfRequested; ++pos)
+  {
+    order[pos] = pos;
+  }
+
+  stable_sort(order.begin(), order.end(), [&rows](unsigned long long pos1, unsigned long long pos2)
+  {
+    return rows[pos1] < rows[pos2];
+  });
+
+  for (unsigned long long orderNr = 0; orderNr < nrOfRequested; ++orderNr)
+  {
+    unsigned long long row = rows[order[orderNr]] - 1;
+
+    if (selectedRows.empty() || row != selectedRows.back())
+    {
+      selectedRows.push_back(row);
+      scatter.offsets.push_back(orderNr);
+    }
+  }
+
+  scatter.offsets.push_back(nrOfRequested);
+  scatter.positions.swap(order);
+
+  return true;
+}
@@ -0,0 +1,129 @@
+/*
+  fst - An R-package for ultra fast storage and retrieval of datasets.
+  Copyright (C) 2017, Mark AJ Klik
+
+  BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following disclaimer
+    in the documentation and/or other materials provided with the
+    distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+    A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  You can contact the author at :
+  - fst source repository : https://github.com/fstPackage/fst
+*/
+
+
+#ifndef FST_ROW_INDEX_H
+#define FST_ROW_INDEX_H
+
+
+#include <string>
+#include <vector>
+
+#include <interface/ifstcolumn.h>
+
+
+/**
+ * \brief Selection of rows of a fst file by row number
+ *
+ * Row numbers are 1-based and can be in any order, rows that are selected more than once are read once and copied to
+ * all requested positions. The result has a row for each element of 'rows', in the same order.
+ */
+class FstRowIndex
+{
+public:
+  std::vector<unsigned long long> rows;  // requested row numbers (1-based)
+};
+
+
+/**
+ * \brief Result positions of the selected rows of a row index
+ *
+ * The distinct selected rows are numbered in table order. Selected row i is copied to result positions
+ * positions[offsets[i]] up to (but not including) positions[offsets[i + 1]].
+ */
+struct RowScatter
+{
+  std::vector<unsigned long long> offsets;
+  std::vector<unsigned long long> positions;
+};
+
+
+/**
+ * \brief Copies the selected strings of each block to all of their result positions
+ *
+ * Used when reading the rows of a row index that are not requested in table order (or more than once).
+ */
+class ScatterStringColumn : public IStringColumn
+{
+  IStringColumn* target;
+  const unsigned long long* selection;
+  unsigned long long selectionOffset;
+  unsigned long long selectedNr;  // number of the next selected row
+  const RowScatter* scatter;
+
+public:
+  /**
+   * \param target result column with room for all requested rows
+   * \param selection bitmap with the selected rows
+   * \param selectionOffset bit of the first row read into this column
+   * \param selectedNr number of the first selected row read into this column
+   * \param scatter result positions of the selected rows
+   */
+  ScatterStringColumn(IStringColumn* target, const unsigned long long* selection, unsigned long long selectionOffset,
+    unsigned long long selectedNr, const RowScatter* scatter)
+  {
+    this->target = target;
+    this->selection = selection;
+    this->selectionOffset = selectionOffset;
+    this->selectedNr = selectedNr;
+    this->scatter = scatter;
+  }
+
+  // the target column is allocated by its owner
+  void AllocateVec(unsigned long long vecLength) {}
+
+  void SetEncoding(StringEncoding stringEncoding) { target->SetEncoding(stringEncoding); }
+
+  void BufferToVec(unsigned long long nrOfElements, unsigned long long startElem, unsigned long long endElem,
+    unsigned long long vecOffset, const unsigned int* sizeMeta, const char* buf);
+
+  const char* GetElement(unsigned long long elementNr) { return target->GetElement(elementNr); }
+};
+
+
+/**
+ * \brief Sort the rows of a row index and determine the result positions of each distinct row
+ * \param rowIndex requested rows
+ * \param nrOfRows number of rows in the table
+ * \param selectedRows distinct requested rows (0-based) in table order (output)
+ * \param scatter result positions of the selected rows (output), left empty if the rows were requested in table order
+ * without duplicates
+ * \param errorMessage description of the problem if the row index can't be used (output)
+ * \return false if the row index contains rows outside the table
+ */
+bool SortRowIndex(const FstRowIndex &rowIndex, unsigned long long nrOfRows, std::vector<unsigned long long> &selectedRows,
+  RowScatter &scatter, std::string &errorMessage);
+
+
+#endif  // FST_ROW_INDEX_H
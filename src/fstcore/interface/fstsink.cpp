@@ -0,0 +1,254 @@
+/*
+  fst - An R-package for ultra fast storage and retrieval of datasets.
+  Copyright (C) 2017, Mark AJ Klik
+
+  BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following disclaimer
+    in the documentation and/or other materials provided with the
+    distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+    A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  You can contact the author at :
+  - fst source repository : https://github.com/fstPackage/fst
+*/
+
+
+#include <cstring>
+#include <cerrno>
+
+#ifdef _WIN32
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <sys/stat.h>
+#endif
+
+#include <interface/fstsink.h>
+
+using namespace std;
+
+
+FstFileSink::FstFileSink()
+{
+  this->fileHandle = -1;
+  this->fileSize   = 0;
+  this->buffer     = nullptr;
+  this->bufferPos  = 0;
+  this->bufferSize = 0;
+  this->failed     = false;
+}
+
+
+bool FstFileSink::Create(const string &fileName)
+{
+  return OpenFile(fileName, true);
+}
+
+
+bool FstFileSink::Open(const string &fileName)
+{
+  return OpenFile(fileName, false);
+}
+
+
+bool FstFileSink::OpenFile(const string &fileName, bool truncate)
+{
+  Close();
+
+  failed = false;
+
+#ifdef _WIN32
+  HANDLE handle = CreateFileA(fileName.c_str(), GENERIC_WRITE, FILE_SHARE_READ, NULL,
+    truncate ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, NULL);
+
+  if (handle == INVALID_HANDLE_VALUE) return false;
+
+  LARGE_INTEGER size;
+
+  if (!GetFileSizeEx(handle, &size))
+  {
+    CloseHandle(handle);
+    return false;
+  }
+
+  fileHandle = reinterpret_cast<intptr_t>(handle);
+  fileSize   = static_cast<unsigned long long>(size.QuadPart);
+#else
+  int fd = truncate ? open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666) : open(fileName.c_str(), O_WRONLY);
+
+  if (fd == -1) return false;
+
+  struct stat fileStat;
+
+  if (fstat(fd, &fileStat) != 0)
+  {
+    close(fd);
+    return false;
+  }
+
+  fileHandle = fd;
+  fileSize   = static_cast<unsigned long long>(fileStat.st_size);
+#endif
+
+  buffer = new char[FST_SINK_BUFFER_SIZE];
+  bufferPos = fileSize;
+  bufferSize = 0;
+
+  return true;
+}
+
+
+bool FstFileSink::Flush()
+{
+  if (bufferSize > 0)
+  {
+    if (!WritePositional(buffer, bufferPos, bufferSize)) failed = true;
+
+    bufferPos += bufferSize;
+    bufferSize = 0;
+  }
+
+  return !failed;
+}
+
+
+bool FstFileSink::Close()
+{
+  if (fileHandle == -1) return !failed;
+
+  Flush();
+
+#ifdef _WIN32
+  if (!CloseHandle(reinterpret_cast<HANDLE>(fileHandle))) failed = true;
+#else
+  if (close(static_cast<int>(fileHandle)) != 0) failed = true;
+#endif
+
+  fileHandle = -1;
+  fileSize = 0;
+
+  delete[] buffer;
+  buffer = nullptr;
+
+  return !failed;
+}
+
+
+bool FstFileSink::Write(const char* data, unsigned long long pos, unsigned long long length)
+{
+  if (fileHandle == -1)
+  {
+    failed = true;
+    return false;
+  }
+
+  // Appended data is collected in the write buffer
+  if (pos == fileSize && length < FST_SINK_BUFFER_SIZE)
+  {
+    if (bufferSize + length > FST_SINK_BUFFER_SIZE) Flush();
+
+    if (bufferSize == 0) bufferPos = pos;
+
+    memcpy(&buffer[bufferSize], data, length);
+    bufferSize += length;
+    fileSize += length;
+
+    return true;
+  }
+
+  // A header that is rewritten while it's still in the buffer is updated in memory
+  if (bufferSize > 0 && pos >= bufferPos && pos + length <= fileSize)
+  {
+    memcpy(&buffer[pos - bufferPos], data, length);
+    return true;
+  }
+
+  // Writes overlapping the buffered bytes are done after the buffer is written, so they are not overwritten later
+  if (bufferSize > 0 && pos + length > bufferPos) Flush();
+
+  if (!WritePositional(data, pos, length))
+  {
+    failed = true;
+    return false;
+  }
+
+  if (pos + length > fileSize) fileSize = pos + length;
+  if (bufferSize == 0) bufferPos = fileSize;
+
+  return true;
+}
+
+
+bool FstFileSink::WritePositional(const char* data, unsigned long long pos, unsigned long long length)
+{
+  // Large writes are split, a single write call is limited to 2^31 bytes on most platforms
+  const unsigned long long maxWrite = 1ULL << 30;
+
+  while (length > 0)
+  {
+    unsigned long long writeSize = length < maxWrite ? length : maxWrite;
+
+#ifdef _WIN32
+    // The handle is opened for overlapped IO, so the file pointer is ignored
+    OVERLAPPED overlapped;
+    memset(&overlapped, 0, sizeof(OVERLAPPED));
+    overlapped.Offset     = static_cast<DWORD>(pos & 0xffffffffULL);
+    overlapped.OffsetHigh = static_cast<DWORD>(pos >> 32);
+    overlapped.hEvent     = CreateEventA(NULL, TRUE, FALSE, NULL);
+
+    if (overlapped.hEvent == NULL) return false;
+
+    HANDLE handle = reinterpret_cast<HANDLE>(fileHandle);
+    DWORD bytesWritten = 0;
+
+    if (!::WriteFile(handle, data, static_cast<DWORD>(writeSize), NULL, &overlapped) &&
+      GetLastError() != ERROR_IO_PENDING)
+    {
+      CloseHandle(overlapped.hEvent);
+      return false;
+    }
+
+    BOOL isWritten = GetOverlappedResult(handle, &overlapped, &bytesWritten, TRUE);
+    CloseHandle(overlapped.hEvent);
+
+    if (!isWritten || bytesWritten == 0) return false;
+#else
+    ssize_t bytesWritten = pwrite(static_cast<int>(fileHandle), data, static_cast<size_t>(writeSize),
+      static_cast<off_t>(pos));
+
+    if (bytesWritten == -1 && errno == EINTR) continue;  // interrupted by a signal before writing any data
+    if (bytesWritten <= 0) return false;
+#endif
+
+    // a positional write can write less bytes than requested
+    data   += bytesWritten;
+    pos    += bytesWritten;
+    length -= bytesWritten;
+  }
+
+  return true;
+}
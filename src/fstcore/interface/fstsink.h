@@ -0,0 +1,108 @@
+/*
+  fst - An R-package for ultra fast storage and retrieval of datasets.
+  Copyright (C) 2017, Mark AJ Klik
+
+  BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following disclaimer
+    in the documentation and/or other materials provided with the
+    distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+    A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  You can contact the author at :
+  - fst source repository : https://github.com/fstPackage/fst
+*/
+
+
+#ifndef FST_SINK_H
+#define FST_SINK_H
+
+#include <string>
+#include <cstdint>
+
+#include <interface/ifstsink.h>
+
+
+#define FST_SINK_BUFFER_SIZE 1048576  // bytes collected before appended data is written to the file
+
+
+/**
+ * \brief Sink that writes to a file with positional writes (pwrite) on a file descriptor.
+ *
+ * Data appended at the end of the file is collected in a write buffer, so the many small writes of the column headers
+ * and string blocks don't each result in a system call. Headers that are rewritten while they are still in the
+ * buffer are updated in memory. Large writes bypass the buffer.
+ */
+class FstFileSink : public IFstSink
+{
+  intptr_t fileHandle;            // file descriptor (or HANDLE on Windows), -1 if no file is opened
+  unsigned long long fileSize;    // size of the file, including the buffered bytes
+  char* buffer;                   // appended bytes that are not written to the file yet
+  unsigned long long bufferPos;   // file position of the first buffered byte
+  unsigned long long bufferSize;  // number of buffered bytes, these are always at the end of the file
+  bool failed;
+
+public:
+  FstFileSink();
+
+  ~FstFileSink() { Close(); }
+
+  /**
+   * \brief Create a new file, an existing file is truncated
+   * \param fileName path of the file
+   * \return false if the file can't be created
+   */
+  bool Create(const std::string &fileName);
+
+  /**
+   * \brief Open an existing file for in-place updates, data is appended at the end of the file
+   * \param fileName path of the file
+   * \return false if the file can't be opened
+   */
+  bool Open(const std::string &fileName);
+
+  /**
+   * \brief Write the buffered bytes to the file
+   * \return false if the write failed (or an earlier write failed)
+   */
+  bool Flush();
+
+  /**
+   * \brief Flush the buffered bytes and close the file
+   * \return false if one of the writes failed
+   */
+  bool Close();
+
+  unsigned long long Size() { return fileSize; }
+
+  bool Write(const char* buffer, unsigned long long pos, unsigned long long length);
+
+  bool Fail() { return failed; }
+
+private:
+  bool OpenFile(const std::string &fileName, bool truncate);
+
+  bool WritePositional(const char* buffer, unsigned long long pos, unsigned long long length);
+};
+
+
+#endif // FST_SINK_H
@@ -0,0 +1,434 @@
+/*
+  fst - An R-package for ultra fast storage and retrieval of datasets.
+  Copyright (C) 2017, Mark AJ Klik
+
+  BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following disclaimer
+    in the documentation and/or other materials provided with the
+    distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+    A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  You can contact the author at :
+  - fst source repository : https://github.com/fstPackage/fst
+*/
+
+#include <cstring>
+#include <climits>
+#include <cstdint>
+#include <cerrno>
+
+#ifdef _WIN32
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+#endif
+
+#include <interface/fstsource.h>
+
+using namespace std;
+
+
+FstStreamSource::FstStreamSource(istream &myfile)
+{
+  this->myfile = &myfile;
+  this->size   = 0;
+
+  // determine stream size, the stream position is restored
+  streampos curPos = myfile.tellg();
+  myfile.seekg(0, ios::end);
+  streampos endPos = myfile.tellg();
+
+  if (endPos > 0) this->size = static_cast<unsigned long long>(endPos);
+
+  myfile.clear();
+  myfile.seekg(curPos);
+}
+
+
+unsigned long long FstStreamSource::Size()
+{
+  return size;
+}
+
+
+bool FstStreamSource::Read(char* buffer, unsigned long long pos, unsigned long long length)
+{
+  bool isValid;
+
+  // the stream's file pointer is shared by all threads
+#pragma omp critical(fst_stream_source)
+  {
+    myfile->clear();
+    myfile->seekg(pos);
+    myfile->read(buffer, length);
+    isValid = !myfile->fail();
+
+    // the unread part reads as zeros instead of undefined data
+    if (!isValid)
+    {
+      unsigned long long bytesRead = myfile->gcount() > 0 ? static_cast<unsigned long long>(myfile->gcount()) : 0;
+      memset(buffer + bytesRead, 0, length - bytesRead);
+    }
+  }
+
+  return isValid;
+}
+
+
+bool FstMemorySource::Read(char* buffer, unsigned long long pos, unsigned long long length)
+{
+  if (pos > size || length > size - pos)
+  {
+    // a damaged or truncated buffer: the missing part reads as zeros instead of undefined data
+    unsigned long long available = pos < size ? size - pos : 0;
+
+    if (available > 0) memcpy(buffer, data + pos, available);
+    memset(buffer + available, 0, length - available);
+
+    return false;
+  }
+
+  memcpy(buffer, data + pos, length);
+
+  return true;
+}
+
+
+const char* FstMemorySource::Map(unsigned long long pos, unsigned long long length)
+{
+  if (pos > size || length > size - pos) return nullptr;
+
+  return data + pos;
+}
+
+
+// Read method used for all fst files opened without an explicit method
+static int FstReadMethod = FST_READ_MAPPED;
+
+
+int GetFstReadMethod()
+{
+  return FstReadMethod;
+}
+
+
+int SetFstReadMethod(int readMethod)
+{
+  if (readMethod < FST_READ_MAPPED || readMethod > FST_READ_STREAM) return -1;
+
+  int previousMethod = FstReadMethod;
+  FstReadMethod = readMethod;
+
+  return previousMethod;
+}
+
+
+FstFileSource::FstFileSource()
+{
+  this->mapping      = nullptr;
+  this->fileSize     = 0;
+  this->fileHandle   = -1;
+  this->streamSource = nullptr;
+}
+
+
+bool FstFileSource::Open(const string &fileName)
+{
+  return Open(fileName, FstReadMethod);
+}
+
+
+bool FstFileSource::Open(const string &fileName, int readMethod)
+{
+  Close();
+
+  if (readMethod == FST_READ_MAPPED && MapFile(fileName)) return true;
+
+  if (readMethod != FST_READ_STREAM) return OpenDescriptor(fileName);
+
+  myfile.open(fileName.c_str(), ios::in | ios::binary);
+
+  if (myfile.fail())
+  {
+    myfile.close();
+    return false;
+  }
+
+  streamSource = new FstStreamSource(myfile);
+
+  return true;
+}
+
+
+int FstFileSource::ReadMethod() const
+{
+  if (mapping != nullptr) return FST_READ_MAPPED;
+  if (streamSource != nullptr) return FST_READ_STREAM;
+
+  return FST_READ_POSITIONAL;
+}
+
+
+bool FstFileSource::OpenDescriptor(const string &fileName)
+{
+#ifdef _WIN32
+  HANDLE handle = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED, NULL);
+
+  if (handle == INVALID_HANDLE_VALUE) return false;
+
+  LARGE_INTEGER size;
+
+  if (!GetFileSizeEx(handle, &size))
+  {
+    CloseHandle(handle);
+    return false;
+  }
+
+  fileHandle = reinterpret_cast<intptr_t>(handle);
+  fileSize   = static_cast<unsigned long long>(size.QuadPart);
+#else
+  int fd = open(fileName.c_str(), O_RDONLY);
+
+  if (fd == -1) return false;
+
+  struct stat fileStat;
+
+  if (fstat(fd, &fileStat) != 0)
+  {
+    close(fd);
+    return false;
+  }
+
+  fileHandle = fd;
+  fileSize   = static_cast<unsigned long long>(fileStat.st_size);
+#endif
+
+  return true;
+}
+
+
+bool FstFileSource::MapFile(const string &fileName)
+{
+#ifdef _WIN32
+  HANDLE handle = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+  if (handle == INVALID_HANDLE_VALUE) return false;
+
+  LARGE_INTEGER mappedSize;
+
+  if (!GetFileSizeEx(handle, &mappedSize) || mappedSize.QuadPart <= 0 ||
+    static_cast<unsigned long long>(mappedSize.QuadPart) > SIZE_MAX)
+  {
+    CloseHandle(handle);
+    return false;
+  }
+
+  HANDLE mapHandle = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+  CloseHandle(handle);
+
+  if (mapHandle == NULL) return false;
+
+  void* view = MapViewOfFile(mapHandle, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapHandle);  // the view keeps the mapping alive
+
+  if (view == NULL) return false;
+
+  mapping  = static_cast<const char*>(view);
+  fileSize = static_cast<unsigned long long>(mappedSize.QuadPart);
+#else
+  int fd = open(fileName.c_str(), O_RDONLY);
+
+  if (fd == -1) return false;
+
+  struct stat fileStat;
+
+  // empty files can't be mapped
+  if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0 ||
+    static_cast<unsigned long long>(fileStat.st_size) > SIZE_MAX)
+  {
+    close(fd);
+    return false;
+  }
+
+  void* view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);  // the mapping keeps a reference to the file
+
+  if (view == MAP_FAILED) return false;
+
+  mapping  = static_cast<const char*>(view);
+  fileSize = static_cast<unsigned long long>(fileStat.st_size);
+#endif
+
+  return true;
+}
+
+
+void FstFileSource::Close()
+{
+  if (mapping != nullptr)
+  {
+#ifdef _WIN32
+    UnmapViewOfFile(mapping);
+#else
+    munmap(const_cast<char*>(mapping), static_cast<size_t>(fileSize));
+#endif
+
+    mapping = nullptr;
+  }
+
+  if (fileHandle != -1)
+  {
+#ifdef _WIN32
+    CloseHandle(reinterpret_cast<HANDLE>(fileHandle));
+#else
+    close(static_cast<int>(fileHandle));
+#endif
+
+    fileHandle = -1;
+  }
+
+  if (streamSource != nullptr)
+  {
+    delete streamSource;
+    streamSource = nullptr;
+    myfile.close();
+  }
+
+  fileSize = 0;
+}
+
+
+unsigned long long FstFileSource::Size()
+{
+  if (streamSource != nullptr) return streamSource->Size();
+
+  return fileSize;
+}
+
+
+bool FstFileSource::Read(char* buffer, unsigned long long pos, unsigned long long length)
+{
+  if (streamSource != nullptr) return streamSource->Read(buffer, pos, length);
+
+  if (mapping == nullptr && fileHandle == -1) return false;
+
+  // Read the available bytes, bytes beyond the end of the file are zeroed
+  unsigned long long available = pos >= fileSize ? 0 : fileSize - pos;
+  bool isValid = length <= available;
+
+  if (!isValid)
+  {
+    memset(&buffer[available], 0, length - available);
+    length = available;
+  }
+
+  if (length == 0) return isValid;
+
+  if (mapping != nullptr)
+  {
+    memcpy(buffer, &mapping[pos], length);
+    return isValid;
+  }
+
+  return ReadPositional(buffer, pos, length) && isValid;
+}
+
+
+bool FstFileSource::ReadPositional(char* buffer, unsigned long long pos, unsigned long long length)
+{
+  // Large reads are split, a single read call is limited to 2^31 bytes on most platforms
+  const unsigned long long maxRead = 1ULL << 30;
+
+  while (length > 0)
+  {
+    unsigned long long readSize = length < maxRead ? length : maxRead;
+
+#ifdef _WIN32
+    // The handle is opened for overlapped IO, so the file pointer is ignored and reads run concurrently
+    OVERLAPPED overlapped;
+    memset(&overlapped, 0, sizeof(OVERLAPPED));
+    overlapped.Offset     = static_cast<DWORD>(pos & 0xffffffffULL);
+    overlapped.OffsetHigh = static_cast<DWORD>(pos >> 32);
+    overlapped.hEvent     = CreateEventA(NULL, TRUE, FALSE, NULL);
+
+    if (overlapped.hEvent == NULL)
+    {
+      memset(buffer, 0, length);
+      return false;
+    }
+
+    HANDLE handle = reinterpret_cast<HANDLE>(fileHandle);
+    DWORD bytesRead = 0;
+
+    if (!::ReadFile(handle, buffer, static_cast<DWORD>(readSize), NULL, &overlapped) &&
+      GetLastError() != ERROR_IO_PENDING)
+    {
+      CloseHandle(overlapped.hEvent);
+      memset(buffer, 0, length);
+      return false;
+    }
+
+    BOOL isRead = GetOverlappedResult(handle, &overlapped, &bytesRead, TRUE);
+    CloseHandle(overlapped.hEvent);
+
+    if (!isRead || bytesRead == 0)
+    {
+      memset(buffer, 0, length);  // the unread part reads as zeros instead of undefined data
+      return false;
+    }
+#else
+    ssize_t bytesRead = pread(static_cast<int>(fileHandle), buffer, static_cast<size_t>(readSize),
+      static_cast<off_t>(pos));
+
+    if (bytesRead == -1 && errno == EINTR) continue;  // interrupted by a signal before reading any data
+    if (bytesRead <= 0)
+    {
+      memset(buffer, 0, length);  // the unread part reads as zeros instead of undefined data
+      return false;
+    }
+#endif
+
+    // a positional read can return less bytes than requested
+    buffer += bytesRead;
+    pos    += bytesRead;
+    length -= bytesRead;
+  }
+
+  return true;
+}
+
+
+const char* FstFileSource::Map(unsigned long long pos, unsigned long long length)
+{
+  if (mapping == nullptr || pos >= fileSize || length > fileSize - pos) return nullptr;
+
+  return &mapping[pos];
+}
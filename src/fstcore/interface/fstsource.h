@@ -0,0 +1,183 @@
+/*
+  fst - An R-package for ultra fast storage and retrieval of datasets.
+  Copyright (C) 2017, Mark AJ Klik
+
+  BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following disclaimer
+    in the documentation and/or other materials provided with the
+    distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+    A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  You can contact the author at :
+  - fst source repository : https://github.com/fstPackage/fst
+*/
+
+
+#ifndef FST_SOURCE_H
+#define FST_SOURCE_H
+
+#include <istream>
+#include <fstream>
+#include <string>
+#include <cstdint>
+
+#include <interface/ifstsource.h>
+
+
+/**
+ * \brief Source that reads from an input stream.
+ *
+ * A stream has a single file pointer, so each (seek and) read is done in a critical section. Data can't be accessed
+ * directly and Map() always returns a nullptr.
+ */
+class FstStreamSource : public IFstSource
+{
+  std::istream* myfile;
+  unsigned long long size;
+
+public:
+  FstStreamSource(std::istream &myfile);
+
+  ~FstStreamSource() {};
+
+  unsigned long long Size();
+
+  bool Read(char* buffer, unsigned long long pos, unsigned long long length);
+
+  const char* Map(unsigned long long pos, unsigned long long length) { return nullptr; }
+};
+
+
+/**
+ * \brief Source that reads from a region of memory, e.g. a table that was serialized to a buffer.
+ *
+ * The memory is owned by the caller and should stay valid while the source is used. The readers decompress (or
+ * copy) the data blocks directly from the region.
+ */
+class FstMemorySource : public IFstSource
+{
+  const char* data;
+  unsigned long long size;
+
+public:
+  FstMemorySource(const char* data, unsigned long long size)
+  {
+    this->data = data;
+    this->size = size;
+  }
+
+  ~FstMemorySource() {};
+
+  unsigned long long Size() { return size; }
+
+  bool Read(char* buffer, unsigned long long pos, unsigned long long length);
+
+  const char* Map(unsigned long long pos, unsigned long long length);
+};
+
+
+// Methods for reading the data of a fst file
+#define FST_READ_MAPPED     0  // memory map the file, positional reads are used if the file can't be mapped
+#define FST_READ_POSITIONAL 1  // positional reads (pread) on a file descriptor shared by all threads
+#define FST_READ_STREAM     2  // ifstream with a single file pointer, reads are serialized
+
+
+/**
+ * \brief Get the method used for reading fst files
+ */
+int GetFstReadMethod();
+
+/**
+ * \brief Set the method used for reading fst files
+ * \param readMethod one of FST_READ_MAPPED, FST_READ_POSITIONAL or FST_READ_STREAM
+ * \return the previous read method, or -1 if readMethod is not a valid method
+ */
+int SetFstReadMethod(int readMethod);
+
+
+/**
+ * \brief Source for reading a fst file.
+ *
+ * By default the file is memory mapped so the readers can decompress or copy the data blocks directly from the
+ * (cached) file pages. If the file can't be mapped (e.g. on 32 bit systems with very large files), positional reads
+ * are used. A positional read doesn't move a file pointer, so all threads can read from the same file descriptor
+ * without locking.
+ */
+class FstFileSource : public IFstSource
+{
+  const char* mapping;
+  unsigned long long fileSize;
+
+  intptr_t fileHandle;  // file descriptor (or HANDLE on Windows) for positional reads, -1 if not used
+
+  std::ifstream myfile;
+  FstStreamSource* streamSource;
+
+public:
+  FstFileSource();
+
+  ~FstFileSource() { Close(); }
+
+  /**
+   * \brief Open a file for reading with the current read method (see SetFstReadMethod)
+   * \param fileName path of the file
+   * \return false if the file can't be opened
+   */
+  bool Open(const std::string &fileName);
+
+  /**
+   * \brief Open a file for reading
+   * \param fileName path of the file
+   * \param readMethod one of FST_READ_MAPPED, FST_READ_POSITIONAL or FST_READ_STREAM
+   * \return false if the file can't be opened
+   */
+  bool Open(const std::string &fileName, int readMethod);
+
+  void Close();
+
+  /**
+   * \brief True if the file contents are accessed through a memory mapping
+   */
+  bool IsMapped() const { return mapping != nullptr; }
+
+  /**
+   * \brief Method actually used for reading the opened file, a mapping falls back to positional reads
+   */
+  int ReadMethod() const;
+
+  unsigned long long Size();
+
+  bool Read(char* buffer, unsigned long long pos, unsigned long long length);
+
+  const char* Map(unsigned long long pos, unsigned long long length);
+
+private:
+  bool MapFile(const std::string &fileName);
+
+  bool OpenDescriptor(const std::string &fileName);
+
+  bool ReadPositional(char* buffer, unsigned long long pos, unsigned long long length);
+};
+
+
+#endif // FST_SOURCE_H
@@ -34,16 +34,31 @@
 
 
 #include <iostream>
-#include <fstream>
 #include <stdexcept>
 #include <cstring>
+#include <cstdio>
 #include <algorithm>
+#include <vector>
+#include <unordered_map>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include <interface/istringwriter.h>
 #include <interface/ifsttable.h>
 #include <interface/icolumnfactory.h>
 #include <interface/fstdefines.h>
 #include <interface/fststore.h>
+#include <interface/fstfilter.h>
+#include <interface/fstkeylookup.h>
+#include <interface/fstrowindex.h>
+#include <interface/fstsource.h>
+#include <interface/openmphelper.h>
+#include <interface/fstmemorybuffer.h>
+#include <interface/fstsink.h>
+#include <interface/fstreadplanner.h>
+#include <interface/fstiocounter.h>
 
 #include <character/character_v6.h>
 #include <factor/factor_v7.h>
@@ -52,6 +67,7 @@
 #include <logical/logical_v10.h>
 #include <integer64/integer64_v11.h>
 #include <byte/byte_v12.h>
+#include <blockstreamer/blockstreamer_v2.h>
 
 #include <ZSTD/common/xxhash.h>
 
@@ -81,11 +97,11 @@ using namespace std;
 //  4                      | int                | chunkset flags     // binary horizontal chunk flags
 //  8                      |                    | free bytes         // possible future use
 //  8                      |                    | free bytes         // possible future use
-//  8                      | unsigned long long | colNamesPos        // reference to column names vector
-//  8                      | unsigned long long | nextHorzChunkSet   // reference to next chunkset header (additional columns)
-//  8                      | unsigned long long | primChunksetIndex  // reference to primary chunkset data (nrOfCols columns)
+//  8                      | unsigned long long | colNamesPos        // reference to column names header (0: directly after chunkset header)
+//  8                      | unsigned long long | nextHorzChunkSet   // reference to next chunkset header (additional columns, 0 for last chunkset)
+//  8                      | unsigned long long | primChunksetIndex  // reference to first chunk index (0: directly after column names)
 //  8                      | unsigned long long | secChunksetIndex   // reference to primary chunkset data (nrOfCols columns)
-//  8                      | unsigned long long | nrOfRows           // total number of rows in chunkset
+//  8                      | unsigned long long | nrOfRows           // total number of rows in chunkset (equal for all chunksets)
 //  4                      | int                | p_nrOfChunksetCols // number of columns in primary chunkset
 //  2 * nrOfCols           | unsigned short int | colAttributesType  // column attributes
 //  2 * nrOfCols           | unsigned short int | colTypes           // column types
@@ -100,14 +116,15 @@ using namespace std;
 //  8                      |                    | free bytes         // possible future use
 //  x                      | char               | colNames           // column names (internally hashed)
 
-// Chunk index [node D, leaf of C] [size: 96]
+// Chunk index [node D, leaf of C or other chunk index] [size: 96]
 //
 //  8                      | unsigned long long | hash value         // hash of chunkset data header
 //  4                      | unsigned int       | FST_VERSION
 //  4                      | int                | index flags        // binary horizontal chunk flags
-//  8                      |                    | free bytes         // possible future use
+//  8                      | unsigned long long | nextChunkIndex     // reference to next chunk index (0 for last index)
 //  2                      | unsigned int       | nrOfChunkSlots     // number of chunk slots
-//  6                      |                    | free bytes         // possible future use
+//  2                      | unsigned short int | nrOfChunks         // number of used chunk slots (0 means 1 for older files)
+//  4                      |                    | free bytes         // possible future use
 //  8 * 4                  | unsigned long long | chunkPos           // data chunk addresses
 //  8 * 4                  | unsigned long long | chunkRows          // data chunk number of rows
 
@@ -129,27 +146,55 @@ FstStore::FstStore(std::string fstFile)
   this->fstFile       = fstFile;
   this->blockReader   = nullptr;
   this->keyColPos     = nullptr;
-  this->p_nrOfRows    = nullptr;
+  this->nrOfRows      = 0;
+  this->metaDataBlock = nullptr;
+  this->fileState     = nullptr;
+  this->writeState    = nullptr;
+  this->source        = nullptr;
+  this->ownsSource    = false;
+}
+
+
+FstStore::FstStore(const char* buffer, unsigned long long bufferSize)
+{
+  this->blockReader   = nullptr;
+  this->keyColPos     = nullptr;
+  this->nrOfRows      = 0;
   this->metaDataBlock = nullptr;
+  this->fileState     = nullptr;
+  this->writeState    = nullptr;
+  this->source        = new FstMemorySource(buffer, bufferSize);
+  this->ownsSource    = true;
+}
+
+
+FstStore::FstStore(IFstSource &source)
+{
+  this->blockReader   = nullptr;
+  this->keyColPos     = nullptr;
+  this->nrOfRows      = 0;
+  this->metaDataBlock = nullptr;
+  this->fileState     = nullptr;
+  this->writeState    = nullptr;
+  this->source        = &source;
+  this->ownsSource    = false;
 }
 
 
 /**
  * \brief Read header information from a fst file
- * \param myfile a stream to a fst file
+ * \param myfile source of the fst file
  * \param keyLength the number of key columns (output)
  * \param nrOfColsFirstChunk the number of columns in the first chunkset (output)
  * \return 
  */
-inline unsigned int ReadHeader(ifstream &myfile, int &keyLength, int &nrOfColsFirstChunk)
+inline unsigned int ReadHeader(IFstSource &myfile, int &keyLength, int &nrOfColsFirstChunk)
 {
   // Get meta-information for table
   char tableMeta[TABLE_META_SIZE];
-  myfile.read(tableMeta, TABLE_META_SIZE);
 
-  if (!myfile)
+  if (!myfile.Read(tableMeta, 0, TABLE_META_SIZE))
   {
-    myfile.close();
     throw(runtime_error(FSTERROR_ERROR_OPEN_READ));
   }
 
@@ -167,14 +212,12 @@ inline unsigned int ReadHeader(ifstream &myfile, int &keyLength, int &nrOfColsFi
 
   if (hHash != *p_headerHash)
   {
-    myfile.close();
     throw(runtime_error(FSTERROR_NON_FST_FILE));
   }
 
   // Compare file version with current
   if (*p_tableVersionMax > FST_VERSION)
   {
-    myfile.close();
     throw(runtime_error(FSTERROR_UPDATE_FST));
   }
 
@@ -205,784 +248,3693 @@ inline void SetKeyIndex(vector<int> &keyIndex, int keyLength, int nrOfSelect, in
   }
 }
 
+// Part of a selected row range that is stored in a single (vertical) data chunk
+struct ChunkRange
+{
+  unsigned long long chunkNr;    // index of the data chunk in the chunk index chain
+  unsigned long long startRow;   // first row to read from the chunk (zero based)
+  unsigned long long length;     // number of rows to read from the chunk
+  unsigned long long chunkRows;  // total number of rows in the data chunk
+  unsigned long long vecOffset;  // position of the first row in the result vector
+};
+
+
+// Location and header of a (horizontal) chunkset
+struct ChunksetInfo
+{
+  unsigned long long chunksetPos;    // file position of the chunkset header
+  unsigned long long colNamesPos;    // file position of the column names header
+  unsigned long long chunkIndexPos;  // file position of the first chunk index (0 if not known yet)
+  bool hasIndexRef;                  // chunk index is referenced from the header (files with zone maps)
+  int nrOfCols;                      // number of columns in the chunkset
+  int colOffset;                     // table column number of the first column in the chunkset
+  vector<char> header;               // chunkset header
+};
+
 
 /**
- * \brief Write a dataset to a fst file
- * \param fstTable interface to a dataset
- * \param compress compression factor in the range 0 - 100 
+ * \brief Read the headers of the primary chunkset and all horizontal chunksets that are linked to it
+ * \param myfile source of the fst file
+ * \param chunksetPos file position of the primary chunkset header
+ * \param chunksets location and header of each chunkset (output)
+ * \param colInfo attribute types, types, base types and scales of all columns, stored as 4 consecutive arrays (output)
+ * \return false if one of the headers is damaged
  */
-void FstStore::fstWrite(IFstTable &fstTable, int compress) const
+inline bool ReadChunksetHeaders(IFstSource &myfile, unsigned long long chunksetPos, vector<ChunksetInfo> &chunksets,
+  vector<unsigned short int> &colInfo)
 {
-  // Meta on dataset
-  int nrOfCols =  fstTable.NrOfColumns();  // number of columns in table
-  int keyLength = fstTable.NrOfKeys();  // number of key columns in table
+  vector<unsigned short int> colAttributeTypes, colTypes, colBaseTypes, colScales;
+  unsigned long long nrOfRows = 0;
+  int colOffset = 0;
 
-  if (nrOfCols == 0)
+  while (true)
   {
-    throw(runtime_error("Your dataset needs at least one column."));
-  }
-
+    ChunksetInfo chunkset;
+    chunkset.chunksetPos = chunksetPos;
+    chunkset.colOffset   = colOffset;
+    chunkset.header.resize(CHUNKSET_HEADER_SIZE);
 
-  unsigned long long tableHeaderSize    = 44;
-  unsigned long long keyIndexHeaderSize = 0;
+    bool isValid = myfile.Read(chunkset.header.data(), chunksetPos, CHUNKSET_HEADER_SIZE);
 
-  if (keyLength != 0)
-  {
-    keyIndexHeaderSize = 4 * (keyLength + 2);  // size of key index vector and hash
-  }
+    int nrOfCols = *reinterpret_cast<int*>(&chunkset.header[72]);
 
-  unsigned long long chunksetHeaderSize = CHUNKSET_HEADER_SIZE + 8 * nrOfCols;
-  unsigned long long colNamesHeaderSize = 24;
+    if (!isValid || nrOfCols <= 0) return false;
 
-  // size of fst file header
-  unsigned long long metaDataSize = tableHeaderSize + keyIndexHeaderSize + chunksetHeaderSize + colNamesHeaderSize;
-  char * metaDataBlock             = new char[metaDataSize];  // fst metadata
+    // Chunkset header [node C, free leaf of A or other chunkset header] [size: 76 + 8 * nrOfCols]
 
+    unsigned long long chunksetHeaderSize = CHUNKSET_HEADER_SIZE + 8 * nrOfCols;
+    chunkset.header.resize(chunksetHeaderSize);
+    isValid = myfile.Read(&chunkset.header[CHUNKSET_HEADER_SIZE], chunksetPos + CHUNKSET_HEADER_SIZE, 8 * nrOfCols);
 
-  // Table header [node A] [size: 44]
+    char* header = chunkset.header.data();
+    unsigned long long* p_chunksetHash      = reinterpret_cast<unsigned long long*>(header);
+    unsigned long long* p_colNamesPos       = reinterpret_cast<unsigned long long*>(&header[32]);
+    unsigned long long* p_nextHorzChunkSet  = reinterpret_cast<unsigned long long*>(&header[40]);
+    unsigned long long* p_primChunksetIndex = reinterpret_cast<unsigned long long*>(&header[48]);
+    unsigned long long* p_nrOfRows          = reinterpret_cast<unsigned long long*>(&header[64]);
+    unsigned short int* p_colInfo           = reinterpret_cast<unsigned short int*>(&header[76]);
 
-  unsigned long long* p_headerHash        = reinterpret_cast<unsigned long long*>(metaDataBlock);
-  unsigned int* p_tableVersion            = reinterpret_cast<unsigned int*>(&metaDataBlock[8]);
-  int* p_tableFlags                       = reinterpret_cast<int*>(&metaDataBlock[12]);
-  unsigned long long* p_freeBytes1        = reinterpret_cast<unsigned long long*>(&metaDataBlock[16]);
-  unsigned int* p_tableVersionMax         = reinterpret_cast<unsigned int*>(&metaDataBlock[24]);
-  int* p_nrOfCols                         = reinterpret_cast<int*>(&metaDataBlock[28]);
-  unsigned long long* primaryChunkSetLoc  = reinterpret_cast<unsigned long long*>(&metaDataBlock[32]);
-  int* p_keyLength                        = reinterpret_cast<int*>(&metaDataBlock[40]);
+    unsigned long long chunksetHash = XXH64(&header[8], chunksetHeaderSize - 8, FST_HASH_SEED);
 
-  // Key index vector (only needed when keyLength > 0) [attached leaf of A] [size: 8 + 4 * keyLength]
+    if (!isValid || *p_chunksetHash != chunksetHash) return false;
 
-  unsigned long long* p_keyIndexHash      = reinterpret_cast<unsigned long long*>(&metaDataBlock[44]);
-  int* keyColPos                          = reinterpret_cast<int*>(&metaDataBlock[52]);
+    // all chunksets describe the same rows
+    if (chunksets.empty())
+    {
+      nrOfRows = *p_nrOfRows;
+    }
+    else if (*p_nrOfRows != nrOfRows)
+    {
+      return false;
+    }
 
-  // Chunkset header [node C, free leaf of A or other chunkset header] [size: 76 + 8 * nrOfCols]
+    // column names and chunk index of files without references directly follow the chunkset header
+    chunkset.nrOfCols      = nrOfCols;
+    chunkset.colNamesPos   = *p_colNamesPos != 0 ? *p_colNamesPos : chunksetPos + chunksetHeaderSize;
+    chunkset.chunkIndexPos = *p_primChunksetIndex;
+    chunkset.hasIndexRef   = *p_primChunksetIndex != 0;
 
-  unsigned int offset = tableHeaderSize + keyIndexHeaderSize;
-  unsigned long long* p_chunksetHash      = reinterpret_cast<unsigned long long*>(&metaDataBlock[offset]);
-  unsigned int* p_chunksetHeaderVersion   = reinterpret_cast<unsigned int*>(&metaDataBlock[offset + 8]);
-  int* p_chunksetFlags                    = reinterpret_cast<int*>(&metaDataBlock[offset + 12]);
-  unsigned long long* p_freeBytes2        = reinterpret_cast<unsigned long long*>(&metaDataBlock[offset + 16]);
-  unsigned long long* p_freeBytes3        = reinterpret_cast<unsigned long long*>(&metaDataBlock[offset + 24]);
-  unsigned long long* p_colNamesPos       = reinterpret_cast<unsigned long long*>(&metaDataBlock[offset + 32]);
-
-  unsigned long long* p_nextHorzChunkSet  = reinterpret_cast<unsigned long long*>(&metaDataBlock[offset + 40]);
-  unsigned long long* p_primChunksetIndex = reinterpret_cast<unsigned long long*>(&metaDataBlock[offset + 48]);
-  unsigned long long* p_secChunksetIndex  = reinterpret_cast<unsigned long long*>(&metaDataBlock[offset + 56]);
-  unsigned long long* p_nrOfRows          = reinterpret_cast<unsigned long long*>(&metaDataBlock[offset + 64]);
-  int* p_nrOfChunksetCols                 = reinterpret_cast<int*>(&metaDataBlock[offset + 72]);
-
-  unsigned short int* colAttributeTypes   = reinterpret_cast<unsigned short int*>(&metaDataBlock[offset + 76]);
-  unsigned short int* colTypes            = reinterpret_cast<unsigned short int*>(&metaDataBlock[offset + 76 + 2 * nrOfCols]);
-  unsigned short int* colBaseTypes        = reinterpret_cast<unsigned short int*>(&metaDataBlock[offset + 76 + 4 * nrOfCols]);
-  unsigned short int* colScales           = reinterpret_cast<unsigned short int*>(&metaDataBlock[offset + 76 + 6 * nrOfCols]);
+    // Column names header [leaf to C] [size: 24]
 
-  // Column names [leaf to C]  [size: 24 + x]
+    char colNamesHeader[24];
+    isValid = myfile.Read(colNamesHeader, chunkset.colNamesPos, 24);
 
-  offset = offset + chunksetHeaderSize;
-  unsigned long long* p_colNamesHash      = reinterpret_cast<unsigned long long*>(&metaDataBlock[offset]);
-  unsigned int* p_colNamesVersion         = reinterpret_cast<unsigned int*>(&metaDataBlock[offset + 8]);
-  int* p_colNamesFlags                    = reinterpret_cast<int*>(&metaDataBlock[offset + 12]);
-  unsigned long long* p_freeBytes4        = reinterpret_cast<unsigned long long*>(&metaDataBlock[offset + 16]);
+    unsigned long long* p_colNamesHash = reinterpret_cast<unsigned long long*>(colNamesHeader);
+    unsigned long long colNamesHash = XXH64(&colNamesHeader[8], 24 - 8, FST_HASH_SEED);
 
+    if (!isValid || *p_colNamesHash != colNamesHash) return false;
 
-  // Set table header parameters
-  
-  *p_tableVersion          = FST_VERSION;
-  *p_tableFlags            = 0;
-  *p_freeBytes1            = 0;
-  *p_tableVersionMax       = FST_VERSION;
+    colAttributeTypes.insert(colAttributeTypes.end(), p_colInfo, p_colInfo + nrOfCols);
+    colTypes.insert(colTypes.end(), &p_colInfo[nrOfCols], &p_colInfo[2 * nrOfCols]);
+    colBaseTypes.insert(colBaseTypes.end(), &p_colInfo[2 * nrOfCols], &p_colInfo[3 * nrOfCols]);
+    colScales.insert(colScales.end(), &p_colInfo[3 * nrOfCols], &p_colInfo[4 * nrOfCols]);
 
-  *p_nrOfCols              = nrOfCols;
-  *primaryChunkSetLoc      = 52 + 4 * keyLength;
-  *p_keyLength             = keyLength;
+    colOffset += nrOfCols;
+    unsigned long long nextChunksetPos = *p_nextHorzChunkSet;
+    chunksets.push_back(chunkset);
 
-  *p_headerHash = XXH64(&metaDataBlock[8], tableHeaderSize - 8, FST_HASH_SEED);
+    if (nextChunksetPos == 0) break;
 
-  // Set key index if present
+    // horizontal chunksets are always appended to the end of the file
+    if (nextChunksetPos <= chunksetPos) return false;
 
-  if (keyLength != 0)
-  {
-    fstTable.GetKeyColumns(keyColPos);
-    *p_keyIndexHash = XXH64(&metaDataBlock[tableHeaderSize + 8], keyIndexHeaderSize - 8, FST_HASH_SEED);
+    chunksetPos = nextChunksetPos;
   }
 
-  *p_chunksetHeaderVersion = FST_VERSION;
-  *p_chunksetFlags         = 0;
-  *p_freeBytes2            = 0;
-  *p_freeBytes3            = 0;
-  *p_colNamesPos           = 0;
-  *p_nextHorzChunkSet      = 0;
-  *p_primChunksetIndex     = 0;
-  *p_secChunksetIndex      = 0;
+  colInfo = colAttributeTypes;
+  colInfo.insert(colInfo.end(), colTypes.begin(), colTypes.end());
+  colInfo.insert(colInfo.end(), colBaseTypes.begin(), colBaseTypes.end());
+  colInfo.insert(colInfo.end(), colScales.begin(), colScales.end());
 
-  unsigned long long nrOfRows = fstTable.NrOfRows();
-  *p_nrOfRows              = nrOfRows;
-  *p_nrOfChunksetCols      = nrOfCols;
+  return true;
+}
 
-  // Set column names header
 
-  *p_colNamesVersion       = FST_VERSION;
-  *p_colNamesFlags         = 0;
-  *p_freeBytes4            = 0;
+/**
+ * \brief Read the column names of all chunksets into a single vector
+ * \param myfile source of the fst file
+ * \param colNames string column receiving the column names, the vector is allocated here
+ * \param chunksets location of each chunkset, chunk index positions that are not known yet are set here
+ * \param nrOfCols total number of columns in all chunksets
+ */
+inline void ReadColumnNames(IFstSource &myfile, IStringColumn* colNames, vector<ChunksetInfo> &chunksets, int nrOfCols)
+{
+  colNames->AllocateVec(nrOfCols);
 
-  if (nrOfRows == 0)
+  for (unsigned int chunksetNr = 0; chunksetNr < chunksets.size(); ++chunksetNr)
   {
-    delete[] metaDataBlock;
-    throw(runtime_error(FSTERROR_NO_DATA));
-  }
-
-  *p_colNamesHash = XXH64(p_colNamesVersion, colNamesHeaderSize - 8, FST_HASH_SEED);
+    ChunksetInfo &chunkset = chunksets[chunksetNr];
 
+    unsigned long long colNamesEnd = fdsReadCharVec_v6(myfile, colNames, chunkset.colNamesPos + 24, 0,
+      static_cast<unsigned int>(chunkset.nrOfCols), static_cast<unsigned int>(chunkset.nrOfCols), chunkset.colOffset);
 
-  // Open file with default buffer
-  ofstream myfile;
-  myfile.open(fstFile.c_str(), ios::out | ios::binary);  // write stream only
-
-  if (myfile.fail())
-  {
-    delete[] metaDataBlock;
-    myfile.close();
-    throw(runtime_error(FSTERROR_ERROR_OPEN_WRITE));
+    // chunk index directly follows the column names
+    if (chunkset.chunkIndexPos == 0)
+    {
+      chunkset.chunkIndexPos = colNamesEnd;
+    }
   }
-
-  // Write table meta information
-  myfile.write(metaDataBlock, metaDataSize);  // table meta data
-
-  // Serialize column names
-  IStringWriter* blockRunner = fstTable.GetColNameWriter();
-  fdsWriteCharVec_v6(myfile, blockRunner, 0, StringEncoding::NATIVE);   // column names
-  delete blockRunner;
+}
 
 
-  // Size of chunkset index header plus data chunk header
-  unsigned long long chunkIndexSize = CHUNK_INDEX_SIZE + DATA_INDEX_SIZE + 8 * nrOfCols;
-  char* chunkIndex = new char[chunkIndexSize];
+/**
+ * \brief Read all chunk indexes of a chunkset by following the chunk index chain
+ * \param myfile source of the fst file
+ * \param chunkIndexPos file position of the first chunk index
+ * \param chunkPos file positions of all data chunk headers (output)
+ * \param chunkRows number of rows of all data chunks (output)
+ * \param lastChunkIndex buffer of size CHUNK_INDEX_SIZE receiving the last chunk index in the chain (output)
+ * \param lastChunkIndexPos file position of the last chunk index (output)
+ * \return false if one of the chained chunk indexes is damaged
+ */
+inline bool ReadChunkIndexChain(IFstSource &myfile, unsigned long long chunkIndexPos, vector<unsigned long long> &chunkPos,
+  vector<unsigned long long> &chunkRows, char* lastChunkIndex, unsigned long long &lastChunkIndexPos)
+{
+  lastChunkIndexPos = chunkIndexPos;
 
-  // Chunkset data index [node D, leaf of C] [size: 96]
+  while (true)
+  {
+    bool isValid = myfile.Read(lastChunkIndex, lastChunkIndexPos, CHUNK_INDEX_SIZE);
 
-  unsigned long long* p_chunkIndexHash = reinterpret_cast<unsigned long long*>(chunkIndex);
-  unsigned int* p_chunkIndexVersion    = reinterpret_cast<unsigned int*>(&chunkIndex[8]);
-  int* p_chunkIndexFlags               = reinterpret_cast<int*>(&chunkIndex[12]);
-  unsigned long long* p_freeBytes5     = reinterpret_cast<unsigned long long*>(&chunkIndex[16]);
-  unsigned short int* p_nrOfChunkSlots = reinterpret_cast<unsigned short int*>(&chunkIndex[24]);
-  unsigned short int* p_freeBytes6     = reinterpret_cast<unsigned short int*>(&chunkIndex[26]);
-  unsigned long long* p_chunkPos       = reinterpret_cast<unsigned long long*>(&chunkIndex[32]);
-  unsigned long long* p_chunkRows      = reinterpret_cast<unsigned long long*>(&chunkIndex[64]);
+    unsigned long long* p_chunkIndexHash = reinterpret_cast<unsigned long long*>(lastChunkIndex);
+    unsigned long long* p_nextChunkIndex = reinterpret_cast<unsigned long long*>(&lastChunkIndex[16]);
+    unsigned short int* p_nrOfChunkSlots = reinterpret_cast<unsigned short int*>(&lastChunkIndex[24]);
+    unsigned short int* p_nrOfChunks     = reinterpret_cast<unsigned short int*>(&lastChunkIndex[26]);
+    unsigned long long* p_chunkPos       = reinterpret_cast<unsigned long long*>(&lastChunkIndex[32]);
+    unsigned long long* p_chunkRows      = reinterpret_cast<unsigned long long*>(&lastChunkIndex[64]);
 
-  // Chunk data header [node E, leaf of D] [size: 24 + 8 * nrOfCols]
+    unsigned long long chunkIndexHash = XXH64(&lastChunkIndex[8], CHUNK_INDEX_SIZE - 8, FST_HASH_SEED);
 
-  unsigned long long* p_chunkDataHash  = reinterpret_cast<unsigned long long*>(&chunkIndex[96]);
-  unsigned int* p_chunkDataVersion     = reinterpret_cast<unsigned int*>(&chunkIndex[104]);
-  int* p_chunkDataFlags                = reinterpret_cast<int*>(&chunkIndex[108]);
-  unsigned long long* p_freeBytes7     = reinterpret_cast<unsigned long long*>(&chunkIndex[112]);
-  unsigned long long* positionData     = reinterpret_cast<unsigned long long*>(&chunkIndex[120]);  // column position index
+    if (!isValid || *p_chunkIndexHash != chunkIndexHash) return false;
 
+    // files without appended data have a zero chunk count
+    int nrOfChunks = max(1, static_cast<int>(*p_nrOfChunks));
 
-  // Set chunkset data index header parameters
+    if (nrOfChunks > *p_nrOfChunkSlots) return false;
 
-  *p_chunkIndexVersion = FST_VERSION;
-  *p_chunkIndexFlags   = 0;
-  *p_freeBytes5       = 0;
-  *p_nrOfChunkSlots   = 4;
-   p_freeBytes6[0]    = p_freeBytes6[1] = p_freeBytes6[2] = 0;
-  *p_chunkRows        = nrOfRows;
+    for (int chunk = 0; chunk < nrOfChunks; ++chunk)
+    {
+      chunkPos.push_back(p_chunkPos[chunk]);
+      chunkRows.push_back(p_chunkRows[chunk]);
+    }
 
-  // Set data chunk header parameters
+    if (*p_nextChunkIndex == 0) return true;
 
-  *p_chunkDataVersion = FST_VERSION;
-  *p_chunkDataFlags   = 0;
-  *p_freeBytes7       = 0;
+    // chained chunk indexes are always appended to the end of the file
+    if (*p_nextChunkIndex <= lastChunkIndexPos) return false;
 
+    // Continue with next chunk index
+    lastChunkIndexPos = *p_nextChunkIndex;
+  }
+}
 
-  // Row and column meta data
-  myfile.write(chunkIndex, chunkIndexSize);   // file positions of column data
 
+/**
+ * \brief Read the column positions from a data chunk header
+ * \param myfile source of the fst file
+ * \param chunkPos file position of the data chunk header
+ * \param nrOfCols number of columns in the chunkset
+ * \param positionData array of length nrOfCols receiving the column positions (output)
+ * \return false if the data chunk header is damaged
+ */
+inline bool ReadDataChunkHeader(IFstSource &myfile, unsigned long long chunkPos, int nrOfCols, unsigned long long* positionData)
+{
+  unsigned long long dataChunkSize = DATA_INDEX_SIZE + 8 * nrOfCols;
+  char* dataChunk = new char[dataChunkSize];
 
-  // column data
-  for (int colNr = 0; colNr < nrOfCols; ++colNr)
-  {
-    positionData[colNr] = myfile.tellp();  // current location
-  	FstColumnAttribute colAttribute;
-  	std::string annotation = "";
-    short int scale = 0;
+  bool isValid = myfile.Read(dataChunk, chunkPos, dataChunkSize);
 
-  	// get type and add annotation
-    FstColumnType colType = fstTable.ColumnType(colNr, colAttribute, scale, annotation);
+  unsigned long long* p_chunkDataHash = reinterpret_cast<unsigned long long*>(dataChunk);
+  unsigned long long chunkDataHash = XXH64(&dataChunk[8], dataChunkSize - 8, FST_HASH_SEED);
 
-    colBaseTypes[colNr] = static_cast<unsigned short int>(colType);
-  	colAttributeTypes[colNr] = static_cast<unsigned short int>(colAttribute);
-    colScales[colNr] = scale;
+  isValid = isValid && (*p_chunkDataHash == chunkDataHash);
 
-    switch (colType)
-    {
-      case FstColumnType::CHARACTER:
-      {
-        colTypes[colNr] = 6;
-     		IStringWriter* stringWriter = fstTable.GetStringWriter(colNr);
-        fdsWriteCharVec_v6(myfile, stringWriter, compress, stringWriter->Encoding());   // column names
-     		delete stringWriter;
-        break;
-      }
+  memcpy(positionData, &dataChunk[DATA_INDEX_SIZE], 8 * nrOfCols);
+  delete[] dataChunk;
 
-      case FstColumnType::FACTOR:
-      {
-        colTypes[colNr] = 7;
-        int* intP = fstTable.GetIntWriter(colNr);  // level values pointer
-     		IStringWriter* stringWriter = fstTable.GetLevelWriter(colNr);
-        fdsWriteFactorVec_v7(myfile, intP, stringWriter, nrOfRows, compress, stringWriter->Encoding(), annotation);
-	      delete stringWriter;
-        break;
-      }
+  return isValid;
+}
 
-      case FstColumnType::INT_32:
-      {
-        colTypes[colNr] = 8;
-        int* intP = fstTable.GetIntWriter(colNr);
-        fdsWriteIntVec_v8(myfile, intP, nrOfRows, compress, annotation);
-        break;
-      }
 
-      case FstColumnType::DOUBLE_64:
-      {
-        colTypes[colNr] = 9;
-        double* doubleP = fstTable.GetDoubleWriter(colNr);
-        fdsWriteRealVec_v9(myfile, doubleP, nrOfRows, compress, annotation);
-        break;
-      }
+/**
+ * \brief Determine the parts of a row range that are stored in each data chunk
+ * \param chunkRows number of rows of all data chunks
+ * \param firstRow first row of the selection (zero based)
+ * \param length number of rows in the selection
+ * \param chunkRanges ranges of the data chunks touched by the selection (output)
+ */
+inline void SelectChunkRanges(vector<unsigned long long> &chunkRows, unsigned long long firstRow, unsigned long long length,
+  vector<ChunkRange> &chunkRanges)
+{
+  unsigned long long chunkStartRow = 0;
+  unsigned long long endRow = firstRow + length;
 
-      case FstColumnType::BOOL_2:
-      {
-        colTypes[colNr] = 10;
-        int* intP = fstTable.GetLogicalWriter(colNr);
-        fdsWriteLogicalVec_v10(myfile, intP, nrOfRows, compress, annotation);
-        break;
-      }
+  for (unsigned long long chunkNr = 0; chunkNr < chunkRows.size(); ++chunkNr)
+  {
+    unsigned long long chunkEndRow = chunkStartRow + chunkRows[chunkNr];
 
-      case FstColumnType::INT_64:
-      {
-        colTypes[colNr] = 11;
-        long long* intP = fstTable.GetInt64Writer(colNr);
-        fdsWriteInt64Vec_v11(myfile, intP, nrOfRows, compress, annotation);
-        break;
-      }
+    // chunk overlaps with selection
+    if (chunkEndRow > firstRow && chunkStartRow < endRow)
+    {
+      unsigned long long rangeStart = max(firstRow, chunkStartRow);
+      unsigned long long rangeEnd = min(endRow, chunkEndRow);
 
-	  case FstColumnType::BYTE:
-	  {
-		  colTypes[colNr] = 12;
-		  char* byteP = fstTable.GetByteWriter(colNr);
-		  fdsWriteByteVec_v12(myfile, byteP, nrOfRows, compress, annotation);
-		  break;
-	  }
+      ChunkRange chunkRange;
+      chunkRange.chunkNr   = chunkNr;
+      chunkRange.startRow  = rangeStart - chunkStartRow;
+      chunkRange.length    = rangeEnd - rangeStart;
+      chunkRange.chunkRows = chunkRows[chunkNr];
+      chunkRange.vecOffset = rangeStart - firstRow;
 
-    default:
-        delete[] metaDataBlock;
-        delete[] chunkIndex;
-        myfile.close();
-        throw(runtime_error("Unknown type found in column."));
+      chunkRanges.push_back(chunkRange);
     }
-  }
-
-  // update chunk position data
-  *p_chunkPos = positionData[0] - 8 * nrOfCols - DATA_INDEX_SIZE;
-
-  // Calculate header hashes
-  *p_chunksetHash = XXH64(&metaDataBlock[tableHeaderSize + keyIndexHeaderSize + 8], chunksetHeaderSize - 8, FST_HASH_SEED);
-  *p_chunkIndexHash = XXH64(&chunkIndex[8], CHUNK_INDEX_SIZE - 8, FST_HASH_SEED);
 
-  myfile.seekp(0);
-  myfile.write(metaDataBlock, metaDataSize);  // table header
+    chunkStartRow = chunkEndRow;
+  }
+}
 
-  *p_chunkDataHash = XXH64(&chunkIndex[CHUNK_INDEX_SIZE + 8], chunkIndexSize - (CHUNK_INDEX_SIZE + 8), FST_HASH_SEED);
 
-  myfile.seekp(*p_chunkPos - CHUNK_INDEX_SIZE);
-  myfile.write(chunkIndex, chunkIndexSize);  // vertical chunkset index and positiondata
+// Chunk index chain of a chunkset and the column positions of its data chunks, both are read on first use
+struct ChunksetIndex
+{
+  bool isLoaded;                          // true if the chunk index chain has been read
+  vector<unsigned long long> chunkPos;    // file positions of all data chunk headers
+  vector<unsigned long long> chunkRows;   // number of rows of all data chunks
+  vector<unsigned long long> positions;   // column positions of all data chunks, nrOfCols positions per chunk
+  vector<char> hasPositions;              // non-zero for data chunks of which the column positions have been read
+};
 
-  // cleanup
-  delete[] metaDataBlock;
-  delete[] chunkIndex;
 
-  // Check file status only here for performance.
-  // Any error that was generated earlier will result in a fail here.
-  if (myfile.fail())
+/**
+ * \brief Parsed metadata of a fst file together with the source that is used to read the file
+ *
+ * An opened store keeps its state until it's closed, so repeated reads don't have to reopen the file and check the
+ * header hashes again. Calls on a store that is not opened use a temporary state.
+ */
+struct FstFileState
+{
+  IFstSource* source;                    // the opened fst file or the source of the store
+  bool ownsSource;                       // true if the source was opened here and is deleted with the state
+  IFstSource* fileSource;                // opened file below a latency source (benchmarks only), nullptr if not used
+  unsigned int version;                  // minimum fstcore version required to read the file
+  int keyLength;                         // number of key columns
+  vector<int> keyColPos;                 // positions of the key columns
+  vector<ChunksetInfo> chunksets;        // location and header of each chunkset
+  vector<unsigned short int> colInfo;    // attribute types, types, base types and scales of all columns
+  FilterStringColumn colNames;           // names of all columns
+  unordered_map<string, int> colNrs;     // column number of each column name (first column with that name)
+  vector<ChunksetIndex> chunksetIndex;   // chunk indexes of each chunkset
+
+  FstFileState()
   {
-	  myfile.close();
-
-	  throw(runtime_error("There was an error during the write operation, fst file might be corrupted. Please check available disk space and access rights."));
+    this->source     = nullptr;
+    this->ownsSource = false;
+    this->fileSource = nullptr;
   }
 
-  myfile.close();
-}
+  ~FstFileState()
+  {
+    if (ownsSource) delete source;
+    delete fileSource;
+  }
+};
 
 
-void FstStore::fstMeta(IColumnFactory* columnFactory)
+/**
+ * \brief Open a fst file and read the table header, key index, chunkset headers and column names
+ * \param fstFile path of the fst file
+ * \param source source of the store, read instead of the file if not a nullptr (not owned by the state)
+ * \param keepOpen true if the state is kept by an opened store. Such a state uses positional reads instead of a
+ * memory mapping, as touching a mapping of a file that was truncated in the meantime raises SIGBUS.
+ * \return state of the opened file, to be deleted by the caller
+ */
+inline FstFileState* OpenFileState(const std::string &fstFile, IFstSource* source, bool keepOpen = false)
 {
-  // fst file stream using a stack buffer
-  ifstream myfile;
-  myfile.open(fstFile.c_str(), ios::in | ios::binary);
+  FstFileState* state = new FstFileState();
 
-  if (myfile.fail())
+  if (source != nullptr)
   {
-    myfile.close();
-    throw(runtime_error(FSTERROR_ERROR_OPENING_FILE));
+    state->source = source;
   }
+  else
+  {
+    FstFileSource* fileSource = new FstFileSource();
+    state->source = fileSource;
+    state->ownsSource = true;
 
-  // Read variables from fst file header and check header hash
-  version = ReadHeader(myfile, keyLength, nrOfCols);
+    int readMethod = GetFstReadMethod();
+    if (keepOpen && readMethod == FST_READ_MAPPED) readMethod = FST_READ_POSITIONAL;
 
+    if (!fileSource->Open(fstFile, readMethod))
+    {
+      delete state;
+      throw(runtime_error(FSTERROR_ERROR_OPENING_FILE));
+    }
 
-  unsigned long long keyIndexHeaderSize = 0;
+    // slow storage is emulated by delaying each request on the file
+    if (GetFstReadLatency() > 0)
+    {
+      state->fileSource = fileSource;
+      state->source = new FstLatencySource(*fileSource, GetFstReadLatency());
+    }
+  }
 
-  if (keyLength != 0)
+  IFstSource &myfile = *state->source;
+
+  // Read variables from fst file header and check header hash
+  int nrOfColsFirstChunk;
+
+  try
   {
-    keyIndexHeaderSize = 4 * (keyLength + 2);  // size of key index vector and hash
+    state->version = ReadHeader(myfile, state->keyLength, nrOfColsFirstChunk);
+  }
+  catch (const std::exception &)
+  {
+    delete state;
+    throw;
   }
 
-  unsigned long long chunksetHeaderSize = CHUNKSET_HEADER_SIZE + 8 * nrOfCols;
-  unsigned long long colNamesHeaderSize = 24;
-  unsigned long long metaSize = keyIndexHeaderSize + chunksetHeaderSize + colNamesHeaderSize;
-
-  // Read format headers
-  metaDataBlock = new char[metaSize];
-  myfile.read(metaDataBlock, metaSize);
+  unsigned long long keyIndexHeaderSize = 0;
 
-  if (keyLength != 0)
+  if (state->keyLength != 0)
   {
-    keyColPos = reinterpret_cast<int*>(&metaDataBlock[8]);  // equals nullptr if there are no keys
+    keyIndexHeaderSize = 4 * (state->keyLength + 2);  // size of key index vector and hash
+
+    // Read key index
+    vector<char> keyIndexHeader(keyIndexHeaderSize);
+    bool isValid = myfile.Read(keyIndexHeader.data(), TABLE_META_SIZE, keyIndexHeaderSize);
 
-    unsigned long long* p_keyIndexHash = reinterpret_cast<unsigned long long*>(metaDataBlock);
-    unsigned long long hHash = XXH64(&metaDataBlock[8], keyIndexHeaderSize - 8, FST_HASH_SEED);
+    unsigned long long* p_keyIndexHash = reinterpret_cast<unsigned long long*>(keyIndexHeader.data());
+    unsigned long long hHash = XXH64(&keyIndexHeader[8], keyIndexHeaderSize - 8, FST_HASH_SEED);
 
-    if (*p_keyIndexHash != hHash)
+    if (!isValid || *p_keyIndexHash != hHash)
     {
-      delete[] metaDataBlock;
-      metaDataBlock = nullptr;
-      myfile.close();
+      delete state;
       throw(runtime_error(FSTERROR_DAMAGED_HEADER));
     }
-  }
-
-  // Chunkset header [node C, free leaf of A or other chunkset header] [size: 76 + 8 * nrOfCols]
-
-  unsigned long long* p_chunksetHash = reinterpret_cast<unsigned long long*>(&metaDataBlock[keyIndexHeaderSize]);
-  //unsigned int* p_chunksetHeaderVersion = reinterpret_cast<unsigned int*>(&metaDataBlock[keyIndexHeaderSize + 8]);
-  //int* p_chunksetFlags = reinterpret_cast<int*>(&metaDataBlock[keyIndexHeaderSize + 12]);
-  //unsigned long long* p_freeBytes2 = reinterpret_cast<unsigned long long*>(&metaDataBlock[keyIndexHeaderSize + 16]);
-  //unsigned long long* p_freeBytes3 = reinterpret_cast<unsigned long long*>(&metaDataBlock[keyIndexHeaderSize + 24]);
-  //unsigned long long* p_colNamesPos = reinterpret_cast<unsigned long long*>(&metaDataBlock[keyIndexHeaderSize + 32]);
 
-  //unsigned long long* p_nextHorzChunkSet = reinterpret_cast<unsigned long long*>(&metaDataBlock[keyIndexHeaderSize + 40]);
-  //unsigned long long* p_primChunksetIndex = reinterpret_cast<unsigned long long*>(&metaDataBlock[keyIndexHeaderSize + 48]);
-  //unsigned long long* p_secChunksetIndex = reinterpret_cast<unsigned long long*>(&metaDataBlock[keyIndexHeaderSize + 56]);
-  p_nrOfRows = reinterpret_cast<unsigned long long*>(&metaDataBlock[keyIndexHeaderSize + 64]);
-  //int* p_nrOfChunksetCols = reinterpret_cast<int*>(&metaDataBlock[keyIndexHeaderSize + 72]);
+    int* keyColPos = reinterpret_cast<int*>(&keyIndexHeader[8]);
+    state->keyColPos.assign(keyColPos, keyColPos + state->keyLength);
+  }
 
-  colAttributeTypes = reinterpret_cast<unsigned short int*>(&metaDataBlock[keyIndexHeaderSize + 76]);
-  colTypes = reinterpret_cast<unsigned short int*>(&metaDataBlock[keyIndexHeaderSize + 76 + 2 * nrOfCols]);
-  colBaseTypes = reinterpret_cast<unsigned short int*>(&metaDataBlock[keyIndexHeaderSize + 76 + 4 * nrOfCols]);
-  colScales = reinterpret_cast<unsigned short int*>(&metaDataBlock[keyIndexHeaderSize + 76 + 6 * nrOfCols]);
+  // Headers of the primary chunkset and all horizontal chunksets
 
-  unsigned long long chunksetHash = XXH64(&metaDataBlock[keyIndexHeaderSize + 8], chunksetHeaderSize - 8, FST_HASH_SEED);
-  if (*p_chunksetHash != chunksetHash)
+  if (!ReadChunksetHeaders(myfile, TABLE_META_SIZE + keyIndexHeaderSize, state->chunksets, state->colInfo))
   {
-    delete[] metaDataBlock;
-    metaDataBlock = nullptr;
-    myfile.close();
+    delete state;
     throw(runtime_error(FSTERROR_DAMAGED_HEADER));
   }
 
-  // Column names header
+  int nrOfCols = state->colInfo.size() / 4;
 
-  unsigned long long offset = keyIndexHeaderSize + chunksetHeaderSize;
-  unsigned long long* p_colNamesHash = reinterpret_cast<unsigned long long*>(&metaDataBlock[offset]);
-  //unsigned int* p_colNamesVersion = reinterpret_cast<unsigned int*>(&metaDataBlock[offset + 8]);
-  //int* p_colNamesFlags = reinterpret_cast<int*>(&metaDataBlock[offset + 12]);
-  //unsigned long long* p_freeBytes4 = reinterpret_cast<unsigned long long*>(&metaDataBlock[16]);
+  // Column names, with a lookup table for column selections
+  try
+  {
+    ReadColumnNames(myfile, &state->colNames, state->chunksets, nrOfCols);
+  }
+  catch (const std::exception &)
+  {
+    delete state;
+    throw;
+  }
 
-  unsigned long long colNamesHash = XXH64(&metaDataBlock[offset + 8], colNamesHeaderSize - 8, FST_HASH_SEED);
-  if (*p_colNamesHash != colNamesHash)
+  for (int colNr = 0; colNr < nrOfCols; ++colNr)
   {
-    delete[] metaDataBlock;
-    metaDataBlock = nullptr;
-    myfile.close();
-    throw(runtime_error(FSTERROR_DAMAGED_HEADER));
+    state->colNrs.insert(std::make_pair(state->colNames.Element(colNr), colNr));
   }
 
-  // Read column names
-  unsigned long long colNamesOffset = metaSize + TABLE_META_SIZE;
+  state->chunksetIndex.resize(state->chunksets.size());
 
-  blockReader = columnFactory->CreateStringColumn(nrOfCols, FstColumnAttribute::NONE);
-  fdsReadCharVec_v6(myfile, blockReader, colNamesOffset, 0, static_cast<unsigned int>(nrOfCols), static_cast<unsigned int>(nrOfCols));
+  for (unsigned int chunksetNr = 0; chunksetNr < state->chunksets.size(); ++chunksetNr)
+  {
+    state->chunksetIndex[chunksetNr].isLoaded = false;
+  }
 
-  // cleanup
-  metaDataBlock = nullptr;
-  myfile.close();
+  return state;
 }
 
 
-void FstStore::fstRead(IFstTable &tableReader, IStringArray* columnSelection, long long startRow, long long endRow,
-  IColumnFactory* columnFactory, vector<int> &keyIndex, IStringArray* selectedCols)
+/**
+ * \brief Get the state of a store, a temporary state is opened if the store is not opened
+ * \param fstFile path of the fst file of the store
+ * \param source source of the store, nullptr for a store on file
+ * \param storeState state of the store, nullptr if the store is not opened
+ * \return state to use, should be released with ReleaseFileState()
+ */
+inline FstFileState* AcquireFileState(const std::string &fstFile, IFstSource* source, FstFileState* storeState)
 {
-  // fst file stream using a stack buffer
-  ifstream myfile;
-  myfile.open(fstFile.c_str(), ios::in | ios::binary);  // only nead an input stream reader
+  if (storeState != nullptr) return storeState;
 
-  if (myfile.fail())
-  {
-    myfile.close();
-    throw(runtime_error(FSTERROR_ERROR_OPENING_FILE));
-  }
+  return OpenFileState(fstFile, source);
+}
 
-  int keyLength;
-  version = ReadHeader(myfile, keyLength, nrOfCols);
 
-  unsigned long long keyIndexHeaderSize = 0;
+/**
+ * \brief Release a state acquired with AcquireFileState(), the state of an opened store is kept
+ */
+inline void ReleaseFileState(FstFileState* state, FstFileState* storeState)
+{
+  if (state != storeState) delete state;
+}
 
-  if (keyLength != 0)
+
+/**
+ * \brief Read the chunk index chain of a chunkset, unless it was read before
+ * \param myfile source of the fst file
+ * \param chunkset location of the chunkset
+ * \param chunksetIndex chunk index of the chunkset
+ * \return false if one of the chained chunk indexes is damaged
+ */
+inline bool LoadChunksetIndex(IFstSource &myfile, ChunksetInfo &chunkset, ChunksetIndex &chunksetIndex)
+{
+  if (chunksetIndex.isLoaded) return true;
+
+  vector<unsigned long long> chunkPos;
+  vector<unsigned long long> chunkRows;
+  char lastChunkIndex[CHUNK_INDEX_SIZE];
+  unsigned long long lastChunkIndexPos;
+
+  if (!ReadChunkIndexChain(myfile, chunkset.chunkIndexPos, chunkPos, chunkRows, lastChunkIndex, lastChunkIndexPos))
   {
-    keyIndexHeaderSize = 4 * (keyLength + 2);  // size of key index vector and hash
+    return false;
   }
 
-  unsigned long long chunksetHeaderSize = CHUNKSET_HEADER_SIZE + 8 * nrOfCols;
-  unsigned long long colNamesHeaderSize = 24;
-  unsigned long long metaSize = keyIndexHeaderSize + chunksetHeaderSize + colNamesHeaderSize;
+  chunksetIndex.chunkPos.swap(chunkPos);
+  chunksetIndex.chunkRows.swap(chunkRows);
+  chunksetIndex.positions.resize(chunkset.nrOfCols * chunksetIndex.chunkPos.size());
+  chunksetIndex.hasPositions.assign(chunksetIndex.chunkPos.size(), 0);
+  chunksetIndex.isLoaded = true;
 
-  // Read format headers
-  char* metaDataBlock = new char[metaSize];
-  myfile.read(metaDataBlock, metaSize);
+  return true;
+}
 
-  int* keyColPos = reinterpret_cast<int*>(&metaDataBlock[8]);  // TODO: why not unsigned ?
 
-  if (keyLength != 0)
+/**
+ * \brief Get the column positions of a data chunk, the data chunk header is read on first use
+ * \param myfile source of the fst file
+ * \param nrOfCols number of columns in the chunkset
+ * \param chunksetIndex loaded chunk index of the chunkset
+ * \param chunkNr index of the data chunk in the chunk index chain
+ * \param positionData array of length nrOfCols receiving the column positions (output)
+ * \return false if the data chunk header is damaged
+ */
+inline bool ChunkPositions(IFstSource &myfile, int nrOfCols, ChunksetIndex &chunksetIndex, unsigned long long chunkNr,
+  unsigned long long* positionData)
+{
+  unsigned long long* chunkPositions = &chunksetIndex.positions[chunkNr * nrOfCols];
+
+  if (chunksetIndex.hasPositions[chunkNr] == 0)
   {
-    unsigned long long* p_keyIndexHash = reinterpret_cast<unsigned long long*>(metaDataBlock);
-    unsigned long long hHash = XXH64(&metaDataBlock[8], keyIndexHeaderSize - 8, FST_HASH_SEED);
+    if (!ReadDataChunkHeader(myfile, chunksetIndex.chunkPos[chunkNr], nrOfCols, chunkPositions)) return false;
 
-    if (*p_keyIndexHash != hHash)
-    {
-      delete[] metaDataBlock;
-      myfile.close();
-      throw(runtime_error(FSTERROR_DAMAGED_HEADER));
-    }
+    chunksetIndex.hasPositions[chunkNr] = 1;
   }
 
-  // Chunkset header [node C, free leaf of A or other chunkset header] [size: 76 + 8 * nrOfCols]
-  
-  unsigned long long* p_chunksetHash      = reinterpret_cast<unsigned long long*>(&metaDataBlock[keyIndexHeaderSize]);
-  //unsigned int* p_chunksetHeaderVersion   = reinterpret_cast<unsigned int*>(&metaDataBlock[keyIndexHeaderSize + 8]);
-  //int* p_chunksetFlags                    = reinterpret_cast<int*>(&metaDataBlock[keyIndexHeaderSize + 12]);
-  //unsigned long long* p_freeBytes2        = reinterpret_cast<unsigned long long*>(&metaDataBlock[keyIndexHeaderSize + 16]);
-  //unsigned long long* p_freeBytes3        = reinterpret_cast<unsigned long long*>(&metaDataBlock[keyIndexHeaderSize + 24]);
-  //unsigned long long* p_colNamesPos       = reinterpret_cast<unsigned long long*>(&metaDataBlock[keyIndexHeaderSize + 32]);
-
-  //unsigned long long* p_nextHorzChunkSet  = reinterpret_cast<unsigned long long*>(&metaDataBlock[keyIndexHeaderSize + 40]);
-  //unsigned long long* p_primChunksetIndex = reinterpret_cast<unsigned long long*>(&metaDataBlock[keyIndexHeaderSize + 48]);
-  //unsigned long long* p_secChunksetIndex  = reinterpret_cast<unsigned long long*>(&metaDataBlock[keyIndexHeaderSize + 56]);
-  //unsigned long long* p_nrOfRows          = reinterpret_cast<unsigned long long*>(&metaDataBlock[keyIndexHeaderSize + 64]);
-  //int* p_nrOfChunksetCols                 = reinterpret_cast<int*>(&metaDataBlock[keyIndexHeaderSize + 72]);
-
-  unsigned short int* colAttributeTypes   = reinterpret_cast<unsigned short int*>(&metaDataBlock[keyIndexHeaderSize + 76]);
-  unsigned short int* colTypes            = reinterpret_cast<unsigned short int*>(&metaDataBlock[keyIndexHeaderSize + 76 + 2 * nrOfCols]);
-  //unsigned short int* colBaseTypes        = reinterpret_cast<unsigned short int*>(&metaDataBlock[keyIndexHeaderSize + 76 + 4 * nrOfCols]);
-  unsigned short int* colScales           = reinterpret_cast<unsigned short int*>(&metaDataBlock[keyIndexHeaderSize + 76 + 6 * nrOfCols]);
-
-  unsigned long long chunksetHash = XXH64(&metaDataBlock[keyIndexHeaderSize + 8], chunksetHeaderSize - 8, FST_HASH_SEED);
-  if (*p_chunksetHash != chunksetHash)
-  {
-    delete[] metaDataBlock;
-    myfile.close();
-    throw(runtime_error(FSTERROR_DAMAGED_HEADER));
-  }
+  memcpy(positionData, chunkPositions, 8 * nrOfCols);
+
+  return true;
+}
 
-  // Column names header
 
-  unsigned long long offset          = keyIndexHeaderSize + chunksetHeaderSize;
-  unsigned long long* p_colNamesHash = reinterpret_cast<unsigned long long*>(&metaDataBlock[offset]);
-  //unsigned int* p_colNamesVersion    = reinterpret_cast<unsigned int*>(&metaDataBlock[offset + 8]);
-  //int* p_colNamesFlags               = reinterpret_cast<int*>(&metaDataBlock[offset + 12]);
-  //unsigned long long* p_freeBytes4   = reinterpret_cast<unsigned long long*>(&metaDataBlock[offset + 16]);
+void FstStore::fstOpen()
+{
+  FstFileState* state = OpenFileState(fstFile, source, true);
+
+  delete fileState;
+  fileState = state;
+}
+
+
+void FstStore::fstClose()
+{
+  delete fileState;
+  fileState = nullptr;
+}
+
 
-  unsigned long long colNamesHash = XXH64(&metaDataBlock[offset + 8], colNamesHeaderSize - 8, FST_HASH_SEED);
-  if (*p_colNamesHash != colNamesHash)
+/**
+ * \brief Compare the strings of a string writer with the elements of a string column
+ * \param stringWriter writer with the strings to compare
+ * \param stringColumn column with the strings to compare
+ * \param colOffset position of the first element to compare in stringColumn
+ * \param nrOfElements number of elements to compare
+ * \return true if all elements are equal
+ */
+inline bool EqualStrings(IStringWriter* stringWriter, IStringColumn* stringColumn, unsigned long long colOffset,
+  unsigned long long nrOfElements)
+{
+  if (stringWriter->vecLength != nrOfElements) return false;
+
+  for (unsigned long long startCount = 0; startCount < nrOfElements; startCount += BLOCKSIZE_CHAR)
   {
-    delete[] metaDataBlock;
-    myfile.close();
-    throw(runtime_error(FSTERROR_DAMAGED_HEADER));
+    unsigned long long endCount = min(startCount + BLOCKSIZE_CHAR, nrOfElements);
+    stringWriter->SetBuffersFromVec(startCount, endCount);
+
+    unsigned int lastPos = 0;
+    for (unsigned long long count = startCount; count < endCount; ++count)
+    {
+      unsigned int pos = stringWriter->strSizes[count - startCount];
+      const char* str = stringColumn->GetElement(colOffset + count);
+
+      if (strlen(str) != pos - lastPos || strncmp(str, &stringWriter->activeBuf[lastPos], pos - lastPos) != 0)
+      {
+        return false;
+      }
+
+      lastPos = pos;
+    }
   }
 
-  // Column names
+  return true;
+}
 
-  unsigned long long colNamesOffset = metaSize + TABLE_META_SIZE;
-  blockReader = columnFactory->CreateStringColumn(nrOfCols, FstColumnAttribute::NONE);
-  fdsReadCharVec_v6(myfile, blockReader, colNamesOffset, 0, static_cast<unsigned int>(nrOfCols), static_cast<unsigned int>(nrOfCols));
 
-  // Size of chunkset index header plus data chunk header
-  unsigned long long chunkIndexSize    = CHUNK_INDEX_SIZE + DATA_INDEX_SIZE + 8 * nrOfCols;
-  char* chunkIndex                     = new char[chunkIndexSize];
+// Format version type of each column type
+inline unsigned short int ColumnTypeVersion(FstColumnType colType)
+{
+  switch (colType)
+  {
+    case FstColumnType::CHARACTER:
+      return 6;
 
-  myfile.read(chunkIndex, chunkIndexSize);
+    case FstColumnType::FACTOR:
+      return 7;
 
-  // Chunk index [node D, leaf of C] [size: 96]
+    case FstColumnType::INT_32:
+      return 8;
 
-  unsigned long long* p_chunkIndexHash = reinterpret_cast<unsigned long long*>(chunkIndex);
-  //unsigned int* p_chunkIndexVersion    = reinterpret_cast<unsigned int*>(&chunkIndex[8]);
-  //int* p_chunkIndexFlags               = reinterpret_cast<int*>(&chunkIndex[12]);
-  //unsigned long long* p_freeBytes5     = reinterpret_cast<unsigned long long*>(&chunkIndex[16]);
-  //unsigned short int* p_nrOfChunkSlots = reinterpret_cast<unsigned short int*>(&chunkIndex[24]);
-  //unsigned short int* p_freeBytes6     = reinterpret_cast<unsigned short int*>(&chunkIndex[26]);
-  //unsigned long long* p_chunkPos       = reinterpret_cast<unsigned long long*>(&chunkIndex[32]);
-  unsigned long long* p_chunkRows      = reinterpret_cast<unsigned long long*>(&chunkIndex[64]);
+    case FstColumnType::DOUBLE_64:
+      return 9;
 
-  // Chunk data header [node E, leaf of D] [size: 24 + 8 * nrOfCols]
+    case FstColumnType::BOOL_2:
+      return 10;
 
-  unsigned long long* p_chunkDataHash  = reinterpret_cast<unsigned long long*>(&chunkIndex[96]);
-  //unsigned int* p_chunkDataVersion     = reinterpret_cast<unsigned int*>(&chunkIndex[104]);
-  //int* p_chunkDataFlags                = reinterpret_cast<int*>(&chunkIndex[108]);
-  //unsigned long long* p_freeBytes7     = reinterpret_cast<unsigned long long*>(&chunkIndex[112]);
-  unsigned long long* positionData     = reinterpret_cast<unsigned long long*>(&chunkIndex[120]);  // column position index
+    case FstColumnType::INT_64:
+      return 11;
+
+    case FstColumnType::BYTE:
+      return 12;
+
+    default:
+      return 0;
+  }
+}
 
 
-  // Check chunk hashes
+// Column of a dataset that is written to a stream
+struct ColumnWriteJob
+{
+  FstColumnType colType;
+  std::string annotation;
+  char* data;                      // vector data of fixed width columns
+  unsigned long long bufferSize;   // expected size of the stored column, 0 if the column is written by the main thread
+};
 
-  unsigned long long chunkIndexHash = XXH64(&chunkIndex[8], CHUNK_INDEX_SIZE - 8, FST_HASH_SEED);
 
-  if (*p_chunkIndexHash != chunkIndexHash)
+/**
+ * \brief Write a single fixed width column to a stream
+ * \param myfile stream to write to
+ * \param job column to write
+ * \param nrOfRows number of rows in the dataset
+ * \param compress compression factor in the range 0 - 100
+ */
+inline void WriteFixedColumn(IFstSink &myfile, ColumnWriteJob &job, unsigned long long nrOfRows, int compress)
+{
+  switch (job.colType)
   {
-    delete[] metaDataBlock;
-    delete[] chunkIndex;
-    delete blockReader;
-    blockReader = nullptr;
-    myfile.close();
-    throw(runtime_error(FSTERROR_DAMAGED_CHUNKINDEX));
+    case FstColumnType::INT_32:
+      fdsWriteIntVec_v8(myfile, reinterpret_cast<int*>(job.data), nrOfRows, compress, job.annotation);
+      break;
+
+    case FstColumnType::DOUBLE_64:
+      fdsWriteRealVec_v9(myfile, reinterpret_cast<double*>(job.data), nrOfRows, compress, job.annotation);
+      break;
+
+    case FstColumnType::BOOL_2:
+      fdsWriteLogicalVec_v10(myfile, reinterpret_cast<int*>(job.data), nrOfRows, compress, job.annotation);
+      break;
+
+    case FstColumnType::INT_64:
+      fdsWriteInt64Vec_v11(myfile, reinterpret_cast<long long*>(job.data), nrOfRows, compress, job.annotation);
+      break;
+
+    default:  // BYTE
+      fdsWriteByteVec_v12(myfile, job.data, nrOfRows, compress, job.annotation);
+      break;
   }
+}
 
-  unsigned long long chunkDataHash = XXH64(&chunkIndex[CHUNK_INDEX_SIZE + 8], chunkIndexSize - (CHUNK_INDEX_SIZE + 8), FST_HASH_SEED);
 
-  if (*p_chunkDataHash != chunkDataHash)
+// Hands the compressed columns of a run from the compression threads to the writer of the run. Columns are claimed in
+// order and their buffers are kept until the writer has appended them, the total size of the buffers is bounded by the
+// write budget. The next column to write is always allowed to reserve its buffer, so a thread that waits for budget
+// always waits for the writer and never for another waiting thread.
+class ColumnWriteQueue
+{
+  std::mutex queueMutex;
+  std::condition_variable queueCondition;
+  std::vector<FstMemoryBuffer*> columnBuffers;  // compressed columns, nullptr if compression failed
+  std::vector<bool> isCompressed;
+  unsigned long long writeBudget;
+  unsigned long long reservedSize = 0;          // total size of the buffers that are not written yet
+  int nextColumn = 0;                           // next column to append to the stream
+
+public:
+  ColumnWriteQueue(int nrOfColumns, unsigned long long writeBudget)
   {
-    delete[] metaDataBlock;
-    delete[] chunkIndex;
-    delete blockReader;
-    blockReader = nullptr;
-    myfile.close();
-    throw(runtime_error(FSTERROR_DAMAGED_CHUNKINDEX));
+    this->writeBudget = writeBudget;
+    columnBuffers.resize(nrOfColumns, nullptr);
+    isCompressed.resize(nrOfColumns, false);
   }
 
+  ~ColumnWriteQueue()
+  {
+    for (FstMemoryBuffer* columnBuffer : columnBuffers) delete columnBuffer;
+  }
 
-  // Read block positions
-  unsigned long long* blockPos = positionData;
+  // Wait until the buffer of a column fits in the write budget
+  void Reserve(int column, unsigned long long bufferSize)
+  {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    queueCondition.wait(lock, [&] { return column == nextColumn || reservedSize + bufferSize <= writeBudget; });
+    reservedSize += bufferSize;
+  }
 
+  // Signal the writer that a column is compressed
+  void Complete(int column, FstMemoryBuffer* columnBuffer)
+  {
+    {
+      std::lock_guard<std::mutex> lock(queueMutex);
+      columnBuffers[column] = columnBuffer;
+      isCompressed[column] = true;
+    }
 
-  // Determine column selection
-  int *colIndex;
-  int nrOfSelect;
+    queueCondition.notify_all();
+  }
 
-  if (columnSelection == nullptr)
+  // Wait until a column is compressed
+  FstMemoryBuffer* WaitCompressed(int column)
   {
-    colIndex = new int[nrOfCols];
+    std::unique_lock<std::mutex> lock(queueMutex);
+    queueCondition.wait(lock, [&] { return isCompressed[column]; });
+    return columnBuffers[column];
+  }
 
-    for (int colNr = 0; colNr < nrOfCols; ++colNr)
+  // Release the buffer of a written column
+  void Release(int column, unsigned long long bufferSize)
+  {
     {
-      colIndex[colNr] = colNr;
+      std::lock_guard<std::mutex> lock(queueMutex);
+      delete columnBuffers[column];
+      columnBuffers[column] = nullptr;
+      reservedSize -= bufferSize;
+      nextColumn = column + 1;
     }
-    nrOfSelect = nrOfCols;
+
+    queueCondition.notify_all();
   }
-  else  // determine column numbers of column names
+};
+
+
+/**
+ * \brief Compress a run of fixed width columns concurrently and append them to a stream in order
+ *
+ * Each thread compresses a column into its own memory buffer. A dedicated writer appends the buffers to the stream in
+ * column order, so writing a column overlaps with compressing the next columns and a thread that finished a column
+ * continues with the next column. Compressed columns wait for the writer within the write budget, see
+ * ColumnWriteQueue.
+ * \param myfile stream to write to
+ * \param jobs columns to write
+ * \param runStart first column of the run
+ * \param runEnd column after the last column of the run
+ * \param positionData column positions (output)
+ */
+inline void WriteColumnsConcurrent(IFstSink &myfile, vector<ColumnWriteJob> &jobs, int runStart, int runEnd,
+  unsigned long long nrOfRows, int compress, unsigned long long* positionData, int nrOfThreads)
+{
+  // Exceptions can't leave the parallel region or the writer, the first error is rethrown afterwards
+  bool hasError = false;
+  std::string errorMessage;
+  std::mutex errorMutex;
+
+  auto setError = [&](const char* message)
   {
-    nrOfSelect = columnSelection->Length();
-    colIndex = new int[nrOfSelect];
-    for (int colSel = 0; colSel < nrOfSelect; ++colSel)
+    std::lock_guard<std::mutex> lock(errorMutex);
+    if (!hasError) errorMessage = message;
+    hasError = true;
+  };
+
+  ColumnWriteQueue writeQueue(runEnd - runStart, GetFstWriteBudget());
+  std::atomic<int> nextJob(runStart);  // columns are claimed in order
+
+  thread writer([&]
+  {
+    bool writeFailed = false;
+
+    for (int colNr = runStart; colNr < runEnd; ++colNr)
     {
-      int equal = -1;
-      const char* str1 = columnSelection->GetElement(colSel);
+      FstMemoryBuffer* columnBuffer = writeQueue.WaitCompressed(colNr - runStart);
+
+      // columns following a failed column are not appended
+      if (columnBuffer == nullptr) writeFailed = true;
 
-      for (int colNr = 0; colNr < nrOfCols; ++colNr)
+      if (!writeFailed)
       {
-        const char* str2 = blockReader->GetElement(colNr);
-        if (strcmp(str1, str2) == 0)
+        try
         {
-          equal = colNr;
-          break;
+          positionData[colNr] = myfile.Size();
+          SinkAppend(myfile, columnBuffer->Data(), columnBuffer->Size());
+        }
+        catch (const std::exception &e)
+        {
+          setError(e.what());
+          writeFailed = true;
+        }
+        catch (...)
+        {
+          setError("Error writing column data to the stream");
+          writeFailed = true;
         }
       }
 
-      if (equal == -1)
+      writeQueue.Release(colNr - runStart, jobs[colNr].bufferSize);
+    }
+  });
+
+  //////////////////////////////////////////////////////////
+  // Parallel logic starts here
+  //////////////////////////////////////////////////////////
+
+#pragma omp parallel num_threads(nrOfThreads)
+  {
+    for (int colNr = nextJob++; colNr < runEnd; colNr = nextJob++)
+    {
+      FstMemoryBuffer* columnBuffer = nullptr;
+
+      writeQueue.Reserve(colNr - runStart, jobs[colNr].bufferSize);
+
+      try
       {
-        delete[] metaDataBlock;
-        delete[] colIndex;
-        delete[] chunkIndex;
-        delete blockReader;
-        blockReader = nullptr;
-        myfile.close();
-        throw(runtime_error("Selected column not found."));
+        // column writers called from inside the parallel region compress with a single thread
+        columnBuffer = new FstMemoryBuffer(jobs[colNr].bufferSize);
+
+        WriteFixedColumn(*columnBuffer, jobs[colNr], nrOfRows, compress);
       }
+      catch (const std::exception &e)
+      {
+        setError(e.what());
 
-      colIndex[colSel] = equal;
+        delete columnBuffer;
+        columnBuffer = nullptr;
+      }
+
+      writeQueue.Complete(colNr - runStart, columnBuffer);
     }
   }
 
+  //////////////////////////////////////////////////////////
+  // Parallel logic ends here
+  //////////////////////////////////////////////////////////
 
-  // Check range of selected rows
-  long long firstRow = startRow - 1;
-  unsigned long long nrOfRows = *p_chunkRows;  // TODO: check for row numbers > INT_MAX !!!
+  writer.join();
 
-  if (firstRow >= static_cast<long long>(nrOfRows) || firstRow < 0)
-  {
-    delete[] metaDataBlock;
-    delete[] colIndex;
-    delete[] chunkIndex;
-    delete blockReader;
-    blockReader = nullptr;
-    myfile.close();
+  if (hasError) throw(runtime_error(errorMessage));
+}
 
-    if (firstRow < 0)
-    {
-      throw(runtime_error("Parameter fromRow should have a positive value."));
-    }
 
-    throw(runtime_error("Row selection is out of range."));
-  }
+/**
+ * \brief Write the column data of a dataset to a stream and register column positions and types
+ *
+ * Character and factor columns access the string data of the dataset and are written by the main thread, as are
+ * columns that don't fit in the memory budget of a single thread (these are compressed with multiple threads
+ * internally). Runs of other columns are compressed concurrently, see WriteColumnsConcurrent().
+ * \param myfile stream to write to
+ * \param fstTable interface to a dataset
+ * \param colOffset column number of the first column to write
+ * \param nrOfCols number of columns to write
+ * \param nrOfRows number of rows in the dataset
+ * \param compress compression factor in the range 0 - 100
+ * \param positionData column positions (output)
+ * \param versionMax fstcore version required to read the written columns, raised here if needed (output)
+ * \return false if a column of unknown type was found
+ */
+inline bool WriteColumnData(IFstSink &myfile, IFstTable &fstTable, int colOffset, int nrOfCols, unsigned long long nrOfRows,
+  int compress, unsigned long long* positionData, unsigned short int* colTypes, unsigned short int* colBaseTypes,
+  unsigned short int* colAttributeTypes, unsigned short int* colScales, unsigned int &versionMax)
+{
+  int nrOfThreads = GetFstThreads();
+  unsigned long long threadBudget = GetFstWriteBudget() / nrOfThreads;  // maximum buffer size for a single thread
 
-  long long length = nrOfRows - firstRow;
+  // Column types and data pointers are retrieved on the main thread
 
+  vector<ColumnWriteJob> jobs(nrOfCols);
 
-  // Determine vector length
-  if (endRow != -1)
+  for (int colNr = 0; colNr < nrOfCols; ++colNr)
   {
-    if (static_cast<long long>(endRow) <= firstRow)
+    FstColumnAttribute colAttribute;
+    short int scale = 0;
+    unsigned int tableCol = colOffset + colNr;
+    ColumnWriteJob &job = jobs[colNr];
+
+    // get type and add annotation
+    job.annotation = "";
+    job.colType = fstTable.ColumnType(tableCol, colAttribute, scale, job.annotation);
+    job.data = nullptr;
+
+    colBaseTypes[colNr] = static_cast<unsigned short int>(job.colType);
+    colAttributeTypes[colNr] = static_cast<unsigned short int>(colAttribute);
+    colScales[colNr] = scale;
+    colTypes[colNr] = ColumnTypeVersion(job.colType);
+
+    unsigned long long elementSize = 0;
+
+    switch (job.colType)
     {
-      delete[] metaDataBlock;
-      delete[] colIndex;
-      delete[] chunkIndex;
-      delete blockReader;
-      blockReader = nullptr;
-      myfile.close();
-      throw(runtime_error("Incorrect row range specified."));
+      case FstColumnType::CHARACTER:
+      case FstColumnType::FACTOR:
+        break;
+
+      case FstColumnType::INT_32:
+        job.data = reinterpret_cast<char*>(fstTable.GetIntWriter(tableCol));
+        elementSize = 4;
+        break;
+
+      case FstColumnType::DOUBLE_64:
+        job.data = reinterpret_cast<char*>(fstTable.GetDoubleWriter(tableCol));
+        elementSize = 8;
+        break;
+
+      case FstColumnType::BOOL_2:
+        job.data = reinterpret_cast<char*>(fstTable.GetLogicalWriter(tableCol));
+        elementSize = 4;
+        break;
+
+      case FstColumnType::INT_64:
+        job.data = reinterpret_cast<char*>(fstTable.GetInt64Writer(tableCol));
+        elementSize = 8;
+        break;
+
+      case FstColumnType::BYTE:
+        job.data = fstTable.GetByteWriter(tableCol);
+        elementSize = 1;
+        break;
+
+      default:
+        return false;
     }
 
-    length = min(endRow - firstRow, static_cast<long long>(nrOfRows) - firstRow);
-  }
+    // Stored size of the column: data, block index, zone map and a margin for incompressible blocks
+    unsigned long long dataSize = nrOfRows * elementSize;
+    job.bufferSize = dataSize == 0 ? 0 : dataSize + dataSize / 64 + job.annotation.length() + 4096;
 
-  tableReader.InitTable(nrOfSelect, length);
+    if (nrOfThreads == 1 || job.bufferSize > threadBudget) job.bufferSize = 0;
+  }
 
-  for (int colSel = 0; colSel < nrOfSelect; ++colSel)
+  for (int colNr = 0; colNr < nrOfCols; )
   {
-    int colNr = colIndex[colSel];
+    // Run of columns that can be compressed concurrently
+    int runEnd = colNr;
+    while (runEnd < nrOfCols && jobs[runEnd].bufferSize > 0) ++runEnd;
 
-    if (colNr < 0 || colNr >= nrOfCols)
+    if (runEnd - colNr > 1)
     {
-      delete[] metaDataBlock;
-      delete[] colIndex;
-      delete[] chunkIndex;
-      delete blockReader;
-      blockReader = nullptr;
-      myfile.close();
-      throw(runtime_error("Column selection is out of range."));
+      WriteColumnsConcurrent(myfile, jobs, colNr, runEnd, nrOfRows, compress, positionData, nrOfThreads);
+      colNr = runEnd;
+      continue;
     }
 
-    unsigned long long pos = blockPos[colNr];
-    short int scale = colScales[colNr];
+    ColumnWriteJob &job = jobs[colNr];
+    unsigned int tableCol = colOffset + colNr;
 
-    switch (colTypes[colNr])
+    positionData[colNr] = myfile.Size();  // current location
+
+    switch (job.colType)
     {
-    // Character vector
-      case 6:
+      case FstColumnType::CHARACTER:
       {
-        IStringColumn* stringColumn = columnFactory->CreateStringColumn(length, static_cast<FstColumnAttribute>(colAttributeTypes[colNr]));
-        fdsReadCharVec_v6(myfile, stringColumn, pos, firstRow, length, nrOfRows);
-        tableReader.SetStringColumn(stringColumn, colSel);
-        delete stringColumn;
+        IStringWriter* stringWriter = fstTable.GetStringWriter(tableCol);
+        unsigned int colVersion = fdsWriteCharVec_v6(myfile, stringWriter, compress, stringWriter->Encoding(), true);
+        versionMax = max(versionMax, colVersion);
+        delete stringWriter;
         break;
       }
 
-      // Integer vector
-      case 8:
+      case FstColumnType::FACTOR:
       {
-        IIntegerColumn* integerColumn = columnFactory->CreateIntegerColumn(length, static_cast<FstColumnAttribute>(colAttributeTypes[colNr]), scale);
-        std::string annotation = "";
-        fdsReadIntVec_v8(myfile, integerColumn->Data(), pos, firstRow, length, nrOfRows, annotation);
-        tableReader.SetIntegerColumn(integerColumn, colSel, annotation);
-        delete integerColumn;
+        int* intP = fstTable.GetIntWriter(tableCol);  // level values pointer
+        IStringWriter* stringWriter = fstTable.GetLevelWriter(tableCol);
+        fdsWriteFactorVec_v7(myfile, intP, stringWriter, nrOfRows, compress, stringWriter->Encoding(), job.annotation);
+        delete stringWriter;
         break;
       }
 
-      // Double vector
-      case 9:
-      {
-        IDoubleColumn* doubleColumn = columnFactory->CreateDoubleColumn(length, static_cast<FstColumnAttribute>(colAttributeTypes[colNr]), scale);
-        std::string annotation = "";
-        fdsReadRealVec_v9(myfile, doubleColumn->Data(), pos, firstRow, length, nrOfRows, annotation);
-        tableReader.SetDoubleColumn(doubleColumn, colSel, annotation);
-        delete doubleColumn;
+      default:
+        WriteFixedColumn(myfile, job, nrOfRows, compress);
         break;
-      }
+    }
 
-      // Logical vector
-      case 10:
-      {
-        ILogicalColumn* logicalColumn = columnFactory->CreateLogicalColumn(length, static_cast<FstColumnAttribute>(colAttributeTypes[colNr]));
-        fdsReadLogicalVec_v10(myfile, logicalColumn->Data(), pos, firstRow, length, nrOfRows);
-        tableReader.SetLogicalColumn(logicalColumn, colSel);
-        delete logicalColumn;
-        break;
-      }
+    ++colNr;
+  }
 
-      // Factor vector
-      case 7:
-      {
-        IFactorColumn* factorColumn = columnFactory->CreateFactorColumn(length, static_cast<FstColumnAttribute>(colAttributeTypes[colNr]));
-        fdsReadFactorVec_v7(myfile, factorColumn->Levels(), factorColumn->LevelData(), pos, firstRow, length, nrOfRows);
-        tableReader.SetFactorColumn(factorColumn, colSel);
-        delete factorColumn;
-        break;
-      }
+  return true;
+}
 
-	  // integer64 vector
-	  case 11:
-	  {
-	    IInt64Column* int64Column = columnFactory->CreateInt64Column(length, static_cast<FstColumnAttribute>(colAttributeTypes[colNr]), scale);
-      fdsReadInt64Vec_v11(myfile, int64Column->Data(), pos, firstRow, length, nrOfRows);
-	    tableReader.SetInt64Column(int64Column, colSel);
-	    delete int64Column;
-	    break;
-	  }
-
-	  // byte vector
-	  case 12:
-	  {
-		  IByteColumn* byteColumn = columnFactory->CreateByteColumn(length, static_cast<FstColumnAttribute>(colAttributeTypes[colNr]));
-		  fdsReadByteVec_v12(myfile, byteColumn->Data(), pos, firstRow, length, nrOfRows);
-		  tableReader.SetByteColumn(byteColumn, colSel);
-		  delete byteColumn;
-		  break;
-	  }
 
-    default:
-      delete[] metaDataBlock;
-      delete[] colIndex;
-      delete[] chunkIndex;
-      delete blockReader;
-      blockReader = nullptr;
-      myfile.close();
-      throw(runtime_error("Unknown type found in column."));
-    }
-  }
+/**
+ * \brief Write all columns of a dataset as a single chunkset, starting at the current stream position
+ * \param myfile stream to write to
+ * \param fstTable interface to a dataset
+ * \param compress compression factor in the range 0 - 100
+ * \param versionMax fstcore version required to read the written columns, raised here if needed (output)
+ * \return false if a column of unknown type was found
+ */
+inline bool WriteChunkset(IFstSink &myfile, IFstTable &fstTable, int compress, unsigned int &versionMax)
+{
+  int nrOfCols = fstTable.NrOfColumns();
+  unsigned long long nrOfRows = fstTable.NrOfRows();
+  unsigned long long chunksetPos = myfile.Size();
 
-  // delete blockReaderStrVec;
+  unsigned long long chunksetHeaderSize = CHUNKSET_HEADER_SIZE + 8 * nrOfCols;
+  unsigned long long colNamesHeaderSize = 24;
+  unsigned long long metaDataSize = chunksetHeaderSize + colNamesHeaderSize;
+  char* metaDataBlock = new char[metaDataSize];
 
-  myfile.close();
+  // Chunkset header [node C, free leaf of A or other chunkset header] [size: 76 + 8 * nrOfCols]
 
-  // Key index
-  SetKeyIndex(keyIndex, keyLength, nrOfSelect, keyColPos, colIndex);
+  unsigned long long* p_chunksetHash      = reinterpret_cast<unsigned long long*>(metaDataBlock);
+  unsigned int* p_chunksetHeaderVersion   = reinterpret_cast<unsigned int*>(&metaDataBlock[8]);
+  int* p_chunksetFlags                    = reinterpret_cast<int*>(&metaDataBlock[12]);
+  unsigned long long* p_freeBytes2        = reinterpret_cast<unsigned long long*>(&metaDataBlock[16]);
+  unsigned long long* p_freeBytes3        = reinterpret_cast<unsigned long long*>(&metaDataBlock[24]);
+  unsigned long long* p_colNamesPos       = reinterpret_cast<unsigned long long*>(&metaDataBlock[32]);
 
-  selectedCols->AllocateArray(nrOfSelect);
+  unsigned long long* p_nextHorzChunkSet  = reinterpret_cast<unsigned long long*>(&metaDataBlock[40]);
+  unsigned long long* p_primChunksetIndex = reinterpret_cast<unsigned long long*>(&metaDataBlock[48]);
+  unsigned long long* p_secChunksetIndex  = reinterpret_cast<unsigned long long*>(&metaDataBlock[56]);
+  unsigned long long* p_nrOfRows          = reinterpret_cast<unsigned long long*>(&metaDataBlock[64]);
+  int* p_nrOfChunksetCols                 = reinterpret_cast<int*>(&metaDataBlock[72]);
 
-  // Only when keys are present in result set, TODO: compute using C++ only !!!
-  for (int i = 0; i < nrOfSelect; ++i)
-  {
-    selectedCols->SetElement(i, blockReader->GetElement(colIndex[i]));
-  }
+  unsigned short int* colAttributeTypes   = reinterpret_cast<unsigned short int*>(&metaDataBlock[76]);
+  unsigned short int* colTypes            = reinterpret_cast<unsigned short int*>(&metaDataBlock[76 + 2 * nrOfCols]);
+  unsigned short int* colBaseTypes        = reinterpret_cast<unsigned short int*>(&metaDataBlock[76 + 4 * nrOfCols]);
+  unsigned short int* colScales           = reinterpret_cast<unsigned short int*>(&metaDataBlock[76 + 6 * nrOfCols]);
 
-  delete[] metaDataBlock;
-  delete[] colIndex;
-  delete[] chunkIndex;
+  // Column names [leaf to C]  [size: 24 + x]
+
+  unsigned long long offset = chunksetHeaderSize;
+  unsigned long long* p_colNamesHash      = reinterpret_cast<unsigned long long*>(&metaDataBlock[offset]);
+  unsigned int* p_colNamesVersion         = reinterpret_cast<unsigned int*>(&metaDataBlock[offset + 8]);
+  int* p_colNamesFlags                    = reinterpret_cast<int*>(&metaDataBlock[offset + 12]);
+  unsigned long long* p_freeBytes4        = reinterpret_cast<unsigned long long*>(&metaDataBlock[offset + 16]);
+
+  *p_chunksetHeaderVersion = FST_VERSION;
+  *p_chunksetFlags         = 0;
+  *p_freeBytes2            = 0;
+  *p_freeBytes3            = 0;
+  *p_colNamesPos           = chunksetPos + chunksetHeaderSize;
+  *p_nextHorzChunkSet      = 0;
+  *p_primChunksetIndex     = 0;
+  *p_secChunksetIndex      = 0;
+  *p_nrOfRows              = nrOfRows;
+  *p_nrOfChunksetCols      = nrOfCols;
+
+  // Set column names header
+
+  *p_colNamesVersion       = FST_VERSION;
+  *p_colNamesFlags         = 0;
+  *p_freeBytes4            = 0;
+
+  *p_colNamesHash = XXH64(p_colNamesVersion, colNamesHeaderSize - 8, FST_HASH_SEED);
+
+  // Write chunkset meta information
+  SinkAppend(myfile, metaDataBlock, metaDataSize);
+
+  // Serialize column names
+  IStringWriter* blockRunner = fstTable.GetColNameWriter();
+  fdsWriteCharVec_v6(myfile, blockRunner, 0, StringEncoding::NATIVE);   // column names
+  delete blockRunner;
+
+  *p_primChunksetIndex = myfile.Size();
+
+
+  // Size of chunkset index header plus data chunk header
+  unsigned long long chunkIndexSize = CHUNK_INDEX_SIZE + DATA_INDEX_SIZE + 8 * nrOfCols;
+  char* chunkIndex = new char[chunkIndexSize];
+
+  // Chunkset data index [node D, leaf of C] [size: 96]
+
+  unsigned long long* p_chunkIndexHash = reinterpret_cast<unsigned long long*>(chunkIndex);
+  unsigned int* p_chunkIndexVersion    = reinterpret_cast<unsigned int*>(&chunkIndex[8]);
+  int* p_chunkIndexFlags               = reinterpret_cast<int*>(&chunkIndex[12]);
+  unsigned long long* p_nextChunkIndex = reinterpret_cast<unsigned long long*>(&chunkIndex[16]);
+  unsigned short int* p_nrOfChunkSlots = reinterpret_cast<unsigned short int*>(&chunkIndex[24]);
+  unsigned short int* p_nrOfChunks     = reinterpret_cast<unsigned short int*>(&chunkIndex[26]);
+  unsigned int* p_freeBytes6           = reinterpret_cast<unsigned int*>(&chunkIndex[28]);
+  unsigned long long* p_chunkPos       = reinterpret_cast<unsigned long long*>(&chunkIndex[32]);
+  unsigned long long* p_chunkRows      = reinterpret_cast<unsigned long long*>(&chunkIndex[64]);
+
+  // Chunk data header [node E, leaf of D] [size: 24 + 8 * nrOfCols]
+
+  unsigned long long* p_chunkDataHash  = reinterpret_cast<unsigned long long*>(&chunkIndex[96]);
+  unsigned int* p_chunkDataVersion     = reinterpret_cast<unsigned int*>(&chunkIndex[104]);
+  int* p_chunkDataFlags                = reinterpret_cast<int*>(&chunkIndex[108]);
+  unsigned long long* p_freeBytes7     = reinterpret_cast<unsigned long long*>(&chunkIndex[112]);
+  unsigned long long* positionData     = reinterpret_cast<unsigned long long*>(&chunkIndex[120]);  // column position index
+
+
+  // Set chunkset data index header parameters
+
+  *p_chunkIndexVersion = FST_VERSION;
+  *p_chunkIndexFlags   = 0;
+  *p_nextChunkIndex   = 0;
+  *p_nrOfChunkSlots   = CHUNK_INDEX_SLOTS;
+  *p_nrOfChunks       = 1;
+  *p_freeBytes6       = 0;
+
+  // unused slots are available for appending data
+  memset(p_chunkPos, 0, 16 * CHUNK_INDEX_SLOTS);
+  *p_chunkRows        = nrOfRows;
+
+  // Set data chunk header parameters
+
+  *p_chunkDataVersion = FST_VERSION;
+  *p_chunkDataFlags   = 0;
+  *p_freeBytes7       = 0;
+
+
+  // Row and column meta data
+  SinkAppend(myfile, chunkIndex, chunkIndexSize);   // file positions of column data
+
+
+  // column data
+  bool isValid;
+
+  try
+  {
+    isValid = WriteColumnData(myfile, fstTable, 0, nrOfCols, nrOfRows, compress, positionData, colTypes, colBaseTypes,
+      colAttributeTypes, colScales, versionMax);
+  }
+  catch (const std::exception &)
+  {
+    delete[] metaDataBlock;
+    delete[] chunkIndex;
+    throw;
+  }
+
+  if (!isValid)
+  {
+    delete[] metaDataBlock;
+    delete[] chunkIndex;
+    return false;
+  }
+
+  // update chunk position data
+  *p_chunkPos = *p_primChunksetIndex + CHUNK_INDEX_SIZE;
+
+  // Calculate header hashes
+  *p_chunksetHash = XXH64(&metaDataBlock[8], chunksetHeaderSize - 8, FST_HASH_SEED);
+  *p_chunkIndexHash = XXH64(&chunkIndex[8], CHUNK_INDEX_SIZE - 8, FST_HASH_SEED);
+  *p_chunkDataHash = XXH64(&chunkIndex[CHUNK_INDEX_SIZE + 8], chunkIndexSize - (CHUNK_INDEX_SIZE + 8), FST_HASH_SEED);
+
+  myfile.Write(metaDataBlock, chunksetPos, metaDataSize);  // chunkset header
+  myfile.Write(chunkIndex, *p_primChunksetIndex, chunkIndexSize);  // vertical chunkset index and positiondata
+
+  // cleanup
+  delete[] metaDataBlock;
+  delete[] chunkIndex;
+
+  return true;
+}
+
+
+/**
+ * \brief Write the columns of a chunkset as a new data chunk at the end of the file and register the chunk
+ * \param myfile stream to write to
+ * \param fstTable interface to a dataset
+ * \param colOffset column number of the first column of the chunkset
+ * \param nrOfCols number of columns in the chunkset
+ * \param compress compression factor in the range 0 - 100
+ * \param lastChunkIndex last chunk index in the chain of the chunkset, updated here. When a new chunk index is
+ * added to the chain, the new index is returned.
+ * \param lastChunkIndexPos file position of lastChunkIndex, updated when a new chunk index is added
+ * \param versionMax fstcore version required to read the written columns, raised here if needed (output)
+ * \return false if a column of unknown type was found
+ */
+inline bool AppendDataChunk(IFstSink &myfile, IFstTable &fstTable, int colOffset, int nrOfCols, int compress,
+  char* lastChunkIndex, unsigned long long &lastChunkIndexPos, unsigned int &versionMax)
+{
+  unsigned long long nrOfRows = fstTable.NrOfRows();
+
+  // Chunk data header [node E, leaf of D] [size: 24 + 8 * nrOfCols]
+
+  unsigned long long dataChunkSize = DATA_INDEX_SIZE + 8 * nrOfCols;
+  char* dataChunk = new char[dataChunkSize];
+
+  unsigned long long* p_chunkDataHash  = reinterpret_cast<unsigned long long*>(dataChunk);
+  unsigned int* p_chunkDataVersion     = reinterpret_cast<unsigned int*>(&dataChunk[8]);
+  int* p_chunkDataFlags                = reinterpret_cast<int*>(&dataChunk[12]);
+  unsigned long long* p_freeBytes7     = reinterpret_cast<unsigned long long*>(&dataChunk[16]);
+  unsigned long long* positionData     = reinterpret_cast<unsigned long long*>(&dataChunk[24]);  // column position index
+
+  *p_chunkDataVersion = FST_VERSION;
+  *p_chunkDataFlags   = 0;
+  *p_freeBytes7       = 0;
+
+  unsigned long long dataChunkPos = myfile.Size();
+  SinkAppend(myfile, dataChunk, dataChunkSize);  // reserve space
+
+  // Column types are equal to the stored types and are not updated
+  unsigned short int* colTypes = new unsigned short int[4 * nrOfCols];
+
+  bool isValid = WriteColumnData(myfile, fstTable, colOffset, nrOfCols, nrOfRows, compress, positionData, colTypes,
+    &colTypes[nrOfCols], &colTypes[2 * nrOfCols], &colTypes[3 * nrOfCols], versionMax);
+
+  delete[] colTypes;
+
+  if (!isValid)
+  {
+    delete[] dataChunk;
+    return false;
+  }
+
+  *p_chunkDataHash = XXH64(&dataChunk[8], dataChunkSize - 8, FST_HASH_SEED);
+
+  myfile.Write(dataChunk, dataChunkPos, dataChunkSize);
+  delete[] dataChunk;
+
+  // Register the new data chunk in the last chunk index
+
+  unsigned long long* p_chunkIndexHash = reinterpret_cast<unsigned long long*>(lastChunkIndex);
+  unsigned long long* p_nextChunkIndex = reinterpret_cast<unsigned long long*>(&lastChunkIndex[16]);
+  unsigned short int* p_nrOfChunkSlots = reinterpret_cast<unsigned short int*>(&lastChunkIndex[24]);
+  unsigned short int* p_nrOfChunks     = reinterpret_cast<unsigned short int*>(&lastChunkIndex[26]);
+  unsigned long long* p_chunkPos       = reinterpret_cast<unsigned long long*>(&lastChunkIndex[32]);
+  unsigned long long* p_chunkRows      = reinterpret_cast<unsigned long long*>(&lastChunkIndex[64]);
+
+  unsigned short int nrOfChunks = max(static_cast<unsigned short int>(1), *p_nrOfChunks);
+  char newChunkIndex[CHUNK_INDEX_SIZE];
+  unsigned long long newChunkIndexPos = 0;
+
+  if (nrOfChunks < *p_nrOfChunkSlots)
+  {
+    p_chunkPos[nrOfChunks]  = dataChunkPos;
+    p_chunkRows[nrOfChunks] = nrOfRows;
+    *p_nrOfChunks = nrOfChunks + 1;
+  }
+  else  // all slots are used, add a new chunk index to the chain
+  {
+    memset(newChunkIndex, 0, CHUNK_INDEX_SIZE);
+
+    unsigned long long* p_newChunkIndexHash = reinterpret_cast<unsigned long long*>(newChunkIndex);
+    unsigned int* p_newChunkIndexVersion    = reinterpret_cast<unsigned int*>(&newChunkIndex[8]);
+    unsigned short int* p_newNrOfChunkSlots = reinterpret_cast<unsigned short int*>(&newChunkIndex[24]);
+    unsigned short int* p_newNrOfChunks     = reinterpret_cast<unsigned short int*>(&newChunkIndex[26]);
+    unsigned long long* p_newChunkPos       = reinterpret_cast<unsigned long long*>(&newChunkIndex[32]);
+    unsigned long long* p_newChunkRows      = reinterpret_cast<unsigned long long*>(&newChunkIndex[64]);
+
+    *p_newChunkIndexVersion = FST_VERSION;
+    *p_newNrOfChunkSlots    = CHUNK_INDEX_SLOTS;
+    *p_newNrOfChunks        = 1;
+    *p_newChunkPos          = dataChunkPos;
+    *p_newChunkRows         = nrOfRows;
+
+    *p_newChunkIndexHash = XXH64(&newChunkIndex[8], CHUNK_INDEX_SIZE - 8, FST_HASH_SEED);
+
+    newChunkIndexPos = myfile.Size();
+    *p_nextChunkIndex = newChunkIndexPos;
+    SinkAppend(myfile, newChunkIndex, CHUNK_INDEX_SIZE);
+  }
+
+  *p_chunkIndexHash = XXH64(&lastChunkIndex[8], CHUNK_INDEX_SIZE - 8, FST_HASH_SEED);
+
+  myfile.Write(lastChunkIndex, lastChunkIndexPos, CHUNK_INDEX_SIZE);
+
+  // the new chunk index is the last index of the chain now
+  if (newChunkIndexPos != 0)
+  {
+    memcpy(lastChunkIndex, newChunkIndex, CHUNK_INDEX_SIZE);
+    lastChunkIndexPos = newChunkIndexPos;
+  }
+
+  return true;
+}
+
+
+/**
+ * \brief Raise the fstcore version that is required to read a fst file
+ *
+ * Files are marked with the lowest version that can read all of their columns, data chunks and chunksets, so files
+ * without newer formats stay readable by earlier versions of fst. These versions refuse to read a file that requires a
+ * newer version.
+ * \param myfile stream of the fst file
+ * \param tableMeta table header of the file, updated here
+ * \param versionMax fstcore version required to read the columns, data chunks and chunksets that were written
+ */
+inline void RaiseTableVersion(IFstSink &myfile, char* tableMeta, unsigned int versionMax)
+{
+  unsigned long long* p_headerHash = reinterpret_cast<unsigned long long*>(tableMeta);
+  unsigned int* p_tableVersionMax  = reinterpret_cast<unsigned int*>(&tableMeta[24]);
+
+  if (versionMax <= *p_tableVersionMax) return;
+
+  *p_tableVersionMax = versionMax;
+  *p_headerHash = XXH64(&tableMeta[8], TABLE_META_SIZE - 8, FST_HASH_SEED);
+
+  myfile.Write(tableMeta, 0, TABLE_META_SIZE);
+}
+
+
+/**
+ * \brief Write a table as a new fst file with a single chunkset
+ * \param myfile stream to write to, positioned at the start of the file
+ * \param fstTable interface to a dataset with at least one column and one row
+ * \param compress compression factor in the range 0 - 100
+ * \param keyLength number of key columns to store, the key column positions are taken from the table
+ * \return false if a column of unknown type was found
+ */
+inline bool WriteTable(IFstSink &myfile, IFstTable &fstTable, int compress, int keyLength)
+{
+  int nrOfCols = fstTable.NrOfColumns();  // number of columns in table
+
+  unsigned long long tableHeaderSize    = 44;
+  unsigned long long keyIndexHeaderSize = 0;
+
+  if (keyLength != 0)
+  {
+    keyIndexHeaderSize = 4 * (keyLength + 2);  // size of key index vector and hash
+  }
+
+  // size of fst file header
+  unsigned long long metaDataSize = tableHeaderSize + keyIndexHeaderSize;
+  char * metaDataBlock             = new char[metaDataSize];  // fst metadata
+
+
+  // Table header [node A] [size: 44]
+
+  unsigned long long* p_headerHash        = reinterpret_cast<unsigned long long*>(metaDataBlock);
+  unsigned int* p_tableVersion            = reinterpret_cast<unsigned int*>(&metaDataBlock[8]);
+  int* p_tableFlags                       = reinterpret_cast<int*>(&metaDataBlock[12]);
+  unsigned long long* p_freeBytes1        = reinterpret_cast<unsigned long long*>(&metaDataBlock[16]);
+  unsigned int* p_tableVersionMax         = reinterpret_cast<unsigned int*>(&metaDataBlock[24]);
+  int* p_nrOfCols                         = reinterpret_cast<int*>(&metaDataBlock[28]);
+  unsigned long long* primaryChunkSetLoc  = reinterpret_cast<unsigned long long*>(&metaDataBlock[32]);
+  int* p_keyLength                        = reinterpret_cast<int*>(&metaDataBlock[40]);
+
+  // Key index vector (only needed when keyLength > 0) [attached leaf of A] [size: 8 + 4 * keyLength]
+
+  unsigned long long* p_keyIndexHash      = reinterpret_cast<unsigned long long*>(&metaDataBlock[44]);
+  int* keyColPos                          = reinterpret_cast<int*>(&metaDataBlock[52]);
+
+
+  // Set table header parameters
+
+  *p_tableVersion          = FST_VERSION;
+  *p_tableFlags            = 0;
+  *p_freeBytes1            = 0;
+  *p_tableVersionMax       = FST_VERSION_BASE;  // raised after writing newer column formats
+
+  *p_nrOfCols              = nrOfCols;
+  *primaryChunkSetLoc      = 52 + 4 * keyLength;
+  *p_keyLength             = keyLength;
+
+  *p_headerHash = XXH64(&metaDataBlock[8], tableHeaderSize - 8, FST_HASH_SEED);
+
+  // Set key index if present
+
+  if (keyLength != 0)
+  {
+    fstTable.GetKeyColumns(keyColPos);
+    *p_keyIndexHash = XXH64(&metaDataBlock[tableHeaderSize + 8], keyIndexHeaderSize - 8, FST_HASH_SEED);
+  }
+
+  // Write table meta information
+  SinkAppend(myfile, metaDataBlock, metaDataSize);  // table meta data
+
+  // Primary chunkset with column names and data
+  unsigned int versionMax = FST_VERSION_BASE;
+  bool isValid;
+
+  try
+  {
+    isValid = WriteChunkset(myfile, fstTable, compress, versionMax);
+  }
+  catch (const std::exception &)
+  {
+    delete[] metaDataBlock;
+    throw;
+  }
+
+  RaiseTableVersion(myfile, metaDataBlock, versionMax);
+  delete[] metaDataBlock;
+
+  return isValid;
+}
+
+
+// Chunksets of an existing fst file together with the information needed to append data chunks to them
+struct AppendState
+{
+  char tableMeta[TABLE_META_SIZE];          // table header
+  vector<ChunksetInfo> chunksets;           // location and header of each chunkset
+  vector<unsigned short int> colInfo;       // attribute types, types, base types and scales of all columns
+  FilterStringColumn colNames;              // names of all columns
+  vector<FilterStringColumn> levels;        // levels of the factor columns (empty for other columns)
+  vector<char> lastChunkIndexes;            // last chunk index in the chain of each chunkset
+  vector<unsigned long long> lastChunkPos;  // file position of the last chunk index of each chunkset
+};
+
+
+/**
+ * \brief Read the chunkset headers, column names, factor levels and last chunk indexes of a fst file without keys
+ * \param myfile source of the fst file
+ * \param state state for appending to the file (output)
+ * \return nullptr on success, or the error message describing the damaged part of the file
+ */
+inline const char* ReadAppendState(IFstSource &myfile, AppendState &state)
+{
+  if (!myfile.Read(state.tableMeta, 0, TABLE_META_SIZE))
+  {
+    return FSTERROR_DAMAGED_HEADER;
+  }
+
+  // Headers of all chunksets, no key index is present
+  if (!ReadChunksetHeaders(myfile, TABLE_META_SIZE, state.chunksets, state.colInfo))
+  {
+    return FSTERROR_DAMAGED_HEADER;
+  }
+
+  int nrOfCols = state.colInfo.size() / 4;
+  unsigned short int* colTypes = &state.colInfo[nrOfCols];
+
+  ReadColumnNames(myfile, &state.colNames, state.chunksets, nrOfCols);
+
+  // Find the last chunk index of each chunkset
+  unsigned int nrOfChunksets = state.chunksets.size();
+  state.lastChunkIndexes.resize(CHUNK_INDEX_SIZE * nrOfChunksets);
+  state.lastChunkPos.resize(nrOfChunksets);
+  state.levels.resize(nrOfCols);
+
+  for (unsigned int chunksetNr = 0; chunksetNr < nrOfChunksets; ++chunksetNr)
+  {
+    ChunksetInfo &chunkset = state.chunksets[chunksetNr];
+    vector<unsigned long long> chunkPos;
+    vector<unsigned long long> chunkRows;
+
+    bool isValid = ReadChunkIndexChain(myfile, chunkset.chunkIndexPos, chunkPos, chunkRows,
+      &state.lastChunkIndexes[CHUNK_INDEX_SIZE * chunksetNr], state.lastChunkPos[chunksetNr]);
+
+    // Factor codes are only valid for identical levels, the levels of the first data chunk are used
+    vector<unsigned long long> positionData(chunkset.nrOfCols);
+    isValid = isValid && ReadDataChunkHeader(myfile, chunkPos[0], chunkset.nrOfCols, positionData.data());
+
+    if (!isValid) return FSTERROR_DAMAGED_CHUNKINDEX;
+
+    for (int chunksetCol = 0; chunksetCol < chunkset.nrOfCols; ++chunksetCol)
+    {
+      int colNr = chunkset.colOffset + chunksetCol;
+
+      if (colTypes[colNr] != 7) continue;
+
+      fdsReadFactorLevels_v7(myfile, &state.levels[colNr], positionData[chunksetCol]);
+    }
+  }
+
+  return nullptr;
+}
+
+
+/**
+ * \brief Check if the columns of a table can be appended to the columns of a fst file
+ * \param fstTable table to append
+ * \param state state for appending to the fst file
+ * \return nullptr if the table can be appended, or the error message describing the difference
+ */
+inline const char* CheckAppendTable(IFstTable &fstTable, AppendState &state)
+{
+  int nrOfCols = state.colInfo.size() / 4;
+
+  if (static_cast<int>(fstTable.NrOfColumns()) != nrOfCols)
+  {
+    return FSTERROR_INCORRECT_COL_COUNT;
+  }
+
+  unsigned short int* colAttributeTypes = &state.colInfo[0];
+  unsigned short int* colTypes          = &state.colInfo[nrOfCols];
+  unsigned short int* colScales         = &state.colInfo[3 * nrOfCols];
+
+  // Column names and types of the new data should be identical to the stored columns
+  IStringWriter* colNameWriter = fstTable.GetColNameWriter();
+  bool isEqual = EqualStrings(colNameWriter, &state.colNames, 0, nrOfCols);
+  delete colNameWriter;
+
+  for (int colNr = 0; colNr < nrOfCols && isEqual; ++colNr)
+  {
+    FstColumnAttribute colAttribute;
+    std::string annotation = "";
+    short int scale = 0;
+
+    FstColumnType colType = fstTable.ColumnType(colNr, colAttribute, scale, annotation);
+
+    isEqual = (colTypes[colNr] == ColumnTypeVersion(colType)) &&
+      (colAttributeTypes[colNr] == static_cast<unsigned short int>(colAttribute)) &&
+      (colScales[colNr] == static_cast<unsigned short int>(scale));
+  }
+
+  if (!isEqual)
+  {
+    return FSTERROR_APPEND_COLUMNS;
+  }
+
+  // Factor codes are only valid for identical levels
+  for (int colNr = 0; colNr < nrOfCols && isEqual; ++colNr)
+  {
+    if (colTypes[colNr] != 7) continue;
+
+    FilterStringColumn &levels = state.levels[colNr];
+
+    IStringWriter* levelWriter = fstTable.GetLevelWriter(colNr);
+    isEqual = EqualStrings(levelWriter, &levels, 0, levels.Length());
+    delete levelWriter;
+  }
+
+  if (!isEqual)
+  {
+    return FSTERROR_APPEND_LEVELS;
+  }
+
+  return nullptr;
+}
+
+
+/**
+ * \brief Append a table as a new data chunk to each chunkset
+ *
+ * The chunk indexes and the required fstcore version are updated in the file, the row counts of the chunkset headers
+ * are only updated in the state and should be written with WriteChunksetHeaders().
+ * \param myfile stream of the fst file, opened for in-place updates
+ * \param fstTable table to append, checked with CheckAppendTable()
+ * \param compress compression factor in the range 0 - 100
+ * \param state state for appending to the file, updated here
+ * \return false if a column of unknown type was found
+ */
+inline bool AppendTableChunk(IFstSink &myfile, IFstTable &fstTable, int compress, AppendState &state)
+{
+  // earlier versions only read the first data chunk of a chunkset
+  unsigned int versionMax = FST_VERSION_CHUNKS;
+
+  for (unsigned int chunksetNr = 0; chunksetNr < state.chunksets.size(); ++chunksetNr)
+  {
+    ChunksetInfo &chunkset = state.chunksets[chunksetNr];
+
+    if (!AppendDataChunk(myfile, fstTable, chunkset.colOffset, chunkset.nrOfCols, compress,
+      &state.lastChunkIndexes[CHUNK_INDEX_SIZE * chunksetNr], state.lastChunkPos[chunksetNr], versionMax))
+    {
+      return false;
+    }
+
+    // Update total number of rows in chunkset header
+    char* header = chunkset.header.data();
+    unsigned long long* p_chunksetHash = reinterpret_cast<unsigned long long*>(header);
+    unsigned long long* p_nrOfRows     = reinterpret_cast<unsigned long long*>(&header[64]);
+
+    *p_nrOfRows += fstTable.NrOfRows();
+    *p_chunksetHash = XXH64(&header[8], chunkset.header.size() - 8, FST_HASH_SEED);
+  }
+
+  RaiseTableVersion(myfile, state.tableMeta, versionMax);
+
+  return true;
+}
+
+
+// Write the (updated) chunkset headers of an append state to the fst file
+inline void WriteChunksetHeaders(IFstSink &myfile, AppendState &state)
+{
+  for (unsigned int chunksetNr = 0; chunksetNr < state.chunksets.size(); ++chunksetNr)
+  {
+    ChunksetInfo &chunkset = state.chunksets[chunksetNr];
+
+    myfile.Write(chunkset.header.data(), chunkset.chunksetPos, chunkset.header.size());
+  }
+}
+
+
+/**
+ * \brief Write a dataset to a fst file
+ * \param fstTable interface to a dataset
+ * \param compress compression factor in the range 0 - 100
+ */
+void FstStore::fstWrite(IFstTable &fstTable, int compress) const
+{
+  if (fstTable.NrOfColumns() == 0)
+  {
+    throw(runtime_error("Your dataset needs at least one column."));
+  }
+
+  if (fstTable.NrOfRows() == 0)
+  {
+    throw(runtime_error(FSTERROR_NO_DATA));
+  }
+
+
+  // Create (or truncate) the file
+  FstFileSink myfile;
+
+  if (!myfile.Create(fstFile))
+  {
+    throw(runtime_error(FSTERROR_ERROR_OPEN_WRITE));
+  }
+
+  // Table header, key index and primary chunkset with column names and data
+  if (!WriteTable(myfile, fstTable, compress, fstTable.NrOfKeys()))
+  {
+    myfile.Close();
+    throw(runtime_error("Unknown type found in column."));
+  }
+
+  // Check file status only here for performance.
+  // Any error that was generated earlier will result in a fail here.
+  if (!myfile.Close())
+  {
+	  throw(runtime_error("There was an error during the write operation, fst file might be corrupted. Please check available disk space and access rights."));
+  }
+}
+
+
+void FstStore::fstWrite(IFstTable &fstTable, int compress, IFstSink &myfile) const
+{
+  if (fstTable.NrOfColumns() == 0)
+  {
+    throw(runtime_error("Your dataset needs at least one column."));
+  }
+
+  if (fstTable.NrOfRows() == 0)
+  {
+    throw(runtime_error(FSTERROR_NO_DATA));
+  }
+
+  // Table header, key index and primary chunkset with column names and data
+  if (!WriteTable(myfile, fstTable, compress, fstTable.NrOfKeys()))
+  {
+    throw(runtime_error("Unknown type found in column."));
+  }
+
+  if (myfile.Fail())
+  {
+    throw(runtime_error("There was an error during the write operation, the data could not be written to the sink."));
+  }
+}
+
+
+void FstStore::fstAppend(IFstTable &fstTable, int compress) const
+{
+  // memory mapped fst file, with a stream reader as fallback
+  FstFileSource myfile;
+
+  // Appending to a non-existing file creates a new file
+  if (!myfile.Open(fstFile))
+  {
+    fstWrite(fstTable, compress);
+    return;
+  }
+
+  int keyLength, nrOfColsFirstChunk;
+  ReadHeader(myfile, keyLength, nrOfColsFirstChunk);
+
+  if (keyLength != 0)
+  {
+    myfile.Close();
+    throw(runtime_error(FSTERROR_APPEND_KEYS));
+  }
+
+  if (fstTable.NrOfRows() == 0)
+  {
+    myfile.Close();
+    throw(runtime_error(FSTERROR_NO_DATA));
+  }
+
+  // Chunksets, column names, factor levels and chunk indexes of the stored table
+  AppendState state;
+  const char* errorMessage = ReadAppendState(myfile, state);
+
+  myfile.Close();
+
+  if (errorMessage == nullptr)
+  {
+    errorMessage = CheckAppendTable(fstTable, state);
+  }
+
+  if (errorMessage != nullptr)
+  {
+    throw(runtime_error(errorMessage));
+  }
+
+
+  // Open file for in-place updates
+  FstFileSink outfile;
+
+  if (!outfile.Open(fstFile))
+  {
+    throw(runtime_error(FSTERROR_ERROR_OPEN_WRITE));
+  }
+
+  // Add a data chunk to each chunkset
+  if (!AppendTableChunk(outfile, fstTable, compress, state))
+  {
+    outfile.Close();
+    throw(runtime_error("Unknown type found in column."));
+  }
+
+  WriteChunksetHeaders(outfile, state);
+
+  // Check file status only here for performance.
+  // Any error that was generated earlier will result in a fail here.
+  if (!outfile.Close())
+  {
+    throw(runtime_error("There was an error during the write operation, fst file might be corrupted. Please check available disk space and access rights."));
+  }
+}
+
+
+// State of a fst file that is written in chunks
+struct FstWriteState
+{
+  FstFileSink myfile;        // the fst file, kept open until the stream is closed
+  int compress;              // compression factor in the range 0 - 100
+  bool hasData;              // true if the first chunk has been written
+  AppendState appendState;   // chunkset header and chunk index of the file, valid when hasData is true
+};
+
+
+/**
+ * \brief Write the final chunkset headers of a streamed fst file and close the file
+ * \param state state of the streamed file
+ * \param fstFile path of the fst file, an empty file is removed
+ * \return false if a write error occurred
+ */
+inline bool FinishStream(FstWriteState* state, const std::string &fstFile)
+{
+  if (state->hasData)
+  {
+    WriteChunksetHeaders(state->myfile, state->appendState);
+  }
+
+  bool isValid = state->myfile.Close();
+
+  // a file without rows is not a valid fst file
+  if (!state->hasData)
+  {
+    std::remove(fstFile.c_str());
+  }
+
+  return isValid;
+}
+
+
+FstStore::~FstStore()
+{
+  // a streamed file that was not closed is completed here
+  if (writeState != nullptr)
+  {
+    FinishStream(writeState, fstFile);
+    delete writeState;
+  }
+
+  delete fileState;
+  delete blockReader;
+  delete[] metaDataBlock;
+
+  if (ownsSource) delete source;
+}
+
+
+void FstStore::fstStreamOpen(int compress)
+{
+  if (writeState != nullptr)
+  {
+    throw(runtime_error("The fst file is already opened for writing."));
+  }
+
+  FstWriteState* state = new FstWriteState();
+  state->compress = compress;
+  state->hasData = false;
+
+  if (!state->myfile.Create(fstFile))
+  {
+    delete state;
+    throw(runtime_error(FSTERROR_ERROR_OPEN_WRITE));
+  }
+
+  writeState = state;
+}
+
+
+void FstStore::fstStreamChunk(IFstTable &fstTable)
+{
+  if (writeState == nullptr)
+  {
+    throw(runtime_error("The fst file is not opened for writing."));
+  }
+
+  // empty chunks don't change the file
+  if (fstTable.NrOfRows() == 0) return;
+
+  FstFileSink &myfile = writeState->myfile;
+
+  // Chunks are appended as data chunks to the chunkset of the first chunk
+  if (writeState->hasData)
+  {
+    const char* errorMessage = CheckAppendTable(fstTable, writeState->appendState);
+
+    if (errorMessage != nullptr)
+    {
+      throw(runtime_error(errorMessage));
+    }
+
+    if (!AppendTableChunk(myfile, fstTable, writeState->compress, writeState->appendState))
+    {
+      throw(runtime_error("Unknown type found in column."));
+    }
+  }
+  else
+  {
+    if (fstTable.NrOfColumns() == 0)
+    {
+      throw(runtime_error("Your dataset needs at least one column."));
+    }
+
+    // The file is written without key columns, the key of a single chunk is not the key of the table
+    if (!WriteTable(myfile, fstTable, writeState->compress, 0))
+    {
+      throw(runtime_error("Unknown type found in column."));
+    }
+
+    // Chunkset header, column names and levels are read back once, for checking and appending the next chunks
+    FstFileSource source;
+    const char* errorMessage = FSTERROR_ERROR_OPEN_READ;
+
+    if (myfile.Flush() && source.Open(fstFile))
+    {
+      errorMessage = ReadAppendState(source, writeState->appendState);
+    }
+
+    source.Close();
+
+    if (errorMessage != nullptr)
+    {
+      throw(runtime_error(errorMessage));
+    }
+
+    writeState->hasData = true;
+  }
+
+  // Check file status only here for performance.
+  // Any error that was generated earlier will result in a fail here.
+  if (myfile.Fail())
+  {
+    throw(runtime_error("There was an error during the write operation, fst file might be corrupted. Please check available disk space and access rights."));
+  }
+}
+
+
+void FstStore::fstStreamClose()
+{
+  if (writeState == nullptr) return;
+
+  FstWriteState* state = writeState;
+  writeState = nullptr;
+
+  bool hasData = state->hasData;
+  bool isValid = FinishStream(state, fstFile);
+
+  delete state;
+
+  if (!hasData)
+  {
+    throw(runtime_error(FSTERROR_NO_DATA));
+  }
+
+  if (!isValid)
+  {
+    throw(runtime_error("There was an error during the write operation, fst file might be corrupted. Please check available disk space and access rights."));
+  }
+}
+
+
+void FstStore::fstAppendColumns(IFstTable &fstTable, int compress) const
+{
+  if (fstTable.NrOfColumns() == 0)
+  {
+    throw(runtime_error("Your dataset needs at least one column."));
+  }
+
+  // memory mapped fst file, with a stream reader as fallback
+  FstFileSource myfile;
+
+  if (!myfile.Open(fstFile))
+  {
+    throw(runtime_error(FSTERROR_ERROR_OPENING_FILE));
+  }
+
+  int keyLength, nrOfColsFirstChunk;
+  ReadHeader(myfile, keyLength, nrOfColsFirstChunk);
+
+  unsigned long long keyIndexHeaderSize = 0;
+
+  if (keyLength != 0)
+  {
+    keyIndexHeaderSize = 4 * (keyLength + 2);  // size of key index vector and hash
+  }
+
+  // Table header and headers of all chunksets
+  char tableMeta[TABLE_META_SIZE];
+  vector<ChunksetInfo> chunksets;
+  vector<unsigned short int> colInfo;
+
+  bool isValid = myfile.Read(tableMeta, 0, TABLE_META_SIZE) &&
+    ReadChunksetHeaders(myfile, TABLE_META_SIZE + keyIndexHeaderSize, chunksets, colInfo);
+  myfile.Close();
+
+  if (!isValid)
+  {
+    throw(runtime_error(FSTERROR_DAMAGED_HEADER));
+  }
+
+  // New columns should have the same length as the stored columns
+  ChunksetInfo &lastChunkset = chunksets.back();
+  char* header = lastChunkset.header.data();
+
+  unsigned long long* p_chunksetHash     = reinterpret_cast<unsigned long long*>(header);
+  unsigned long long* p_nextHorzChunkSet = reinterpret_cast<unsigned long long*>(&header[40]);
+  unsigned long long* p_nrOfRows         = reinterpret_cast<unsigned long long*>(&header[64]);
+
+  if (fstTable.NrOfRows() != *p_nrOfRows)
+  {
+    throw(runtime_error(FSTERROR_APPEND_ROWS));
+  }
+
+
+  // Open file for in-place updates
+  FstFileSink outfile;
+
+  if (!outfile.Open(fstFile))
+  {
+    throw(runtime_error(FSTERROR_ERROR_OPEN_WRITE));
+  }
+
+  unsigned long long chunksetPos = outfile.Size();
+
+  // Horizontal chunkset with column names and data, earlier versions only read the first chunkset
+  unsigned int versionMax = FST_VERSION_CHUNKSETS;
+
+  if (!WriteChunkset(outfile, fstTable, compress, versionMax))
+  {
+    outfile.Close();
+    throw(runtime_error("Unknown type found in column."));
+  }
+
+  RaiseTableVersion(outfile, tableMeta, versionMax);
+
+  // Link the new chunkset to the last chunkset in the chain
+  *p_nextHorzChunkSet = chunksetPos;
+  *p_chunksetHash = XXH64(&header[8], lastChunkset.header.size() - 8, FST_HASH_SEED);
+
+  outfile.Write(header, lastChunkset.chunksetPos, lastChunkset.header.size());
+
+  // Check file status only here for performance.
+  // Any error that was generated earlier will result in a fail here.
+  if (!outfile.Close())
+  {
+    throw(runtime_error("There was an error during the write operation, fst file might be corrupted. Please check available disk space and access rights."));
+  }
+}
+
+
+void FstStore::fstMeta(IColumnFactory* columnFactory)
+{
+  FstFileState* state = AcquireFileState(fstFile, source, fileState);
+
+  version   = state->version;
+  keyLength = state->keyLength;
+  colInfo   = state->colInfo;
+  nrOfCols  = colInfo.size() / 4;
+  nrOfRows  = *reinterpret_cast<unsigned long long*>(&state->chunksets[0].header[64]);
+
+  colAttributeTypes = &colInfo[0];
+  colTypes          = &colInfo[nrOfCols];
+  colBaseTypes      = &colInfo[2 * nrOfCols];
+  colScales         = &colInfo[3 * nrOfCols];
+
+  // Key index
+  delete[] metaDataBlock;
+  metaDataBlock = nullptr;
+  keyColPos = nullptr;
+
+  if (keyLength != 0)
+  {
+    metaDataBlock = new char[4 * keyLength];
+    memcpy(metaDataBlock, state->keyColPos.data(), 4 * keyLength);
+    keyColPos = reinterpret_cast<int*>(metaDataBlock);
+  }
+
+  // Column names are read from the file, so the string column receives their encoding
+  delete blockReader;
+  blockReader = columnFactory->CreateStringColumn(nrOfCols, FstColumnAttribute::NONE);
+
+  try
+  {
+    ReadColumnNames(*state->source, blockReader, state->chunksets, nrOfCols);
+  }
+  catch (const std::exception &)
+  {
+    ReleaseFileState(state, fileState);
+    throw;
+  }
+
+  ReleaseFileState(state, fileState);
+}
+
+
+// Consecutive rows of the selected row range that are read from the projected columns
+struct RowRun
+{
+  unsigned long long startRow;      // first row of the run (relative to the selected row range)
+  unsigned long long length;        // number of rows in the run
+  unsigned long long resultOffset;  // position of the first selected row of the run in the result vectors (number of
+                                    // the first selected row for scattered row index reads)
+  bool allSelected;                 // true if all rows of the run are selected
+};
+
+
+/**
+ * \brief Size of a single element of a column in memory
+ * \param colType fst column type
+ * \return element size in bytes, 0 for character columns
+ */
+inline unsigned int ColumnElementSize(unsigned short int colType)
+{
+  switch (colType)
+  {
+    case 6:
+      return 0;
+
+    case 9:
+    case 11:
+      return 8;
+
+    case 12:
+      return 1;
+
+    default:  // factor, integer and logical columns
+      return 4;
+  }
+}
+
+
+/**
+ * \brief Number of rows in a compressed data block of a column
+ * \param colType fst column type
+ */
+inline unsigned long long ColumnBlockRows(unsigned short int colType)
+{
+  switch (colType)
+  {
+    case 6:
+      return BLOCKSIZE_CHAR;
+
+    case 9:
+      return BLOCKSIZE_REAL;
+
+    case 11:
+      return BLOCKSIZE_INT64;
+
+    case 12:
+      return BLOCKSIZE_BYTE;
+
+    default:  // factor, integer and logical columns
+      return BLOCKSIZE_INT;
+  }
+}
+
+
+/**
+ * \brief Read consecutive rows of a column, possibly spanning multiple data chunks
+ * \param myfile source of the fst file
+ * \param colType type of the column
+ * \param chunkRanges data chunk ranges of the selected row range in the column's chunkset
+ * \param positions column positions for each chunk range
+ * \param chunksetCols number of columns in the column's chunkset
+ * \param chunksetCol column number in the chunkset
+ * \param startRow first row to read (relative to the selected row range)
+ * \param length number of rows to read
+ * \param outVec result vector for non-character columns, factor levels are not read
+ * \param stringColumn result vector for character columns
+ * \param vecOffset position in the result vector of the first row
+ * \param annotation annotation of the column in the first data chunk (output)
+ */
+inline void ReadColumnRows(IFstSource &myfile, unsigned short int colType, vector<ChunkRange> &chunkRanges,
+  unsigned long long* positions, int chunksetCols, int chunksetCol, unsigned long long startRow, unsigned long long length,
+  char* outVec, IStringColumn* stringColumn, unsigned long long vecOffset, std::string &annotation)
+{
+  unsigned long long endRow = startRow + length;
+  bool isFirst = true;
+
+  for (unsigned int rangeNr = 0; rangeNr < chunkRanges.size(); ++rangeNr)
+  {
+    ChunkRange &range = chunkRanges[rangeNr];
+
+    if (range.vecOffset + range.length <= startRow || range.vecOffset >= endRow) continue;
+
+    unsigned long long rangeStart = max(startRow, range.vecOffset);
+    unsigned long long rangeLength = min(endRow, range.vecOffset + range.length) - rangeStart;
+    unsigned long long chunkStartRow = range.startRow + rangeStart - range.vecOffset;
+    unsigned long long offset = vecOffset + rangeStart - startRow;
+    unsigned long long blockPos = positions[rangeNr * chunksetCols + chunksetCol];
+    std::string chunkAnnotation = "";
+
+    switch (colType)
+    {
+      case 6:
+        fdsReadCharVec_v6(myfile, stringColumn, blockPos, chunkStartRow, rangeLength, range.chunkRows, offset);
+        break;
+
+      case 7:
+        fdsReadFactorVec_v7(myfile, nullptr, &reinterpret_cast<int*>(outVec)[offset], blockPos, chunkStartRow, rangeLength,
+          range.chunkRows);
+        break;
+
+      case 8:
+        fdsReadIntVec_v8(myfile, &reinterpret_cast<int*>(outVec)[offset], blockPos, chunkStartRow, rangeLength, range.chunkRows,
+          chunkAnnotation);
+        break;
+
+      case 9:
+        fdsReadRealVec_v9(myfile, &reinterpret_cast<double*>(outVec)[offset], blockPos, chunkStartRow, rangeLength,
+          range.chunkRows, chunkAnnotation);
+        break;
+
+      case 10:
+        fdsReadLogicalVec_v10(myfile, &reinterpret_cast<int*>(outVec)[offset], blockPos, chunkStartRow, rangeLength,
+          range.chunkRows);
+        break;
+
+      case 11:
+        fdsReadInt64Vec_v11(myfile, &reinterpret_cast<long long*>(outVec)[offset], blockPos, chunkStartRow, rangeLength,
+          range.chunkRows);
+        break;
+
+      default:  // 12
+        fdsReadByteVec_v12(myfile, &outVec[offset], blockPos, chunkStartRow, rangeLength, range.chunkRows);
+        break;
+    }
+
+    if (isFirst) annotation = chunkAnnotation;
+    isFirst = false;
+  }
+}
+
+
+/**
+ * \brief Read the rows of a single row run of a non-character column
+ * \param result result vector with room for all selected rows
+ * \param rowRun run of rows that contains the selected rows
+ * \param selection bitmap with the selected rows, only used if the run is not fully selected
+ * \param scatter result positions of the selected rows, nullptr if the selected rows are stored consecutively
+ * \param annotation annotation of the column in the first data chunk read (output)
+ */
+template<class T>
+inline void ReadRunRows(IFstSource &myfile, unsigned short int colType, vector<ChunkRange> &chunkRanges,
+  unsigned long long* positions, int chunksetCols, int chunksetCol, const RowRun &rowRun,
+  const unsigned long long* selection, const RowScatter* scatter, T* result, std::string &annotation)
+{
+  // Read directly into the result vector
+  if (rowRun.allSelected && scatter == nullptr)
+  {
+    ReadColumnRows(myfile, colType, chunkRanges, positions, chunksetCols, chunksetCol, rowRun.startRow, rowRun.length,
+      reinterpret_cast<char*>(result), nullptr, rowRun.resultOffset, annotation);
+
+    return;
+  }
+
+  vector<T> buffer(rowRun.length);
+
+  ReadColumnRows(myfile, colType, chunkRanges, positions, chunksetCols, chunksetCol, rowRun.startRow, rowRun.length,
+    reinterpret_cast<char*>(buffer.data()), nullptr, 0, annotation);
+
+  // Gather selected rows
+  if (scatter == nullptr)
+  {
+    T* resultP = &result[rowRun.resultOffset];
+
+    for (unsigned long long row = 0; row < rowRun.length; ++row)
+    {
+      unsigned long long bitNr = rowRun.startRow + row;
+      if (((selection[bitNr / 64] >> (bitNr % 64)) & 1) != 0) *resultP++ = buffer[row];
+    }
+
+    return;
+  }
+
+  // Copy each selected row to all of its result positions
+  const unsigned long long* offsets = scatter->offsets.data();
+  const unsigned long long* resultPos = scatter->positions.data();
+  unsigned long long selectedNr = rowRun.resultOffset;
+
+  for (unsigned long long row = 0; row < rowRun.length; ++row)
+  {
+    unsigned long long bitNr = rowRun.startRow + row;
+    if (((selection[bitNr / 64] >> (bitNr % 64)) & 1) == 0) continue;
+
+    for (unsigned long long posNr = offsets[selectedNr]; posNr < offsets[selectedNr + 1]; ++posNr)
+    {
+      result[resultPos[posNr]] = buffer[row];
+    }
+
+    ++selectedNr;
+  }
+}
+
+
+// A selected column of the result table, created on the main thread before the column data is read
+struct ResultColumn
+{
+  unsigned short int colType;
+  int chunksetNr;
+  int chunksetCol;
+  char* data;              // result vector of non-character columns
+  IStringColumn* stringColumn;
+  IIntegerColumn* integerColumn;
+  IDoubleColumn* doubleColumn;
+  ILogicalColumn* logicalColumn;
+  IFactorColumn* factorColumn;
+  IInt64Column* int64Column;
+  IByteColumn* byteColumn;
+  std::string annotation;  // annotation of the first data chunk read
+};
+
+
+/**
+ * \brief Split the row runs into read tasks of at most READ_TASK_SIZE rows
+ *
+ * Fully selected runs are split on multiples of READ_TASK_SIZE rows (counted from the start of the table) so that the
+ * tasks start at block boundaries. Partially selected runs are at most FILTER_BATCH_SIZE rows and are not split.
+ * \param rowRuns runs of rows that contain the selected rows
+ * \param firstRow first row of the selected row range
+ * \param taskRuns row runs of the read tasks (output)
+ */
+inline void SplitRowRuns(vector<RowRun> &rowRuns, unsigned long long firstRow, vector<RowRun> &taskRuns)
+{
+  for (unsigned int runNr = 0; runNr < rowRuns.size(); ++runNr)
+  {
+    RowRun &rowRun = rowRuns[runNr];
+
+    if (!rowRun.allSelected)
+    {
+      taskRuns.push_back(rowRun);
+      continue;
+    }
+
+    unsigned long long runEnd = rowRun.startRow + rowRun.length;
+    RowRun taskRun = rowRun;
+
+    while (taskRun.startRow < runEnd)
+    {
+      unsigned long long tableRow = firstRow + taskRun.startRow;
+      unsigned long long taskEnd = min(runEnd, taskRun.startRow + READ_TASK_SIZE - tableRow % READ_TASK_SIZE);
+
+      taskRun.length = taskEnd - taskRun.startRow;
+      taskRuns.push_back(taskRun);
+
+      taskRun.resultOffset += taskRun.length;
+      taskRun.startRow = taskEnd;
+    }
+  }
+}
+
+
+/**
+ * \brief Read a single row run of a non-character column
+ * \param resultColumn column to read into
+ * \param rowRun run of rows that contains the selected rows
+ * \param selection bitmap with the selected rows, only used if the run is not fully selected
+ * \param scatter result positions of the selected rows, nullptr if the selected rows are stored consecutively
+ * \param annotation annotation of the column in the first data chunk read (output)
+ */
+inline void ReadColumnTask(IFstSource &myfile, ResultColumn &resultColumn, vector<ChunkRange> &chunkRanges,
+  unsigned long long* positions, int chunksetCols, const RowRun &rowRun, const unsigned long long* selection,
+  const RowScatter* scatter, std::string &annotation)
+{
+  unsigned short int colType = resultColumn.colType;
+  int chunksetCol = resultColumn.chunksetCol;
+
+  switch (colType)
+  {
+    case 9:
+      ReadRunRows(myfile, colType, chunkRanges, positions, chunksetCols, chunksetCol, rowRun, selection, scatter,
+        reinterpret_cast<double*>(resultColumn.data), annotation);
+      break;
+
+    case 11:
+      ReadRunRows(myfile, colType, chunkRanges, positions, chunksetCols, chunksetCol, rowRun, selection, scatter,
+        reinterpret_cast<long long*>(resultColumn.data), annotation);
+      break;
+
+    case 12:
+      ReadRunRows(myfile, colType, chunkRanges, positions, chunksetCols, chunksetCol, rowRun, selection, scatter,
+        resultColumn.data, annotation);
+      break;
+
+    default:  // factor, integer and logical columns
+      ReadRunRows(myfile, colType, chunkRanges, positions, chunksetCols, chunksetCol, rowRun, selection, scatter,
+        reinterpret_cast<int*>(resultColumn.data), annotation);
+      break;
+  }
+}
+
+
+/**
+ * \brief Delete the column objects of the result table that were not yet handed to the table
+ */
+inline void DeleteResultColumns(vector<ResultColumn> &resultColumns)
+{
+  for (unsigned int colSel = 0; colSel < resultColumns.size(); ++colSel)
+  {
+    ResultColumn &resultColumn = resultColumns[colSel];
+
+    delete resultColumn.stringColumn;
+    delete resultColumn.integerColumn;
+    delete resultColumn.doubleColumn;
+    delete resultColumn.logicalColumn;
+    delete resultColumn.factorColumn;
+    delete resultColumn.int64Column;
+    delete resultColumn.byteColumn;
+
+    resultColumn.stringColumn = nullptr;
+    resultColumn.integerColumn = nullptr;
+    resultColumn.doubleColumn = nullptr;
+    resultColumn.logicalColumn = nullptr;
+    resultColumn.factorColumn = nullptr;
+    resultColumn.int64Column = nullptr;
+    resultColumn.byteColumn = nullptr;
+  }
+}
+
+
+/**
+ * \brief Read the selected rows of a character column
+ * \param scatter result positions of the selected rows, nullptr if the selected rows are stored consecutively
+ * \param stringColumn result vector with room for all selected rows
+ */
+inline void ReadSelectedStrings(IFstSource &myfile, vector<ChunkRange> &chunkRanges, unsigned long long* positions,
+  int chunksetCols, int chunksetCol, vector<RowRun> &rowRuns, const unsigned long long* selection,
+  const RowScatter* scatter, IStringColumn* stringColumn)
+{
+  std::string annotation;
+
+  for (unsigned int runNr = 0; runNr < rowRuns.size(); ++runNr)
+  {
+    RowRun &rowRun = rowRuns[runNr];
+
+    // Each selected string is copied to all of its result positions
+    if (scatter != nullptr)
+    {
+      ScatterStringColumn scatterColumn(stringColumn, selection, rowRun.startRow, rowRun.resultOffset, scatter);
+
+      ReadColumnRows(myfile, 6, chunkRanges, positions, chunksetCols, chunksetCol, rowRun.startRow, rowRun.length,
+        nullptr, &scatterColumn, 0, annotation);
+
+      continue;
+    }
+
+    if (rowRun.allSelected)
+    {
+      ReadColumnRows(myfile, 6, chunkRanges, positions, chunksetCols, chunksetCol, rowRun.startRow, rowRun.length,
+        nullptr, stringColumn, rowRun.resultOffset, annotation);
+
+      continue;
+    }
+
+    // Only the selected strings of each block are copied to the result
+    SelectionStringColumn selectionColumn(stringColumn, selection, rowRun.startRow, rowRun.resultOffset);
+
+    ReadColumnRows(myfile, 6, chunkRanges, positions, chunksetCols, chunksetCol, rowRun.startRow, rowRun.length,
+      nullptr, &selectionColumn, 0, annotation);
+  }
+}
+
+
+/**
+ * \brief Plan the byte ranges that ReadColumnRows() reads for consecutive rows of a column
+ * \param planner planner on the source of the fst file
+ * \param colType type of the column
+ * \param chunkRanges data chunk ranges of the selected row range in the column's chunkset
+ * \param positions column positions for each chunk range
+ * \param chunksetCols number of columns in the column's chunkset
+ * \param chunksetCol column number in the chunkset
+ * \param startRow first row to read (relative to the selected row range)
+ * \param length number of rows to read
+ */
+inline void PlanColumnRows(FstReadPlanner &planner, unsigned short int colType, vector<ChunkRange> &chunkRanges,
+  unsigned long long* positions, int chunksetCols, int chunksetCol, unsigned long long startRow, unsigned long long length)
+{
+  unsigned long long endRow = startRow + length;
+
+  for (unsigned int rangeNr = 0; rangeNr < chunkRanges.size(); ++rangeNr)
+  {
+    ChunkRange &range = chunkRanges[rangeNr];
+
+    if (range.vecOffset + range.length <= startRow || range.vecOffset >= endRow) continue;
+
+    unsigned long long rangeStart = max(startRow, range.vecOffset);
+    unsigned long long rangeLength = min(endRow, range.vecOffset + range.length) - rangeStart;
+    unsigned long long chunkStartRow = range.startRow + rangeStart - range.vecOffset;
+    unsigned long long blockPos = positions[rangeNr * chunksetCols + chunksetCol];
+
+    // ranges that still have to be fetched are requested from the planner
+    switch (colType)
+    {
+      case 6:
+        fdsPlanCharVec_v6(planner, blockPos, chunkStartRow, rangeLength, range.chunkRows);
+        break;
+
+      case 7:
+        fdsPlanFactorVec_v7(planner, blockPos, chunkStartRow, rangeLength, range.chunkRows, false);
+        break;
+
+      default:  // integer, double, logical, integer64 and byte columns
+        fdsPlanColumn_v2(planner, blockPos, chunkStartRow, rangeLength, range.chunkRows, ColumnElementSize(colType));
+        break;
+    }
+  }
+}
+
+
+/**
+ * \brief Fetch the byte ranges of the selected columns with a few merged reads
+ *
+ * The heads of all selected columns in each data chunk are fetched first, they contain the column headers and often
+ * the required part of the block index. The remaining index slices and the data blocks are planned and fetched in
+ * the following passes.
+ * \param planner planner on the source of the fst file
+ * \param colTypes types of the selected columns
+ * \param colChunksets chunkset numbers of the selected columns
+ * \param chunksetCols column numbers of the selected columns in their chunkset
+ * \param chunksets all chunksets of the table
+ * \param chunkRanges data chunk ranges of the selected row range for each chunkset
+ * \param rangePositions column positions for each chunk range for each chunkset
+ * \param colRuns row runs that are read from each selected column
+ */
+inline void PlanColumnReads(FstReadPlanner &planner, vector<unsigned short int> &colTypes, vector<int> &colChunksets,
+  vector<int> &chunksetCols, vector<ChunksetInfo> &chunksets, vector<vector<ChunkRange> > &chunkRanges,
+  vector<vector<unsigned long long> > &rangePositions, vector<vector<RowRun>*> &colRuns)
+{
+  unsigned long long sourceSize = planner.Size();
+
+  for (unsigned int colSel = 0; colSel < colTypes.size(); ++colSel)
+  {
+    int chunksetNr = colChunksets[colSel];
+
+    for (unsigned int rangeNr = 0; rangeNr < chunkRanges[chunksetNr].size(); ++rangeNr)
+    {
+      unsigned long long blockPos = rangePositions[chunksetNr][rangeNr * chunksets[chunksetNr].nrOfCols +
+        chunksetCols[colSel]];
+
+      if (blockPos < sourceSize) planner.Require(blockPos, min(static_cast<unsigned long long>(READ_PLAN_HEAD_SIZE),
+        sourceSize - blockPos));
+    }
+  }
+
+  for (int pass = 0; pass < READ_PLAN_PASSES && planner.Fetch(); ++pass)
+  {
+    for (unsigned int colSel = 0; colSel < colTypes.size(); ++colSel)
+    {
+      int chunksetNr = colChunksets[colSel];
+      unsigned long long* positions = rangePositions[chunksetNr].data();
+      int nrOfCols = chunksets[chunksetNr].nrOfCols;
+      vector<RowRun> &runs = *colRuns[colSel];
+
+      // levels are read from the first selected chunk
+      if (colTypes[colSel] == 7 && !chunkRanges[chunksetNr].empty())
+      {
+        fdsPlanFactorVec_v7(planner, positions[chunksetCols[colSel]], 0, 0, 0, true);
+      }
+
+      for (unsigned long long runNr = 0; runNr < runs.size(); ++runNr)
+      {
+        PlanColumnRows(planner, colTypes[colSel], chunkRanges[chunksetNr], positions, nrOfCols, chunksetCols[colSel],
+          runs[runNr].startRow, runs[runNr].length);
+      }
+    }
+  }
+}
+
+
+/**
+ * \brief Combine the zone map statistics of all blocks that overlap with a range of rows
+ * \param blocks zone map blocks of a column, ordered by row number
+ * \param blockNr first block that might overlap with the range, updated for use with the next range (input/output)
+ * \param startRow first row of the range
+ * \param endRow row after the last row of the range
+ * \param colType type of the column
+ * \param statistics statistics of the range (output)
+ */
+inline void RangeStatistics(vector<ZoneMapBlock> &blocks, unsigned long long &blockNr, unsigned long long startRow,
+  unsigned long long endRow, unsigned short int colType, FilterStatistics &statistics)
+{
+  statistics.hasStatistics = false;
+
+  // skip blocks before the range
+  while (blockNr < blocks.size() && blocks[blockNr].startRow + blocks[blockNr].nrOfRows <= startRow) ++blockNr;
+
+  bool hasRange = false;
+  bool hasNA = false;
+  bool allNA = true;
+  unsigned long long coveredRow = startRow;
+
+  for (unsigned long long block = blockNr; block < blocks.size() && blocks[block].startRow < endRow; ++block)
+  {
+    ZoneMapBlock &zoneMapBlock = blocks[block];
+
+    // statistics should be available for all rows of the range
+    if (!zoneMapBlock.hasStatistics || zoneMapBlock.startRow > coveredRow) return;
+
+    coveredRow = zoneMapBlock.startRow + zoneMapBlock.nrOfRows;
+
+    if (zoneMapBlock.naCount > 0) hasNA = true;
+    if (zoneMapBlock.naCount == zoneMapBlock.nrOfRows) continue;  // no values in block
+
+    allNA = false;
+
+    if (!hasRange)
+    {
+      statistics.minValue = zoneMapBlock.minValue;
+      statistics.maxValue = zoneMapBlock.maxValue;
+      hasRange = true;
+      continue;
+    }
+
+    if (colType == 9)
+    {
+      statistics.minValue.doubleValue = min(statistics.minValue.doubleValue, zoneMapBlock.minValue.doubleValue);
+      statistics.maxValue.doubleValue = max(statistics.maxValue.doubleValue, zoneMapBlock.maxValue.doubleValue);
+      continue;
+    }
+
+    statistics.minValue.intValue = min(statistics.minValue.intValue, zoneMapBlock.minValue.intValue);
+    statistics.maxValue.intValue = max(statistics.maxValue.intValue, zoneMapBlock.maxValue.intValue);
+  }
+
+  if (coveredRow < endRow) return;
+
+  statistics.hasStatistics = true;
+  statistics.hasNA = hasNA;
+  statistics.allNA = allNA;
+}
+
+
+/**
+ * \brief Determine the rows of the selected row range that match a filter
+ *
+ * The filter is first tested on segments of FILTER_SEGMENT_SIZE rows using the zone maps of the filter columns. Only
+ * segments that might contain matching rows are decoded (in batches of consecutive segments) and tested row by row.
+ *
+ * \param firstRow first row of the selected row range
+ * \param length number of rows in the selected row range
+ * \param selection bitmap with a bit set for each matching row (output)
+ * \param rowRuns runs of rows that contain the matching rows (output)
+ * \return number of matching rows
+ */
+inline unsigned long long SelectRows(IFstSource &myfile, vector<FilterNode> &filterNodes, vector<int> &filterCols,
+  unsigned long long firstRow, unsigned long long length, vector<ChunksetInfo> &chunksets, vector<int> &colChunkset,
+  unsigned short int* colTypes, vector<vector<ChunkRange> > &chunkRanges,
+  vector<vector<unsigned long long> > &rangePositions, vector<unsigned long long> &selection, vector<RowRun> &rowRuns)
+{
+  int nrOfFilterCols = filterCols.size();
+  vector<unsigned short int> filterColTypes(nrOfFilterCols);
+  vector<vector<ZoneMapBlock> > zoneMaps(nrOfFilterCols);
+  vector<FilterColumnData> columnData(nrOfFilterCols);
+
+  // Factor levels and zone maps of the filter columns
+
+  for (int filterCol = 0; filterCol < nrOfFilterCols; ++filterCol)
+  {
+    int colNr = filterCols[filterCol];
+    int chunksetNr = colChunkset[colNr];
+    int chunksetCol = colNr - chunksets[chunksetNr].colOffset;
+    int chunksetCols = chunksets[chunksetNr].nrOfCols;
+    vector<ChunkRange> &ranges = chunkRanges[chunksetNr];
+    unsigned long long* positions = rangePositions[chunksetNr].data();
+    unsigned short int colType = colTypes[colNr];
+
+    filterColTypes[filterCol] = colType;
+    columnData[filterCol].colType = colType;
+
+    // levels are equal for all chunks
+    if (colType == 7)
+    {
+      FilterStringColumn levels;
+      fdsReadFactorLevels_v7(myfile, &levels, positions[chunksetCol]);
+      SetFilterLevels(filterNodes, filterCol, levels);
+    }
+
+    for (unsigned int rangeNr = 0; rangeNr < ranges.size(); ++rangeNr)
+    {
+      ChunkRange &range = ranges[rangeNr];
+      unsigned long long blockPos = positions[rangeNr * chunksetCols + chunksetCol];
+      unsigned long long rowOffset = firstRow + range.vecOffset - range.startRow;  // first row of the chunk
+
+      switch (colType)
+      {
+        case 7:
+          fdsReadFactorZoneMap_v7(myfile, blockPos, range.chunkRows, rowOffset, zoneMaps[filterCol]);
+          break;
+
+        case 8:
+          fdsReadIntZoneMap_v8(myfile, blockPos, range.chunkRows, rowOffset, zoneMaps[filterCol]);
+          break;
+
+        case 9:
+          fdsReadRealZoneMap_v9(myfile, blockPos, range.chunkRows, rowOffset, zoneMaps[filterCol]);
+          break;
+
+        case 11:
+          fdsReadInt64ZoneMap_v11(myfile, blockPos, range.chunkRows, rowOffset, zoneMaps[filterCol]);
+          break;
+
+        default:  // no zone maps available
+          break;
+      }
+    }
+  }
+
+  // Test segments using the zone maps
+
+  unsigned long long nrOfSegments = (length + FILTER_SEGMENT_SIZE - 1) / FILTER_SEGMENT_SIZE;
+  vector<FilterResult> segmentResults(nrOfSegments);
+  vector<FilterStatistics> statistics(nrOfFilterCols);
+  vector<unsigned long long> blockNrs(nrOfFilterCols, 0);
+
+  for (unsigned long long segmentNr = 0; segmentNr < nrOfSegments; ++segmentNr)
+  {
+    unsigned long long segmentStart = firstRow + segmentNr * FILTER_SEGMENT_SIZE;
+    unsigned long long segmentEnd = min(segmentStart + FILTER_SEGMENT_SIZE, firstRow + length);
+
+    for (int filterCol = 0; filterCol < nrOfFilterCols; ++filterCol)
+    {
+      RangeStatistics(zoneMaps[filterCol], blockNrs[filterCol], segmentStart, segmentEnd, filterColTypes[filterCol],
+        statistics[filterCol]);
+    }
+
+    segmentResults[segmentNr] = EvaluateFilterStatistics(filterNodes, 0, filterColTypes, statistics);
+  }
+
+  // Test the remaining segments row by row
+
+  selection.assign((length + 63) / 64, 0);
+  vector<unsigned long long> segmentCounts(nrOfSegments, 0);
+  char* mask = new char[min(length, static_cast<unsigned long long>(FILTER_BATCH_SIZE))];
+
+  unsigned long long segmentNr = 0;
+  while (segmentNr < nrOfSegments)
+  {
+    unsigned long long segmentStart = segmentNr * FILTER_SEGMENT_SIZE;
+    unsigned long long segmentLength = min(static_cast<unsigned long long>(FILTER_SEGMENT_SIZE), length - segmentStart);
+
+    if (segmentResults[segmentNr] == FilterResult::NONE)
+    {
+      ++segmentNr;
+      continue;
+    }
+
+    if (segmentResults[segmentNr] == FilterResult::ALL)
+    {
+      for (unsigned long long row = segmentStart; row < segmentStart + segmentLength; ++row)
+      {
+        selection[row / 64] |= 1ULL << (row % 64);
+      }
+
+      segmentCounts[segmentNr++] = segmentLength;
+      continue;
+    }
+
+    // Batch of consecutive segments that need to be tested row by row
+    unsigned long long batchStart = segmentStart;
+    unsigned long long batchSegments = 0;
+
+    while (segmentNr < nrOfSegments && segmentResults[segmentNr] == FilterResult::SOME &&
+      (batchSegments + 1) * FILTER_SEGMENT_SIZE <= FILTER_BATCH_SIZE)
+    {
+      ++segmentNr;
+      ++batchSegments;
+    }
+
+    unsigned long long batchLength = min(segmentNr * FILTER_SEGMENT_SIZE, length) - batchStart;
+
+    // Decode filter columns
+    for (int filterCol = 0; filterCol < nrOfFilterCols; ++filterCol)
+    {
+      int colNr = filterCols[filterCol];
+      int chunksetNr = colChunkset[colNr];
+      FilterColumnData &data = columnData[filterCol];
+      std::string annotation;
+
+      if (data.colType == 6)
+      {
+        data.strings.AllocateVec(batchLength);
+      }
+      else
+      {
+        data.values.resize(batchLength * ColumnElementSize(data.colType));
+      }
+
+      ReadColumnRows(myfile, data.colType, chunkRanges[chunksetNr], rangePositions[chunksetNr].data(),
+        chunksets[chunksetNr].nrOfCols, colNr - chunksets[chunksetNr].colOffset, batchStart, batchLength, data.values.data(),
+        &data.strings, 0, annotation);
+    }
+
+    EvaluateFilterRows(filterNodes, 0, columnData, batchLength, mask);
+
+    for (unsigned long long row = 0; row < batchLength; ++row)
+    {
+      if (mask[row] == 0) continue;
+
+      unsigned long long bitNr = batchStart + row;
+      selection[bitNr / 64] |= 1ULL << (bitNr % 64);
+      ++segmentCounts[bitNr / FILTER_SEGMENT_SIZE];
+    }
+  }
+
+  delete[] mask;
+
+  // Runs of consecutive segments with matching rows
+
+  unsigned long long resultOffset = 0;
+  segmentNr = 0;
+
+  while (segmentNr < nrOfSegments)
+  {
+    if (segmentCounts[segmentNr] == 0)
+    {
+      ++segmentNr;
+      continue;
+    }
+
+    RowRun rowRun;
+    rowRun.startRow = segmentNr * FILTER_SEGMENT_SIZE;
+    rowRun.resultOffset = resultOffset;
+    rowRun.allSelected = true;
+
+    unsigned long long runSegments = 0;
+
+    while (segmentNr < nrOfSegments && segmentCounts[segmentNr] > 0 &&
+      (runSegments + 1) * FILTER_SEGMENT_SIZE <= FILTER_BATCH_SIZE)
+    {
+      unsigned long long segmentStart = segmentNr * FILTER_SEGMENT_SIZE;
+      unsigned long long segmentLength = min(static_cast<unsigned long long>(FILTER_SEGMENT_SIZE), length - segmentStart);
+
+      if (segmentCounts[segmentNr] != segmentLength) rowRun.allSelected = false;
+
+      resultOffset += segmentCounts[segmentNr++];
+      ++runSegments;
+    }
+
+    rowRun.length = min(segmentNr * FILTER_SEGMENT_SIZE, length) - rowRun.startRow;
+    rowRuns.push_back(rowRun);
+  }
+
+  return resultOffset;
+}
+
+
+/**
+ * \brief Reads blocks of a key column in the selected row range
+ */
+class KeyBlockReader : public IKeyBlockReader
+{
+  IFstSource* myfile;
+  vector<ChunkRange>* chunkRanges;
+  unsigned long long* positions;
+  int chunksetCols;
+  int chunksetCol;
+  unsigned long long firstRow;
+
+public:
+  KeyBlockReader(IFstSource &myfile, vector<ChunkRange> &chunkRanges, unsigned long long* positions, int chunksetCols,
+    int chunksetCol, unsigned long long firstRow)
+  {
+    this->myfile       = &myfile;
+    this->chunkRanges  = &chunkRanges;
+    this->positions    = positions;
+    this->chunksetCols = chunksetCols;
+    this->chunksetCol  = chunksetCol;
+    this->firstRow     = firstRow;
+  }
+
+  void ReadRows(unsigned long long startRow, unsigned long long length, FilterColumnData &data)
+  {
+    std::string annotation;
+
+    if (data.colType == 6)
+    {
+      data.strings.AllocateVec(length);
+    }
+    else
+    {
+      data.values.resize(length * ColumnElementSize(data.colType));
+    }
+
+    ReadColumnRows(*myfile, data.colType, *chunkRanges, positions, chunksetCols, chunksetCol, startRow - firstRow,
+      length, data.values.data(), &data.strings, 0, annotation);
+  }
+};
+
+
+/**
+ * \brief Determine the storage blocks of a key column in the selected row range
+ *
+ * Blocks with a zone map keep their statistics, blocks at the edges of the selected row range are clipped and lose
+ * their statistics.
+ *
+ * \param firstRow first row of the selected row range
+ * \param blocks storage blocks covering all rows of the selected row range (output)
+ */
+inline void KeyColumnBlocks(IFstSource &myfile, unsigned short int colType, vector<ChunkRange> &chunkRanges,
+  unsigned long long* positions, int chunksetCols, int chunksetCol, unsigned long long firstRow,
+  vector<ZoneMapBlock> &blocks)
+{
+  unsigned long long blockSize = ColumnBlockRows(colType);
+
+  for (unsigned int rangeNr = 0; rangeNr < chunkRanges.size(); ++rangeNr)
+  {
+    ChunkRange &range = chunkRanges[rangeNr];
+    unsigned long long blockPos = positions[rangeNr * chunksetCols + chunksetCol];
+    unsigned long long chunkStart = firstRow + range.vecOffset - range.startRow;  // first row of the chunk
+    unsigned long long rangeStart = firstRow + range.vecOffset;
+    unsigned long long rangeEnd = rangeStart + range.length;
+    vector<ZoneMapBlock> chunkBlocks;
+
+    switch (colType)
+    {
+      case 7:
+        fdsReadFactorZoneMap_v7(myfile, blockPos, range.chunkRows, chunkStart, chunkBlocks);
+        break;
+
+      case 8:
+        fdsReadIntZoneMap_v8(myfile, blockPos, range.chunkRows, chunkStart, chunkBlocks);
+        break;
+
+      case 9:
+        fdsReadRealZoneMap_v9(myfile, blockPos, range.chunkRows, chunkStart, chunkBlocks);
+        break;
+
+      case 11:
+        fdsReadInt64ZoneMap_v11(myfile, blockPos, range.chunkRows, chunkStart, chunkBlocks);
+        break;
+
+      default:  // no zone maps available
+      {
+        ZoneMapBlock block;
+        block.startRow = chunkStart;
+        block.nrOfRows = range.chunkRows;
+        block.naCount = 0;
+        block.hasStatistics = false;
+
+        chunkBlocks.push_back(block);
+        break;
+      }
+    }
+
+    for (unsigned int blockNr = 0; blockNr < chunkBlocks.size(); ++blockNr)
+    {
+      ZoneMapBlock &chunkBlock = chunkBlocks[blockNr];
+      unsigned long long blockEnd = chunkBlock.startRow + chunkBlock.nrOfRows;
+
+      // blocks without statistics are split into storage blocks
+      unsigned long long step = chunkBlock.hasStatistics ? chunkBlock.nrOfRows : blockSize;
+
+      for (unsigned long long subStart = chunkBlock.startRow; subStart < blockEnd; subStart += step)
+      {
+        unsigned long long subEnd = min(subStart + step, blockEnd);
+        ZoneMapBlock block = chunkBlock;
+
+        block.startRow = max(subStart, rangeStart);
+        unsigned long long clippedEnd = min(subEnd, rangeEnd);
+
+        if (block.startRow >= clippedEnd) continue;
+
+        block.nrOfRows = clippedEnd - block.startRow;
+
+        // statistics are only valid for complete blocks
+        if (block.startRow != subStart || clippedEnd != subEnd) block.hasStatistics = false;
+
+        blocks.push_back(block);
+      }
+    }
+  }
+}
+
+
+/**
+ * \brief Determine the rows of the selected row range with keys that are equal to one of the key lookups
+ *
+ * Lookups are processed in key order. For each lookup, the range of matching rows is narrowed down one key column at a
+ * time, using a binary search for the lower and upper bound of the lookup value.
+ *
+ * \param keyCols bound key lookup columns
+ * \param firstRow first row of the selected row range
+ * \param length number of rows in the selected row range
+ * \param rowRuns runs of matching rows (output)
+ * \return number of matching rows
+ */
+inline unsigned long long LookupRows(IFstSource &myfile, vector<KeyLookupColumn> &keyCols, unsigned long long firstRow,
+  unsigned long long length, vector<ChunksetInfo> &chunksets, vector<int> &colChunkset,
+  vector<vector<ChunkRange> > &chunkRanges, vector<vector<unsigned long long> > &rangePositions,
+  vector<RowRun> &rowRuns)
+{
+  int nrOfKeyCols = keyCols.size();
+  vector<KeyBlockReader> blockReaders;
+  vector<KeyColumnSearch> keySearches;
+
+  // searches keep a pointer to their block reader
+  blockReaders.reserve(nrOfKeyCols);
+  keySearches.reserve(nrOfKeyCols);
+
+  for (int keyNr = 0; keyNr < nrOfKeyCols; ++keyNr)
+  {
+    KeyLookupColumn &keyCol = keyCols[keyNr];
+    int chunksetNr = colChunkset[keyCol.colNr];
+    int chunksetCol = keyCol.colNr - chunksets[chunksetNr].colOffset;
+    int chunksetCols = chunksets[chunksetNr].nrOfCols;
+    unsigned long long* positions = rangePositions[chunksetNr].data();
+
+    // levels are equal for all chunks
+    if (keyCol.colType == 7)
+    {
+      FilterStringColumn levels;
+      fdsReadFactorLevels_v7(myfile, &levels, positions[chunksetCol]);
+      SetKeyLevels(keyCol, levels);
+    }
+
+    vector<ZoneMapBlock> blocks;
+    KeyColumnBlocks(myfile, keyCol.colType, chunkRanges[chunksetNr], positions, chunksetCols, chunksetCol, firstRow,
+      blocks);
+
+    blockReaders.push_back(KeyBlockReader(myfile, chunkRanges[chunksetNr], positions, chunksetCols, chunksetCol,
+      firstRow));
+    keySearches.push_back(KeyColumnSearch(&keyCol, blocks, &blockReaders[keyNr]));
+  }
+
+  vector<unsigned long long> keyOrder;
+  SortKeyLookups(keyCols, keyOrder);
+
+  unsigned long long endRow = firstRow + length;
+  unsigned long long searchStart = firstRow;  // all rows before this row have smaller keys than the current lookup
+  unsigned long long resultOffset = 0;
+
+  for (unsigned long long orderNr = 0; orderNr < keyOrder.size(); ++orderNr)
+  {
+    unsigned long long keyNr = keyOrder[orderNr];
+    unsigned long long lowerRow = searchStart;
+    unsigned long long upperRow = endRow;
+
+    for (int colNr = 0; colNr < nrOfKeyCols && lowerRow < upperRow; ++colNr)
+    {
+      lowerRow = keySearches[colNr].Bound(lowerRow, upperRow, keyNr, false);
+      upperRow = keySearches[colNr].Bound(lowerRow, upperRow, keyNr, true);
+    }
+
+    // lookups are sorted, so rows before the lower bound are smaller than all remaining lookups
+    searchStart = lowerRow;
+
+    if (lowerRow >= upperRow) continue;
+
+    // Extend the last run if possible
+    if (!rowRuns.empty() && rowRuns.back().startRow + rowRuns.back().length == lowerRow - firstRow)
+    {
+      rowRuns.back().length += upperRow - lowerRow;
+    }
+    else
+    {
+      RowRun rowRun;
+      rowRun.startRow = lowerRow - firstRow;
+      rowRun.length = upperRow - lowerRow;
+      rowRun.resultOffset = resultOffset;
+      rowRun.allSelected = true;
+
+      rowRuns.push_back(rowRun);
+    }
+
+    resultOffset += upperRow - lowerRow;
+  }
+
+  return resultOffset;
+}
+
+
+/**
+ * \brief Group the rows of a row index into runs of rows that are read from a column with a single read
+ *
+ * A run contains the selected rows of one or more consecutive data blocks of the column. Blocks without selected rows
+ * are never part of a run and a block is never split over multiple runs, so each block with selected rows is
+ * decompressed exactly once. Runs are closed on block boundaries when they contain more than READ_TASK_SIZE rows.
+ *
+ * \param selectedRows distinct selected rows in table order
+ * \param firstRow first row of the selected row range
+ * \param chunkRanges data chunk ranges of the selected row range in the column's chunkset
+ * \param blockRows number of rows in a data block of the column
+ * \param rowRuns runs of rows that contain the selected rows (output)
+ */
+inline void IndexRowRuns(const vector<unsigned long long> &selectedRows, unsigned long long firstRow,
+  const vector<ChunkRange> &chunkRanges, unsigned long long blockRows, vector<RowRun> &rowRuns)
+{
+  unsigned long long nrOfSelected = selectedRows.size();
+  unsigned int rangeNr = 0;
+  unsigned long long lastBlock = 0;
+  RowRun rowRun;
+
+  for (unsigned long long selectedNr = 0; selectedNr < nrOfSelected; ++selectedNr)
+  {
+    unsigned long long row = selectedRows[selectedNr] - firstRow;  // relative to the selected row range
+    unsigned int lastRange = rangeNr;
+
+    while (row >= chunkRanges[rangeNr].vecOffset + chunkRanges[rangeNr].length) ++rangeNr;
+
+    // blocks are counted from the start of each data chunk
+    const ChunkRange &range = chunkRanges[rangeNr];
+    unsigned long long block = (range.startRow + row - range.vecOffset) / blockRows;
+
+    bool extendRun = selectedNr != 0 && rangeNr == lastRange &&
+      (block == lastBlock || (block == lastBlock + 1 && row - rowRun.startRow < READ_TASK_SIZE));
+
+    if (!extendRun)
+    {
+      if (selectedNr != 0) rowRuns.push_back(rowRun);
+
+      rowRun.startRow = row;
+      rowRun.resultOffset = selectedNr;
+    }
+
+    rowRun.length = row + 1 - rowRun.startRow;
+    rowRun.allSelected = rowRun.length == selectedNr + 1 - rowRun.resultOffset;
+    lastBlock = block;
+  }
+
+  if (nrOfSelected != 0) rowRuns.push_back(rowRun);
+}
+
+
+// A read task: a run of rows of a single non-character column
+struct ReadTask
+{
+  int colSel;    // column in the result table
+  RowRun rowRun;
+  bool isFirst;  // true for the first run of the column
+};
+
+
+void FstStore::fstRead(IFstTable &tableReader, IStringArray* columnSelection, long long startRow, long long endRow,
+  IColumnFactory* columnFactory, vector<int> &keyIndex, IStringArray* selectedCols, const FstFilter* filter,
+  const FstKeyLookup* keyLookup, const FstRowIndex* rowIndex)
+{
+  // Parsed metadata of the file, kept by an opened store
+  FstFileState* state = AcquireFileState(fstFile, source, fileState);
+  IFstSource &myfile = *state->source;
+  vector<ChunksetInfo> &chunksets = state->chunksets;
+  IStringColumn* colNames = &state->colNames;
+
+  version = state->version;
+  int keyLength = state->keyLength;
+  int* keyColPos = state->keyColPos.data();  // TODO: why not unsigned ?
+
+  nrOfCols = state->colInfo.size() / 4;
+
+  unsigned short int* colAttributeTypes   = &state->colInfo[0];
+  unsigned short int* colTypes            = &state->colInfo[nrOfCols];
+  unsigned short int* colScales           = &state->colInfo[3 * nrOfCols];
+
+
+  // Determine column selection
+  int *colIndex;
+  int nrOfSelect;
+
+  if (columnSelection == nullptr)
+  {
+    colIndex = new int[nrOfCols];
+
+    for (int colNr = 0; colNr < nrOfCols; ++colNr)
+    {
+      colIndex[colNr] = colNr;
+    }
+    nrOfSelect = nrOfCols;
+  }
+  else  // determine column numbers of column names
+  {
+    nrOfSelect = columnSelection->Length();
+    colIndex = new int[nrOfSelect];
+    for (int colSel = 0; colSel < nrOfSelect; ++colSel)
+    {
+      unordered_map<string, int>::const_iterator colIt = state->colNrs.find(columnSelection->GetElement(colSel));
+      int equal = colIt == state->colNrs.end() ? -1 : colIt->second;
+
+      if (equal == -1)
+      {
+        delete[] colIndex;
+        ReleaseFileState(state, fileState);
+        throw(runtime_error("Selected column not found."));
+      }
+
+      colIndex[colSel] = equal;
+    }
+  }
+
+
+  nrOfRows = *reinterpret_cast<unsigned long long*>(&chunksets[0].header[64]);  // TODO: check for row numbers > INT_MAX !!!
+
+  // The row range of a row index spans the requested rows
+  vector<unsigned long long> indexRows;  // distinct requested rows in table order
+  RowScatter rowScatter;
+
+  if (rowIndex != nullptr)
+  {
+    std::string errorMessage = "A row index can't be combined with a row filter or key lookup";
+
+    if (filter != nullptr || keyLookup != nullptr || !SortRowIndex(*rowIndex, nrOfRows, indexRows, rowScatter,
+      errorMessage))
+    {
+      delete[] colIndex;
+      ReleaseFileState(state, fileState);
+      throw(runtime_error(errorMessage));
+    }
+
+    startRow = 1;
+    endRow = -1;
+
+    if (!indexRows.empty())
+    {
+      startRow = indexRows.front() + 1;
+      endRow = indexRows.back() + 1;
+    }
+  }
+
+  // Check range of selected rows
+  long long firstRow = startRow - 1;
+
+  if (firstRow >= static_cast<long long>(nrOfRows) || firstRow < 0)
+  {
+    delete[] colIndex;
+    ReleaseFileState(state, fileState);
+
+    if (firstRow < 0)
+    {
+      throw(runtime_error("Parameter fromRow should have a positive value."));
+    }
+
+    throw(runtime_error("Row selection is out of range."));
+  }
+
+  long long length = nrOfRows - firstRow;
+
+
+  // Determine vector length
+  if (endRow != -1)
+  {
+    if (static_cast<long long>(endRow) <= firstRow)
+    {
+      delete[] colIndex;
+      ReleaseFileState(state, fileState);
+      throw(runtime_error("Incorrect row range specified."));
+    }
+
+    length = min(endRow - firstRow, static_cast<long long>(nrOfRows) - firstRow);
+  }
+
+
+  // Chunksets that contain selected columns
+  unsigned int nrOfChunksets = chunksets.size();
+  vector<int> colChunkset(nrOfCols);
+  vector<bool> chunksetSelected(nrOfChunksets, false);
+
+  for (unsigned int chunksetNr = 0; chunksetNr < nrOfChunksets; ++chunksetNr)
+  {
+    for (int chunksetCol = 0; chunksetCol < chunksets[chunksetNr].nrOfCols; ++chunksetCol)
+    {
+      colChunkset[chunksets[chunksetNr].colOffset + chunksetCol] = chunksetNr;
+    }
+  }
+
+  for (int colSel = 0; colSel < nrOfSelect; ++colSel)
+  {
+    int colNr = colIndex[colSel];
+
+    if (colNr < 0 || colNr >= nrOfCols)
+    {
+      delete[] colIndex;
+      ReleaseFileState(state, fileState);
+      throw(runtime_error("Column selection is out of range."));
+    }
+
+    chunksetSelected[colChunkset[colNr]] = true;
+  }
+
+
+  // Bind the row filter to the columns of the table, filter columns are read first
+  vector<FilterNode> filterNodes;
+  vector<int> filterCols;
+
+  if (filter != nullptr)
+  {
+    std::string errorMessage;
+
+    if (!BindFilter(*filter, colNames, nrOfCols, colTypes, filterNodes, filterCols, errorMessage))
+    {
+      delete[] colIndex;
+      ReleaseFileState(state, fileState);
+      throw(runtime_error(errorMessage));
+    }
+
+    for (unsigned int filterCol = 0; filterCol < filterCols.size(); ++filterCol)
+    {
+      chunksetSelected[colChunkset[filterCols[filterCol]]] = true;
+    }
+  }
+
+
+  // Bind the key lookup to the key columns of the table
+  vector<KeyLookupColumn> keyCols;
+
+  if (keyLookup != nullptr)
+  {
+    std::string errorMessage = "A key lookup can't be combined with a row filter";
+
+    if (filter != nullptr || !BindKeyLookup(*keyLookup, keyLength, keyColPos, colNames, colTypes, keyCols,
+      errorMessage))
+    {
+      delete[] colIndex;
+      ReleaseFileState(state, fileState);
+      throw(runtime_error(errorMessage));
+    }
+
+    for (unsigned int keyNr = 0; keyNr < keyCols.size(); ++keyNr)
+    {
+      chunksetSelected[colChunkset[keyCols[keyNr].colNr]] = true;
+    }
+  }
+
+
+  // Data chunks containing the selected rows and their column positions, for selected chunksets only
+  vector<vector<ChunkRange> > chunkRanges(nrOfChunksets);
+  vector<vector<unsigned long long> > rangePositions(nrOfChunksets);
+
+  for (unsigned int chunksetNr = 0; chunksetNr < nrOfChunksets; ++chunksetNr)
+  {
+    if (!chunksetSelected[chunksetNr]) continue;
+
+    ChunksetInfo &chunkset = chunksets[chunksetNr];
+    ChunksetIndex &chunksetIndex = state->chunksetIndex[chunksetNr];
+
+    bool isValid = LoadChunksetIndex(myfile, chunkset, chunksetIndex);
+
+    if (isValid)
+    {
+      SelectChunkRanges(chunksetIndex.chunkRows, firstRow, length, chunkRanges[chunksetNr]);
+      rangePositions[chunksetNr].resize(chunkset.nrOfCols * chunkRanges[chunksetNr].size());
+    }
+
+    for (unsigned int rangeNr = 0; rangeNr < chunkRanges[chunksetNr].size() && isValid; ++rangeNr)
+    {
+      isValid = ChunkPositions(myfile, chunkset.nrOfCols, chunksetIndex, chunkRanges[chunksetNr][rangeNr].chunkNr,
+        &rangePositions[chunksetNr][rangeNr * chunkset.nrOfCols]);
+    }
+
+    if (!isValid)
+    {
+      delete[] colIndex;
+      ReleaseFileState(state, fileState);
+      throw(runtime_error(FSTERROR_DAMAGED_CHUNKINDEX));
+    }
+  }
+
+  // Rows of the selected row range that are read from the projected columns
+  vector<RowRun> rowRuns;
+  vector<unsigned long long> selection;  // bitmap of matching rows (filtered reads only)
+  unsigned long long nrOfResultRows = length;
+
+  if (rowIndex != nullptr)
+  {
+    nrOfResultRows = rowIndex->rows.size();
+    selection.resize(1 + length / 64, 0);
+
+    for (unsigned long long selectedNr = 0; selectedNr < indexRows.size(); ++selectedNr)
+    {
+      unsigned long long bitNr = indexRows[selectedNr] - firstRow;
+      selection[bitNr / 64] |= 1ULL << (bitNr % 64);
+    }
+  }
+  else if (keyLookup != nullptr)
+  {
+    nrOfResultRows = LookupRows(myfile, keyCols, firstRow, length, chunksets, colChunkset, chunkRanges, rangePositions,
+      rowRuns);
+  }
+  else if (filter == nullptr)
+  {
+    RowRun rowRun;
+    rowRun.startRow = 0;
+    rowRun.length = length;
+    rowRun.resultOffset = 0;
+    rowRun.allSelected = true;
+
+    rowRuns.push_back(rowRun);
+  }
+  else
+  {
+    nrOfResultRows = SelectRows(myfile, filterNodes, filterCols, firstRow, length, chunksets, colChunkset, colTypes,
+      chunkRanges, rangePositions, selection, rowRuns);
+  }
+
+  // Row runs of at most READ_TASK_SIZE rows, each combination of a column and a run is a single read task
+  vector<RowRun> taskRuns;
+  SplitRowRuns(rowRuns, firstRow, taskRuns);
+
+  // Row index reads use runs that are aligned with the data blocks of each column
+  vector<vector<RowRun> > indexRuns(nrOfSelect);
+  const RowScatter* scatter = rowScatter.offsets.empty() ? nullptr : &rowScatter;
+
+  if (rowIndex != nullptr)
+  {
+    for (int colSel = 0; colSel < nrOfSelect; ++colSel)
+    {
+      int colNr = colIndex[colSel];
+
+      IndexRowRuns(indexRows, firstRow, chunkRanges[colChunkset[colNr]], ColumnBlockRows(colTypes[colNr]),
+        indexRuns[colSel]);
+    }
+  }
+
+  // Sources that are not memory based are read through a read planner, which fetches the headers, block indexes and
+  // data blocks of all selected columns with a few large requests instead of many small requests per column
+  FstReadPlanner planner(myfile, max(0LL, GetFstReadGap()), READ_PLAN_BUDGET);
+  bool usePlanner = GetFstReadGap() >= 0 && myfile.Map(0, TABLE_META_SIZE) == nullptr;
+
+  if (usePlanner)
+  {
+    vector<unsigned short int> selectedTypes(nrOfSelect);
+    vector<int> selectedChunksets(nrOfSelect);
+    vector<int> selectedChunksetCols(nrOfSelect);
+    vector<vector<RowRun>*> selectedRuns(nrOfSelect);
+
+    for (int colSel = 0; colSel < nrOfSelect; ++colSel)
+    {
+      int colNr = colIndex[colSel];
+
+      selectedTypes[colSel] = colTypes[colNr];
+      selectedChunksets[colSel] = colChunkset[colNr];
+      selectedChunksetCols[colSel] = colNr - chunksets[colChunkset[colNr]].colOffset;
+      selectedRuns[colSel] = rowIndex == nullptr ? &rowRuns : &indexRuns[colSel];
+    }
+
+    PlanColumnReads(planner, selectedTypes, selectedChunksets, selectedChunksetCols, chunksets, chunkRanges,
+      rangePositions, selectedRuns);
+  }
+
+  IFstSource &columnSource = usePlanner ? static_cast<IFstSource &>(planner) : myfile;
+
+  tableReader.InitTable(nrOfSelect, nrOfResultRows);
+
+  // Create the result columns on the main thread, R objects can't be allocated from the worker threads
+
+  vector<ResultColumn> resultColumns(nrOfSelect);
+  vector<int> taskCols;    // non-character columns, read in (column, row run) tasks by all threads
+  vector<int> stringCols;  // character columns, read by the main thread
+
+  for (int colSel = 0; colSel < nrOfSelect; ++colSel)
+  {
+    int colNr = colIndex[colSel];
+    short int scale = colScales[colNr];
+    FstColumnAttribute colAttribute = static_cast<FstColumnAttribute>(colAttributeTypes[colNr]);
+    ResultColumn &resultColumn = resultColumns[colSel];
+
+    // Location of column in its chunkset
+    resultColumn.colType       = colTypes[colNr];
+    resultColumn.chunksetNr    = colChunkset[colNr];
+    resultColumn.chunksetCol   = colNr - chunksets[resultColumn.chunksetNr].colOffset;
+    resultColumn.data          = nullptr;
+    resultColumn.stringColumn  = nullptr;
+    resultColumn.integerColumn = nullptr;
+    resultColumn.doubleColumn  = nullptr;
+    resultColumn.logicalColumn = nullptr;
+    resultColumn.factorColumn  = nullptr;
+    resultColumn.int64Column   = nullptr;
+    resultColumn.byteColumn    = nullptr;
+
+    switch (resultColumn.colType)
+    {
+      // Character vector
+      case 6:
+        resultColumn.stringColumn = columnFactory->CreateStringColumn(nrOfResultRows, colAttribute);
+        resultColumn.stringColumn->AllocateVec(nrOfResultRows);
+        stringCols.push_back(colSel);
+        continue;
+
+      // Factor vector
+      case 7:
+        resultColumn.factorColumn = columnFactory->CreateFactorColumn(nrOfResultRows, colAttribute);
+        resultColumn.data = reinterpret_cast<char*>(resultColumn.factorColumn->LevelData());
+
+        // levels are equal for all chunks and are read from the first selected chunk only
+        fdsReadFactorLevels_v7(columnSource, resultColumn.factorColumn->Levels(),
+          rangePositions[resultColumn.chunksetNr][resultColumn.chunksetCol]);
+        break;
+
+      // Integer vector
+      case 8:
+        resultColumn.integerColumn = columnFactory->CreateIntegerColumn(nrOfResultRows, colAttribute, scale);
+        resultColumn.data = reinterpret_cast<char*>(resultColumn.integerColumn->Data());
+        break;
+
+      // Double vector
+      case 9:
+        resultColumn.doubleColumn = columnFactory->CreateDoubleColumn(nrOfResultRows, colAttribute, scale);
+        resultColumn.data = reinterpret_cast<char*>(resultColumn.doubleColumn->Data());
+        break;
+
+      // Logical vector
+      case 10:
+        resultColumn.logicalColumn = columnFactory->CreateLogicalColumn(nrOfResultRows, colAttribute);
+        resultColumn.data = reinterpret_cast<char*>(resultColumn.logicalColumn->Data());
+        break;
+
+      // integer64 vector
+      case 11:
+        resultColumn.int64Column = columnFactory->CreateInt64Column(nrOfResultRows, colAttribute, scale);
+        resultColumn.data = reinterpret_cast<char*>(resultColumn.int64Column->Data());
+        break;
+
+      // byte vector
+      case 12:
+        resultColumn.byteColumn = columnFactory->CreateByteColumn(nrOfResultRows, colAttribute);
+        resultColumn.data = resultColumn.byteColumn->Data();
+        break;
+
+      default:
+        DeleteResultColumns(resultColumns);
+        delete[] colIndex;
+        ReleaseFileState(state, fileState);
+        throw(runtime_error("Unknown type found in column."));
+    }
+
+    taskCols.push_back(colSel);
+  }
+
+  vector<ReadTask> readTasks;
+
+  for (unsigned int taskCol = 0; taskCol < taskCols.size(); ++taskCol)
+  {
+    int colSel = taskCols[taskCol];
+    vector<RowRun> &colRuns = rowIndex == nullptr ? taskRuns : indexRuns[colSel];
+
+    for (unsigned long long runNr = 0; runNr < colRuns.size(); ++runNr)
+    {
+      ReadTask readTask;
+      readTask.colSel = colSel;
+      readTask.rowRun = colRuns[runNr];
+      readTask.isFirst = runNr == 0;
+
+      readTasks.push_back(readTask);
+    }
+  }
+
+  // No rows selected, read the first row only to get the column annotations
+  if (nrOfResultRows == 0)
+  {
+    for (unsigned int taskCol = 0; taskCol < taskCols.size(); ++taskCol)
+    {
+      ResultColumn &resultColumn = resultColumns[taskCols[taskCol]];
+      long long element;  // fits a single element of all column types
+
+      ReadColumnRows(columnSource, resultColumn.colType, chunkRanges[resultColumn.chunksetNr],
+        rangePositions[resultColumn.chunksetNr].data(), chunksets[resultColumn.chunksetNr].nrOfCols,
+        resultColumn.chunksetCol, 0, 1, reinterpret_cast<char*>(&element), nullptr, 0, resultColumn.annotation);
+    }
+  }
+
+
+  //////////////////////////////////////////////////////////
+  // Parallel logic starts here
+  //////////////////////////////////////////////////////////
+
+  // Tasks are scheduled over all selected columns, so narrow columns and short row ranges are read in parallel
+  // as well. Readers called from a task use a single thread.
+
+  long long nrOfTasks = readTasks.size();
+
+  // Without tasks the region is inactive, so the character columns are decompressed by all threads
+  int nrOfThreads = nrOfTasks == 0 ? 1 : GetFstThreads();
+  bool hasError = false;
+  std::string errorMessage;
+
+#pragma omp parallel num_threads(nrOfThreads)
+  {
+    // Character columns create R strings, they are read by the main thread while the other threads start on the tasks
+#pragma omp master
+    {
+      for (unsigned int stringCol = 0; stringCol < stringCols.size(); ++stringCol)
+      {
+        int colSel = stringCols[stringCol];
+        ResultColumn &resultColumn = resultColumns[colSel];
+        int chunksetNr = resultColumn.chunksetNr;
+
+        try
+        {
+          ReadSelectedStrings(columnSource, chunkRanges[chunksetNr], rangePositions[chunksetNr].data(),
+            chunksets[chunksetNr].nrOfCols, resultColumn.chunksetCol, rowIndex == nullptr ? rowRuns : indexRuns[colSel],
+            selection.data(), scatter, resultColumn.stringColumn);
+        }
+        catch (const std::exception &e)
+        {
+#pragma omp critical(fst_read_error)
+          {
+            if (!hasError) errorMessage = e.what();
+            hasError = true;
+          }
+        }
+      }
+    }
+
+#pragma omp for schedule(dynamic, 1) nowait
+    for (long long taskNr = 0; taskNr < nrOfTasks; ++taskNr)
+    {
+      ReadTask &readTask = readTasks[taskNr];
+      ResultColumn &resultColumn = resultColumns[readTask.colSel];
+      int chunksetNr = resultColumn.chunksetNr;
+      std::string annotation = "";
+
+      try
+      {
+        ReadColumnTask(columnSource, resultColumn, chunkRanges[chunksetNr], rangePositions[chunksetNr].data(),
+          chunksets[chunksetNr].nrOfCols, readTask.rowRun, selection.data(), scatter, annotation);
+      }
+      catch (const std::exception &e)
+      {
+#pragma omp critical(fst_read_error)
+        {
+          if (!hasError) errorMessage = e.what();
+          hasError = true;
+        }
+      }
+
+      // the column annotation is taken from the first data chunk read
+      if (readTask.isFirst) resultColumn.annotation = annotation;
+    }
+  }
+
+  //////////////////////////////////////////////////////////
+  // Parallel logic ends here
+  //////////////////////////////////////////////////////////
+
+  if (hasError)
+  {
+    DeleteResultColumns(resultColumns);
+    delete[] colIndex;
+    ReleaseFileState(state, fileState);
+    throw(runtime_error(errorMessage));
+  }
+
+  // Hand the columns to the table on the main thread
+  for (int colSel = 0; colSel < nrOfSelect; ++colSel)
+  {
+    ResultColumn &resultColumn = resultColumns[colSel];
+
+    switch (resultColumn.colType)
+    {
+      case 6:
+        tableReader.SetStringColumn(resultColumn.stringColumn, colSel);
+        break;
+
+      case 7:
+        tableReader.SetFactorColumn(resultColumn.factorColumn, colSel);
+        break;
+
+      case 8:
+        tableReader.SetIntegerColumn(resultColumn.integerColumn, colSel, resultColumn.annotation);
+        break;
+
+      case 9:
+        tableReader.SetDoubleColumn(resultColumn.doubleColumn, colSel, resultColumn.annotation);
+        break;
+
+      case 10:
+        tableReader.SetLogicalColumn(resultColumn.logicalColumn, colSel);
+        break;
+
+      case 11:
+        tableReader.SetInt64Column(resultColumn.int64Column, colSel);
+        break;
+
+      default:  // 12
+        tableReader.SetByteColumn(resultColumn.byteColumn, colSel);
+        break;
+    }
+  }
+
+  DeleteResultColumns(resultColumns);
+
+  // Key index, rows of a row index are only sorted on the key if they are requested in non-decreasing order
+  bool isSorted = true;
+
+  if (rowIndex != nullptr)
+  {
+    for (size_t i = 1; i < rowIndex->rows.size(); ++i)
+    {
+      if (rowIndex->rows[i] < rowIndex->rows[i - 1])
+      {
+        isSorted = false;
+        break;
+      }
+    }
+  }
+
+  if (isSorted) SetKeyIndex(keyIndex, keyLength, nrOfSelect, keyColPos, colIndex);
+
+  selectedCols->AllocateArray(nrOfSelect);
+
+  // Only when keys are present in result set, TODO: compute using C++ only !!!
+  for (int i = 0; i < nrOfSelect; ++i)
+  {
+    selectedCols->SetElement(i, colNames->GetElement(colIndex[i]));
+  }
+
+  ReleaseFileState(state, fileState);
+  delete[] colIndex;
+}
+
+
+void FstStore::fstReadZoneMap(int colNr, ZoneMap &zoneMap) const
+{
+  // Parsed metadata of the file, kept by an opened store
+  FstFileState* state = AcquireFileState(fstFile, source, fileState);
+  IFstSource &myfile = *state->source;
+  vector<ChunksetInfo> &chunksets = state->chunksets;
+  vector<unsigned short int> &colInfo = state->colInfo;
+
+  int totalCols = colInfo.size() / 4;
+
+  if (colNr < 0 || colNr >= totalCols)
+  {
+    ReleaseFileState(state, fileState);
+    throw(runtime_error("Column selection is out of range."));
+  }
+
+  unsigned short int colType = colInfo[totalCols + colNr];
+
+  switch (colType)
+  {
+    case 7:
+    case 8:
+      zoneMap.valueType = FstColumnType::INT_32;
+      break;
+
+    case 9:
+      zoneMap.valueType = FstColumnType::DOUBLE_64;
+      break;
+
+    case 11:
+      zoneMap.valueType = FstColumnType::INT_64;
+      break;
+
+    default:
+      ReleaseFileState(state, fileState);
+      throw(runtime_error(FSTERROR_ZONEMAP_TYPE));
+  }
+
+  // Chunkset containing the column
+  unsigned int chunksetNr = 0;
+  while (colNr >= chunksets[chunksetNr].colOffset + chunksets[chunksetNr].nrOfCols) ++chunksetNr;
+
+  ChunksetInfo &chunkset = chunksets[chunksetNr];
+  int chunksetCol = colNr - chunkset.colOffset;
+
+  // Files without a chunk index reference were written before zone maps were introduced
+  if (!chunkset.hasIndexRef)
+  {
+    ZoneMapBlock block;
+    block.startRow = 0;
+    block.nrOfRows = *reinterpret_cast<unsigned long long*>(&chunkset.header[64]);
+    block.naCount = 0;
+    block.hasStatistics = false;
+    block.minValue.intValue = 0;
+    block.maxValue.intValue = 0;
+
+    zoneMap.blocks.push_back(block);
+    ReleaseFileState(state, fileState);
+
+    return;
+  }
+
+  ChunksetIndex &chunksetIndex = state->chunksetIndex[chunksetNr];
+
+  if (!LoadChunksetIndex(myfile, chunkset, chunksetIndex))
+  {
+    ReleaseFileState(state, fileState);
+    throw(runtime_error(FSTERROR_DAMAGED_CHUNKINDEX));
+  }
+
+  vector<unsigned long long> &chunkRows = chunksetIndex.chunkRows;
+
+  // Only the column positions and zone maps are read, not the data blocks
+  vector<unsigned long long> positionData(chunkset.nrOfCols);
+  unsigned long long rowOffset = 0;
+
+  for (unsigned int chunkNr = 0; chunkNr < chunkRows.size(); ++chunkNr)
+  {
+    if (!ChunkPositions(myfile, chunkset.nrOfCols, chunksetIndex, chunkNr, positionData.data()))
+    {
+      ReleaseFileState(state, fileState);
+      throw(runtime_error(FSTERROR_DAMAGED_CHUNKINDEX));
+    }
+
+    unsigned long long blockPos = positionData[chunksetCol];
+
+    switch (colType)
+    {
+      case 7:
+        fdsReadFactorZoneMap_v7(myfile, blockPos, chunkRows[chunkNr], rowOffset, zoneMap.blocks);
+        break;
+
+      case 8:
+        fdsReadIntZoneMap_v8(myfile, blockPos, chunkRows[chunkNr], rowOffset, zoneMap.blocks);
+        break;
+
+      case 9:
+        fdsReadRealZoneMap_v9(myfile, blockPos, chunkRows[chunkNr], rowOffset, zoneMap.blocks);
+        break;
+
+      default:  // 11
+        fdsReadInt64ZoneMap_v11(myfile, blockPos, chunkRows[chunkNr], rowOffset, zoneMap.blocks);
+        break;
+    }
+
+    rowOffset += chunkRows[chunkNr];
+  }
+
+  ReleaseFileState(state, fileState);
 }
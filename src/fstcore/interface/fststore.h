@@ -41,6 +41,19 @@
 
 #include <interface/icolumnfactory.h>
 #include <interface/ifsttable.h>
+#include <interface/fstzonemap.h>
+#include <interface/fstfilter.h>
+#include <interface/fstkeylookup.h>
+#include <interface/fstrowindex.h>
+#include <interface/ifstsource.h>
+#include <interface/ifstsink.h>
+
+
+// Parsed metadata of an opened fst file
+struct FstFileState;
+
+// State of a fst file that is written in chunks
+struct FstWriteState;
 
 
 class FstStore
@@ -49,9 +62,16 @@ class FstStore
 
   std::string fstFile;
 
+  FstFileState* fileState;  // state of the opened file, nullptr if the store is not opened
+
+  FstWriteState* writeState;  // state of the file written in chunks, nullptr if no stream is open
+
+  IFstSource* source;  // source with the table of the store, nullptr for a store on file
+  bool ownsSource;     // true if the source is deleted with the store
+
   public:
     IStringColumn* blockReader;
-    unsigned long long* p_nrOfRows;
+    unsigned long long nrOfRows;
     int* keyColPos;
     char* metaDataBlock;
 
@@ -60,13 +80,53 @@ class FstStore
     unsigned short int* colBaseTypes;
     unsigned short int* colAttributeTypes;
     unsigned short int* colScales;
+    std::vector<unsigned short int> colInfo;
 
     unsigned int version;
     int nrOfCols, keyLength;
 
     FstStore(std::string fstFile);
 
-    ~FstStore() { delete blockReader; delete[] metaDataBlock;  }
+	/**
+     * \brief Create a store that reads a table serialized to a memory region (see fstWrite)
+     *
+     * The data is read (and decompressed) directly from the region, which is owned by the caller and should stay
+     * valid while the store is used. Such a store can't be written to.
+     * \param buffer first byte of the serialized table
+     * \param bufferSize size of the serialized table in bytes
+     */
+    FstStore(const char* buffer, unsigned long long bufferSize);
+
+	/**
+     * \brief Create a store that reads the table from a source, e.g. an instrumented FstCountingSource
+     *
+     * The source is owned by the caller and should stay valid while the store is used. Such a store can't be
+     * written to.
+     * \param source source of the stored table
+     */
+    FstStore(IFstSource &source);
+
+    ~FstStore();
+
+	/**
+     * \brief Open the fst file and keep it open until the store is closed or deleted
+     *
+     * The file header, key index, chunkset headers and column names are read and checked once. Reads on an opened
+     * store reuse them, together with the chunk indexes and data chunk headers that were read by earlier reads.
+     * Changes made to the file after it was opened are not visible until the store is opened again. The file is read
+     * with positional reads instead of a memory mapping, so truncating it while it is opened can't crash the process.
+     */
+    void fstOpen();
+
+	/**
+     * \brief Close a store opened with fstOpen(), the cached metadata is released
+     */
+    void fstClose();
+
+	/**
+     * \brief True if the store was opened with fstOpen()
+     */
+    bool IsOpen() const { return fileState != nullptr; }
 
 	/**
      * \brief Stream a data table
@@ -75,10 +135,87 @@ class FstStore
      */
     void fstWrite(IFstTable &fstTable, int compress) const;
 
+	/**
+     * \brief Serialize a data table to a sink, e.g. a FstMemoryBuffer
+     *
+     * The sink receives the same bytes as a fst file. The result can be read with a store created on the memory
+     * region (or source) that holds the bytes.
+     * \param fstTable Table to serialize, implementation of IFstTable interface
+     * \param compress Compression factor with a value 0-100
+     * \param myfile Empty sink that receives the serialized table
+     */
+    void fstWrite(IFstTable &fstTable, int compress, IFstSink &myfile) const;
+
+	/**
+     * \brief Append a data table to an existing fst file as a new (row) data chunk
+     * \param fstTable Table to append, column names and types should be identical to those of the stored table
+     * \param compress Compression factor with a value 0-100
+     */
+    void fstAppend(IFstTable &fstTable, int compress) const;
+
+	/**
+     * \brief Append columns to an existing fst file as a new horizontal chunkset
+     * \param fstTable Table with the new columns, the number of rows should be equal to that of the stored table
+     * \param compress Compression factor with a value 0-100
+     */
+    void fstAppendColumns(IFstTable &fstTable, int compress) const;
+
+	/**
+     * \brief Create the fst file for writing a table in (row) chunks
+     *
+     * The file is kept open until fstStreamClose() is called. Each chunk is compressed and written when it's passed
+     * to fstStreamChunk(), so only a single chunk has to be in memory. The chunk indexes are updated on disk and the
+     * total number of rows is written to the file header when the stream is closed.
+     * \param compress Compression factor with a value 0-100, used for all chunks
+     */
+    void fstStreamOpen(int compress);
+
+	/**
+     * \brief Write the next chunk of rows to a file opened with fstStreamOpen()
+     * \param fstTable Chunk to write, column names and types should be identical to those of the first chunk. Key
+     * columns are not stored. Chunks without rows are skipped.
+     */
+    void fstStreamChunk(IFstTable &fstTable);
+
+	/**
+     * \brief Complete and close a file opened with fstStreamOpen()
+     *
+     * The file is removed if no rows were written. Deleting the store completes the file as well.
+     */
+    void fstStreamClose();
+
     void fstMeta(IColumnFactory* columnFactory);
 
+	/**
+     * \brief Read (a selection of) the rows and columns of a fst file
+     * \param tableReader Table that receives the result columns
+     * \param columnSelection Names of the columns to read, all columns are read when nullptr
+     * \param startRow First row to read (one based)
+     * \param endRow Last row to read, -1 to read up to the last row of the table
+     * \param columnFactory Factory used to create the result columns
+     * \param keyIndex Positions of the key columns in the result (output)
+     * \param selectedCols Names of the result columns (output)
+     * \param filter Row filter, only rows in the selected row range that match the filter are read. Blocks of rows that
+     * can't contain matching rows (according to their zone maps) are skipped. Use nullptr to read all rows.
+     * \param keyLookup Key lookup, only rows in the selected row range with keys equal to one of the lookups are read.
+     * The sorted key columns are searched with a binary search that decodes only the blocks that contain the bounds of
+     * the matching rows. Use nullptr to read all rows. A key lookup can't be combined with a row filter.
+     * \param rowIndex Row numbers to read, in any order and possibly with duplicates. The result has a row for each
+     * requested row, in the requested order. Each data block that contains requested rows is decompressed once. The
+     * selected row range is ignored. Use nullptr to read all rows. A row index can't be combined with a row filter or
+     * a key lookup.
+     */
     void fstRead(IFstTable &tableReader, IStringArray* columnSelection, long long startRow, long long endRow,
-      IColumnFactory* columnFactory, std::vector<int> &keyIndex, IStringArray* selectedCols);
+      IColumnFactory* columnFactory, std::vector<int> &keyIndex, IStringArray* selectedCols, const FstFilter* filter,
+      const FstKeyLookup* keyLookup, const FstRowIndex* rowIndex);
+
+	/**
+     * \brief Read the per-block statistics of a column without reading the column data
+     * \param colNr Column number (zero based) of an integer, double, integer64 or factor column
+     * \param zoneMap Statistics of all blocks of the column (output), blocks of data that was stored without
+     * statistics (uncompressed data or data from older fst versions) are marked with hasStatistics == false
+     */
+    void fstReadZoneMap(int colNr, ZoneMap &zoneMap) const;
 };
 
 
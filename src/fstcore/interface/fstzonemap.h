@@ -0,0 +1,73 @@
+/*
+  fst - An R-package for ultra fast storage and retrieval of datasets.
+  Copyright (C) 2017, Mark AJ Klik
+
+  BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following disclaimer
+    in the documentation and/or other materials provided with the
+    distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+    A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  You can contact the author at :
+  - fst source repository : https://github.com/fstPackage/fst
+*/
+
+
+#ifndef FST_ZONEMAP_H
+#define FST_ZONEMAP_H
+
+
+#include <vector>
+
+#include <interface/ifstcolumn.h>
+
+
+// Minimum or maximum value of a block of column data
+union ZoneMapValue
+{
+  long long intValue;  // INT_32 (widened to 64 bits) and INT_64 columns
+  double doubleValue;  // DOUBLE_64 columns
+};
+
+
+// Statistics of a single block of column data
+struct ZoneMapBlock
+{
+  unsigned long long startRow;  // first row of the block (zero based)
+  unsigned long long nrOfRows;  // number of rows in the block
+  unsigned long long naCount;   // number of NA values in the block
+  bool hasStatistics;           // false if the block was stored without statistics (min, max and naCount are undefined)
+  ZoneMapValue minValue;        // smallest non-NA value, undefined when all values are NA
+  ZoneMapValue maxValue;        // largest non-NA value, undefined when all values are NA
+};
+
+
+// Per-block statistics of a single column, can be used to skip blocks that can't contain selected values
+struct ZoneMap
+{
+  FstColumnType valueType;          // INT_32 (also used for factor codes), DOUBLE_64 or INT_64
+  std::vector<ZoneMapBlock> blocks;  // statistics of consecutive blocks covering all rows of the column
+};
+
+
+#endif  // FST_ZONEMAP_H
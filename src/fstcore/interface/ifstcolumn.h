@@ -150,9 +150,19 @@ public:
   virtual void SetEncoding(StringEncoding stringEncoding) = 0;
 
   virtual void BufferToVec(unsigned long long nrOfElements, unsigned long long startElem, unsigned long long endElem,
-    unsigned long long vecOffset, unsigned int* sizeMeta, char* buf) = 0;
+    unsigned long long vecOffset, const unsigned int* sizeMeta, const char* buf) = 0;
 
   virtual const char* GetElement(unsigned long long elementNr) = 0;
+
+  // Set the level strings of a dictionary encoded vector, a null string is a NA level. Returns false if the column
+  // can't set elements from level codes, the elements are then set with BufferToVec.
+  virtual bool SetLevels(unsigned int nrOfLevels, const char* const* levelStrings, const unsigned int* levelSizes)
+  {
+    return false;
+  }
+
+  // Set elements from (validated) one-based level codes, FST_NA_INT codes are set to NA
+  virtual void LevelCodesToVec(unsigned long long nrOfElements, unsigned long long vecOffset, const int* levelCodes) {}
 };
 
 
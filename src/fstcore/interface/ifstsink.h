@@ -0,0 +1,87 @@
+/*
+  fst - An R-package for ultra fast storage and retrieval of datasets.
+  Copyright (C) 2017, Mark AJ Klik
+
+  BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following disclaimer
+    in the documentation and/or other materials provided with the
+    distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+    A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  You can contact the author at :
+  - fst source repository : https://github.com/fstPackage/fst
+*/
+
+
+#ifndef IFST_SINK_H
+#define IFST_SINK_H
+
+
+/**
+ * \brief Interface to the destination of the bytes of a fst file that are written by the column writers.
+ *
+ * All writes are positional. New data is appended at the end of the sink (at position Size()) and headers are
+ * completed afterwards by writing them again at their original position. Writes are issued by a single thread at a
+ * time, columns and blocks that are compressed concurrently are collected in memory first.
+ */
+class IFstSink
+{
+public:
+  virtual ~IFstSink() {};
+
+  /**
+   * \brief Total number of bytes written to the sink, which is the position where new data is appended
+   */
+  virtual unsigned long long Size() = 0;
+
+  /**
+   * \brief Write a range of bytes to the sink
+   * \param buffer bytes to write
+   * \param pos position of the first byte in the sink, at most Size()
+   * \param length number of bytes to write
+   * \return false if the bytes could not be written
+   */
+  virtual bool Write(const char* buffer, unsigned long long pos, unsigned long long length) = 0;
+
+  /**
+   * \brief True if one of the writes failed. Writers don't check each write, the state of the sink is checked once
+   * after all data has been written.
+   */
+  virtual bool Fail() = 0;
+};
+
+
+/**
+ * \brief Append a range of bytes at the end of a sink
+ * \param sink sink to write to
+ * \param buffer bytes to write
+ * \param length number of bytes to write
+ * \return false if the bytes could not be written
+ */
+inline bool SinkAppend(IFstSink &sink, const char* buffer, unsigned long long length)
+{
+  return sink.Write(buffer, sink.Size(), length);
+}
+
+
+#endif // IFST_SINK_H
@@ -0,0 +1,96 @@
+/*
+  fst - An R-package for ultra fast storage and retrieval of datasets.
+  Copyright (C) 2017, Mark AJ Klik
+
+  BSD 2-Clause License (http://www.opensource.org/licenses/bsd-license.php)
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions are
+  met:
+
+  * Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+  * Redistributions in binary form must reproduce the above
+    copyright notice, this list of conditions and the following disclaimer
+    in the documentation and/or other materials provided with the
+    distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+    A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+    OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+    SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+    LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+    DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+    THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+    (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+  You can contact the author at :
+  - fst source repository : https://github.com/fstPackage/fst
+*/
+
+
+#ifndef IFST_SOURCE_H
+#define IFST_SOURCE_H
+
+
+/**
+ * \brief Interface to the bytes of a fst file that are read by the column readers.
+ *
+ * All reads are positional, so a source has no file pointer and can be used by multiple threads at once. Sources that
+ * keep the file contents in memory can hand out pointers to the stored bytes, which allows readers to decompress (or
+ * copy) the data directly from that memory.
+ */
+class IFstSource
+{
+public:
+  virtual ~IFstSource() {};
+
+  /**
+   * \brief Total number of bytes available in the source
+   */
+  virtual unsigned long long Size() = 0;
+
+  /**
+   * \brief Copy a range of bytes from the source into a buffer
+   * \param buffer buffer with room for at least 'length' bytes
+   * \param pos position of the first byte in the source
+   * \param length number of bytes to read
+   * \return false if the range could not be read completely
+   */
+  virtual bool Read(char* buffer, unsigned long long pos, unsigned long long length) = 0;
+
+  /**
+   * \brief Direct access to a range of bytes in the source
+   * \param pos position of the first byte in the source
+   * \param length number of bytes requested
+   * \return pointer to the first byte or a nullptr if the source is not memory based or the range is out of bounds. In
+   * the latter case, the bytes should be retrieved with Read().
+   */
+  virtual const char* Map(unsigned long long pos, unsigned long long length) = 0;
+};
+
+
+/**
+ * \brief Access a range of bytes of a source, without a copy if the source is memory based
+ * \param buffer buffer with room for 'length' bytes, receives the bytes if they can't be accessed directly
+ * \param pos position of the first byte in the source
+ * \param length number of bytes requested
+ * \return pointer to the requested bytes, either in the source or in 'buffer'
+ */
+inline const char* SourceData(IFstSource &source, char* buffer, unsigned long long pos, unsigned long long length)
+{
+  const char* data = source.Map(pos, length);
+
+  if (data != nullptr) return data;
+
+  source.Read(buffer, pos, length);
+
+  return buffer;
+}
+
+
+#endif // IFST_SOURCE_H
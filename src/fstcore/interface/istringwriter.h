@@ -59,6 +59,12 @@ public:
   virtual StringEncoding Encoding() = 0;
 
   virtual void SetBuffersFromVec(unsigned long long startCount, unsigned long long endCount) = 0;
+
+  /**
+   * \brief Create a writer for the same string vector with its own buffers, for use by a single worker thread
+   * \return a new writer (owned by the caller), or a nullptr if the vector can't be accessed from multiple threads
+   */
+  virtual IStringWriter* CreateThreadWriter() { return nullptr; }
 };
 
 
@@ -39,6 +39,7 @@ You can contact the author at :
 #endif
 
 #include "openmphelper.h"
+#include "fstdefines.h"
 
 
 static int FstThreads = 0;
@@ -46,6 +47,9 @@ static int FstThreads = 0;
 int GetFstThreads()
 {
 #ifdef _OPENMP
+	// nested parallel regions are not used, work inside a parallel region is done by the calling thread
+	if (omp_in_parallel()) return 1;
+
 	int ans = FstThreads == 0 ? omp_get_max_threads() : std::min(FstThreads, omp_get_max_threads());
 	return std::max(1, ans);
 #else
@@ -68,3 +72,18 @@ bool HasOpenMP()
   return false;
 #endif
 }
+
+
+static unsigned long long FstWriteBudget = WRITE_PIPELINE_BUDGET;
+
+unsigned long long GetFstWriteBudget()
+{
+  return FstWriteBudget;
+}
+
+unsigned long long SetFstWriteBudget(unsigned long long writeBudget)
+{
+  unsigned long long oldWriteBudget = FstWriteBudget;
+  FstWriteBudget = writeBudget == 0 ? WRITE_PIPELINE_BUDGET : writeBudget;
+  return oldWriteBudget;
+}
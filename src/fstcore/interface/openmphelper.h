@@ -48,4 +48,16 @@ int SetFstThreads(int nrOfThreads);
 
 bool HasOpenMP();
 
+/**
+ * \brief Memory budget (in bytes) for the buffers of columns that are compressed concurrently during writes
+ */
+unsigned long long GetFstWriteBudget();
+
+/**
+ * \brief Set the memory budget for concurrent column writes
+ * \param writeBudget budget in bytes, 0 restores the default budget
+ * \return the previous budget
+ */
+unsigned long long SetFstWriteBudget(unsigned long long writeBudget);
+
 #endif  // OPEN_MP_HELPER_H
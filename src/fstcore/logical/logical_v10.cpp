@@ -44,12 +44,12 @@ using namespace std;
 
 // Logical vectors are always compressed to fill all available bits (factor 16 compression).
 // On top of that, we can compress the resulting bytes with a custom compressor.
-void fdsWriteLogicalVec_v10(ofstream &myfile, int* boolVector, unsigned long long nrOfLogicals, int compression, std::string annotation)
+void fdsWriteLogicalVec_v10(IFstSink &myfile, int* boolVector, unsigned long long nrOfLogicals, int compression, std::string annotation)
 {
   if (compression == 0)
   {
     FixedRatioCompressor* compressor = new FixedRatioCompressor(CompAlgo::LOGIC64);  // compression level not relevant here
-    fdsStreamUncompressed_v2(myfile, (char*) boolVector, nrOfLogicals, 4, BLOCKSIZE_LOGICAL, compressor, annotation);
+    fdsStreamUncompressed_v2(myfile, (char*) boolVector, nrOfLogicals, 4, BLOCKSIZE_LOGICAL, compressor, annotation, FstColumnType::UNKNOWN);
 
     delete compressor;
 
@@ -65,7 +65,17 @@ void fdsWriteLogicalVec_v10(ofstream &myfile, int* boolVector, unsigned long lon
     StreamCompressor* streamCompressor = new StreamCompositeCompressor(defaultCompress, compress2, 2 * compression);
     streamCompressor->CompressBufferSize(blockSize);
 
-    fdsStreamcompressed_v2(myfile, (char*) boolVector, nrOfLogicals, 4, streamCompressor, BLOCKSIZE_LOGICAL, annotation);
+    try
+    {
+      fdsStreamcompressed_v2(myfile, (char*) boolVector, nrOfLogicals, 4, streamCompressor, BLOCKSIZE_LOGICAL, annotation, FstColumnType::UNKNOWN);
+    }
+    catch (...)
+    {
+      delete defaultCompress;
+      delete compress2;
+      delete streamCompressor;
+      throw;
+    }
 
     delete defaultCompress;
     delete compress2;
@@ -79,7 +89,17 @@ void fdsWriteLogicalVec_v10(ofstream &myfile, int* boolVector, unsigned long lon
     Compressor* compress2 = new SingleCompressor(CompAlgo::ZSTD_LOGIC64, 30 + 7 * (compression - 50) / 5);
     StreamCompressor* streamCompressor = new StreamCompositeCompressor(compress1, compress2, 2 * (compression - 50));
     streamCompressor->CompressBufferSize(blockSize);
-    fdsStreamcompressed_v2(myfile, (char*) boolVector, nrOfLogicals, 4, streamCompressor, BLOCKSIZE_LOGICAL, annotation);
+    try
+    {
+      fdsStreamcompressed_v2(myfile, (char*) boolVector, nrOfLogicals, 4, streamCompressor, BLOCKSIZE_LOGICAL, annotation, FstColumnType::UNKNOWN);
+    }
+    catch (...)
+    {
+      delete compress1;
+      delete compress2;
+      delete streamCompressor;
+      throw;
+    }
 
     delete compress1;
     delete compress2;
@@ -90,7 +110,7 @@ void fdsWriteLogicalVec_v10(ofstream &myfile, int* boolVector, unsigned long lon
 }
 
 
-void fdsReadLogicalVec_v10(istream &myfile, int* boolVector, unsigned long long blockPos, unsigned long long startRow,
+void fdsReadLogicalVec_v10(IFstSource &myfile, int* boolVector, unsigned long long blockPos, unsigned long long startRow,
   unsigned long long length, unsigned long long size)
 {
   std::string annotation;
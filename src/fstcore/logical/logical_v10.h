@@ -40,13 +40,16 @@
 #include <istream>
 #include <ostream>
 
+#include <interface/ifstsource.h>
+#include <interface/ifstsink.h>
+
 
 // Logical vectors are always compressed to fill all available bits (factor 16 compression).
 // On top of that, we can compress the resulting bytes with a custom compressor.
-void fdsWriteLogicalVec_v10(std::ofstream &myfile, int* boolVector, unsigned long long nrOfLogicals, int compression, std::string annotation);
+void fdsWriteLogicalVec_v10(IFstSink &myfile, int* boolVector, unsigned long long nrOfLogicals, int compression, std::string annotation);
 
 
-void fdsReadLogicalVec_v10(std::istream &myfile, int* boolVector, unsigned long long blockPos, unsigned long long startRow,
+void fdsReadLogicalVec_v10(IFstSource &myfile, int* boolVector, unsigned long long blockPos, unsigned long long startRow,
   unsigned long long length, unsigned long long size);
 
 #endif // LOGICAL_v10_H
@@ -9,26 +9,65 @@
 */
 
 /* .Call calls */
+extern SEXP _fst_fstaddcolumns(SEXP, SEXP, SEXP, SEXP);
+extern SEXP _fst_fstbatchclose(SEXP);
+extern SEXP _fst_fstbatchnext(SEXP);
+extern SEXP _fst_fstbatchopen(SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP _fst_fstchardict(SEXP);
+extern SEXP _fst_fstclose(SEXP);
 extern SEXP _fst_fstcomp(SEXP, SEXP, SEXP, SEXP);
 extern SEXP _fst_fstdecomp(SEXP);
 extern SEXP _fst_fsthasher(SEXP, SEXP);
+extern SEXP _fst_fstlazycolumn(SEXP, SEXP, SEXP, SEXP, SEXP);
 extern SEXP _fst_fstmetadata(SEXP);
-extern SEXP _fst_fstretrieve(SEXP, SEXP, SEXP, SEXP);
-extern SEXP _fst_fststore(SEXP, SEXP, SEXP, SEXP);
+extern SEXP _fst_fstopen(SEXP);
+extern SEXP _fst_fstreadgap(SEXP);
+extern SEXP _fst_fstreadlatency(SEXP);
+extern SEXP _fst_fstreadmethod(SEXP);
+extern SEXP _fst_fstreadqueue(SEXP);
+extern SEXP _fst_fstretrieve(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP _fst_fstserialize(SEXP, SEXP, SEXP);
+extern SEXP _fst_fststore(SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP _fst_fstwritebudget(SEXP);
+extern SEXP _fst_fstwriterchunk(SEXP, SEXP, SEXP);
+extern SEXP _fst_fstwriterclose(SEXP);
+extern SEXP _fst_fstwriteropen(SEXP, SEXP);
+extern SEXP _fst_fstzonemap(SEXP, SEXP);
+extern SEXP _fst_fstzstdreuse(SEXP);
 extern SEXP _fst_getnrofthreads();
 extern SEXP _fst_hasopenmp();
 extern SEXP _fst_setnrofthreads(SEXP);
 
 extern int avoid_openmp_hang_within_fork();
+extern void register_fst_altrep_classes(DllInfo *dll);
 
 
 static const R_CallMethodDef CallEntries[] = {
+    {"_fst_fstaddcolumns",  (DL_FUNC) &_fst_fstaddcolumns,  4},
+    {"_fst_fstbatchclose",  (DL_FUNC) &_fst_fstbatchclose,  1},
+    {"_fst_fstbatchnext",   (DL_FUNC) &_fst_fstbatchnext,   1},
+    {"_fst_fstbatchopen",   (DL_FUNC) &_fst_fstbatchopen,   5},
+    {"_fst_fstchardict",    (DL_FUNC) &_fst_fstchardict,    1},
+    {"_fst_fstclose",       (DL_FUNC) &_fst_fstclose,       1},
     {"_fst_fstcomp",        (DL_FUNC) &_fst_fstcomp,        4},
     {"_fst_fstdecomp",      (DL_FUNC) &_fst_fstdecomp,      1},
     {"_fst_fsthasher",      (DL_FUNC) &_fst_fsthasher,      2},
+    {"_fst_fstlazycolumn",  (DL_FUNC) &_fst_fstlazycolumn,  5},
     {"_fst_fstmetadata",    (DL_FUNC) &_fst_fstmetadata,    1},
-    {"_fst_fstretrieve",    (DL_FUNC) &_fst_fstretrieve,    4},
-    {"_fst_fststore",       (DL_FUNC) &_fst_fststore,       4},
+    {"_fst_fstopen",        (DL_FUNC) &_fst_fstopen,        1},
+    {"_fst_fstreadgap",     (DL_FUNC) &_fst_fstreadgap,     1},
+    {"_fst_fstreadlatency", (DL_FUNC) &_fst_fstreadlatency, 1},
+    {"_fst_fstreadmethod",  (DL_FUNC) &_fst_fstreadmethod,  1},
+    {"_fst_fstreadqueue",   (DL_FUNC) &_fst_fstreadqueue,   1},
+    {"_fst_fstretrieve",    (DL_FUNC) &_fst_fstretrieve,    7},
+    {"_fst_fstserialize",   (DL_FUNC) &_fst_fstserialize,   3},
+    {"_fst_fststore",       (DL_FUNC) &_fst_fststore,       5},
+    {"_fst_fstwritebudget", (DL_FUNC) &_fst_fstwritebudget, 1},
+    {"_fst_fstwriterchunk", (DL_FUNC) &_fst_fstwriterchunk, 3},
+    {"_fst_fstwriterclose", (DL_FUNC) &_fst_fstwriterclose, 1},
+    {"_fst_fstwriteropen",  (DL_FUNC) &_fst_fstwriteropen,  2},
+    {"_fst_fstzonemap",     (DL_FUNC) &_fst_fstzonemap,     2},
+    {"_fst_fstzstdreuse",   (DL_FUNC) &_fst_fstzstdreuse,   1},
     {"_fst_getnrofthreads", (DL_FUNC) &_fst_getnrofthreads, 0},
     {"_fst_hasopenmp",      (DL_FUNC) &_fst_hasopenmp,      0},
     {"_fst_setnrofthreads", (DL_FUNC) &_fst_setnrofthreads, 1},
@@ -41,4 +80,6 @@ void R_init_fst(DllInfo *dll)
     R_useDynamicSymbols(dll, FALSE);
 
     avoid_openmp_hang_within_fork();  // don't use OpenMP after forking
+
+    register_fst_altrep_classes(dll);  // lazy columns
 }